@@ -548,6 +548,45 @@ void CopyContext::updateBuffer(const Buffer* pBuffer, const void* pData, size_t
     mCommandsPending = true;
 }
 
+void CopyContext::updateBufferRegions(const Buffer* pBuffer, const void* pData, const std::vector<BufferRegion>& regions)
+{
+    uint64_t totalSize = 0;
+    for (const auto& region : regions)
+    {
+        FALCOR_CHECK(
+            region.offset + region.size <= pBuffer->getSize(),
+            "Region (offset {}, size {}) doesn't fit the buffer size {}.",
+            region.offset,
+            region.size,
+            pBuffer->getSize()
+        );
+        totalSize += region.size;
+    }
+    if (totalSize == 0)
+        return;
+
+    const auto& pUploadHeap = mpDevice->getUploadHeap();
+    auto allocation = pUploadHeap->allocate(totalSize, 16);
+
+    bufferBarrier(pBuffer, Resource::State::CopyDest);
+    auto resourceEncoder = getLowLevelData()->getResourceCommandEncoder();
+
+    uint64_t stagingOffset = 0;
+    for (const auto& region : regions)
+    {
+        if (region.size == 0)
+            continue;
+        std::memcpy(allocation.pData + stagingOffset, static_cast<const uint8_t*>(pData) + region.offset, region.size);
+        resourceEncoder->copyBuffer(
+            pBuffer->getGfxBufferResource(), region.offset, allocation.gfxBufferResource, allocation.offset + stagingOffset, region.size
+        );
+        stagingOffset += region.size;
+    }
+
+    pUploadHeap->release(allocation);
+    mCommandsPending = true;
+}
+
 void CopyContext::readBuffer(const Buffer* pBuffer, void* pData, size_t offset, size_t numBytes)
 {
     if (numBytes == 0)
@@ -198,6 +198,22 @@ public:
      */
     void updateBuffer(const Buffer* pBuffer, const void* pData, size_t offset = 0, size_t numBytes = 0);
 
+    /// Region of a buffer in bytes.
+    struct BufferRegion
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    /**
+     * Update multiple regions of a buffer.
+     * All regions are staged in a single allocation of the device upload heap and copied with one copy command per region.
+     * @param[in] pBuffer Buffer to update.
+     * @param[in] pData Pointer to the source data. Each region is read from the same byte offset as it is written to.
+     * @param[in] regions List of regions to update.
+     */
+    void updateBufferRegions(const Buffer* pBuffer, const void* pData, const std::vector<BufferRegion>& regions);
+
     void readBuffer(const Buffer* pBuffer, void* pData, size_t offset = 0, size_t numBytes = 0);
 
     template<typename T>
@@ -1295,6 +1295,7 @@ FALCOR_SCRIPT_BINDING(Device)
     FALCOR_SCRIPT_BINDING_DEPENDENCY(Profiler)
     FALCOR_SCRIPT_BINDING_DEPENDENCY(RenderContext)
     FALCOR_SCRIPT_BINDING_DEPENDENCY(Program)
+    FALCOR_SCRIPT_BINDING_DEPENDENCY(ProgramManager)
 
     pybind11::class_<AdapterInfo> adapterInfo(m, "AdapterInfo");
     adapterInfo.def_readonly("device_id", &AdapterInfo::deviceID);
@@ -1454,6 +1455,7 @@ FALCOR_SCRIPT_BINDING(Device)
     device.def("end_frame", &Device::endFrame);
 
     device.def_property_readonly("profiler", &Device::getProfiler);
+    device.def_property_readonly("program_manager", &Device::getProgramManager);
     device.def_property_readonly("type", &Device::getType);
     device.def_property_readonly("info", &Device::getInfo);
     device.def_property_readonly("limits", &Device::getLimits);
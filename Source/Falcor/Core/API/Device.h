@@ -148,6 +148,10 @@ public:
         /// The full path to the root directory for the shader cache. An empty string will disable the cache.
         std::string shaderCachePath = (getRuntimeDirectory() / ".shadercache").string();
 
+        /// The full path to the directory for the persistent program cache, which stores the results of the Slang front-end.
+        /// An empty string will disable the cache. Can be overridden by the FALCOR_PROGRAM_CACHE_PATH environment variable.
+        std::string programCachePath;
+
 #if FALCOR_HAS_D3D12
         /// GUID list for experimental features
         std::vector<GUID> experimentalFeatures;
@@ -0,0 +1,491 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ReadbackQueue.h"
+#include "Device.h"
+#include "Buffer.h"
+#include "Texture.h"
+#include "Fence.h"
+#include "RenderContext.h"
+#include "GFXAPI.h"
+#include "PythonHelpers.h"
+#include "Core/Error.h"
+#include "Core/ObjectPython.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/Scripting/ndarray.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace Falcor
+{
+namespace
+{
+/// Alignment of items in the staging buffer. This is the texture data placement alignment required by D3D12.
+constexpr uint64_t kStagingAlignment = 512;
+/// Staging buffers are allocated in multiples of this size to avoid reallocating for small changes in batch size.
+constexpr uint64_t kStagingGranularity = 1ull << 16;
+/// Maximum number of host memory blocks kept for reuse per ring slot.
+constexpr size_t kMaxFreeHostBlocksPerSlot = 2;
+
+void copyItemToHost(const ReadbackQueue::ItemLayout& layout, const uint8_t* pStaging, uint8_t* pDst)
+{
+    const uint8_t* pSrc = pStaging + layout.stagingOffset;
+    if (layout.stagingRowPitch == layout.rowSize)
+    {
+        std::memcpy(pDst, pSrc, layout.size);
+        return;
+    }
+
+    for (uint32_t z = 0; z < layout.depth; z++)
+    {
+        for (uint32_t y = 0; y < layout.rowCount; y++)
+        {
+            size_t row = size_t(z) * layout.rowCount + y;
+            std::memcpy(pDst + row * layout.rowSize, pSrc + row * layout.stagingRowPitch, layout.rowSize);
+        }
+    }
+}
+} // namespace
+
+ReadbackQueue::Batch::Batch(
+    ref<ReadbackQueue> pQueue,
+    uint32_t slot,
+    uint64_t fenceValue,
+    std::vector<ItemLayout> layouts,
+    uint64_t hostSize
+)
+    : mpQueue(std::move(pQueue)), mSlot(slot), mFenceValue(fenceValue), mLayouts(std::move(layouts)), mHostSize(hostSize)
+{}
+
+ReadbackQueue::Batch::~Batch()
+{
+    // An unresolved batch still owns its ring slot. The data is discarded, but later copies into the slot are
+    // ordered after the pending transfer on the device, so the slot can be reused right away.
+    if (!mResolved)
+        mpQueue->releaseSlot(mSlot);
+    if (mpHostData)
+        mpQueue->recycleHostMemory(std::move(mpHostData), mHostSize);
+}
+
+bool ReadbackQueue::Batch::isReady() const
+{
+    return mResolved || mpQueue->mpFence->getCurrentValue() >= mFenceValue;
+}
+
+void ReadbackQueue::Batch::wait(const std::vector<void*>& destinations)
+{
+    FALCOR_CHECK(
+        destinations.empty() || destinations.size() == mLayouts.size(),
+        "Expected {} destinations, got {}.",
+        mLayouts.size(),
+        destinations.size()
+    );
+
+    // The batch may already have been resolved, e.g. when its ring slot was reused. Copy out of host memory instead.
+    if (mResolved)
+    {
+        for (size_t i = 0; i < destinations.size(); i++)
+        {
+            if (!destinations[i])
+                continue;
+            FALCOR_CHECK(mInHostMemory[i], "Item {} was copied to caller-provided memory.", i);
+            std::memcpy(destinations[i], mpHostData.get() + mLayouts[i].hostOffset, mLayouts[i].size);
+        }
+        return;
+    }
+
+    mpQueue->mpFence->wait(mFenceValue);
+
+    const Buffer* pStaging = mpQueue->mSlots[mSlot].pStaging.get();
+    const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(pStaging->map());
+
+    mInHostMemory.resize(mLayouts.size());
+    for (size_t i = 0; i < mLayouts.size(); i++)
+    {
+        uint8_t* pDst = destinations.empty() ? nullptr : reinterpret_cast<uint8_t*>(destinations[i]);
+        mInHostMemory[i] = pDst == nullptr;
+        if (!pDst)
+        {
+            if (!mpHostData)
+                mpHostData = mpQueue->acquireHostMemory(mHostSize);
+            pDst = mpHostData.get() + mLayouts[i].hostOffset;
+        }
+        copyItemToHost(mLayouts[i], pSrc, pDst);
+    }
+
+    pStaging->unmap();
+
+    mResolved = true;
+    mpQueue->releaseSlot(mSlot);
+}
+
+bool ReadbackQueue::Batch::isInHostMemory(size_t index) const
+{
+    FALCOR_CHECK(index < mLayouts.size(), "'index' ({}) is out of bounds. Batch has {} item(s).", index, mLayouts.size());
+    return mResolved && mInHostMemory[index];
+}
+
+const void* ReadbackQueue::Batch::getData(size_t index)
+{
+    FALCOR_CHECK(index < mLayouts.size(), "'index' ({}) is out of bounds. Batch has {} item(s).", index, mLayouts.size());
+    wait();
+    FALCOR_CHECK(mInHostMemory[index], "Item {} was copied to caller-provided memory.", index);
+    return mpHostData.get() + mLayouts[index].hostOffset;
+}
+
+ReadbackQueue::ReadbackQueue(ref<Device> pDevice, uint32_t slotCount) : mpDevice(std::move(pDevice))
+{
+    FALCOR_CHECK(mpDevice, "'device' must not be null");
+    FALCOR_CHECK(slotCount > 0, "'slotCount' must be at least 1");
+
+    mpFence = mpDevice->createFence();
+    mSlots.resize(slotCount);
+}
+
+ref<ReadbackQueue::Batch> ReadbackQueue::enqueue(RenderContext* pRenderContext, const std::vector<Item>& items)
+{
+    FALCOR_CHECK(pRenderContext, "'renderContext' must not be null");
+    FALCOR_CHECK(!items.empty(), "'items' must not be empty");
+
+    // Compute the staging and host memory layouts of all items.
+    std::vector<ItemLayout> layouts(items.size());
+    uint64_t stagingSize = 0;
+    uint64_t hostSize = 0;
+    const uint32_t rowAlignment = (uint32_t)mpDevice->getTextureRowAlignment();
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const Resource* pResource = items[i].pResource.get();
+        FALCOR_CHECK(pResource, "Item {} has no resource.", i);
+
+        ItemLayout& layout = layouts[i];
+        layout.type = pResource->getType();
+        if (layout.type == Resource::Type::Buffer)
+        {
+            const Buffer* pBuffer = static_cast<const Buffer*>(pResource);
+            FALCOR_CHECK(pBuffer->getMemoryType() != MemoryType::ReadBack, "Item {} is a readback buffer and cannot be copied from.", i);
+            layout.format = pBuffer->getFormat();
+            layout.width = pBuffer->isTyped() ? pBuffer->getElementCount() : (uint32_t)pBuffer->getSize();
+            layout.height = 1;
+            layout.depth = 1;
+            layout.rowSize = (uint32_t)pBuffer->getSize();
+            layout.rowCount = 1;
+            layout.stagingRowPitch = layout.rowSize;
+        }
+        else
+        {
+            const Texture* pTexture = static_cast<const Texture*>(pResource);
+            uint32_t subresource = items[i].subresource;
+            FALCOR_CHECK(
+                subresource < pTexture->getSubresourceCount(),
+                "Item {} subresource ({}) is out of bounds. Only {} subresource(s) available.",
+                i,
+                subresource,
+                pTexture->getSubresourceCount()
+            );
+            uint32_t mipLevel = pTexture->getSubresourceMipLevel(subresource);
+            ResourceFormat format = pTexture->getFormat();
+            uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+            uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+
+            layout.format = format;
+            layout.width = pTexture->getWidth(mipLevel);
+            layout.height = pTexture->getHeight(mipLevel);
+            layout.depth = pTexture->getDepth(mipLevel);
+            layout.rowSize = div_round_up(layout.width, blockWidth) * getFormatBytesPerBlock(format);
+            layout.rowCount = div_round_up(layout.height, blockHeight);
+            layout.stagingRowPitch = align_to(rowAlignment, layout.rowSize);
+        }
+
+        layout.size = uint64_t(layout.depth) * layout.rowCount * layout.rowSize;
+        layout.stagingOffset = align_to(kStagingAlignment, stagingSize);
+        stagingSize = layout.stagingOffset + uint64_t(layout.depth) * layout.rowCount * layout.stagingRowPitch;
+        layout.hostOffset = hostSize;
+        hostSize = align_to(uint64_t(16), hostSize + layout.size);
+    }
+
+    // Acquire the next ring slot. If it is still owned by an unresolved batch, resolve that batch first.
+    uint32_t slotIndex = mNextSlot;
+    mNextSlot = (mNextSlot + 1) % (uint32_t)mSlots.size();
+    Slot& slot = mSlots[slotIndex];
+    if (slot.pOwner)
+        slot.pOwner->wait();
+    FALCOR_ASSERT(slot.pOwner == nullptr);
+
+    if (!slot.pStaging || slot.pStaging->getSize() < stagingSize)
+    {
+        slot.pStaging =
+            mpDevice->createBuffer(align_to(kStagingGranularity, stagingSize), ResourceBindFlags::None, MemoryType::ReadBack, nullptr);
+    }
+
+    // Record all copies into the staging buffer.
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const ItemLayout& layout = layouts[i];
+        if (layout.type == Resource::Type::Buffer)
+        {
+            const Buffer* pBuffer = static_cast<const Buffer*>(items[i].pResource.get());
+            pRenderContext->copyBufferRegion(slot.pStaging.get(), layout.stagingOffset, pBuffer, 0, layout.size);
+        }
+        else
+        {
+            const Texture* pTexture = static_cast<const Texture*>(items[i].pResource.get());
+            uint32_t subresource = items[i].subresource;
+            pRenderContext->resourceBarrier(pTexture, Resource::State::CopySource);
+
+            gfx::SubresourceRange srcSubresource = {};
+            srcSubresource.baseArrayLayer = pTexture->getSubresourceArraySlice(subresource);
+            srcSubresource.mipLevel = pTexture->getSubresourceMipLevel(subresource);
+            srcSubresource.layerCount = 1;
+            srcSubresource.mipLevelCount = 1;
+            auto encoder = pRenderContext->getLowLevelData()->getResourceCommandEncoder();
+            encoder->copyTextureToBuffer(
+                slot.pStaging->getGfxBufferResource(),
+                layout.stagingOffset,
+                uint64_t(layout.depth) * layout.rowCount * layout.stagingRowPitch,
+                layout.stagingRowPitch,
+                pTexture->getGfxTextureResource(),
+                gfx::ResourceState::CopySource,
+                srcSubresource,
+                gfx::ITextureResource::Offset3D(0, 0, 0),
+                gfx::ITextureResource::Extents{
+                    static_cast<gfx::GfxIndex>(layout.width),
+                    static_cast<gfx::GfxIndex>(layout.height),
+                    static_cast<gfx::GfxIndex>(layout.depth)}
+            );
+            pRenderContext->setPendingCommands(true);
+        }
+    }
+
+    // Submit without waiting and signal the fence once for the whole batch.
+    pRenderContext->submit(false);
+    uint64_t fenceValue = pRenderContext->signal(mpFence.get());
+
+    ref<Batch> pBatch(new Batch(ref<ReadbackQueue>(this), slotIndex, fenceValue, std::move(layouts), hostSize));
+    slot.pOwner = pBatch.get();
+    return pBatch;
+}
+
+uint64_t ReadbackQueue::getStagingSize() const
+{
+    uint64_t size = 0;
+    for (const auto& slot : mSlots)
+        size += slot.pStaging ? slot.pStaging->getSize() : 0;
+    return size;
+}
+
+void ReadbackQueue::releaseSlot(uint32_t slot)
+{
+    FALCOR_ASSERT(slot < mSlots.size());
+    mSlots[slot].pOwner = nullptr;
+}
+
+std::unique_ptr<uint8_t[]> ReadbackQueue::acquireHostMemory(uint64_t size)
+{
+    // Pick the smallest free block that fits.
+    auto best = mFreeHostBlocks.end();
+    for (auto it = mFreeHostBlocks.begin(); it != mFreeHostBlocks.end(); ++it)
+    {
+        if (it->size == size || (it->size > size && (best == mFreeHostBlocks.end() || it->size < best->size)))
+            best = it;
+        if (best != mFreeHostBlocks.end() && best->size == size)
+            break;
+    }
+
+    if (best != mFreeHostBlocks.end())
+    {
+        std::unique_ptr<uint8_t[]> pData = std::move(best->pData);
+        mFreeHostBlocks.erase(best);
+        return pData;
+    }
+
+    return std::unique_ptr<uint8_t[]>(new uint8_t[size]);
+}
+
+void ReadbackQueue::recycleHostMemory(std::unique_ptr<uint8_t[]> pData, uint64_t size)
+{
+    if (mFreeHostBlocks.size() >= kMaxFreeHostBlocksPerSlot * mSlots.size())
+    {
+        // Drop the smallest block to keep the pool bounded.
+        auto smallest =
+            std::min_element(mFreeHostBlocks.begin(), mFreeHostBlocks.end(), [](const auto& a, const auto& b) { return a.size < b.size; });
+        if (smallest->size >= size)
+            return;
+        mFreeHostBlocks.erase(smallest);
+    }
+    mFreeHostBlocks.push_back({std::move(pData), size});
+}
+
+/**
+ * Python binding helpers.
+ */
+inline std::vector<size_t> getItemShape(const ReadbackQueue::ItemLayout& layout)
+{
+    std::vector<size_t> shape;
+    uint32_t channelCount = getFormatChannelCount(layout.format);
+    if (layout.depth > 1)
+        shape.push_back(layout.depth);
+    if (layout.height > 1)
+        shape.push_back(layout.height);
+    shape.push_back(layout.width);
+    if (channelCount > 1)
+        shape.push_back(channelCount);
+    return shape;
+}
+
+template<typename Framework>
+inline pybind11::list batch_to_ndarrays(ReadbackQueue::Batch& self)
+{
+    self.wait();
+
+    pybind11::list result;
+    for (size_t i = 0; i < self.getItemCount(); i++)
+    {
+        // Items that were copied to caller-provided memory have no view.
+        if (!self.isInHostMemory(i))
+        {
+            result.append(pybind11::none());
+            continue;
+        }
+
+        const ReadbackQueue::ItemLayout& layout = self.getLayout(i);
+        void* pData = const_cast<void*>(self.getData(i));
+
+        // The returned arrays are views into the batch host memory. Keep the batch alive as long as any view exists.
+        pybind11::capsule owner(
+            new ref<ReadbackQueue::Batch>(&self), [](void* p) noexcept { delete reinterpret_cast<ref<ReadbackQueue::Batch>*>(p); }
+        );
+
+        auto dtype = layout.format != ResourceFormat::Unknown ? resourceFormatToDtype(layout.format) : std::nullopt;
+        if (dtype)
+        {
+            std::vector<size_t> shape = getItemShape(layout);
+            result.append(
+                pybind11::ndarray<Framework>(pData, shape.size(), shape.data(), owner, nullptr, *dtype, pybind11::device::cpu::value)
+            );
+        }
+        else
+        {
+            size_t shape[1] = {layout.size};
+            result.append(
+                pybind11::ndarray<Framework>(pData, 1, shape, owner, nullptr, pybind11::dtype<uint8_t>(), pybind11::device::cpu::value)
+            );
+        }
+    }
+    return result;
+}
+
+inline void batch_wait(ReadbackQueue::Batch& self, std::optional<pybind11::list> out)
+{
+    std::vector<void*> destinations;
+    if (out)
+    {
+        FALCOR_CHECK(out->size() == self.getItemCount(), "'out' must contain {} entries, got {}.", self.getItemCount(), out->size());
+        destinations.resize(self.getItemCount(), nullptr);
+        for (size_t i = 0; i < self.getItemCount(); i++)
+        {
+            pybind11::handle entry = (*out)[i];
+            if (entry.is_none())
+                continue;
+            auto array = pybind11::cast<pybind11::ndarray<>>(entry);
+            FALCOR_CHECK(array.device_type() == pybind11::device::cpu::value, "'out[{}]' is not in host memory.", i);
+            FALCOR_CHECK(isNdarrayContiguous(array), "'out[{}]' is not contiguous.", i);
+            size_t size = getNdarrayByteSize(array);
+            FALCOR_CHECK(
+                size == self.getLayout(i).size, "'out[{}]' doesn't match the item size ({} != {}).", i, size, self.getLayout(i).size
+            );
+            destinations[i] = array.data();
+        }
+    }
+
+    self.wait(destinations);
+}
+
+inline ref<ReadbackQueue::Batch> readback_queue_enqueue(ReadbackQueue& self, RenderContext* render_context, pybind11::list items)
+{
+    std::vector<ReadbackQueue::Item> queueItems;
+    queueItems.reserve(items.size());
+    for (pybind11::handle entry : items)
+    {
+        ReadbackQueue::Item item;
+        if (pybind11::isinstance<pybind11::tuple>(entry))
+        {
+            // (texture, mip_level, array_slice)
+            auto tuple = pybind11::cast<pybind11::tuple>(entry);
+            FALCOR_CHECK(tuple.size() == 3, "Texture items must be given as (texture, mip_level, array_slice).");
+            auto pTexture = pybind11::cast<ref<Texture>>(tuple[0]);
+            auto mipLevel = pybind11::cast<uint32_t>(tuple[1]);
+            auto arraySlice = pybind11::cast<uint32_t>(tuple[2]);
+            FALCOR_CHECK(pTexture, "Texture item must not be None.");
+            FALCOR_CHECK(
+                mipLevel < pTexture->getMipCount(),
+                "'mip_level' ({}) is out of bounds. Only {} level(s) available.",
+                mipLevel,
+                pTexture->getMipCount()
+            );
+            FALCOR_CHECK(
+                arraySlice < pTexture->getArraySize(),
+                "'array_slice' ({}) is out of bounds. Only {} slice(s) available.",
+                arraySlice,
+                pTexture->getArraySize()
+            );
+            item.subresource = pTexture->getSubresourceIndex(arraySlice, mipLevel);
+            item.pResource = pTexture;
+        }
+        else
+        {
+            item.pResource = pybind11::cast<ref<Resource>>(entry);
+        }
+        queueItems.push_back(std::move(item));
+    }
+    return self.enqueue(render_context, queueItems);
+}
+
+FALCOR_SCRIPT_BINDING(ReadbackQueue)
+{
+    using namespace pybind11::literals;
+
+    FALCOR_SCRIPT_BINDING_DEPENDENCY(Buffer)
+    FALCOR_SCRIPT_BINDING_DEPENDENCY(Texture)
+    FALCOR_SCRIPT_BINDING_DEPENDENCY(RenderContext)
+
+    pybind11::class_<ReadbackQueue, ref<ReadbackQueue>> readbackQueue(m, "ReadbackQueue");
+    readbackQueue.def(pybind11::init<ref<Device>, uint32_t>(), "device"_a, "slot_count"_a = ReadbackQueue::kDefaultSlotCount);
+    readbackQueue.def_property_readonly("slot_count", &ReadbackQueue::getSlotCount);
+    readbackQueue.def_property_readonly("staging_size", &ReadbackQueue::getStagingSize);
+    readbackQueue.def("enqueue", readback_queue_enqueue, "render_context"_a, "items"_a);
+
+    pybind11::class_<ReadbackQueue::Batch, ref<ReadbackQueue::Batch>> batch(readbackQueue, "Batch");
+    batch.def("__len__", &ReadbackQueue::Batch::getItemCount);
+    batch.def_property_readonly("done", &ReadbackQueue::Batch::isReady);
+    batch.def("wait", batch_wait, "out"_a = pybind11::none());
+    batch.def("to_numpy", batch_to_ndarrays<pybind11::numpy>);
+    batch.def("to_torch", batch_to_ndarrays<pybind11::pytorch>);
+}
+} // namespace Falcor
@@ -0,0 +1,184 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "fwd.h"
+#include "Formats.h"
+#include "Resource.h"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Batched, pipelined readback of textures and buffers to host memory.
+ *
+ * All items of a batch are copied into a single slot of a ring of host-visible staging buffers and
+ * synchronized with a single fence signal. The returned batch is a future-style handle: the caller can
+ * continue recording and submitting work (e.g. render the next frame) while the transfer is in flight and
+ * only block in Batch::wait(). Staging buffers and the host memory that batches resolve into are recycled,
+ * so steady-state readback does not allocate.
+ *
+ * The ring holds a fixed number of slots. Enqueuing a batch into a slot that is still owned by an
+ * unresolved batch resolves that batch first (blocking until its transfer has completed).
+ * This class is not thread-safe.
+ */
+class FALCOR_API ReadbackQueue : public Object
+{
+    FALCOR_OBJECT(ReadbackQueue)
+public:
+    static constexpr uint32_t kDefaultSlotCount = 2;
+
+    /// Describes a single item to read back. For buffers, the whole buffer is read back and the subresource is ignored.
+    struct Item
+    {
+        ref<Resource> pResource;
+        uint32_t subresource = 0;
+    };
+
+    /// Layout of a read back item in host memory. Rows are tightly packed.
+    struct ItemLayout
+    {
+        Resource::Type type = Resource::Type::Buffer; ///< Type of the source resource.
+        ResourceFormat format = ResourceFormat::Unknown; ///< Format of the source texture or typed buffer, Unknown for raw data.
+        uint32_t width = 0;            ///< Width in texels, or element count for buffers.
+        uint32_t height = 0;           ///< Height in texels (1 for buffers).
+        uint32_t depth = 0;            ///< Depth in texels (1 for buffers and non-3D textures).
+        uint32_t rowSize = 0;          ///< Size of a tightly packed row in bytes.
+        uint32_t rowCount = 0;         ///< Number of rows per depth slice (block rows for compressed formats).
+        uint32_t stagingRowPitch = 0;  ///< Row pitch in the staging buffer in bytes.
+        uint64_t stagingOffset = 0;    ///< Offset of the item in the staging buffer in bytes.
+        uint64_t hostOffset = 0;       ///< Offset of the item in the batch host memory in bytes.
+        uint64_t size = 0;             ///< Tightly packed size in bytes.
+    };
+
+    /**
+     * Future-style handle to an enqueued readback.
+     * The batch keeps the queue alive. Host memory is returned to the queue for reuse when the batch is destroyed.
+     */
+    class FALCOR_API Batch : public Object
+    {
+        FALCOR_OBJECT(Batch)
+    public:
+        ~Batch();
+
+        /// Returns the number of items in the batch.
+        size_t getItemCount() const { return mLayouts.size(); }
+
+        /// Returns the host memory layout of an item.
+        const ItemLayout& getLayout(size_t index) const { return mLayouts.at(index); }
+
+        /// Returns true if the transfer has completed on the device. Does not block.
+        bool isReady() const;
+
+        /// Returns true if the batch has been resolved into host memory.
+        bool isResolved() const { return mResolved; }
+
+        /**
+         * Wait for the transfer to complete and copy the data out of the staging ring.
+         * Items with a non-null entry in `destinations` are copied directly to that memory (which must hold at least
+         * getLayout(i).size bytes). All other items are copied to host memory owned by the batch, see getData().
+         * If the batch is already resolved (e.g. because its ring slot was reused), items with a non-null destination are
+         * copied from host memory owned by the batch instead. This throws if such an item was copied to caller-provided memory.
+         * @param[in] destinations Optional list of destination pointers. Must be empty or contain one entry per item.
+         */
+        void wait(const std::vector<void*>& destinations = {});
+
+        /// Returns true if the batch is resolved and the item was copied to host memory owned by the batch.
+        bool isInHostMemory(size_t index) const;
+
+        /**
+         * Get a pointer to the data of an item in host memory. Waits for the batch if it is not resolved.
+         * The pointer is valid for the lifetime of the batch.
+         * Throws if the item was copied to caller-provided memory.
+         */
+        const void* getData(size_t index);
+
+    private:
+        Batch(ref<ReadbackQueue> pQueue, uint32_t slot, uint64_t fenceValue, std::vector<ItemLayout> layouts, uint64_t hostSize);
+
+        ref<ReadbackQueue> mpQueue;
+        uint32_t mSlot;
+        uint64_t mFenceValue;
+        std::vector<ItemLayout> mLayouts;
+        uint64_t mHostSize;
+        std::unique_ptr<uint8_t[]> mpHostData;
+        std::vector<bool> mInHostMemory;
+        bool mResolved = false;
+
+        friend class ReadbackQueue;
+    };
+
+    /**
+     * Constructor.
+     * @param[in] pDevice GPU device.
+     * @param[in] slotCount Number of staging ring slots, i.e. the number of batches that can be in flight at once.
+     */
+    ReadbackQueue(ref<Device> pDevice, uint32_t slotCount = kDefaultSlotCount);
+
+    /**
+     * Schedule the readback of a list of items.
+     * Records all copies into the staging ring, submits the command list and signals the queue fence once.
+     * @param[in] pRenderContext Render context used to record the copies.
+     * @param[in] items Items to read back.
+     * @return Handle to the batch.
+     */
+    ref<Batch> enqueue(RenderContext* pRenderContext, const std::vector<Item>& items);
+
+    /// Returns the number of staging ring slots.
+    uint32_t getSlotCount() const { return (uint32_t)mSlots.size(); }
+
+    /// Returns the total size of the staging ring in bytes.
+    uint64_t getStagingSize() const;
+
+private:
+    struct Slot
+    {
+        ref<Buffer> pStaging;
+        Batch* pOwner = nullptr; ///< Unresolved batch currently using the slot.
+    };
+
+    void releaseSlot(uint32_t slot);
+    std::unique_ptr<uint8_t[]> acquireHostMemory(uint64_t size);
+    void recycleHostMemory(std::unique_ptr<uint8_t[]> pData, uint64_t size);
+
+    ref<Device> mpDevice;
+    ref<Fence> mpFence;
+    std::vector<Slot> mSlots;
+    uint32_t mNextSlot = 0;
+
+    struct HostBlock
+    {
+        std::unique_ptr<uint8_t[]> pData;
+        uint64_t size = 0;
+    };
+    std::vector<HostBlock> mFreeHostBlocks;
+};
+} // namespace Falcor
@@ -381,7 +381,7 @@ ref<Texture> Texture::createFromFile(
     {
         try
         {
-            pTex = ImageIO::loadTextureFromDDS(pDevice, path, loadAsSrgb);
+            pTex = ImageIO::loadTextureFromDDS(pDevice, path, loadAsSrgb, bindFlags);
         }
         catch (const std::exception& e)
         {
@@ -393,21 +393,7 @@ ref<Texture> Texture::createFromFile(
         Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
         if (pBitmap)
         {
-            ResourceFormat texFormat = pBitmap->getFormat();
-            if (loadAsSrgb)
-            {
-                texFormat = linearToSrgbFormat(texFormat);
-            }
-
-            pTex = pDevice->createTexture2D(
-                pBitmap->getWidth(),
-                pBitmap->getHeight(),
-                texFormat,
-                1,
-                generateMipLevels ? Texture::kMaxPossible : 1,
-                pBitmap->getData(),
-                bindFlags
-            );
+            pTex = createFromBitmap(pDevice, *pBitmap, generateMipLevels, loadAsSrgb, bindFlags);
         }
     }
 
@@ -431,6 +417,25 @@ ref<Texture> Texture::createFromFile(
     return pTex;
 }
 
+ref<Texture> Texture::createFromBitmap(
+    ref<Device> pDevice,
+    const Bitmap& bitmap,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    ResourceBindFlags bindFlags
+)
+{
+    ResourceFormat texFormat = bitmap.getFormat();
+    if (loadAsSrgb)
+    {
+        texFormat = linearToSrgbFormat(texFormat);
+    }
+
+    return pDevice->createTexture2D(
+        bitmap.getWidth(), bitmap.getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, bitmap.getData(), bindFlags
+    );
+}
+
 gfx::IResource* Texture::getGfxResource() const
 {
     return mGfxTextureResource;
@@ -195,6 +195,22 @@ public:
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
     );
 
+    /**
+     * Create a new 2D texture object from a bitmap.
+     * @param[in] bitmap The bitmap, loaded in top-down memory layout.
+     * @param[in] generateMipLevels Whether the mip-chain should be generated.
+     * @param[in] loadAsSrgb Create the texture using sRGB format. Only valid for 3 or 4 component textures.
+     * @param[in] bindFlags The bind flags to create the texture with.
+     * @return A new texture.
+     */
+    static ref<Texture> createFromBitmap(
+        ref<Device> pDevice,
+        const Bitmap& bitmap,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
+    );
+
     gfx::ITextureResource* getGfxTextureResource() const { return mGfxTextureResource; }
 
     virtual gfx::IResource* getGfxResource() const override;
@@ -315,6 +331,11 @@ public:
      */
     Bitmap::ImportFlags getImportFlags() const { return mImportFlags; }
 
+    /**
+     * In case the texture was loaded from a file, set the import flags used.
+     */
+    void setImportFlags(Bitmap::ImportFlags importFlags) { mImportFlags = importFlags; }
+
     /**
      * Returns the total number of texels across all mip levels and array slices.
      */
@@ -0,0 +1,124 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CompressedFileReader.h"
+#include "Core/Error.h"
+#include "Utils/StringFormatters.h"
+
+#include <zlib.h>
+
+#include <fstream>
+#include <vector>
+
+namespace Falcor
+{
+
+struct CompressedFileReader::Impl
+{
+    static constexpr size_t kInputBufferSize = 256 * 1024;
+
+    std::filesystem::path path;
+    std::ifstream stream;
+    std::vector<char> input;
+    z_stream zs = {};
+    bool eof = false;
+
+    ~Impl() { inflateEnd(&zs); }
+};
+
+CompressedFileReader::CompressedFileReader() = default;
+
+CompressedFileReader::CompressedFileReader(const std::filesystem::path& path)
+{
+    open(path);
+}
+
+CompressedFileReader::~CompressedFileReader()
+{
+    close();
+}
+
+bool CompressedFileReader::open(const std::filesystem::path& path)
+{
+    close();
+
+    auto pImpl = std::make_unique<Impl>();
+    pImpl->path = path;
+    pImpl->stream.open(path, std::ios::binary);
+    if (!pImpl->stream)
+        return false;
+
+    // MAX_WBITS | 32 to support both zlib or gzip files.
+    if (inflateInit2(&pImpl->zs, MAX_WBITS | 32) != Z_OK)
+        return false;
+
+    pImpl->input.resize(Impl::kInputBufferSize);
+    mpImpl = std::move(pImpl);
+    return true;
+}
+
+void CompressedFileReader::close()
+{
+    mpImpl.reset();
+}
+
+bool CompressedFileReader::isEOF() const
+{
+    return !mpImpl || mpImpl->eof;
+}
+
+size_t CompressedFileReader::read(void* data, size_t size)
+{
+    FALCOR_CHECK(isOpen(), "File is not open.");
+
+    auto& zs = mpImpl->zs;
+    zs.next_out = reinterpret_cast<Bytef*>(data);
+    zs.avail_out = (uInt)size;
+
+    while (zs.avail_out > 0 && !mpImpl->eof)
+    {
+        // Refill the input buffer.
+        if (zs.avail_in == 0)
+        {
+            mpImpl->stream.read(mpImpl->input.data(), mpImpl->input.size());
+            zs.next_in = reinterpret_cast<Bytef*>(mpImpl->input.data());
+            zs.avail_in = (uInt)mpImpl->stream.gcount();
+            if (zs.avail_in == 0)
+                FALCOR_THROW("Failure to decompress file '{}' (unexpected end of file).", mpImpl->path);
+        }
+
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END)
+            mpImpl->eof = true;
+        else if (ret != Z_OK)
+            FALCOR_THROW("Failure to decompress file '{}' (error: {}).", mpImpl->path, ret);
+    }
+
+    return size - zs.avail_out;
+}
+
+} // namespace Falcor
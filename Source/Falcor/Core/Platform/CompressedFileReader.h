@@ -0,0 +1,91 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+
+#include "Core/Macros.h"
+
+#include <filesystem>
+#include <memory>
+
+namespace Falcor
+{
+
+/**
+ * Reader for gzip or zlib compressed files.
+ * Decompresses the file incrementally, which allows processing large compressed
+ * files without holding the whole decompressed contents in memory.
+ * Use decompressFile() in OS.h to decompress a whole file at once.
+ */
+class FALCOR_API CompressedFileReader
+{
+public:
+    CompressedFileReader();
+
+    /**
+     * Construct and open a compressed file.
+     * @note Use isOpen() to check if the file was successfully opened.
+     * @param path File path.
+     */
+    CompressedFileReader(const std::filesystem::path& path);
+
+    ~CompressedFileReader();
+
+    /**
+     * Open a compressed file.
+     * @param path File path.
+     * @return True if successful.
+     */
+    bool open(const std::filesystem::path& path);
+
+    /// Closes the file.
+    void close();
+
+    /// Returns true if the file is open.
+    bool isOpen() const { return mpImpl != nullptr; }
+
+    /// Returns true if the end of the decompressed stream was reached.
+    bool isEOF() const;
+
+    /**
+     * Read decompressed data.
+     * Throws an exception if the file is corrupted.
+     * @param data Destination buffer.
+     * @param size Size of the destination buffer in bytes.
+     * @return Number of bytes read. This is only less than size at the end of the stream.
+     */
+    size_t read(void* data, size_t size);
+
+private:
+    CompressedFileReader(const CompressedFileReader&) = delete;
+    CompressedFileReader& operator=(const CompressedFileReader&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> mpImpl;
+};
+
+} // namespace Falcor
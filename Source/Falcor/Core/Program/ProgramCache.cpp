@@ -0,0 +1,326 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ProgramCache.h"
+#include "Core/Error.h"
+#include "Utils/CacheFile.h"
+#include "Utils/Logger.h"
+
+#include <lz4_stream/lz4_stream.h>
+
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+/**
+ * Specifies the current cache file version.
+ * This needs to be incremented every time the file format changes!
+ */
+const uint32_t kVersion = 2;
+
+const size_t kBlockSize = 1 * 1024 * 1024;
+
+/// Upper bound of the LZ4 compression ratio, used to reject corrupt sizes of the compressed section.
+const uint64_t kMaxCompressionRatio = 256;
+
+const char* kMagic = "FalcorP$";
+
+/// Minimum serialized sizes of the variable sized records, used to validate element counts.
+const size_t kMinStringSize = sizeof(uint64_t);
+const size_t kMinDependencySize = kMinStringSize + sizeof(SHA1::MD);
+const size_t kMinModuleSize = 2 * kMinStringSize + sizeof(uint64_t);
+
+void writeValue(std::ostream& stream, const void* data, size_t len)
+{
+    stream.write(reinterpret_cast<const char*>(data), len);
+}
+
+template<typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+    writeValue(stream, &value, sizeof(T));
+}
+
+void writeString(std::ostream& stream, const std::string& str)
+{
+    writeValue(stream, (uint64_t)str.size());
+    writeValue(stream, str.data(), str.size());
+}
+
+/// Size of the module section of an entry before compression.
+uint64_t getModuleSectionSize(const ProgramCache::Entry& entry)
+{
+    uint64_t size = sizeof(uint32_t);
+    for (const auto& module : entry.modules)
+        size += kMinModuleSize + module.name.size() + module.path.size() + module.irBlob.size();
+    size += sizeof(uint32_t) + entry.translationUnits.size() * sizeof(uint32_t);
+    return size;
+}
+
+/**
+ * Reads values from a stream while tracking the number of bytes left.
+ * Sizes read from the stream are validated against the remaining bytes before allocating any memory, so that corrupt
+ * entries are rejected instead of triggering huge allocations. Once a read fails, all further reads are ignored.
+ */
+class BoundedReader
+{
+public:
+    BoundedReader(std::istream& stream, uint64_t size) : mStream(stream), mRemaining(size) {}
+
+    bool isValid() const { return mValid; }
+    uint64_t getRemaining() const { return mRemaining; }
+
+    void read(void* data, size_t len)
+    {
+        if (!mValid || len > mRemaining)
+        {
+            mValid = false;
+            return;
+        }
+        mStream.read(reinterpret_cast<char*>(data), len);
+        if ((size_t)mStream.gcount() != len)
+            mValid = false;
+        mRemaining -= len;
+    }
+
+    template<typename T>
+    T read()
+    {
+        T value{};
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    /// Read an element count and check that the elements, each at least `minElementSize` bytes, fit into the remaining bytes.
+    template<typename T>
+    size_t readCount(size_t minElementSize)
+    {
+        uint64_t count = read<T>();
+        if (!mValid || (minElementSize > 0 && count > mRemaining / minElementSize))
+        {
+            mValid = false;
+            return 0;
+        }
+        return (size_t)count;
+    }
+
+    std::string readString()
+    {
+        std::string str(readCount<uint64_t>(1), '\0');
+        read(str.data(), str.size());
+        return str;
+    }
+
+    std::vector<uint8_t> readBlob()
+    {
+        std::vector<uint8_t> blob(readCount<uint64_t>(1));
+        read(blob.data(), blob.size());
+        return blob;
+    }
+
+private:
+    std::istream& mStream;
+    uint64_t mRemaining;
+    bool mValid = true;
+};
+} // namespace
+
+ProgramCache::ProgramCache(std::filesystem::path directory) : mDirectory(std::move(directory))
+{
+    if (std::filesystem::exists(mDirectory))
+    {
+        if (!std::filesystem::is_directory(mDirectory))
+            FALCOR_THROW("Program cache path {} exists and is not a directory", mDirectory);
+    }
+    else
+    {
+        std::filesystem::create_directories(mDirectory);
+    }
+}
+
+std::optional<ProgramCache::Entry> ProgramCache::read(const Key& key)
+{
+    auto readEntry = [&]() -> std::optional<Entry>
+    {
+        auto path = getEntryPath(key);
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs.good())
+            return {};
+
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec || fileSize < sizeof(CacheFileHeader))
+            return {};
+
+        // Read header (uncompressed).
+        CacheFileHeader header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs.good() || !header.isValid(kMagic, kVersion))
+            return {};
+
+        Entry entry;
+
+        // Read and validate dependencies (uncompressed) before reading the modules.
+        BoundedReader reader(fs, fileSize - sizeof(CacheFileHeader));
+        entry.dependencies.resize(reader.readCount<uint32_t>(kMinDependencySize));
+        for (auto& dependency : entry.dependencies)
+        {
+            dependency.path = reader.readString();
+            reader.read(dependency.hash.data(), dependency.hash.size());
+        }
+        uint64_t moduleSectionSize = reader.read<uint64_t>();
+        if (!reader.isValid() || moduleSectionSize / kMaxCompressionRatio > reader.getRemaining())
+            return {};
+
+        for (const auto& dependency : entry.dependencies)
+        {
+            if (hashFile(dependency.path) != dependency.hash)
+            {
+                logDebug("Program cache entry {} is out of date ({} changed).", SHA1::toString(key), dependency.path);
+                return {};
+            }
+        }
+
+        // Read modules (compressed).
+        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
+        BoundedReader zreader(zs, moduleSectionSize);
+        entry.modules.resize(zreader.readCount<uint32_t>(kMinModuleSize));
+        for (auto& module : entry.modules)
+        {
+            module.name = zreader.readString();
+            module.path = zreader.readString();
+            module.irBlob = zreader.readBlob();
+        }
+        entry.translationUnits.resize(zreader.readCount<uint32_t>(sizeof(uint32_t)));
+        zreader.read(entry.translationUnits.data(), entry.translationUnits.size() * sizeof(uint32_t));
+        if (!zreader.isValid() || zreader.getRemaining() != 0)
+            return {};
+
+        for (auto index : entry.translationUnits)
+            if (index >= entry.modules.size())
+                return {};
+
+        return entry;
+    };
+
+    auto entry = readEntry();
+
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    if (entry)
+        mStats.hitCount++;
+    else
+        mStats.missCount++;
+
+    return entry;
+}
+
+void ProgramCache::write(const Key& key, const Entry& entry)
+{
+    try
+    {
+        writeFileAtomic(
+            getEntryPath(key),
+            [&](std::ostream& fs)
+            {
+                // Write header and dependencies (uncompressed).
+                writeValue(fs, CacheFileHeader(kMagic, kVersion));
+                writeValue(fs, (uint32_t)entry.dependencies.size());
+                for (const auto& dependency : entry.dependencies)
+                {
+                    writeString(fs, dependency.path);
+                    writeValue(fs, dependency.hash.data(), dependency.hash.size());
+                }
+                writeValue(fs, getModuleSectionSize(entry));
+
+                // Write modules (compressed).
+                lz4_stream::basic_ostream<kBlockSize> zs(fs);
+                writeValue(zs, (uint32_t)entry.modules.size());
+                for (const auto& module : entry.modules)
+                {
+                    writeString(zs, module.name);
+                    writeString(zs, module.path);
+                    writeValue(zs, (uint64_t)module.irBlob.size());
+                    writeValue(zs, module.irBlob.data(), module.irBlob.size());
+                }
+                writeValue(zs, (uint32_t)entry.translationUnits.size());
+                writeValue(zs, entry.translationUnits.data(), entry.translationUnits.size() * sizeof(uint32_t));
+            }
+        );
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Failed to write program cache entry {}: {}", SHA1::toString(key), e.what());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    mStats.writeCount++;
+}
+
+void ProgramCache::recordMiss()
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    mStats.missCount++;
+}
+
+ProgramCache::Stats ProgramCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return mStats;
+}
+
+void ProgramCache::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    mStats = {};
+}
+
+SHA1::MD ProgramCache::hashFile(const std::filesystem::path& path)
+{
+    std::ifstream fs(path, std::ios_base::binary);
+    if (!fs.good())
+        return {};
+
+    SHA1 sha1;
+    char buffer[64 * 1024];
+    while (fs)
+    {
+        fs.read(buffer, sizeof(buffer));
+        sha1.update(buffer, (size_t)fs.gcount());
+    }
+    return sha1.finalize();
+}
+
+std::filesystem::path ProgramCache::getEntryPath(const Key& key) const
+{
+    // Use the first two characters of the key as a subdirectory to keep directory sizes manageable.
+    std::string keyStr = SHA1::toString(key);
+    return mDirectory / keyStr.substr(0, 2) / keyStr;
+}
+} // namespace Falcor
@@ -0,0 +1,124 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Persistent on-disk cache of Slang front-end results.
+ *
+ * Each entry stores the serialized Slang IR of all modules that were loaded when compiling a program version,
+ * together with the list of source files the program depends on. Entries are content-addressed by a key covering
+ * the full specialization of the program front-end (sources, entry points, defines, search paths, compiler flags and
+ * compiler version), which is computed by the `ProgramManager`.
+ *
+ * An entry is only used if all its source dependencies still have the same content as when the entry was written.
+ * The cache is safe to use from multiple threads and processes, entries are written atomically.
+ */
+class FALCOR_API ProgramCache
+{
+public:
+    using Key = SHA1::MD;
+
+    /// Source file the cached program depends on.
+    struct Dependency
+    {
+        std::string path;
+        SHA1::MD hash;
+    };
+
+    /// Serialized Slang module.
+    struct Module
+    {
+        std::string name;
+        std::string path;
+        std::vector<uint8_t> irBlob;
+    };
+
+    struct Entry
+    {
+        std::vector<Dependency> dependencies;
+        std::vector<Module> modules;            ///< All modules in load order, imported modules come before the modules importing them.
+        std::vector<uint32_t> translationUnits; ///< Indices into `modules` for each translation unit of the program.
+    };
+
+    struct Stats
+    {
+        size_t hitCount = 0;   ///< Number of lookups that returned a valid entry.
+        size_t missCount = 0;  ///< Number of lookups without a valid entry.
+        size_t writeCount = 0; ///< Number of entries written.
+    };
+
+    /**
+     * Create a program cache.
+     * @param[in] directory Directory to store cache entries in. Created if it does not exist.
+     */
+    ProgramCache(std::filesystem::path directory);
+
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+    /**
+     * Read a cache entry.
+     * @param[in] key Cache key.
+     * @return Returns the entry if it exists and all its dependencies are up-to-date.
+     */
+    std::optional<Entry> read(const Key& key);
+
+    /**
+     * Write a cache entry.
+     * Failures are logged but not considered an error.
+     * @param[in] key Cache key.
+     * @param[in] entry Cache entry.
+     */
+    void write(const Key& key, const Entry& entry);
+
+    /// Record a miss for a lookup that was skipped, for example because the program can't be cached.
+    void recordMiss();
+
+    Stats getStats() const;
+    void resetStats();
+
+    /// Compute the hash of a file's content. Returns an all-zero hash if the file can't be read.
+    static SHA1::MD hashFile(const std::filesystem::path& path);
+
+private:
+    std::filesystem::path getEntryPath(const Key& key) const;
+
+    std::filesystem::path mDirectory;
+    mutable std::mutex mStatsMutex;
+    Stats mStats;
+};
+} // namespace Falcor
@@ -30,8 +30,13 @@
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/Timing/CpuTimer.h"
+#include "Utils/Scripting/ScriptBindings.h"
+#include "Core/API/PythonHelpers.h"
 
 #include <slang.h>
+#include <BS_thread_pool/BS_thread_pool.hpp>
+
+#include <set>
 
 namespace Falcor
 {
@@ -100,6 +105,53 @@ inline bool doSlangReflection(
     return true;
 }
 
+/// Rename entry point in the generated code if the exported name differs from the source name.
+/// This makes it possible to generate different specializations of the same source entry point,
+/// for example by setting different type conformances.
+inline Slang::ComPtr<slang::IComponentType> renameEntryPoint(
+    const ProgramDesc::EntryPoint& entryPoint,
+    Slang::ComPtr<slang::IComponentType> pSlangEntryPoint
+)
+{
+    if (entryPoint.exportName == entryPoint.name)
+        return pSlangEntryPoint;
+    Slang::ComPtr<slang::IComponentType> pRenamedEntryPoint;
+    pSlangEntryPoint->renameEntryPoint(entryPoint.exportName.c_str(), pRenamedEntryPoint.writeRef());
+    return pRenamedEntryPoint;
+}
+
+/// Minimal blob implementation for passing cached module IR to Slang.
+class SlangBlob : public ISlangBlob
+{
+public:
+    SlangBlob(const std::vector<uint8_t>& data) : mData(data) {}
+
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override
+    {
+        if (uuid == ISlangUnknown::getTypeGuid() || uuid == ISlangBlob::getTypeGuid())
+        {
+            addRef();
+            *outObject = static_cast<ISlangBlob*>(this);
+            return SLANG_OK;
+        }
+        return SLANG_E_NO_INTERFACE;
+    }
+    SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override { return ++mRefCount; }
+    SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+    {
+        uint32_t refCount = --mRefCount;
+        if (refCount == 0)
+            delete this;
+        return refCount;
+    }
+    SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return mData.data(); }
+    SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return mData.size(); }
+
+private:
+    std::vector<uint8_t> mData;
+    std::atomic<uint32_t> mRefCount{0};
+};
+
 ProgramManager::ProgramManager(Device* pDevice) : mpDevice(pDevice)
 {
     // Set global shader defines
@@ -114,14 +166,169 @@ ProgramManager::ProgramManager(Device* pDevice) : mpDevice(pDevice)
 
     addGlobalDefines(globalDefines);
 
+    // Setup the persistent program cache. The environment variable takes precedence over the device setting.
+    std::string programCachePath = mpDevice->getDesc().programCachePath;
+    if (auto envPath = getEnvironmentVariable("FALCOR_PROGRAM_CACHE_PATH"))
+        programCachePath = *envPath;
+    setProgramCachePath(programCachePath);
+}
+
+void ProgramManager::setProgramCachePath(const std::filesystem::path& path)
+{
+    if (path.empty())
+    {
+        mpProgramCache.reset();
+        return;
+    }
+    mpProgramCache = std::make_unique<ProgramCache>(path);
+    logInfo("Using program cache at '{}'.", path);
+}
+
+std::filesystem::path ProgramManager::getProgramCachePath() const
+{
+    return mpProgramCache ? mpProgramCache->getDirectory() : std::filesystem::path();
+}
+
+ProgramCache::Stats ProgramManager::getProgramCacheStats() const
+{
+    return mpProgramCache ? mpProgramCache->getStats() : ProgramCache::Stats{};
+}
+
+ProgramManager::CompilationStats ProgramManager::getCompilationStats() const
+{
+    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+    return mCompilationStats;
+}
+
+void ProgramManager::resetCompilationStats()
+{
+    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+    mCompilationStats = {};
+}
+
+bool ProgramManager::isProgramCacheable(const Program& program) const
+{
+    // Compiler arguments are passed to Slang as a command line and can't be replicated when loading
+    // modules from the cache. Dumping intermediates requires running the full compiler.
+    return mGlobalCompilerArguments.empty() && program.mDesc.compilerArguments.empty() &&
+           !is_set(program.mDesc.compilerFlags, SlangCompilerFlags::DumpIntermediates);
+}
+
+ProgramCache::Key ProgramManager::computeProgramCacheKey(const Program& program, const DefineList& defineList) const
+{
+    SHA1 sha1;
+    auto hashString = [&sha1](std::string_view str)
+    {
+        sha1.update(str);
+        sha1.update(uint8_t(0));
+    };
+
+    // Compiler version and target.
+    hashString(mpDevice->getSlangGlobalSession()->getBuildTagString());
+    sha1.update(mpDevice->getType());
+    sha1.update(program.mDesc.shaderModel);
+
+    SlangCompilerFlags compilerFlags = program.mDesc.compilerFlags;
+    compilerFlags &= ~mForcedCompilerFlags.disabled;
+    compilerFlags |= mForcedCompilerFlags.enabled;
+    sha1.update(compilerFlags);
+    sha1.update(mGenerateDebugInfo);
+    sha1.update(program.mDesc.useSPIRVBackend);
+    hashString(getEnvironmentVariable("FALCOR_USE_SLANG_SPIRV_BACKEND").value_or(""));
+
+    // Defines.
+    for (const auto& [name, value] : mGlobalDefineList)
+    {
+        hashString(name);
+        hashString(value);
+    }
+    sha1.update(uint8_t(0xff));
+    for (const auto& [name, value] : defineList)
+    {
+        hashString(name);
+        hashString(value);
+    }
+
+    // Shader modules. File sources are identified by path here, their content is validated
+    // through the dependencies stored with the cache entry.
+    for (const auto& module : program.mDesc.shaderModules)
+    {
+        hashString(module.name);
+        sha1.update(module.sources.size());
+        for (const auto& source : module.sources)
+        {
+            sha1.update(source.type);
+            hashString(source.path.string());
+            hashString(source.string);
+        }
+    }
+
+    // Entry points.
+    for (const auto& entryPointGroup : program.mDesc.entryPointGroups)
+    {
+        sha1.update(entryPointGroup.shaderModuleIndex);
+        for (const auto& entryPoint : entryPointGroup.entryPoints)
+        {
+            sha1.update(entryPoint.type);
+            hashString(entryPoint.name);
+        }
+    }
+
+    // Shader search paths determine how imports are resolved.
+    for (const auto& path : getShaderDirectoriesList())
+        hashString(path.string());
+
+    return sha1.finalize();
 }
 
 ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& program, std::string& log) const
+{
+    program.mFileTimeMap.clear(); // TODO @skallweit
+    return createProgramVersion(program, program.getDefineList(), program.mFileTimeMap, log);
+}
+
+ref<const ProgramVersion> ProgramManager::createProgramVersion(
+    const Program& program,
+    const DefineList& defineList,
+    Program::string_time_map& fileTimeMap,
+    std::string& log
+) const
 {
     CpuTimer timer;
     timer.update();
 
-    auto pSlangRequest = createSlangCompileRequest(program);
+    // Try to skip the Slang front-end by loading the modules from the persistent program cache.
+    std::optional<ProgramCache::Key> cacheKey;
+    if (mpProgramCache)
+    {
+        if (isProgramCacheable(program))
+        {
+            cacheKey = computeProgramCacheKey(program, defineList);
+            if (auto entry = mpProgramCache->read(*cacheKey))
+            {
+                auto pVersion = createProgramVersionFromCache(program, defineList, *entry, fileTimeMap, log);
+                if (pVersion)
+                {
+                    timer.update();
+                    double time = timer.delta();
+                    recordProgramVersionTime(time);
+                    logDebug("Loaded program version from cache in {:.3f} s: {}", time, program.getProgramDescString());
+                    return pVersion;
+                }
+                logWarning("Failed to load program from cache, recompiling: {}", program.getProgramDescString());
+            }
+        }
+        else
+        {
+            mpProgramCache->recordMiss();
+        }
+    }
+
+    // All Slang objects derive from the device's global session, which may only be used by one thread at a time.
+    // The lock is declared first so that the local Slang objects are released while it is held.
+    std::lock_guard<std::mutex> slangLock(mSlangGlobalSessionMutex);
+
+    auto pSlangRequest = createSlangCompileRequest(program, defineList);
     if (pSlangRequest == nullptr)
         return nullptr;
 
@@ -146,32 +353,146 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
         {
             Slang::ComPtr<slang::IComponentType> pSlangEntryPoint;
             spCompileRequest_getEntryPoint(pSlangRequest, entryPoint.globalIndex, pSlangEntryPoint.writeRef());
-
-            // Rename entry point in the generated code if the exported name differs from the source name.
-            // This makes it possible to generate different specializations of the same source entry point,
-            // for example by setting different type conformances.
-            if (entryPoint.exportName != entryPoint.name)
-            {
-                Slang::ComPtr<slang::IComponentType> pRenamedEntryPoint;
-                pSlangEntryPoint->renameEntryPoint(entryPoint.exportName.c_str(), pRenamedEntryPoint.writeRef());
-                pSlangEntryPoints.push_back(pRenamedEntryPoint);
-            }
-            else
-            {
-                pSlangEntryPoints.push_back(pSlangEntryPoint);
-            }
+            pSlangEntryPoints.push_back(renameEntryPoint(entryPoint, pSlangEntryPoint));
         }
     }
 
     // Extract list of files referenced, for dependency-tracking purposes.
+    std::vector<std::string> depFilePaths;
     int depFileCount = spGetDependencyFileCount(pSlangRequest);
     for (int ii = 0; ii < depFileCount; ++ii)
     {
         std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
         if (std::filesystem::exists(depFilePath))
-            program.mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+        {
+            fileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            depFilePaths.push_back(depFilePath);
+        }
+    }
+
+    auto pVersion = finalizeProgramVersion(program, defineList, pSlangGlobalScope, pSlangEntryPoints, log);
+    if (!pVersion)
+        return nullptr;
+
+    // Store the loaded modules in the program cache.
+    // This includes all imported modules so that a later load doesn't need to parse any source.
+    if (cacheKey)
+    {
+        ProgramCache::Entry entry;
+        for (const auto& path : depFilePaths)
+            entry.dependencies.push_back({path, ProgramCache::hashFile(path)});
+
+        bool serialized = true;
+        auto addModule = [&](slang::IModule* pModule)
+        {
+            Slang::ComPtr<ISlangBlob> pBlob;
+            if (!pModule || SLANG_FAILED(pModule->serialize(pBlob.writeRef())))
+            {
+                serialized = false;
+                return;
+            }
+            const uint8_t* pData = reinterpret_cast<const uint8_t*>(pBlob->getBufferPointer());
+            entry.modules.push_back(
+                {pModule->getName(), pModule->getFilePath() ? pModule->getFilePath() : "", {pData, pData + pBlob->getBufferSize()}}
+            );
+        };
+
+        for (SlangInt i = 0; i < pSlangSession->getLoadedModuleCount(); ++i)
+            addModule(pSlangSession->getLoadedModule(i));
+        for (size_t i = 0; i < program.mDesc.shaderModules.size(); ++i)
+        {
+            slang::IModule* pModule = nullptr;
+            spCompileRequest_getModule(pSlangRequest, (SlangInt)i, &pModule);
+            entry.translationUnits.push_back((uint32_t)entry.modules.size());
+            addModule(pModule);
+        }
+
+        if (serialized)
+            mpProgramCache->write(*cacheKey, entry);
+    }
+
+    timer.update();
+    double time = timer.delta();
+    recordProgramVersionTime(time);
+    logDebug("Created program version in {:.3f} s: {}", time, program.getProgramDescString());
+
+    return pVersion;
+}
+
+ref<const ProgramVersion> ProgramManager::createProgramVersionFromCache(
+    const Program& program,
+    const DefineList& defineList,
+    const ProgramCache::Entry& entry,
+    Program::string_time_map& fileTimeMap,
+    std::string& log
+) const
+{
+    std::lock_guard<std::mutex> slangLock(mSlangGlobalSessionMutex);
+    Slang::ComPtr<slang::ISession> pSlangSession = createSlangSession(program, defineList, true);
+
+    // Load modules in their original order, so that imports resolve to the already loaded modules.
+    std::vector<Slang::ComPtr<slang::IModule>> modules;
+    for (const auto& module : entry.modules)
+    {
+        Slang::ComPtr<ISlangBlob> pBlob(new SlangBlob(module.irBlob));
+        Slang::ComPtr<slang::IBlob> pDiagnostics;
+        Slang::ComPtr<slang::IModule> pModule(
+            pSlangSession->loadModuleFromIRBlob(module.name.c_str(), module.path.c_str(), pBlob, pDiagnostics.writeRef())
+        );
+        if (pDiagnostics && pDiagnostics->getBufferSize() > 0)
+            log += (const char*)pDiagnostics->getBufferPointer();
+        if (!pModule)
+            return nullptr;
+        modules.push_back(pModule);
+    }
+
+    std::vector<slang::IComponentType*> translationUnits;
+    for (auto index : entry.translationUnits)
+        translationUnits.push_back(modules[index]);
+
+    Slang::ComPtr<slang::IComponentType> pSlangGlobalScope;
+    if (SLANG_FAILED(pSlangSession->createCompositeComponentType(
+            translationUnits.data(), (SlangInt)translationUnits.size(), pSlangGlobalScope.writeRef()
+        )))
+    {
+        log += "Slang call createCompositeComponentType() failed.\n";
+        return nullptr;
+    }
+
+    // Prepare entry points.
+    std::vector<Slang::ComPtr<slang::IComponentType>> pSlangEntryPoints;
+    for (const auto& entryPointGroup : program.mDesc.entryPointGroups)
+    {
+        for (const auto& entryPoint : entryPointGroup.entryPoints)
+        {
+            Slang::ComPtr<slang::IEntryPoint> pSlangEntryPoint;
+            Slang::ComPtr<slang::IBlob> pDiagnostics;
+            modules[entry.translationUnits[entryPointGroup.shaderModuleIndex]]->findAndCheckEntryPoint(
+                entryPoint.name.c_str(), getSlangStage(entryPoint.type), pSlangEntryPoint.writeRef(), pDiagnostics.writeRef()
+            );
+            if (!pSlangEntryPoint)
+            {
+                log += fmt::format("Entry point '{}' not found in cached program.\n", entryPoint.name);
+                return nullptr;
+            }
+            pSlangEntryPoints.push_back(renameEntryPoint(entryPoint, Slang::ComPtr<slang::IComponentType>(pSlangEntryPoint.get())));
+        }
     }
 
+    for (const auto& dependency : entry.dependencies)
+        fileTimeMap[dependency.path] = getFileModifiedTime(dependency.path);
+
+    return finalizeProgramVersion(program, defineList, pSlangGlobalScope, pSlangEntryPoints, log);
+}
+
+ref<const ProgramVersion> ProgramManager::finalizeProgramVersion(
+    const Program& program,
+    const DefineList& defineList,
+    slang::IComponentType* pSlangGlobalScope,
+    const std::vector<Slang::ComPtr<slang::IComponentType>>& pSlangEntryPoints,
+    std::string& log
+) const
+{
     // Note: the `ProgramReflection` needs to be able to refer back to the
     // `ProgramVersion`, but the `ProgramVersion` can't be initialized
     // until we have its reflection. We cut that dependency knot by
@@ -195,24 +516,13 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
     // to just use `pSlangGlobalScope` for the reflection step instead
     // of `pSlangProgram`.
     //
-    Slang::ComPtr<slang::IComponentType> pSlangProgram;
-    spCompileRequest_getProgram(pSlangRequest, pSlangProgram.writeRef());
-
     ref<const ProgramReflection> pReflector;
     if (!doSlangReflection(*pVersion, pSlangGlobalScope, pSlangEntryPoints, pReflector, log))
     {
         return nullptr;
     }
 
-    auto descStr = program.getProgramDescString();
-    pVersion->init(program.getDefineList(), pReflector, descStr, pSlangEntryPoints);
-
-    timer.update();
-    double time = timer.delta();
-    mCompilationStats.programVersionCount++;
-    mCompilationStats.programVersionTotalTime += time;
-    mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
-    logDebug("Created program version in {:.3f} s: {}", timer.delta(), descStr);
+    pVersion->init(defineList, pReflector, program.getProgramDescString(), pSlangEntryPoints);
 
     return pVersion;
 }
@@ -223,10 +533,23 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
     const ProgramVars& programVars,
     std::string& log
 ) const
+{
+    return createProgramKernels(program, programVersion, program.mTypeConformanceList, log);
+}
+
+ref<const ProgramKernels> ProgramManager::createProgramKernels(
+    const Program& program,
+    const ProgramVersion& programVersion,
+    const TypeConformanceList& typeConformanceList,
+    std::string& log
+) const
 {
     CpuTimer timer;
     timer.update();
 
+    // Linking, specialization and kernel creation use the Slang global session and the gfx device.
+    std::lock_guard<std::mutex> slangLock(mSlangGlobalSessionMutex);
+
     auto pSlangGlobalScope = programVersion.getSlangGlobalScope();
     auto pSlangSession = pSlangGlobalScope->getSession();
 
@@ -307,7 +630,7 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
     typeConformancesCompositeComponents.reserve(program.mDesc.entryPointGroups.size());
     for (const auto& group : program.mDesc.entryPointGroups)
     {
-        TypeConformanceList typeConformances = program.mTypeConformanceList;
+        TypeConformanceList typeConformances = typeConformanceList;
         typeConformances.add(group.typeConformances);
         if (auto typeConformanceComponentList = createTypeConformanceComponentList(typeConformances))
             typeConformancesCompositeComponents.emplace_back(*typeConformanceComponentList);
@@ -500,14 +823,160 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
 
     timer.update();
     double time = timer.delta();
-    mCompilationStats.programKernelsCount++;
-    mCompilationStats.programKernelsTotalTime += time;
-    mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+    recordProgramKernelsTime(time);
     logDebug("Created program kernels in {:.3f} s: {}", time, descStr);
 
     return pProgramKernels;
 }
 
+size_t ProgramManager::precompilePrograms(const std::vector<PrecompileRequest>& requests, uint32_t threadCount)
+{
+    CpuTimer timer;
+    timer.update();
+
+    // Skip versions that already exist and duplicate requests.
+    std::vector<const PrecompileRequest*> pendingRequests;
+    std::set<std::pair<const Program*, Program::ProgramVersionKey>> requestedVersions;
+    for (const auto& request : requests)
+    {
+        FALCOR_CHECK(request.pProgram, "Precompile request is missing a program.");
+        Program::ProgramVersionKey key{request.defineList, request.typeConformanceList};
+        if (request.pProgram->mProgramVersions.find(key) != request.pProgram->mProgramVersions.end())
+            continue;
+        if (!requestedVersions.emplace(request.pProgram.get(), key).second)
+            continue;
+        pendingRequests.push_back(&request);
+    }
+
+    struct Result
+    {
+        ref<const ProgramVersion> pVersion;
+        Program::string_time_map fileTimeMap;
+        std::string log;
+    };
+    std::vector<Result> results(pendingRequests.size());
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, (uint32_t)pendingRequests.size());
+
+    std::vector<CompilationStats::ThreadStats> threadStats(threadCount);
+    std::atomic<size_t> nextRequest{0};
+
+    // Each worker pulls requests from the shared list until it is exhausted.
+    // All Slang sessions derive from the device's global session, so the Slang and gfx calls are serialized.
+    // Workers overlap the program cache lookups with compilation on other threads.
+    auto worker = [&](uint32_t threadIndex)
+    {
+        auto& stats = threadStats[threadIndex];
+        for (size_t i = nextRequest++; i < pendingRequests.size(); i = nextRequest++)
+        {
+            const auto& request = *pendingRequests[i];
+            auto& result = results[i];
+
+            CpuTimer threadTimer;
+            threadTimer.update();
+            try
+            {
+                result.pVersion = createProgramVersion(*request.pProgram, request.defineList, result.fileTimeMap, result.log);
+                if (result.pVersion)
+                {
+                    stats.programVersionCount++;
+
+                    // Programs without specialization arguments look up their kernels using an empty key,
+                    // see `ProgramVersion::getKernels()`.
+                    auto pKernels = createProgramKernels(*request.pProgram, *result.pVersion, request.typeConformanceList, result.log);
+                    if (pKernels)
+                    {
+                        result.pVersion->mpKernels[""] = pKernels;
+                        stats.programKernelsCount++;
+                    }
+                }
+            }
+            catch (const std::exception& e)
+            {
+                // Releasing the version releases its Slang objects.
+                std::lock_guard<std::mutex> slangLock(mSlangGlobalSessionMutex);
+                result.pVersion = nullptr;
+                result.log += e.what();
+            }
+            threadTimer.update();
+            stats.busyTime += threadTimer.delta();
+        }
+    };
+
+    if (!pendingRequests.empty())
+    {
+        BS::thread_pool threadPool(threadCount);
+        for (uint32_t threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+            threadPool.push_task(worker, threadIndex);
+        threadPool.wait_for_tasks();
+    }
+
+    // Commit the compiled versions to the programs in request order.
+    size_t failedCount = 0;
+    for (size_t i = 0; i < pendingRequests.size(); ++i)
+    {
+        const auto& request = *pendingRequests[i];
+        auto& result = results[i];
+        Program& program = *request.pProgram;
+
+        if (!result.pVersion)
+        {
+            logError("Failed to precompile program:\n{}\n\n{}", program.getProgramDescString(), result.log);
+            failedCount++;
+            continue;
+        }
+        if (!result.log.empty())
+            logWarning("Warnings in program:\n{}\n{}", program.getProgramDescString(), result.log);
+
+        program.mProgramVersions[Program::ProgramVersionKey{request.defineList, request.typeConformanceList}] = result.pVersion;
+        program.mFileTimeMap.insert(result.fileTimeMap.begin(), result.fileTimeMap.end());
+    }
+
+    timer.update();
+    double wallTime = timer.delta();
+
+    {
+        std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+        mCompilationStats.precompileRequestCount += pendingRequests.size();
+        mCompilationStats.precompileFailedCount += failedCount;
+        mCompilationStats.precompileWallTime += wallTime;
+        mCompilationStats.threadStats = threadStats;
+    }
+
+    logInfo(
+        "Precompiled {} program versions on {} threads in {:.3f} s ({} failed).", pendingRequests.size(), threadCount, wallTime, failedCount
+    );
+
+    return failedCount;
+}
+
+size_t ProgramManager::precompileRegisteredPrograms(uint32_t threadCount)
+{
+    std::vector<PrecompileRequest> requests;
+    requests.reserve(mLoadedPrograms.size());
+    for (auto pProgram : mLoadedPrograms)
+        requests.push_back({ref<Program>(pProgram), pProgram->mDefineList, pProgram->mTypeConformanceList});
+    return precompilePrograms(requests, threadCount);
+}
+
+void ProgramManager::recordProgramVersionTime(double time) const
+{
+    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+    mCompilationStats.programVersionCount++;
+    mCompilationStats.programVersionTotalTime += time;
+    mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
+}
+
+void ProgramManager::recordProgramKernelsTime(double time) const
+{
+    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+    mCompilationStats.programKernelsCount++;
+    mCompilationStats.programKernelsTotalTime += time;
+    mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+}
+
 ref<const EntryPointGroupKernels> ProgramManager::createEntryPointGroupKernels(
     const std::vector<ref<EntryPointKernel>>& kernels,
     const ref<EntryPointBaseReflection>& pReflector
@@ -619,7 +1088,11 @@ ProgramManager::ForcedCompilerFlags ProgramManager::getForcedCompilerFlags()
     return mForcedCompilerFlags;
 }
 
-SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program) const
+Slang::ComPtr<slang::ISession> ProgramManager::createSlangSession(
+    const Program& program,
+    const DefineList& defineList,
+    bool loadFromCache
+) const
 {
     slang::IGlobalSession* pSlangGlobalSession = mpDevice->getSlangGlobalSession();
     FALCOR_ASSERT(pSlangGlobalSession);
@@ -711,7 +1184,7 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     // Add global followed by program specific defines.
     for (const auto& shaderDefine : mGlobalDefineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
-    for (const auto& shaderDefine : program.getDefineList())
+    for (const auto& shaderDefine : defineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
 
     // Add a `#define`s based on the target and shader model.
@@ -757,6 +1230,22 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     addStringOption(slang::CompilerOptionName::DisableWarning, "30081"); // implicit conversion
     addStringOption(slang::CompilerOptionName::DisableWarning, "41203"); // reinterpret<> into not equally sized types
 
+    // When loading modules from the program cache there is no compile request, so options that are
+    // otherwise set on the request need to be set on the session instead.
+#if FALCOR_NVAPI_AVAILABLE
+    std::string nvapiInclude = "-I" + (getRuntimeDirectory() / "shaders/nvapi").string();
+#endif
+    if (loadFromCache)
+    {
+        if (mGenerateDebugInfo || is_set(program.mDesc.compilerFlags, SlangCompilerFlags::GenerateDebugInfo))
+            addIntOption(slang::CompilerOptionName::DebugInformation, SLANG_DEBUG_INFO_LEVEL_STANDARD);
+#if FALCOR_NVAPI_AVAILABLE
+        compilerOptionEntries.push_back(
+            {slang::CompilerOptionName::DownstreamArgs, {slang::CompilerOptionValueKind::String, 0, 0, "dxc", nvapiInclude.c_str()}}
+        );
+#endif
+    }
+
     sessionDesc.compilerOptionEntries = compilerOptionEntries.data();
     sessionDesc.compilerOptionEntryCount = (uint32_t)compilerOptionEntries.size();
 
@@ -764,7 +1253,12 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     pSlangGlobalSession->createSession(sessionDesc, pSlangSession.writeRef());
     FALCOR_ASSERT(pSlangSession);
 
-    program.mFileTimeMap.clear(); // TODO @skallweit
+    return pSlangSession;
+}
+
+SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program, const DefineList& defineList) const
+{
+    Slang::ComPtr<slang::ISession> pSlangSession = createSlangSession(program, defineList, false);
 
     SlangCompileRequest* pSlangRequest = nullptr;
     pSlangSession->createCompileRequest(&pSlangRequest);
@@ -861,4 +1355,100 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     return pSlangRequest;
 }
 
+FALCOR_SCRIPT_BINDING(ProgramManager)
+{
+    using namespace pybind11::literals;
+
+    FALCOR_SCRIPT_BINDING_DEPENDENCY(Program)
+
+    pybind11::class_<ProgramManager> programManager(m, "ProgramManager");
+
+    // Each item is either a program (compiles its current version) or a tuple of (program, defines, type_conformances).
+    programManager.def(
+        "precompile",
+        [](ProgramManager& self, const pybind11::list& programs, uint32_t thread_count)
+        {
+            std::vector<ProgramManager::PrecompileRequest> requests;
+            for (const auto& item : programs)
+            {
+                if (pybind11::isinstance<Program>(item))
+                {
+                    auto pProgram = item.cast<ref<Program>>();
+                    requests.push_back({pProgram, pProgram->getDefineList(), pProgram->getTypeConformances()});
+                }
+                else
+                {
+                    auto tuple = item.cast<pybind11::tuple>();
+                    FALCOR_CHECK(tuple.size() >= 1 && tuple.size() <= 3, "Expected a tuple of (program, defines, type_conformances).");
+                    auto pProgram = tuple[0].cast<ref<Program>>();
+                    ProgramManager::PrecompileRequest request{pProgram, pProgram->getDefineList(), pProgram->getTypeConformances()};
+                    if (tuple.size() > 1)
+                        request.defineList = defineListFromPython(tuple[1].cast<pybind11::dict>());
+                    if (tuple.size() > 2)
+                        request.typeConformanceList = typeConformanceListFromPython(tuple[2].cast<pybind11::dict>());
+                    requests.push_back(std::move(request));
+                }
+            }
+            pybind11::gil_scoped_release release;
+            return self.precompilePrograms(requests, thread_count);
+        },
+        "programs"_a,
+        "thread_count"_a = 0
+    );
+    programManager.def(
+        "precompile_all",
+        [](ProgramManager& self, uint32_t thread_count)
+        {
+            pybind11::gil_scoped_release release;
+            return self.precompileRegisteredPrograms(thread_count);
+        },
+        "thread_count"_a = 0
+    );
+    programManager.def_property_readonly(
+        "compilation_stats",
+        [](ProgramManager& self)
+        {
+            auto s = self.getCompilationStats();
+            pybind11::dict d;
+            d["program_version_count"] = s.programVersionCount;
+            d["program_kernels_count"] = s.programKernelsCount;
+            d["program_version_max_time"] = s.programVersionMaxTime;
+            d["program_kernels_max_time"] = s.programKernelsMaxTime;
+            d["program_version_total_time"] = s.programVersionTotalTime;
+            d["program_kernels_total_time"] = s.programKernelsTotalTime;
+            d["precompile_request_count"] = s.precompileRequestCount;
+            d["precompile_failed_count"] = s.precompileFailedCount;
+            d["precompile_wall_time"] = s.precompileWallTime;
+            pybind11::list threads;
+            for (const auto& t : s.threadStats)
+            {
+                pybind11::dict td;
+                td["program_version_count"] = t.programVersionCount;
+                td["program_kernels_count"] = t.programKernelsCount;
+                td["busy_time"] = t.busyTime;
+                threads.append(td);
+            }
+            d["thread_stats"] = threads;
+            return d;
+        }
+    );
+    programManager.def("reset_compilation_stats", &ProgramManager::resetCompilationStats);
+
+    programManager.def_property(
+        "program_cache_path", &ProgramManager::getProgramCachePath, &ProgramManager::setProgramCachePath
+    );
+    programManager.def_property_readonly(
+        "program_cache_stats",
+        [](ProgramManager& self)
+        {
+            auto s = self.getProgramCacheStats();
+            pybind11::dict d;
+            d["hit_count"] = s.hitCount;
+            d["miss_count"] = s.missCount;
+            d["write_count"] = s.writeCount;
+            return d;
+        }
+    );
+}
+
 } // namespace Falcor
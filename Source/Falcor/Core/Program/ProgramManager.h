@@ -27,10 +27,15 @@
  **************************************************************************/
 #pragma once
 #include "Program.h"
+#include "ProgramCache.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 
+#include <filesystem>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <vector>
 
 namespace Falcor
 {
@@ -52,12 +57,37 @@ public:
 
     struct CompilationStats
     {
+        /// Statistics for a single worker thread used by `precompilePrograms()`.
+        struct ThreadStats
+        {
+            size_t programVersionCount = 0;
+            size_t programKernelsCount = 0;
+            double busyTime = 0.0; ///< Time spent compiling on this thread in seconds.
+        };
+
         size_t programVersionCount = 0;
         size_t programKernelsCount = 0;
         double programVersionMaxTime = 0.0;
         double programKernelsMaxTime = 0.0;
         double programVersionTotalTime = 0.0;
         double programKernelsTotalTime = 0.0;
+
+        size_t precompileRequestCount = 0;    ///< Number of program versions requested through `precompilePrograms()`.
+        size_t precompileFailedCount = 0;     ///< Number of requested program versions that failed to compile.
+        double precompileWallTime = 0.0;      ///< Accumulated wall-clock time spent in `precompilePrograms()` in seconds.
+        std::vector<ThreadStats> threadStats; ///< Per-thread statistics of the last `precompilePrograms()` call.
+    };
+
+    /**
+     * Describes a single program version to compile ahead of time.
+     * The program version is identified by the set of defines and type conformances, matching the key
+     * used by `Program` to look up its versions at runtime.
+     */
+    struct PrecompileRequest
+    {
+        ref<Program> pProgram;
+        DefineList defineList;
+        TypeConformanceList typeConformanceList;
     };
 
     ProgramDesc applyForcedCompilerFlags(ProgramDesc desc) const;
@@ -73,6 +103,28 @@ public:
         std::string& log
     ) const;
 
+    /**
+     * Compile a set of program versions in parallel.
+     * Each request is compiled on a worker thread using its own Slang session. This includes the Slang front-end
+     * (parsing, checking), linking of the type conformances and creation of the unspecialized kernels.
+     * Slang only allows one thread at a time to use a global session and the objects derived from it, so the
+     * compilation itself is serialized. Only the program cache lookups run in parallel.
+     * The compiled versions are added to the programs so that later lookups of the same defines and type conformances
+     * do not trigger any compilation. Requests for versions that already exist are skipped.
+     * @param[in] requests List of program versions to compile.
+     * @param[in] threadCount Number of worker threads. If zero, the number of hardware threads is used.
+     * @return Number of program versions that failed to compile. Errors are logged.
+     */
+    size_t precompilePrograms(const std::vector<PrecompileRequest>& requests, uint32_t threadCount = 0);
+
+    /**
+     * Compile the current version of all registered programs in parallel.
+     * This is useful after setting up scenes and render graphs, to compile the programs before rendering starts.
+     * @param[in] threadCount Number of worker threads. If zero, the number of hardware threads is used.
+     * @return Number of program versions that failed to compile. Errors are logged.
+     */
+    size_t precompileRegisteredPrograms(uint32_t threadCount = 0);
+
     ref<const EntryPointGroupKernels> createEntryPointGroupKernels(
         const std::vector<ref<EntryPointKernel>>& kernels,
         const ref<EntryPointBaseReflection>& pReflector
@@ -141,23 +193,80 @@ public:
      */
     ForcedCompilerFlags getForcedCompilerFlags();
 
-    const CompilationStats& getCompilationStats() { return mCompilationStats; }
-    void resetCompilationStats() { mCompilationStats = {}; }
+    /**
+     * Set the directory of the persistent program cache.
+     * The cache stores the results of the Slang front-end (parsing, checking) of each program version, so that
+     * later runs can skip parsing the shader sources. Entries are invalidated when any source file changes.
+     * @param[in] path Cache directory. An empty path disables the cache.
+     */
+    void setProgramCachePath(const std::filesystem::path& path);
+
+    /// Get the directory of the persistent program cache. Returns an empty path if the cache is disabled.
+    std::filesystem::path getProgramCachePath() const;
+
+    /// Get the persistent program cache statistics.
+    ProgramCache::Stats getProgramCacheStats() const;
+
+    /// Get a snapshot of the compilation statistics.
+    CompilationStats getCompilationStats() const;
+    void resetCompilationStats();
 
 private:
-    SlangCompileRequest* createSlangCompileRequest(const Program& program) const;
+    ref<const ProgramVersion> createProgramVersion(
+        const Program& program,
+        const DefineList& defineList,
+        Program::string_time_map& fileTimeMap,
+        std::string& log
+    ) const;
+
+    ref<const ProgramKernels> createProgramKernels(
+        const Program& program,
+        const ProgramVersion& programVersion,
+        const TypeConformanceList& typeConformanceList,
+        std::string& log
+    ) const;
+
+    ref<const ProgramVersion> createProgramVersionFromCache(
+        const Program& program,
+        const DefineList& defineList,
+        const ProgramCache::Entry& entry,
+        Program::string_time_map& fileTimeMap,
+        std::string& log
+    ) const;
+
+    ref<const ProgramVersion> finalizeProgramVersion(
+        const Program& program,
+        const DefineList& defineList,
+        slang::IComponentType* pSlangGlobalScope,
+        const std::vector<Slang::ComPtr<slang::IComponentType>>& pSlangEntryPoints,
+        std::string& log
+    ) const;
+
+    bool isProgramCacheable(const Program& program) const;
+    ProgramCache::Key computeProgramCacheKey(const Program& program, const DefineList& defineList) const;
+
+    Slang::ComPtr<slang::ISession> createSlangSession(const Program& program, const DefineList& defineList, bool loadFromCache) const;
+    SlangCompileRequest* createSlangCompileRequest(const Program& program, const DefineList& defineList) const;
+
+    void recordProgramVersionTime(double time) const;
+    void recordProgramKernelsTime(double time) const;
 
     Device* mpDevice;
 
     std::vector<Program*> mLoadedPrograms;
     mutable CompilationStats mCompilationStats;
+    mutable std::mutex mCompilationStatsMutex;
+    /// Serializes access to the Slang global session, everything derived from it and the gfx device, which are not thread-safe.
+    mutable std::mutex mSlangGlobalSessionMutex;
+
+    std::unique_ptr<ProgramCache> mpProgramCache;
 
     DefineList mGlobalDefineList;
     std::vector<std::string> mGlobalCompilerArguments;
     bool mGenerateDebugInfo = false;
     ForcedCompilerFlags mForcedCompilerFlags;
 
-    mutable uint32_t mHitGroupID = 0;
+    mutable std::atomic<uint32_t> mHitGroupID{0};
 };
 
 } // namespace Falcor
@@ -29,7 +29,10 @@
 #include "Animation.h"
 #include "Core/API/RenderContext.h"
 #include "Scene/Scene.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
 #include "Utils/Timing/Profiler.h"
+#include <cstring>
 
 namespace Falcor
 {
@@ -92,17 +95,30 @@ namespace Falcor
 
             return InterpolationInfo{ keyframeIndices, t };
         }
+
+        template<typename T>
+        void appendBytes(std::vector<uint8_t>& bytes, const std::vector<T>& data)
+        {
+            size_t offset = bytes.size();
+            bytes.resize(offset + data.size() * sizeof(T));
+            if (!data.empty()) std::memcpy(bytes.data() + offset, data.data(), data.size() * sizeof(T));
+        }
     }
 
-    AnimatedVertexCache::AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes,
+        const std::optional<VertexCacheStreamer::Options>& streamingOptions)
         : mpDevice(pDevice)
         , mpScene(pScene)
         , mpPrevVertexData(pPrevVertexData)
-        , mCachedCurves(cachedCurves)
-        , mCachedMeshes(cachedMeshes)
+        , mCachedCurves(std::move(cachedCurves))
+        , mCachedMeshes(std::move(cachedMeshes))
     {
         if (mCachedCurves.empty() && mCachedMeshes.empty()) return;
 
+        // When streaming, the keyframe buffers are created on demand. Keyframes are read from disk, so in-memory data is moved to a file first.
+        mStreaming = streamingOptions.has_value();
+        if (mStreaming) moveKeyframesOutOfCore();
+
         if (!mCachedCurves.empty())
         {
             for (auto& cache : mCachedCurves)
@@ -136,12 +152,31 @@ namespace Falcor
 
             createMeshVertexUpdatePass();
         }
+
+        if (mStreaming)
+        {
+            initStreaming(*streamingOptions);
+        }
+        else
+        {
+            // All keyframes are resident on the GPU, the CPU copies are no longer needed.
+            auto releaseKeyframes = [](auto& cache)
+            {
+                cache.vertexData = {};
+                cache.pKeyframeFile = nullptr;
+                cache.keyframeChunks = {};
+            };
+            for (auto& cache : mCachedCurves) releaseKeyframes(cache);
+            for (auto& cache : mCachedMeshes) releaseKeyframes(cache);
+        }
     }
 
     bool AnimatedVertexCache::animate(RenderContext* pRenderContext, double time)
     {
         if (!hasAnimations()) return false;
 
+        if (mpStreamer) updateStreaming(time);
+
         if (!mCachedCurves.empty())
         {
             double curveTime = mLoopAnimations ? std::fmod(time, mGlobalCurveAnimationLength) : time;
@@ -194,6 +229,38 @@ namespace Falcor
         return m;
     }
 
+    void AnimatedVertexCache::renderUI(Gui::Widgets& widget)
+    {
+        if (mpStreamer) mpStreamer->renderUI(widget);
+    }
+
+    void AnimatedVertexCache::moveKeyframesOutOfCore()
+    {
+        bool hasInMemoryData = false;
+        for (const auto& cache : mCachedCurves) hasInMemoryData |= !cache.isOutOfCore();
+        for (const auto& cache : mCachedMeshes) hasInMemoryData |= !cache.isOutOfCore();
+        if (!hasInMemoryData) return;
+
+        std::filesystem::path path = getTempFilePath();
+        {
+            VertexCacheFile::Writer writer(path);
+            auto moveToWriter = [&writer](auto& cache)
+            {
+                if (cache.isOutOfCore()) return;
+                cache.keyframeChunks.clear();
+                for (const auto& data : cache.vertexData) cache.keyframeChunks.push_back(writer.addChunk(data));
+                cache.vertexData = {};
+            };
+            for (auto& cache : mCachedCurves) moveToWriter(cache);
+            for (auto& cache : mCachedMeshes) moveToWriter(cache);
+        }
+
+        auto pFile = VertexCacheFile::open(path, true);
+        if (!pFile) FALCOR_THROW("Failed to open vertex cache keyframe file '{}'.", path);
+        for (auto& cache : mCachedCurves) if (!cache.isOutOfCore()) cache.pKeyframeFile = pFile;
+        for (auto& cache : mCachedMeshes) if (!cache.isOutOfCore()) cache.pKeyframeFile = pFile;
+    }
+
     // We create a merged list of all timestamps and generate new frames for curves where those timestamps are missing.
     // This can lead to fairly heavy overhead if we have cached curves with vastly different total length.
     // Currently, our assets have cached curves with the same list of timestamps.
@@ -209,6 +276,75 @@ namespace Falcor
         mCurveKeyframeTimes.erase(std::unique(mCurveKeyframeTimes.begin(), mCurveKeyframeTimes.end()), mCurveKeyframeTimes.end());
 
         mGlobalCurveAnimationLength = mCurveKeyframeTimes.empty() ? 0 : mCurveKeyframeTimes.back();
+
+        // Find the time sample of each cache at or after each keyframe time.
+        mCurveKeyframeSamples.resize(mCachedCurves.size());
+        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        {
+            const auto& timeSamples = mCachedCurves[i].timeSamples;
+            auto& samples = mCurveKeyframeSamples[i];
+            samples.resize(mCurveKeyframeTimes.size());
+
+            uint32_t k = 0;
+            for (size_t j = 0; j < mCurveKeyframeTimes.size(); j++)
+            {
+                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
+                samples[j] = k;
+            }
+        }
+    }
+
+    std::vector<DynamicCurveVertexData> AnimatedVertexCache::buildCurveKeyframe(uint32_t keyframe, CurveTessellationMode mode) const
+    {
+        uint32_t vertexCount = mode == CurveTessellationMode::LinearSweptSphere ? mCurveVertexCount : mCurvePolyTubeVertexCount;
+        std::vector<DynamicCurveVertexData> vertices(vertexCount);
+
+        size_t offset = 0;
+        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        {
+            const auto& cache = mCachedCurves[i];
+            if (cache.tessellationMode != mode) continue;
+
+            uint32_t k = mCurveKeyframeSamples[i][keyframe];
+            const auto& timeSamples = cache.timeSamples;
+            size_t cacheVertexCount = cache.getVertexCount();
+
+            if (timeSamples[k] == mCurveKeyframeTimes[keyframe])
+            {
+                if (cache.isOutOfCore()) cache.pKeyframeFile->readChunk(cache.keyframeChunks[k], vertices.data() + offset);
+                else std::copy(cache.vertexData[k].begin(), cache.vertexData[k].end(), vertices.begin() + offset);
+            }
+            else
+            {
+                // Linearly interpolate at the missing keyframe.
+                float t = float((mCurveKeyframeTimes[keyframe] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
+                std::vector<DynamicCurveVertexData> prevVertices = cache.loadKeyframe(k - 1);
+                std::vector<DynamicCurveVertexData> nextVertices = cache.loadKeyframe(k);
+                for (size_t p = 0; p < cacheVertexCount; p++)
+                {
+                    vertices[offset + p].position = lerp(prevVertices[p].position, nextVertices[p].position, t);
+                }
+            }
+
+            offset += cacheVertexCount;
+        }
+        FALCOR_ASSERT(offset == vertexCount);
+
+        return vertices;
+    }
+
+    std::vector<DynamicCurveVertexData> AnimatedVertexCache::buildCurvePrevVertices(CurveTessellationMode mode) const
+    {
+        std::vector<DynamicCurveVertexData> vertices;
+        for (const auto& cache : mCachedCurves)
+        {
+            if (cache.tessellationMode != mode) continue;
+
+            // Initialize with positions at the first keyframe.
+            auto data = cache.loadKeyframe(0);
+            vertices.insert(vertices.end(), data.begin(), data.end());
+        }
+        return vertices;
     }
 
     void AnimatedVertexCache::bindCurveLSSBuffers()
@@ -220,68 +356,33 @@ namespace Falcor
         {
             if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
 
-            mCurveVertexCount += (uint32_t)mCachedCurves[i].vertexData[0].size();
+            mCurveVertexCount += mCachedCurves[i].getVertexCount();
             mCurveIndexCount += (uint32_t)mCachedCurves[i].indexData.size();
         }
 
-        // Create buffers for vertex positions in curve vertex caches.
+        // Create buffers for vertex positions in curve vertex caches, initialized with cached positions.
+        // When streaming, the buffers are created when the keyframes are loaded.
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurveVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        for (uint32_t i = 0; i < mCurveKeyframeTimes.size() && !mStreaming; i++)
         {
-            mpCurveVertexBuffers[i] = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, MemoryType::DeviceLocal, nullptr, false);
+            auto vertices = buildCurveKeyframe(i, CurveTessellationMode::LinearSweptSphere);
+            mpCurveVertexBuffers[i] = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, MemoryType::DeviceLocal, vertices.data(), false);
             mpCurveVertexBuffers[i]->setName("AnimatedVertexCache::mpCurveVertexBuffers[" + std::to_string(i) + "]");
         }
 
         // Create buffers for previous vertex positions.
-        mpPrevCurveVertexBuffer = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, MemoryType::DeviceLocal, nullptr, false);
+        auto prevVertices = buildCurvePrevVertices(CurveTessellationMode::LinearSweptSphere);
+        mpPrevCurveVertexBuffer = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, MemoryType::DeviceLocal, prevVertices.data(), false);
         mpPrevCurveVertexBuffer->setName("AnimatedVertexCache::mpPrevCurveVertexBuffer");
 
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
-        {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurveVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurveVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            // Initialize it with positions at the first keyframe.
-            mpPrevCurveVertexBuffer->setBlob(mCachedCurves[i].vertexData[0].data(), offset, bufSize);
-
-            offset += bufSize;
-        }
-
         // Create curve index buffer.
         vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurveIndexBuffer = mpDevice->createBuffer(sizeof(uint32_t) * mCurveIndexCount, vbBindFlags);
         mpCurveIndexBuffer->setName("AnimatedVertexCache::mpCurveIndexBuffer");
 
         // Initialize index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         std::vector<uint32_t> indexData(mCurveIndexCount);
         for (CurveID curveID{ 0 }; curveID.get() < (uint32_t)mCachedCurves.size(); ++curveID)
         {
@@ -315,7 +416,7 @@ namespace Falcor
             PerCurveMetadata curveMeta;
             curveMeta.indexCount = (uint32_t)cache.indexData.size();
             curveMeta.indexOffset = mCurvePolyTubeIndexCount;
-            curveMeta.vertexCount = (uint32_t)cache.vertexData[0].size();
+            curveMeta.vertexCount = cache.getVertexCount();
             curveMeta.vertexOffset = mCurvePolyTubeVertexCount;
             curveMetadata.push_back(curveMeta);
 
@@ -337,57 +438,24 @@ namespace Falcor
         mpCurvePolyTubeMeshMetadataBuffer = mpDevice->createStructuredBuffer(sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, meshMetadata.data(), false);
         mpCurvePolyTubeMeshMetadataBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeMeshMetadataBuffer");
 
-        // Create buffers for vertex positions in curve vertex caches.
+        // Create buffers for vertex positions in curve vertex caches, initialized with cached positions.
+        // When streaming, the buffers are created when the keyframes are loaded.
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurvePolyTubeVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        for (uint32_t i = 0; i < mCurveKeyframeTimes.size() && !mStreaming; i++)
         {
-            mpCurvePolyTubeVertexBuffers[i] = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, MemoryType::DeviceLocal, nullptr, false);
+            auto vertices = buildCurveKeyframe(i, CurveTessellationMode::PolyTube);
+            mpCurvePolyTubeVertexBuffers[i] = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, MemoryType::DeviceLocal, vertices.data(), false);
             mpCurvePolyTubeVertexBuffers[i]->setName("AnimatedVertexCache::mpCurvePolyTubeVertexBuffers[" + std::to_string(i) + "]");
         }
 
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
-        {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::PolyTube) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            offset += bufSize;
-        }
-
         // Create curve strand index buffer.
         vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurvePolyTubeStrandIndexBuffer = mpDevice->createBuffer(sizeof(uint32_t) * mCurvePolyTubeVertexCount, vbBindFlags);
         mpCurvePolyTubeStrandIndexBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeStrandIndexBuffer");
 
         // Initialize strand index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         const uint32_t strandLastVertexIndex = 0xffffffff;
         std::vector<uint32_t> strandIndexData(mCurvePolyTubeVertexCount);
         for (uint32_t i = 0; i < (uint32_t)mCachedCurves.size(); i++)
@@ -429,32 +497,37 @@ namespace Falcor
         {
             mGlobalMeshAnimationLength = std::max(mGlobalMeshAnimationLength, cache.timeSamples.back());
             mMeshKeyframeCount += (uint32_t)cache.timeSamples.size();
-            mMaxMeshVertexCount = std::max((uint32_t)cache.vertexData.front().size(), mMaxMeshVertexCount);
+            mMaxMeshVertexCount = std::max(cache.getVertexCount(), mMaxMeshVertexCount);
         }
     }
 
     void AnimatedVertexCache::initMeshBuffers()
     {
         mpMeshVertexBuffers.resize(mMeshKeyframeCount);
+        mMeshKeyframeOffsets.reserve(mCachedMeshes.size());
         std::vector<PerMeshMetadata> meshMetadata;
         meshMetadata.reserve(mCachedMeshes.size());
 
         uint32_t keyframeOffset = 0;
         for (auto& cache : mCachedMeshes)
         {
-            FALCOR_ASSERT(cache.vertexData.front().size() == mpScene->getMesh(cache.meshID).vertexCount);
+            FALCOR_ASSERT(cache.getVertexCount() == mpScene->getMesh(cache.meshID).vertexCount);
 
             PerMeshMetadata meta;
             meta.keyframeBufferOffset = keyframeOffset;
-            meta.vertexCount = (uint32_t)cache.vertexData.front().size();
+            meta.vertexCount = cache.getVertexCount();
             meta.sceneVbOffset = mpScene->getMesh(cache.meshID).vbOffset;
             meta.prevVbOffset = mpScene->getMesh(cache.meshID).prevVbOffset;
             meshMetadata.push_back(meta);
+            mMeshKeyframeOffsets.push_back(keyframeOffset);
 
-            // Create vertex buffer for each keyframe on this mesh
-            for (size_t i = 0; i < cache.vertexData.size(); i++)
+            // Create vertex buffer for each keyframe on this mesh.
+            // When streaming, the buffers are created when the keyframes are loaded.
+            for (size_t i = 0; i < cache.getKeyframeCount() && !mStreaming; i++)
             {
-                auto& data = cache.vertexData[i];
+                std::vector<PackedStaticVertexData> keyframeData;
+                if (cache.isOutOfCore()) keyframeData = cache.loadKeyframe(i);
+                const auto& data = cache.isOutOfCore() ? keyframeData : cache.vertexData[i];
                 size_t index = keyframeOffset + i;
                 mpMeshVertexBuffers[index] = mpDevice->createStructuredBuffer(sizeof(PackedStaticVertexData), (uint32_t)data.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, data.data(), false);
                 mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
@@ -483,7 +556,7 @@ namespace Falcor
         // Bind data
         auto block = mpMeshVertexUpdatePass->getRootVar()["gMeshVertexUpdater"];
         auto keyframesVar = block["meshPerKeyframe"];
-        for (size_t i = 0; i < mpMeshVertexBuffers.size(); i++) keyframesVar[i]["vertexData"] = mpMeshVertexBuffers[i];
+        for (size_t i = 0; i < mpMeshVertexBuffers.size(); i++) if (mpMeshVertexBuffers[i]) keyframesVar[i]["vertexData"] = mpMeshVertexBuffers[i];
 
         block["perMeshInterp"] = mpMeshInterpolationBuffer;
         block["perMeshData"] = mpMeshMetadataBuffer;
@@ -503,7 +576,7 @@ namespace Falcor
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
+        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) if (mpCurveVertexBuffers[i]) var[i]["vertexData"] = mpCurveVertexBuffers[i];
     }
 
     void AnimatedVertexCache::createCurveLSSAABBUpdatePass()
@@ -532,7 +605,137 @@ namespace Falcor
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
+        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) if (mpCurvePolyTubeVertexBuffers[i]) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
+    }
+
+    void AnimatedVertexCache::initStreaming(const VertexCacheStreamer::Options& options)
+    {
+        mpStreamer = std::make_unique<VertexCacheStreamer>(options);
+
+        // All curves share a single keyframe track, holding the LSS and poly-tube vertices of each keyframe.
+        if (!mCachedCurves.empty())
+        {
+            auto load = [this](uint32_t keyframe)
+            {
+                std::vector<uint8_t> data;
+                if (mCurveLSSCount > 0) appendBytes(data, buildCurveKeyframe(keyframe, CurveTessellationMode::LinearSweptSphere));
+                if (mCurvePolyTubeCount > 0) appendBytes(data, buildCurveKeyframe(keyframe, CurveTessellationMode::PolyTube));
+                return data;
+            };
+            auto upload = [this](uint32_t keyframe, const std::vector<uint8_t>& data)
+            {
+                ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+                const uint8_t* pData = data.data();
+                if (mCurveLSSCount > 0)
+                {
+                    mpCurveVertexBuffers[keyframe] = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, MemoryType::DeviceLocal, pData, false);
+                    mpCurveVertexBuffers[keyframe]->setName("AnimatedVertexCache::mpCurveVertexBuffers[" + std::to_string(keyframe) + "]");
+                    pData += mCurveVertexCount * sizeof(DynamicCurveVertexData);
+                }
+                if (mCurvePolyTubeCount > 0)
+                {
+                    mpCurvePolyTubeVertexBuffers[keyframe] = mpDevice->createStructuredBuffer(sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, MemoryType::DeviceLocal, pData, false);
+                    mpCurvePolyTubeVertexBuffers[keyframe]->setName("AnimatedVertexCache::mpCurvePolyTubeVertexBuffers[" + std::to_string(keyframe) + "]");
+                }
+                bindCurveKeyframe(keyframe);
+            };
+            auto evict = [this](uint32_t keyframe)
+            {
+                if (mCurveLSSCount > 0) mpCurveVertexBuffers[keyframe] = nullptr;
+                if (mCurvePolyTubeCount > 0) mpCurvePolyTubeVertexBuffers[keyframe] = nullptr;
+                bindCurveKeyframe(keyframe);
+            };
+            mCurveTrack = mpStreamer->addTrack((uint32_t)mCurveKeyframeTimes.size(), load, upload, evict);
+        }
+
+        // Each cached mesh has its own keyframe track.
+        mFirstMeshTrack = mpStreamer->getTrackCount();
+        for (size_t meshIndex = 0; meshIndex < mCachedMeshes.size(); meshIndex++)
+        {
+            auto load = [this, meshIndex](uint32_t keyframe)
+            {
+                const auto& cache = mCachedMeshes[meshIndex];
+                uint32_t chunk = cache.keyframeChunks[keyframe];
+                std::vector<uint8_t> data(cache.pKeyframeFile->getChunkSize(chunk));
+                cache.pKeyframeFile->readChunk(chunk, data.data());
+                return data;
+            };
+            auto upload = [this, meshIndex](uint32_t keyframe, const std::vector<uint8_t>& data)
+            {
+                uint32_t index = mMeshKeyframeOffsets[meshIndex] + keyframe;
+                uint32_t vertexCount = uint32_t(data.size() / sizeof(PackedStaticVertexData));
+                mpMeshVertexBuffers[index] = mpDevice->createStructuredBuffer(sizeof(PackedStaticVertexData), vertexCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, data.data(), false);
+                mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
+                bindMeshKeyframe(index);
+            };
+            auto evict = [this, meshIndex](uint32_t keyframe)
+            {
+                uint32_t index = mMeshKeyframeOffsets[meshIndex] + keyframe;
+                mpMeshVertexBuffers[index] = nullptr;
+                bindMeshKeyframe(index);
+            };
+            mpStreamer->addTrack((uint32_t)mCachedMeshes[meshIndex].getKeyframeCount(), load, upload, evict);
+        }
+
+        logInfo("Streaming vertex cache keyframes with {} tracks, keeping up to {} keyframes resident per track.", mpStreamer->getTrackCount(), mpStreamer->getOptions().residentKeyframeCount);
+    }
+
+    void AnimatedVertexCache::updateStreaming(double time)
+    {
+        FALCOR_ASSERT(mpStreamer);
+
+        // Predict the upcoming animation times from the advance of the animation clock since the last frame.
+        double frameTime = std::isfinite(mPrevStreamingTime) ? time - mPrevStreamingTime : 0.0;
+        mPrevStreamingTime = time;
+
+        auto requestKeyframes = [&](double t, bool required)
+        {
+            auto request = [&](uint32_t track, uint2 keyframeIndices)
+            {
+                for (uint32_t keyframe : { keyframeIndices.x, keyframeIndices.y })
+                {
+                    if (required) mpStreamer->require(track, keyframe);
+                    else mpStreamer->prefetch(track, keyframe);
+                }
+            };
+
+            if (!mCachedCurves.empty())
+            {
+                double curveTime = mLoopAnimations ? std::fmod(t, mGlobalCurveAnimationLength) : t;
+                request(mCurveTrack, calculateInterpolation(curveTime, mCurveKeyframeTimes, mPreInfinityBehavior, Animation::Behavior::Constant).keyframeIndices);
+            }
+
+            auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
+            for (size_t i = 0; i < mCachedMeshes.size(); i++)
+            {
+                request(mFirstMeshTrack + (uint32_t)i, calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior).keyframeIndices);
+            }
+        };
+
+        mpStreamer->beginFrame();
+        requestKeyframes(time, true);
+        if (frameTime != 0.0)
+        {
+            for (uint32_t i = 1; i <= mpStreamer->getOptions().prefetchFrameCount; i++) requestKeyframes(time + i * frameTime, false);
+        }
+        mpStreamer->endFrame();
+    }
+
+    void AnimatedVertexCache::bindCurveKeyframe(uint32_t keyframe)
+    {
+        if (mpCurveVertexUpdatePass)
+        {
+            mpCurveVertexUpdatePass->getRootVar()["gCurveVertexUpdater"]["curvePerKeyframe"][keyframe]["vertexData"] = mpCurveVertexBuffers[keyframe];
+        }
+        if (mpCurvePolyTubeVertexUpdatePass)
+        {
+            mpCurvePolyTubeVertexUpdatePass->getRootVar()["gCurvePolyTubeVertexUpdater"]["curvePerKeyframe"][keyframe]["vertexData"] = mpCurvePolyTubeVertexBuffers[keyframe];
+        }
+    }
+
+    void AnimatedVertexCache::bindMeshKeyframe(uint32_t index)
+    {
+        mpMeshVertexUpdatePass->getRootVar()["gMeshVertexUpdater"]["meshPerKeyframe"][index]["vertexData"] = mpMeshVertexBuffers[index];
     }
 
 
@@ -27,6 +27,8 @@
  **************************************************************************/
 #pragma once
 #include "Animation.h"
+#include "VertexCacheFile.h"
+#include "VertexCacheStreamer.h"
 #include "SharedTypes.slang"
 #include "Core/API/Buffer.h"
 #include "Core/Pass/ComputePass.h"
@@ -37,6 +39,8 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <vector>
 
 namespace Falcor
@@ -58,6 +62,26 @@ namespace Falcor
 
         // vertexData[i][j] represents at the i-th keyframe, the cache data of the j-th vertex.
         std::vector<std::vector<DynamicCurveVertexData>> vertexData;
+
+        // Out-of-core keyframes. If pKeyframeFile is set, vertexData is empty and the i-th keyframe is stored in chunk keyframeChunks[i].
+        std::shared_ptr<VertexCacheFile> pKeyframeFile;
+        std::vector<uint32_t> keyframeChunks;
+
+        bool isOutOfCore() const { return pKeyframeFile != nullptr; }
+
+        size_t getKeyframeCount() const { return isOutOfCore() ? keyframeChunks.size() : vertexData.size(); }
+
+        uint32_t getVertexCount(size_t keyframe = 0) const
+        {
+            if (isOutOfCore()) return (uint32_t)(pKeyframeFile->getChunkSize(keyframeChunks[keyframe]) / sizeof(DynamicCurveVertexData));
+            return (uint32_t)vertexData[keyframe].size();
+        }
+
+        std::vector<DynamicCurveVertexData> loadKeyframe(size_t keyframe) const
+        {
+            if (isOutOfCore()) return pKeyframeFile->readChunk<DynamicCurveVertexData>(keyframeChunks[keyframe]);
+            return vertexData[keyframe];
+        }
     };
 
     struct CachedMesh
@@ -68,12 +92,37 @@ namespace Falcor
 
         // vertexData[i][j] represents at the i-th keyframe, the cache data of the j-th vertex.
         std::vector<std::vector<PackedStaticVertexData>> vertexData;
+
+        // Out-of-core keyframes. If pKeyframeFile is set, vertexData is empty and the i-th keyframe is stored in chunk keyframeChunks[i].
+        std::shared_ptr<VertexCacheFile> pKeyframeFile;
+        std::vector<uint32_t> keyframeChunks;
+
+        bool isOutOfCore() const { return pKeyframeFile != nullptr; }
+
+        size_t getKeyframeCount() const { return isOutOfCore() ? keyframeChunks.size() : vertexData.size(); }
+
+        uint32_t getVertexCount(size_t keyframe = 0) const
+        {
+            if (isOutOfCore()) return (uint32_t)(pKeyframeFile->getChunkSize(keyframeChunks[keyframe]) / sizeof(PackedStaticVertexData));
+            return (uint32_t)vertexData[keyframe].size();
+        }
+
+        std::vector<PackedStaticVertexData> loadKeyframe(size_t keyframe) const
+        {
+            if (isOutOfCore()) return pKeyframeFile->readChunk<PackedStaticVertexData>(keyframeChunks[keyframe]);
+            return vertexData[keyframe];
+        }
     };
 
     class FALCOR_API AnimatedVertexCache
     {
     public:
-        AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        /** Create the vertex cache animation.
+            \param[in] streamingOptions If set, keyframes are streamed from disk during playback instead of keeping all keyframes resident on the GPU.
+                In-memory keyframe data is moved to a temporary file in this case.
+        */
+        AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes,
+            const std::optional<VertexCacheStreamer::Options>& streamingOptions = {});
         ~AnimatedVertexCache() = default;
 
         void setIsLooped(bool looped) { mLoopAnimations = looped; }
@@ -98,8 +147,20 @@ namespace Falcor
 
         uint64_t getMemoryUsageInBytes() const;
 
+        bool isStreaming() const { return mStreaming; }
+
+        /** Get the keyframe streamer, or nullptr if keyframes are not streamed.
+        */
+        VertexCacheStreamer* getStreamer() const { return mpStreamer.get(); }
+
+        void renderUI(Gui::Widgets& widget);
+
     private:
+        void moveKeyframesOutOfCore();
+
         void initCurveKeyframes();
+        std::vector<DynamicCurveVertexData> buildCurveKeyframe(uint32_t keyframe, CurveTessellationMode mode) const;
+        std::vector<DynamicCurveVertexData> buildCurvePrevVertices(CurveTessellationMode mode) const;
         void bindCurveLSSBuffers();
         void bindCurvePolyTubeBuffers();
 
@@ -112,6 +173,11 @@ namespace Falcor
 
         void createMeshVertexUpdatePass();
 
+        void initStreaming(const VertexCacheStreamer::Options& options);
+        void updateStreaming(double time);
+        void bindCurveKeyframe(uint32_t keyframe);
+        void bindMeshKeyframe(uint32_t index);
+
         void executeMeshVertexUpdatePass(RenderContext* pContext, double t, bool copyPrev = false);
 
         // Interpolate vertex positions.
@@ -137,6 +203,7 @@ namespace Falcor
         uint32_t mCurveLSSCount = 0;
         uint32_t mCurvePolyTubeCount = 0;
         std::vector<double> mCurveKeyframeTimes;
+        std::vector<std::vector<uint32_t>> mCurveKeyframeSamples; ///< Per cached curve and keyframe, index of the first time sample not before the keyframe time.
 
         // Cached curve (LSS) animation.
         ref<ComputePass> mpCurveVertexUpdatePass;
@@ -170,9 +237,17 @@ namespace Falcor
         std::vector<InterpolationInfo> mMeshInterpolationInfo;
         uint32_t mMeshKeyframeCount = 0; ///< Total count of all keyframes for all meshes
         uint32_t mMaxMeshVertexCount = 0; ///< Greatest vertex count a mesh has
+        std::vector<uint32_t> mMeshKeyframeOffsets; ///< Offset of the first keyframe of each mesh in mpMeshVertexBuffers.
 
         std::vector<ref<Buffer>> mpMeshVertexBuffers;
         ref<Buffer> mpMeshInterpolationBuffer;
         ref<Buffer> mpMeshMetadataBuffer;
+
+        // Keyframe streaming. The streamer is declared last so that it's destroyed first, as pending loads access the cached data.
+        bool mStreaming = false;
+        uint32_t mCurveTrack = 0;
+        uint32_t mFirstMeshTrack = 0;
+        double mPrevStreamingTime = std::numeric_limits<double>::quiet_NaN();
+        std::unique_ptr<VertexCacheStreamer> mpStreamer;
     };
 }
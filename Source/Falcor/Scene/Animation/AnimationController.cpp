@@ -44,13 +44,18 @@ namespace Falcor
     AnimationController::AnimationController(ref<Device> pDevice, Scene* pScene, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations)
         : mpDevice(pDevice)
         , mAnimations(animations)
-        , mNodesEdited(pScene->mSceneGraph.size())
         , mLocalMatrices(pScene->mSceneGraph.size())
         , mGlobalMatrices(pScene->mSceneGraph.size())
         , mInvTransposeGlobalMatrices(pScene->mSceneGraph.size())
-        , mMatricesChanged(pScene->mSceneGraph.size())
         , mpScene(pScene)
     {
+        // Lay out the scene graph for transform updates.
+        std::vector<uint32_t> parents(pScene->mSceneGraph.size());
+        for (size_t i = 0; i < parents.size(); i++) parents[i] = pScene->mSceneGraph[i].parent.get();
+        mTransformHierarchy = TransformHierarchy(parents);
+        mNodesEdited = mTransformHierarchy.createBitset();
+        mMatricesChanged = mTransformHierarchy.createBitset();
+
         // Create GPU resources.
         FALCOR_ASSERT(mLocalMatrices.size() <= std::numeric_limits<uint32_t>::max());
 
@@ -93,7 +98,7 @@ namespace Falcor
         }
     }
 
-    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const std::optional<VertexCacheStreamer::Options>& streamingOptions)
     {
         size_t totalAnimatedMeshVertexCount = 0;
 
@@ -119,7 +124,7 @@ namespace Falcor
             for (auto& cache : cachedMeshes)
             {
                 uint32_t offset = mpScene->getMesh(cache.meshID).vbOffset;
-                for (size_t i = 0; i < cache.vertexData.front().size(); i++)
+                for (size_t i = 0; i < cache.getVertexCount(); i++)
                 {
                     prevVertexData.push_back({ staticVertexData[offset + i].position });
                 }
@@ -158,7 +163,7 @@ namespace Falcor
             mpPrevVertexData->setBlob(prevVertexData.data(), byteOffset, prevVertexData.size() * sizeof(PrevVertexData));
         }
 
-        mpVertexCache = std::make_unique<AnimatedVertexCache>(mpDevice, mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes));
+        mpVertexCache = std::make_unique<AnimatedVertexCache>(mpDevice, mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes), streamingOptions);
 
         // Note: It is a workaround to have two pre-infinity behaviors for the cached animation.
         // We need `Cycle` behavior when the length of cached animation is smaller than the length of mesh animation (e.g., tiger forest).
@@ -196,20 +201,22 @@ namespace Falcor
     {
         FALCOR_PROFILE(pRenderContext, "animate");
 
-        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        mUploadedBytes = 0;
+        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), 0);
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
         bool edited = false;
-        for (size_t i = 0; i < sceneGraph.size(); ++i)
+        for (size_t word = 0; word < mNodesEdited.size(); ++word)
         {
-            if (mNodesEdited[i])
+            if (mNodesEdited[word] == 0) continue;
+            for (size_t i = word * 64; i < std::min(sceneGraph.size(), (word + 1) * 64); ++i)
             {
-                mLocalMatrices[i] = sceneGraph[i].transform;
-                mNodesEdited[i] = false;
-                mMatricesChanged[i] = true;
-                edited = true;
+                if (TransformHierarchy::testBit(mNodesEdited, i)) mLocalMatrices[i] = sceneGraph[i].transform;
             }
+            mMatricesChanged[word] = mNodesEdited[word];
+            mNodesEdited[word] = 0;
+            edited = true;
         }
 
         bool changed = false;
@@ -220,7 +227,7 @@ namespace Falcor
         // including transformation matrices, dynamic vertex data etc.
         if (mFirstUpdate || mEnabled != mPrevEnabled)
         {
-            std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), true);
+            std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), ~uint64_t(0));
             initLocalMatrices();
             if (mEnabled)
             {
@@ -228,7 +235,7 @@ namespace Falcor
                 mTime = mPrevTime = time;
             }
             updateWorldMatrices(true);
-            uploadWorldMatrices(true);
+            uploadWorldMatrices(pRenderContext, true);
 
             if (!sceneGraph.empty())
             {
@@ -268,7 +275,7 @@ namespace Falcor
                 std::swap(mpPrevInvTransposeWorldMatricesBuffer, mpInvTransposeWorldMatricesBuffer);
                 updateLocalMatrices(time);
                 updateWorldMatrices();
-                uploadWorldMatrices();
+                uploadWorldMatrices(pRenderContext);
                 bindBuffers();
                 executeSkinningPass(pRenderContext);
                 changed = true;
@@ -296,42 +303,28 @@ namespace Falcor
             NodeID nodeID = pAnimation->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
             mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
-            mMatricesChanged[nodeID.get()] = true;
+            TransformHierarchy::setBit(mMatricesChanged, nodeID.get());
         }
     }
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
-
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        TransformHierarchy::Matrices matrices;
+        matrices.pLocal = mLocalMatrices.data();
+        matrices.pGlobal = mGlobalMatrices.data();
+        matrices.pInvTransposeGlobal = mInvTransposeGlobalMatrices.data();
+        if (mpSkinningPass)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
-            {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
-            }
-
-            if (!mMatricesChanged[i] && !updateAll) continue;
-
-            mGlobalMatrices[i] = mLocalMatrices[i];
-
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
-            {
-                mGlobalMatrices[i] = mul(mGlobalMatrices[sceneGraph[i].parent.get()], mGlobalMatrices[i]);
-            }
-
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
-
-            if (mpSkinningPass)
-            {
-                mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
-            }
+            matrices.pLocalToBindSpace = mLocalToBindSpaceMatrices.data();
+            matrices.pSkinning = mSkinningMatrices.data();
+            matrices.pInvTransposeSkinning = mInvTransposeSkinningMatrices.data();
         }
+
+        // Propagates the matrix change flags to the children.
+        mTransformHierarchy.update(matrices, mMatricesChanged, updateAll);
     }
 
-    void AnimationController::uploadWorldMatrices(bool uploadAll)
+    void AnimationController::uploadWorldMatrices(RenderContext* pRenderContext, bool uploadAll)
     {
         if (mGlobalMatrices.empty()) return;
 
@@ -343,25 +336,20 @@ namespace Falcor
             // Upload all matrices.
             mpWorldMatricesBuffer->setBlob(mGlobalMatrices.data(), 0, mpWorldMatricesBuffer->getSize());
             mpInvTransposeWorldMatricesBuffer->setBlob(mInvTransposeGlobalMatrices.data(), 0, mpInvTransposeWorldMatricesBuffer->getSize());
+            mUploadedBytes += mpWorldMatricesBuffer->getSize() + mpInvTransposeWorldMatricesBuffer->getSize();
+            mPrevDirtyMatrices.clear();
         }
         else
         {
-            // Upload changed matrices only.
-            for (size_t i = 0; i < mGlobalMatrices.size();)
-            {
-                // Detect ranges of consecutive matrices that have all changed or not.
-                size_t offset = i;
-                bool changed = mMatricesChanged[i];
-                while (i < mGlobalMatrices.size() && mMatricesChanged[i] == changed) ++i;
-
-                // Upload range of changed matrices.
-                if (changed)
-                {
-                    size_t count = i - offset;
-                    mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                    mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                }
-            }
+            // Upload changed matrices only. The matrix buffers are swapped every frame, so the buffer written
+            // now also lacks the matrices that changed in the previous frame.
+            DirtyRangeTracker dirtyMatrices = mPrevDirtyMatrices;
+            mPrevDirtyMatrices.clear();
+            mPrevDirtyMatrices.markDirty(mMatricesChanged, mGlobalMatrices.size());
+            dirtyMatrices.markDirty(mPrevDirtyMatrices);
+
+            mUploadedBytes += dirtyMatrices.upload(pRenderContext, mpWorldMatricesBuffer.get(), mGlobalMatrices.data(), sizeof(float4x4));
+            mUploadedBytes += dirtyMatrices.upload(pRenderContext, mpInvTransposeWorldMatricesBuffer.get(), mInvTransposeGlobalMatrices.data(), sizeof(float4x4));
         }
     }
 
@@ -401,6 +389,7 @@ namespace Falcor
             mSkinningMatrices.resize(mpScene->mSceneGraph.size());
             mInvTransposeSkinningMatrices.resize(mSkinningMatrices.size());
             mMeshBindMatrices.resize(mpScene->mSceneGraph.size());
+            mLocalToBindSpaceMatrices.resize(mpScene->mSceneGraph.size());
 
             DefineList defines;
             staticVertexData.getShaderDefines(defines);
@@ -413,6 +402,7 @@ namespace Falcor
             for (size_t i = 0; i < mpScene->mSceneGraph.size(); i++)
             {
                 mMeshBindMatrices[i] = mpScene->mSceneGraph[i].meshBind;
+                mLocalToBindSpaceMatrices[i] = mpScene->mSceneGraph[i].localToBindSpace;
                 meshInvBindMatrices[i] = inverse(mMeshBindMatrices[i]);
             }
 
@@ -478,7 +468,7 @@ namespace Falcor
         float4x4 transform = mul(mul(T, R), S);
 
         mLocalMatrices[nodeID] = transform;
-        mNodesEdited[nodeID] = true;
+        setNodeEdited(nodeID);
     }
 
     //Animation::Keyframe AnimationController::getTransform(int nodeID)
@@ -541,5 +531,13 @@ namespace Falcor
                 animation->renderUI(animGroup);
             }
         }
+
+        if (mpVertexCache && mpVertexCache->isStreaming())
+        {
+            if (auto streamingGroup = widget.group("Vertex Cache Streaming"))
+            {
+                mpVertexCache->renderUI(streamingGroup);
+            }
+        }
     }
 }
@@ -28,11 +28,13 @@
 #pragma once
 #include "Animation.h"
 #include "AnimatedVertexCache.h"
+#include "TransformHierarchy.h"
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 #include "Core/Pass/ComputePass.h"
 #include "Utils/Math/Matrix.h"
 #include "Scene/SceneTypes.slang"
+#include "Utils/DirtyRangeTracker.h"
 #include "Utils/SplitBuffer.h"
 #include <memory>
 #include <vector>
@@ -55,8 +57,9 @@ namespace Falcor
         AnimationController(ref<Device> pDevice, Scene* pScene, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations);
 
         /** Add animated vertex caches (curves and meshes) to the controller.
+            \param[in] streamingOptions If set, the vertex cache keyframes are streamed during playback.
         */
-        void addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        void addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const std::optional<VertexCacheStreamer::Options>& streamingOptions = {});
 
         /** Returns true if controller contains animations.
         */
@@ -101,7 +104,7 @@ namespace Falcor
         /** Mark a scene node as being edited externally.
             Ensures that all global matrices depending on this scene node are updated.
         */
-        void setNodeEdited(size_t nodeID) { mNodesEdited[nodeID] = true; }
+        void setNodeEdited(size_t nodeID) { TransformHierarchy::setBit(mNodesEdited, nodeID); }
 
         /** Run the animation system.
             \return true if a change occurred, otherwise false.
@@ -110,7 +113,11 @@ namespace Falcor
 
         /** Check if a matrix changed since last frame.
         */
-        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
+        bool isMatrixChanged(NodeID matrixID) const { return TransformHierarchy::testBit(mMatricesChanged, matrixID.get()); }
+
+        /** Get the matrix change flags of the last call to animate(). The bitset holds one bit per global matrix.
+        */
+        const TransformHierarchy::Bitset& getMatrixChangeFlags() const { return mMatricesChanged; }
 
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
@@ -144,6 +151,10 @@ namespace Falcor
         */
         uint64_t getMemoryUsageInBytes() const;
 
+        /** Get the number of bytes of transform matrices uploaded to the GPU in the last call to animate().
+        */
+        uint64_t getUploadedBytes() const { return mUploadedBytes; }
+
         /** directly set the transform of an object*/
         void setTransform(int nodeID, const Animation::Keyframe new_transform);
 
@@ -154,10 +165,13 @@ namespace Falcor
         friend class SceneBuilder;
         friend class Scene;
 
+        /// Maximum number of unchanged matrices between two changed ranges for the ranges to be uploaded with a single copy.
+        static constexpr size_t kMatrixMergeDistance = 4;
+
         void initLocalMatrices();
         void updateLocalMatrices(double time);
         void updateWorldMatrices(bool updateAll = false);
-        void uploadWorldMatrices(bool uploadAll = false);
+        void uploadWorldMatrices(RenderContext* pRenderContext, bool uploadAll = false);
 
         void bindBuffers();
 
@@ -168,11 +182,12 @@ namespace Falcor
 
         // Animation
         std::vector<ref<Animation>> mAnimations;
-        std::vector<bool> mNodesEdited;
+        TransformHierarchy mTransformHierarchy;     ///< Breadth-first layout of the scene graph for updating the global matrices.
+        TransformHierarchy::Bitset mNodesEdited;    ///< Flag per scene graph node, set if the node was edited externally.
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
-        std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        TransformHierarchy::Bitset mMatricesChanged; ///< Flag per matrix, set if matrix changed since last frame.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -188,10 +203,13 @@ namespace Falcor
         ref<Buffer> mpPrevWorldMatricesBuffer;
         ref<Buffer> mpInvTransposeWorldMatricesBuffer;
         ref<Buffer> mpPrevInvTransposeWorldMatricesBuffer;
+        DirtyRangeTracker mPrevDirtyMatrices{ kMatrixMergeDistance }; ///< Matrices changed in the previous upload.
+        uint64_t mUploadedBytes = 0;    ///< Bytes of matrix data uploaded in the last call to animate().
 
         // Skinning
         ref<ComputePass> mpSkinningPass;
         std::vector<float4x4> mMeshBindMatrices; // Optimization TODO: These are only needed per mesh
+        std::vector<float4x4> mLocalToBindSpaceMatrices;
         std::vector<float4x4> mSkinningMatrices;
         std::vector<float4x4> mInvTransposeSkinningMatrices;
         uint32_t mSkinningDispatchSize = 0;
@@ -0,0 +1,328 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TransformHierarchy.h"
+#include "Core/Error.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <execution>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FALCOR_TRANSFORM_HIERARCHY_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        // Slots are updated in chunks aligned to bitset words, so that no two chunks write to the same word.
+        const uint32_t kChunkSize = 1024;
+        static_assert(kChunkSize % 64 == 0);
+
+        // Levels with fewer nodes are updated on the calling thread.
+        const uint32_t kMinParallelSlotCount = 4096;
+
+        // Number of bitset words gathered per task.
+        const uint32_t kGatherWordCount = 256;
+
+        bool isAffine(const float4x4& m)
+        {
+            return m[3][0] == 0.f && m[3][1] == 0.f && m[3][2] == 0.f && m[3][3] == 1.f;
+        }
+
+#if FALCOR_TRANSFORM_HIERARCHY_SSE2
+        __m128 cross(__m128 a, __m128 b)
+        {
+            __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        }
+
+        float dot(__m128 a, __m128 b)
+        {
+            __m128 m = _mm_mul_ps(a, b);
+            __m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+            s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+            return _mm_cvtss_f32(s);
+        }
+
+        __m128 splatW(__m128 v)
+        {
+            return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+#endif
+
+        /** Multiply two matrices. Affine matrices are multiplied row by row with SSE2 on x86-64.
+            Other platforms use float4 code and rely on the compiler to vectorize it.
+        */
+        float4x4 mulAffine(const float4x4& a, const float4x4& b)
+        {
+            if (!isAffine(a) || !isAffine(b)) return mul(a, b);
+
+            float4x4 result;
+#if FALCOR_TRANSFORM_HIERARCHY_SSE2
+            const float* pA = a.data();
+            const float* pB = b.data();
+            float* pResult = result.data();
+            __m128 b0 = _mm_loadu_ps(pB);
+            __m128 b1 = _mm_loadu_ps(pB + 4);
+            __m128 b2 = _mm_loadu_ps(pB + 8);
+            __m128 b3 = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+            for (int i = 0; i < 3; i++)
+            {
+                const float* pRow = pA + 4 * i;
+                __m128 row = _mm_mul_ps(_mm_set1_ps(pRow[0]), b0);
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(pRow[1]), b1));
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(pRow[2]), b2));
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(pRow[3]), b3));
+                _mm_storeu_ps(pResult + 4 * i, row);
+            }
+            _mm_storeu_ps(pResult + 12, b3);
+#else
+            for (int i = 0; i < 3; i++)
+            {
+                float4 row = a[i][0] * b[0] + a[i][1] * b[1] + a[i][2] * b[2];
+                row.w += a[i][3];
+                result[i] = row;
+            }
+            result[3] = float4(0.f, 0.f, 0.f, 1.f);
+#endif
+            return result;
+        }
+
+        /** Compute the inverse transpose of a matrix. For affine matrices, the inverse transpose of the upper 3x3 part
+            is the cofactor matrix divided by the determinant, which avoids computing a general 4x4 inverse.
+            Uses SSE2 on x86-64 and float4 code elsewhere.
+        */
+        float4x4 inverseTransposeAffine(const float4x4& m)
+        {
+            if (!isAffine(m)) return transpose(inverse(m));
+
+            float4x4 result;
+#if FALCOR_TRANSFORM_HIERARCHY_SSE2
+            const float* pM = m.data();
+            float* pResult = result.data();
+            const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+            __m128 m0 = _mm_loadu_ps(pM);
+            __m128 m1 = _mm_loadu_ps(pM + 4);
+            __m128 m2 = _mm_loadu_ps(pM + 8);
+            __m128 a0 = _mm_and_ps(m0, xyzMask);
+            __m128 a1 = _mm_and_ps(m1, xyzMask);
+            __m128 a2 = _mm_and_ps(m2, xyzMask);
+
+            __m128 invDet = _mm_set1_ps(1.f / dot(a0, cross(a1, a2)));
+            __m128 c0 = _mm_mul_ps(cross(a1, a2), invDet);
+            __m128 c1 = _mm_mul_ps(cross(a2, a0), invDet);
+            __m128 c2 = _mm_mul_ps(cross(a0, a1), invDet);
+
+            // The last row holds the negated inverse translation.
+            __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, splatW(m0)), _mm_mul_ps(c1, splatW(m1))), _mm_mul_ps(c2, splatW(m2)));
+            t = _mm_sub_ps(_mm_setzero_ps(), t);
+
+            _mm_storeu_ps(pResult, _mm_and_ps(c0, xyzMask));
+            _mm_storeu_ps(pResult + 4, _mm_and_ps(c1, xyzMask));
+            _mm_storeu_ps(pResult + 8, _mm_and_ps(c2, xyzMask));
+            _mm_storeu_ps(pResult + 12, _mm_and_ps(t, xyzMask));
+            pResult[15] = 1.f;
+#else
+            float3 a0 = m[0].xyz();
+            float3 a1 = m[1].xyz();
+            float3 a2 = m[2].xyz();
+            float3 c0 = cross(a1, a2);
+            float3 c1 = cross(a2, a0);
+            float3 c2 = cross(a0, a1);
+            float invDet = 1.f / dot(a0, c0);
+            c0 *= invDet;
+            c1 *= invDet;
+            c2 *= invDet;
+
+            // The last row holds the negated inverse translation.
+            float3 t = -(c0 * m[0].w + c1 * m[1].w + c2 * m[2].w);
+
+            result[0] = float4(c0, 0.f);
+            result[1] = float4(c1, 0.f);
+            result[2] = float4(c2, 0.f);
+            result[3] = float4(t, 1.f);
+#endif
+            return result;
+        }
+    }
+
+    TransformHierarchy::TransformHierarchy(const std::vector<uint32_t>& parents)
+    {
+        const uint32_t nodeCount = (uint32_t)parents.size();
+
+        // Compute the depth of each node. Walk up the hierarchy until reaching a node with known depth,
+        // so that the nodes don't need to be sorted.
+        std::vector<uint32_t> depth(nodeCount, kInvalidNode);
+        std::vector<uint32_t> stack;
+        uint32_t levelCount = 0;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            uint32_t node = i;
+            while (node != kInvalidNode && depth[node] == kInvalidNode)
+            {
+                FALCOR_CHECK(parents[node] == kInvalidNode || parents[node] < nodeCount, "Invalid parent of scene graph node {}.", node);
+                FALCOR_CHECK(stack.size() < nodeCount, "Scene graph contains a cycle.");
+                stack.push_back(node);
+                node = parents[node];
+            }
+
+            uint32_t d = node == kInvalidNode ? 0 : depth[node] + 1;
+            while (!stack.empty())
+            {
+                depth[stack.back()] = d++;
+                stack.pop_back();
+            }
+            levelCount = std::max(levelCount, depth[i] + 1);
+        }
+
+        // Sort the nodes by depth. Nodes within a level keep their relative order.
+        mLevelOffsets.assign(levelCount + 1, 0);
+        for (uint32_t node = 0; node < nodeCount; node++) mLevelOffsets[depth[node] + 1]++;
+        for (uint32_t level = 0; level < levelCount; level++) mLevelOffsets[level + 1] += mLevelOffsets[level];
+
+        std::vector<uint32_t> next(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+        mSlotToNode.resize(nodeCount);
+        mNodeToSlot.resize(nodeCount);
+        for (uint32_t node = 0; node < nodeCount; node++)
+        {
+            uint32_t slot = next[depth[node]]++;
+            mSlotToNode[slot] = node;
+            mNodeToSlot[node] = slot;
+        }
+
+        mSlotParent.resize(nodeCount);
+        mSlotParentSlot.resize(nodeCount);
+        for (uint32_t slot = 0; slot < nodeCount; slot++)
+        {
+            uint32_t parent = parents[mSlotToNode[slot]];
+            mSlotParent[slot] = parent;
+            mSlotParentSlot[slot] = parent == kInvalidNode ? kInvalidNode : mNodeToSlot[parent];
+        }
+
+        mSlotChanged = createBitset();
+    }
+
+    void TransformHierarchy::update(const Matrices& matrices, Bitset& changed, bool updateAll)
+    {
+        FALCOR_ASSERT(matrices.pLocal && matrices.pGlobal && matrices.pInvTransposeGlobal);
+        FALCOR_ASSERT(changed.size() == mSlotChanged.size());
+
+        // Update the levels in order. Nodes within a level are independent.
+        for (uint32_t level = 0; level < getLevelCount();)
+        {
+            uint32_t begin = mLevelOffsets[level];
+            uint32_t end = mLevelOffsets[level + 1];
+
+            // Runs of small levels are updated serially. Parents come before their children in slot order,
+            // so the run is updated in a single pass.
+            if (end - begin < kMinParallelSlotCount)
+            {
+                while (level + 1 < getLevelCount() && mLevelOffsets[level + 2] - mLevelOffsets[level + 1] < kMinParallelSlotCount) level++;
+                updateSlots(matrices, changed, updateAll, begin, mLevelOffsets[++level]);
+                continue;
+            }
+            level++;
+
+            auto range = NumericRange<uint32_t>(begin / kChunkSize, (end - 1) / kChunkSize + 1);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t chunk)
+            {
+                updateSlots(matrices, changed, updateAll, std::max(begin, chunk * kChunkSize), std::min(end, (chunk + 1) * kChunkSize));
+            });
+        }
+
+        // Report all updated nodes, including the ones updated because an ancestor changed.
+        uint32_t wordCount = (uint32_t)changed.size();
+        auto range = NumericRange<uint32_t>(0, (wordCount + kGatherWordCount - 1) / kGatherWordCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
+        {
+            gatherChangedNodes(changed, i * kGatherWordCount, std::min(wordCount, (i + 1) * kGatherWordCount));
+        });
+    }
+
+    void TransformHierarchy::updateSlots(const Matrices& matrices, const Bitset& changed, bool updateAll, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t wordBegin = begin; wordBegin < end;)
+        {
+            const uint32_t word = wordBegin / 64;
+            const uint32_t wordEnd = std::min(end, (word + 1) * 64);
+            uint64_t mask = 0;
+            uint64_t bits = 0;
+
+            for (uint32_t slot = wordBegin; slot < wordEnd; slot++)
+            {
+                const uint32_t node = mSlotToNode[slot];
+                const uint32_t parent = mSlotParent[slot];
+                const uint64_t bit = uint64_t(1) << (slot % 64);
+                mask |= bit;
+
+                // Propagate the change flag from the parent. The parent precedes the node in slot order,
+                // its flag is still held locally if it was updated in this pass and belongs to the same word.
+                bool isChanged = testBit(changed, node);
+                if (!isChanged && parent != kInvalidNode)
+                {
+                    const uint32_t parentSlot = mSlotParentSlot[slot];
+                    const uint64_t parentBit = uint64_t(1) << (parentSlot % 64);
+                    isChanged = parentSlot / 64 == word && (mask & parentBit) ? (bits & parentBit) != 0 : testBit(mSlotChanged, parentSlot);
+                }
+                if (isChanged) bits |= bit;
+                if (!isChanged && !updateAll) continue;
+
+                const float4x4& global = matrices.pGlobal[node] = parent != kInvalidNode ? mulAffine(matrices.pGlobal[parent], matrices.pLocal[node]) : matrices.pLocal[node];
+                matrices.pInvTransposeGlobal[node] = inverseTransposeAffine(global);
+
+                if (matrices.pSkinning)
+                {
+                    const float4x4& skinning = matrices.pSkinning[node] = mulAffine(global, matrices.pLocalToBindSpace[node]);
+                    matrices.pInvTransposeSkinning[node] = inverseTransposeAffine(skinning);
+                }
+            }
+
+            // Words shared with other levels are only written while updating one level at a time.
+            mSlotChanged[word] = (mSlotChanged[word] & ~mask) | bits;
+            wordBegin = wordEnd;
+        }
+    }
+
+    void TransformHierarchy::gatherChangedNodes(Bitset& changed, uint32_t firstWord, uint32_t lastWord) const
+    {
+        const uint32_t nodeCount = getNodeCount();
+        for (uint32_t word = firstWord; word < lastWord; word++)
+        {
+            uint64_t bits = 0;
+            const uint32_t nodeEnd = std::min(nodeCount, (word + 1) * 64);
+            for (uint32_t node = word * 64; node < nodeEnd; node++)
+            {
+                if (testBit(mSlotChanged, mNodeToSlot[node])) bits |= uint64_t(1) << (node % 64);
+            }
+            changed[word] = bits;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Matrix.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    /** Scene graph hierarchy laid out for parallel transform propagation.
+
+        Nodes are sorted breadth-first by depth. Nodes of one level only depend on nodes of the previous level,
+        so all nodes of a level are updated in parallel. Change flags are stored in bitsets with one bit per node,
+        which makes propagating and scanning them cheap for large scene graphs.
+
+        Matrices of affine transforms, which is the common case, are multiplied and inverted with specialized kernels.
+        These use SSE2 intrinsics on x86-64. On other platforms they are plain float4 code and rely on the compiler
+        to vectorize it.
+    */
+    class FALCOR_API TransformHierarchy
+    {
+    public:
+        static constexpr uint32_t kInvalidNode = std::numeric_limits<uint32_t>::max();
+
+        /** Bitset with one bit per node.
+        */
+        using Bitset = std::vector<uint64_t>;
+
+        /** Matrices updated by update(). All arrays are indexed by node ID and hold one matrix per node.
+        */
+        struct Matrices
+        {
+            const float4x4* pLocal = nullptr;                   ///< Local transforms (input).
+            float4x4* pGlobal = nullptr;                        ///< Object-to-world transforms.
+            float4x4* pInvTransposeGlobal = nullptr;            ///< Inverse transpose of the object-to-world transforms.
+            const float4x4* pLocalToBindSpace = nullptr;        ///< Local to bind space transforms for skinning (input, optional).
+            float4x4* pSkinning = nullptr;                      ///< Skinning transforms (optional).
+            float4x4* pInvTransposeSkinning = nullptr;          ///< Inverse transpose of the skinning transforms (optional).
+        };
+
+        TransformHierarchy() = default;
+
+        /** Create the hierarchy. Throws an exception if the hierarchy contains cycles.
+            \param[in] parents Parent ID of each node, or kInvalidNode for root nodes.
+        */
+        TransformHierarchy(const std::vector<uint32_t>& parents);
+
+        uint32_t getNodeCount() const { return (uint32_t)mSlotToNode.size(); }
+
+        uint32_t getLevelCount() const { return mLevelOffsets.empty() ? 0 : (uint32_t)mLevelOffsets.size() - 1; }
+
+        /** Update the global matrices of changed nodes.
+            A node is updated if it is flagged as changed or any of its ancestors is. On return, the change flags
+            include all updated nodes.
+            \param[in] matrices Matrices to update.
+            \param[in,out] changed Change flag per node.
+            \param[in] updateAll Update all nodes regardless of the change flags.
+        */
+        void update(const Matrices& matrices, Bitset& changed, bool updateAll = false);
+
+        /** Create a bitset for the nodes of the hierarchy with all bits cleared.
+        */
+        Bitset createBitset() const { return Bitset((getNodeCount() + 63) / 64, 0); }
+
+        static bool testBit(const Bitset& bitset, size_t index) { return (bitset[index >> 6] >> (index & 63)) & 1; }
+        static void setBit(Bitset& bitset, size_t index) { bitset[index >> 6] |= uint64_t(1) << (index & 63); }
+
+    private:
+        void updateSlots(const Matrices& matrices, const Bitset& changed, bool updateAll, uint32_t begin, uint32_t end);
+        void gatherChangedNodes(Bitset& changed, uint32_t firstWord, uint32_t lastWord) const;
+
+        std::vector<uint32_t> mSlotToNode;      ///< Node ID of each slot in breadth-first order.
+        std::vector<uint32_t> mNodeToSlot;      ///< Slot of each node.
+        std::vector<uint32_t> mSlotParent;      ///< Parent node ID of each slot, or kInvalidNode.
+        std::vector<uint32_t> mSlotParentSlot;  ///< Parent slot of each slot, or kInvalidNode.
+        std::vector<uint32_t> mLevelOffsets;    ///< First slot of each level, followed by the node count.
+        Bitset mSlotChanged;                    ///< Change flag per slot, including propagated changes.
+    };
+}
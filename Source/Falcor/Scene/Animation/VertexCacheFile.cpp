@@ -0,0 +1,199 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexCacheFile.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+
+#include <lz4.h>
+
+#include <cstring>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Specifies the current file version.
+            This needs to be incremented every time the file format changes!
+        */
+        const uint32_t kVersion = 1;
+
+        const char* kMagic = "FalcorK$";
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t chunkCount{};
+            uint64_t chunkTableOffset{};
+
+            bool isValid() const
+            {
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+            }
+        };
+    }
+
+    // Writer
+
+    VertexCacheFile::Writer::Writer(const std::filesystem::path& path)
+        : mPath(path)
+    {
+        if (mPath.has_parent_path()) std::filesystem::create_directories(mPath.parent_path());
+        mStream.open(mPath, std::ios_base::binary | std::ios_base::trunc);
+        if (!mStream.good()) FALCOR_THROW("Failed to create vertex cache file '{}'.", mPath);
+
+        // Write a placeholder header. It is updated with the chunk table location in close().
+        Header header;
+        mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        mOffset = sizeof(header);
+    }
+
+    VertexCacheFile::Writer::~Writer()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception& e)
+        {
+            logError("Failed to close vertex cache file '{}': {}", mPath, e.what());
+        }
+    }
+
+    uint32_t VertexCacheFile::Writer::addChunk(const void* pData, size_t size)
+    {
+        FALCOR_CHECK(mStream.is_open(), "Vertex cache file '{}' is closed.", mPath);
+
+        ChunkInfo chunk{ mOffset, size, size };
+
+        // Compress the chunk if it is worth it, otherwise store it uncompressed.
+        const char* pStored = reinterpret_cast<const char*>(pData);
+        if (size > 0 && size <= LZ4_MAX_INPUT_SIZE)
+        {
+            mCompressBuffer.resize(LZ4_compressBound((int)size));
+            int compressedSize = LZ4_compress_default(pStored, mCompressBuffer.data(), (int)size, (int)mCompressBuffer.size());
+            if (compressedSize > 0 && (size_t)compressedSize < size)
+            {
+                chunk.storedSize = compressedSize;
+                pStored = mCompressBuffer.data();
+            }
+        }
+
+        mStream.write(pStored, chunk.storedSize);
+        if (mStream.bad()) FALCOR_THROW("Failed to write vertex cache file '{}'.", mPath);
+
+        mOffset += chunk.storedSize;
+        mChunks.push_back(chunk);
+        return (uint32_t)mChunks.size() - 1;
+    }
+
+    void VertexCacheFile::Writer::close()
+    {
+        if (!mStream.is_open()) return;
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+        header.version = kVersion;
+        header.chunkCount = (uint32_t)mChunks.size();
+        header.chunkTableOffset = mOffset;
+
+        mStream.write(reinterpret_cast<const char*>(mChunks.data()), mChunks.size() * sizeof(ChunkInfo));
+        mStream.seekp(0);
+        mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        bool failed = mStream.bad();
+        mStream.close();
+        if (failed) FALCOR_THROW("Failed to write vertex cache file '{}'.", mPath);
+    }
+
+    // VertexCacheFile
+
+    std::shared_ptr<VertexCacheFile> VertexCacheFile::open(const std::filesystem::path& path, bool deleteOnClose)
+    {
+        std::shared_ptr<VertexCacheFile> pFile(new VertexCacheFile());
+        if (!pFile->mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        {
+            logWarning("Failed to open vertex cache file '{}'.", path);
+            return nullptr;
+        }
+        pFile->mPath = path;
+        pFile->mDeleteOnClose = deleteOnClose;
+
+        const size_t fileSize = pFile->mFile.getSize();
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(pFile->mFile.getData());
+
+        Header header;
+        if (fileSize < sizeof(header)) return nullptr;
+        std::memcpy(&header, pData, sizeof(header));
+
+        const uint64_t tableSize = uint64_t(header.chunkCount) * sizeof(Writer::ChunkInfo);
+        if (!header.isValid() || header.chunkTableOffset + tableSize > fileSize)
+        {
+            logWarning("Invalid vertex cache file '{}'.", path);
+            return nullptr;
+        }
+
+        pFile->mChunks.resize(header.chunkCount);
+        std::memcpy(pFile->mChunks.data(), pData + header.chunkTableOffset, tableSize);
+        for (const auto& chunk : pFile->mChunks)
+        {
+            if (chunk.offset + chunk.storedSize > header.chunkTableOffset)
+            {
+                logWarning("Invalid chunk table in vertex cache file '{}'.", path);
+                return nullptr;
+            }
+        }
+
+        return pFile;
+    }
+
+    VertexCacheFile::~VertexCacheFile()
+    {
+        mFile.close();
+        if (mDeleteOnClose)
+        {
+            std::error_code ec;
+            std::filesystem::remove(mPath, ec);
+        }
+    }
+
+    void VertexCacheFile::readChunk(uint32_t index, void* pData) const
+    {
+        FALCOR_CHECK(index < mChunks.size(), "Chunk index {} is out of range.", index);
+
+        const auto& chunk = mChunks[index];
+        const char* pSrc = reinterpret_cast<const char*>(mFile.getData()) + chunk.offset;
+        if (chunk.storedSize == chunk.size)
+        {
+            std::memcpy(pData, pSrc, chunk.size);
+        }
+        else
+        {
+            int size = LZ4_decompress_safe(pSrc, reinterpret_cast<char*>(pData), (int)chunk.storedSize, (int)chunk.size);
+            if (size < 0 || (size_t)size != chunk.size) FALCOR_THROW("Corrupt chunk {} in vertex cache file '{}'.", index, mPath);
+        }
+    }
+}
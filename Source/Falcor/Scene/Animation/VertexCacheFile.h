@@ -0,0 +1,133 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace Falcor
+{
+    /** Chunked on-disk storage for vertex cache keyframes.
+
+        Each chunk stores one keyframe of a cached mesh or curve and is compressed individually, so that any keyframe
+        can be loaded without reading the rest of the file. The chunk table is written at the end of the file, which
+        allows appending keyframes while they are produced.
+
+        The file is memory mapped for reading. Reading chunks is thread-safe.
+    */
+    class FALCOR_API VertexCacheFile
+    {
+    public:
+        /** Writer appending chunks to a new vertex cache file.
+        */
+        class FALCOR_API Writer
+        {
+        public:
+            /** Create a new file. Throws an exception if the file can't be created.
+                \param[in] path File path.
+            */
+            Writer(const std::filesystem::path& path);
+            ~Writer();
+
+            /** Append a chunk.
+                \param[in] pData Chunk data.
+                \param[in] size Size of the chunk data in bytes.
+                \return Index of the chunk.
+            */
+            uint32_t addChunk(const void* pData, size_t size);
+
+            template<typename T>
+            uint32_t addChunk(const std::vector<T>& data) { return addChunk(data.data(), data.size() * sizeof(T)); }
+
+            /** Write the chunk table and close the file. Called automatically on destruction.
+            */
+            void close();
+
+            const std::filesystem::path& getPath() const { return mPath; }
+
+        private:
+            struct ChunkInfo
+            {
+                uint64_t offset;
+                uint64_t storedSize;
+                uint64_t size;
+            };
+
+            std::filesystem::path mPath;
+            std::ofstream mStream;
+            std::vector<ChunkInfo> mChunks;
+            std::vector<char> mCompressBuffer;
+            uint64_t mOffset = 0;
+
+            friend class VertexCacheFile;
+        };
+
+        /** Open a vertex cache file for reading.
+            \param[in] path File path.
+            \param[in] deleteOnClose Delete the file when the last reference to it is released.
+            \return The opened file, or nullptr if the file can't be opened or is invalid.
+        */
+        static std::shared_ptr<VertexCacheFile> open(const std::filesystem::path& path, bool deleteOnClose = false);
+
+        ~VertexCacheFile();
+
+        uint32_t getChunkCount() const { return (uint32_t)mChunks.size(); }
+
+        /** Get the uncompressed size of a chunk in bytes.
+        */
+        size_t getChunkSize(uint32_t index) const { return mChunks[index].size; }
+
+        /** Read and decompress a chunk. Throws an exception if the chunk data is corrupt.
+            \param[in] index Chunk index.
+            \param[out] pData Destination buffer of at least getChunkSize() bytes.
+        */
+        void readChunk(uint32_t index, void* pData) const;
+
+        template<typename T>
+        std::vector<T> readChunk(uint32_t index) const
+        {
+            std::vector<T> data(getChunkSize(index) / sizeof(T));
+            readChunk(index, data.data());
+            return data;
+        }
+
+        const std::filesystem::path& getPath() const { return mPath; }
+
+    private:
+        VertexCacheFile() = default;
+
+        std::filesystem::path mPath;
+        bool mDeleteOnClose = false;
+        MemoryMappedFile mFile;
+        std::vector<Writer::ChunkInfo> mChunks;
+    };
+}
@@ -0,0 +1,245 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexCacheStreamer.h"
+#include "Core/Error.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+namespace Falcor
+{
+    VertexCacheStreamer::VertexCacheStreamer(const Options& options)
+        : mOptions(options)
+    {
+        // The two keyframes being interpolated always need to be resident.
+        mOptions.residentKeyframeCount = std::max(mOptions.residentKeyframeCount, 2u);
+        uint32_t threadCount = mOptions.threadCount > 0 ? mOptions.threadCount : std::clamp(std::thread::hardware_concurrency() / 2, 1u, 8u);
+        mpThreadPool = std::make_unique<BS::thread_pool>(threadCount);
+    }
+
+    VertexCacheStreamer::~VertexCacheStreamer()
+    {
+        mpThreadPool->wait_for_tasks();
+    }
+
+    uint32_t VertexCacheStreamer::addTrack(uint32_t keyframeCount, LoadFunc load, UploadFunc upload, EvictFunc evict)
+    {
+        Track track;
+        track.load = std::move(load);
+        track.upload = std::move(upload);
+        track.evict = std::move(evict);
+        track.keyframes.resize(keyframeCount);
+        mTracks.push_back(std::move(track));
+        return (uint32_t)mTracks.size() - 1;
+    }
+
+    void VertexCacheStreamer::beginFrame()
+    {
+        mFrame++;
+
+        // Make keyframes that finished loading in the meantime resident.
+        for (size_t i = 0; i < mLoading.size();)
+        {
+            auto [track, keyframe] = mLoading[i];
+            if (mTracks[track].keyframes[keyframe].pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                finishLoad(track, keyframe);
+                mLoading[i] = mLoading.back();
+                mLoading.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void VertexCacheStreamer::require(uint32_t track, uint32_t keyframe)
+    {
+        FALCOR_ASSERT(track < mTracks.size() && keyframe < mTracks[track].keyframes.size());
+        auto& k = mTracks[track].keyframes[keyframe];
+        mStats.requestCount++;
+        k.lastUsedFrame = mFrame;
+
+        if (k.state == State::Resident) return;
+
+        if (k.state == State::Unloaded)
+        {
+            // Required keyframes always get loaded, even if that temporarily exceeds the budget of the track.
+            if (mTracks[track].activeCount >= mOptions.residentKeyframeCount) evictLeastRecentlyUsed(track);
+            requestLoad(track, keyframe);
+        }
+
+        if (k.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            CpuTimer timer;
+            timer.update();
+            k.pending.wait();
+            timer.update();
+            mStats.stallCount++;
+            mStats.stallTime += timer.delta();
+        }
+
+        finishLoad(track, keyframe);
+        mLoading.erase(std::find(mLoading.begin(), mLoading.end(), std::make_pair(track, keyframe)));
+    }
+
+    void VertexCacheStreamer::prefetch(uint32_t track, uint32_t keyframe)
+    {
+        FALCOR_ASSERT(track < mTracks.size() && keyframe < mTracks[track].keyframes.size());
+        auto& t = mTracks[track];
+        auto& k = t.keyframes[keyframe];
+
+        if (k.state != State::Unloaded)
+        {
+            k.lastUsedFrame = mFrame;
+            return;
+        }
+
+        // Drop the request if all resident keyframes of the track are in use this frame.
+        if (t.activeCount >= mOptions.residentKeyframeCount && !evictLeastRecentlyUsed(track)) return;
+
+        k.lastUsedFrame = mFrame;
+        requestLoad(track, keyframe);
+    }
+
+    void VertexCacheStreamer::endFrame()
+    {
+        for (uint32_t track = 0; track < (uint32_t)mTracks.size(); ++track)
+        {
+            while (mTracks[track].activeCount > mOptions.residentKeyframeCount)
+            {
+                if (!evictLeastRecentlyUsed(track)) break;
+            }
+        }
+    }
+
+    void VertexCacheStreamer::flush()
+    {
+        for (auto [track, keyframe] : mLoading)
+        {
+            mTracks[track].keyframes[keyframe].pending.wait();
+            finishLoad(track, keyframe);
+        }
+        mLoading.clear();
+    }
+
+    bool VertexCacheStreamer::isResident(uint32_t track, uint32_t keyframe) const
+    {
+        return track < mTracks.size() && keyframe < mTracks[track].keyframes.size() && mTracks[track].keyframes[keyframe].state == State::Resident;
+    }
+
+    void VertexCacheStreamer::resetStats()
+    {
+        Stats stats;
+        stats.residentCount = mStats.residentCount;
+        stats.residentBytes = mStats.residentBytes;
+        stats.peakResidentBytes = mStats.residentBytes;
+        mStats = stats;
+    }
+
+    void VertexCacheStreamer::renderUI(Gui::Widgets& widget)
+    {
+        std::ostringstream oss;
+        oss << "Tracks: " << mTracks.size() << std::endl
+            << "Resident keyframes: " << mStats.residentCount << " (max " << mOptions.residentKeyframeCount << " per track)" << std::endl
+            << "Prefetch frames: " << mOptions.prefetchFrameCount << std::endl
+            << "Memory: " << formatByteSize(mStats.residentBytes) << " (peak " << formatByteSize(mStats.peakResidentBytes) << ")" << std::endl
+            << "Loads: " << mStats.loadCount << ", evictions: " << mStats.evictCount << std::endl
+            << "Stalls: " << mStats.stallCount << " of " << mStats.requestCount << " requests (" << mStats.stallTime * 1000.0 << " ms)" << std::endl;
+        widget.text(oss.str());
+        if (widget.button("Reset stats")) resetStats();
+    }
+
+    void VertexCacheStreamer::requestLoad(uint32_t track, uint32_t keyframe)
+    {
+        auto& t = mTracks[track];
+        auto& k = t.keyframes[keyframe];
+        FALCOR_ASSERT(k.state == State::Unloaded);
+
+        k.state = State::Loading;
+        k.pending = mpThreadPool->submit([load = t.load, keyframe]() { return load(keyframe); });
+        t.activeCount++;
+        mLoading.emplace_back(track, keyframe);
+    }
+
+    void VertexCacheStreamer::finishLoad(uint32_t track, uint32_t keyframe)
+    {
+        auto& t = mTracks[track];
+        auto& k = t.keyframes[keyframe];
+        FALCOR_ASSERT(k.state == State::Loading && k.pending.valid());
+
+        std::vector<uint8_t> data = k.pending.get();
+        t.upload(keyframe, data);
+
+        k.state = State::Resident;
+        k.byteSize = data.size();
+        t.resident.push_back(keyframe);
+        mStats.loadCount++;
+        mStats.residentCount++;
+        mStats.residentBytes += k.byteSize;
+        mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+    }
+
+    void VertexCacheStreamer::evictKeyframe(uint32_t track, uint32_t keyframe)
+    {
+        auto& t = mTracks[track];
+        auto& k = t.keyframes[keyframe];
+        FALCOR_ASSERT(k.state == State::Resident);
+
+        t.evict(keyframe);
+
+        k.state = State::Unloaded;
+        t.activeCount--;
+        t.resident.erase(std::find(t.resident.begin(), t.resident.end(), keyframe));
+        mStats.evictCount++;
+        mStats.residentCount--;
+        mStats.residentBytes -= k.byteSize;
+        k.byteSize = 0;
+    }
+
+    bool VertexCacheStreamer::evictLeastRecentlyUsed(uint32_t track)
+    {
+        // Find the least recently used resident keyframe that is not used in the current frame.
+        const auto& t = mTracks[track];
+        uint32_t victim = uint32_t(-1);
+        for (uint32_t i : t.resident)
+        {
+            const auto& k = t.keyframes[i];
+            if (k.lastUsedFrame == mFrame) continue;
+            if (victim == uint32_t(-1) || k.lastUsedFrame < t.keyframes[victim].lastUsedFrame) victim = i;
+        }
+        if (victim == uint32_t(-1)) return false;
+
+        evictKeyframe(track, victim);
+        return true;
+    }
+}
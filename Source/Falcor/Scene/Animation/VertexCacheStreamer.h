@@ -0,0 +1,180 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/UI/Gui.h"
+#include <BS_thread_pool/BS_thread_pool.hpp>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace Falcor
+{
+    /** Streams vertex cache keyframes for playback.
+
+        Keyframes are organized in tracks, for example one track per animated mesh. Each track keeps at most a fixed
+        number of keyframes resident. Keyframes are loaded asynchronously on a pool of worker threads and handed to the
+        owner for upload once loading has finished. Keyframes that are no longer used are evicted in least-recently-used order.
+
+        Each frame, the owner calls beginFrame(), then require() for the keyframes needed to render the current time
+        and prefetch() for the keyframes needed in upcoming frames, and finally endFrame().
+        Note: All functions must be called from the main thread, loading is the only work done on worker threads.
+    */
+    class FALCOR_API VertexCacheStreamer
+    {
+    public:
+        struct Options
+        {
+            uint32_t residentKeyframeCount = 8;     ///< Maximum number of keyframes resident per track. Clamped to at least 2.
+            uint32_t prefetchFrameCount = 8;        ///< Number of upcoming frames to prefetch keyframes for, predicted from the animation clock.
+            uint32_t threadCount = 0;               ///< Number of loading threads. If zero, a default is chosen based on the hardware.
+        };
+
+        struct Stats
+        {
+            uint64_t requestCount = 0;      ///< Number of keyframe requests for rendering.
+            uint64_t stallCount = 0;        ///< Number of keyframe requests that had to wait for the keyframe to load.
+            double stallTime = 0.0;         ///< Total time spent waiting for keyframes to load in seconds.
+            uint64_t loadCount = 0;         ///< Number of keyframes loaded.
+            uint64_t evictCount = 0;        ///< Number of keyframes evicted.
+            uint64_t residentCount = 0;     ///< Number of keyframes currently resident.
+            uint64_t residentBytes = 0;     ///< Memory used by the resident keyframes.
+            uint64_t peakResidentBytes = 0; ///< Peak memory used by the resident keyframes.
+        };
+
+        /** Load a keyframe. Called on a worker thread.
+        */
+        using LoadFunc = std::function<std::vector<uint8_t>(uint32_t keyframe)>;
+
+        /** Make a loaded keyframe resident, for example by uploading it to the GPU. Called on the main thread.
+        */
+        using UploadFunc = std::function<void(uint32_t keyframe, const std::vector<uint8_t>& data)>;
+
+        /** Release a resident keyframe. Called on the main thread.
+        */
+        using EvictFunc = std::function<void(uint32_t keyframe)>;
+
+        VertexCacheStreamer(const Options& options);
+        ~VertexCacheStreamer();
+
+        /** Add a track of keyframes.
+            \param[in] keyframeCount Number of keyframes in the track.
+            \param[in] load Function loading a keyframe.
+            \param[in] upload Function making a loaded keyframe resident.
+            \param[in] evict Function releasing a resident keyframe.
+            \return Track index.
+        */
+        uint32_t addTrack(uint32_t keyframeCount, LoadFunc load, UploadFunc upload, EvictFunc evict);
+
+        /** Begin a new frame. Makes keyframes that finished loading resident. This call never blocks.
+        */
+        void beginFrame();
+
+        /** Make sure a keyframe is resident. Blocks if the keyframe is not loaded yet, which is recorded as a stall.
+            \param[in] track Track index.
+            \param[in] keyframe Keyframe index.
+        */
+        void require(uint32_t track, uint32_t keyframe);
+
+        /** Start loading a keyframe in the background. The request is dropped if the track has no room for another keyframe.
+            \param[in] track Track index.
+            \param[in] keyframe Keyframe index.
+        */
+        void prefetch(uint32_t track, uint32_t keyframe);
+
+        /** End the frame. Evicts keyframes exceeding the resident budget of each track.
+        */
+        void endFrame();
+
+        /** Wait for all pending loads and make them resident.
+        */
+        void flush();
+
+        /** Check if a keyframe is resident.
+        */
+        bool isResident(uint32_t track, uint32_t keyframe) const;
+
+        uint32_t getTrackCount() const { return (uint32_t)mTracks.size(); }
+
+        /** Get the streaming options.
+        */
+        const Options& getOptions() const { return mOptions; }
+
+        /** Get the streaming statistics.
+        */
+        const Stats& getStats() const { return mStats; }
+
+        /** Reset the streaming statistics. The resident counts are kept.
+        */
+        void resetStats();
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        enum class State
+        {
+            Unloaded,
+            Loading,
+            Resident,
+        };
+
+        struct Keyframe
+        {
+            State state = State::Unloaded;
+            std::future<std::vector<uint8_t>> pending;
+            uint64_t lastUsedFrame = 0;
+            uint64_t byteSize = 0;
+        };
+
+        struct Track
+        {
+            LoadFunc load;
+            UploadFunc upload;
+            EvictFunc evict;
+            std::vector<Keyframe> keyframes;
+            std::vector<uint32_t> resident; ///< Indices of the resident keyframes.
+            uint32_t activeCount = 0;       ///< Number of keyframes that are loading or resident.
+        };
+
+        void requestLoad(uint32_t track, uint32_t keyframe);
+        void finishLoad(uint32_t track, uint32_t keyframe);
+        void evictKeyframe(uint32_t track, uint32_t keyframe);
+        bool evictLeastRecentlyUsed(uint32_t track);
+
+        Options mOptions;
+        std::vector<Track> mTracks;
+        std::vector<std::pair<uint32_t, uint32_t>> mLoading; ///< Keyframes currently loading (track, keyframe).
+        uint64_t mFrame = 0;
+        Stats mStats;
+
+        std::unique_ptr<BS::thread_pool> mpThreadPool;
+    };
+}
@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "InstanceDescBuilder.h"
+#include "Core/Error.h"
+#include "Utils/NumericRange.h"
+
+#include <algorithm>
+#include <atomic>
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Number of instances per parallel chunk.
+        const size_t kChunkSize = 4096;
+
+        bool testBit(const std::vector<uint64_t>& bits, uint32_t index)
+        {
+            return (size_t)(index >> 6) < bits.size() && ((bits[index >> 6] >> (index & 63)) & 1);
+        }
+    }
+
+    void InstanceDescBuilder::setLayout(std::vector<Group> groups, std::vector<uint32_t> matrixIDs)
+    {
+        mGroups = std::move(groups);
+        mMatrixIDs = std::move(matrixIDs);
+
+        mGroupOffsets.resize(mGroups.size() + 1);
+        size_t instanceCount = 0;
+        for (size_t i = 0; i < mGroups.size(); i++)
+        {
+            mGroupOffsets[i] = instanceCount;
+            instanceCount += mGroups[i].instanceCount;
+        }
+        mGroupOffsets.back() = instanceCount;
+
+        FALCOR_CHECK(mMatrixIDs.size() == instanceCount, "Expected {} matrix IDs, got {}.", instanceCount, mMatrixIDs.size());
+
+        mInstanceDescs.resize(instanceCount);
+        mValid = false;
+    }
+
+    size_t InstanceDescBuilder::build(const float4x4* pMatrices, const std::vector<uint64_t>* pChangedMatrices)
+    {
+        const size_t instanceCount = mInstanceDescs.size();
+        const size_t chunkCount = (instanceCount + kChunkSize - 1) / kChunkSize;
+        auto chunks = NumericRange<size_t>(0, chunkCount);
+
+        if (mValid && pChangedMatrices)
+        {
+            // Rewrite the transforms of the instances with changed matrices only.
+            std::atomic<size_t> writeCount{ 0 };
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk)
+            {
+                size_t begin = chunk * kChunkSize;
+                size_t count = updateTransforms(pMatrices, *pChangedMatrices, begin, std::min(begin + kChunkSize, instanceCount));
+                if (count > 0) writeCount.fetch_add(count, std::memory_order_relaxed);
+            });
+            return writeCount;
+        }
+
+        std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk)
+        {
+            size_t begin = chunk * kChunkSize;
+            writeDescs(pMatrices, begin, std::min(begin + kChunkSize, instanceCount));
+        });
+        mValid = true;
+        return instanceCount;
+    }
+
+    void InstanceDescBuilder::writeDescs(const float4x4* pMatrices, size_t begin, size_t end)
+    {
+        // Find the group of the first instance in the range.
+        size_t groupIndex = std::upper_bound(mGroupOffsets.begin(), mGroupOffsets.end(), begin) - mGroupOffsets.begin() - 1;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            while (i >= mGroupOffsets[groupIndex + 1]) groupIndex++;
+            const Group& group = mGroups[groupIndex];
+
+            RtInstanceDesc& desc = mInstanceDescs[i];
+            desc = {};
+            desc.accelerationStructure = group.blasAddress;
+            desc.instanceMask = 0xFF;
+            desc.flags = group.flags;
+            desc.instanceContributionToHitGroupIndex = group.instanceContributionToHitGroupIndex;
+            desc.instanceID = group.firstInstanceID + (uint32_t)(i - mGroupOffsets[groupIndex]) * group.instanceIDStride;
+
+            uint32_t matrixID = mMatrixIDs[i];
+            desc.setTransform(matrixID == kIdentityMatrix ? float4x4::identity() : pMatrices[matrixID]);
+        }
+    }
+
+    size_t InstanceDescBuilder::updateTransforms(const float4x4* pMatrices, const std::vector<uint64_t>& changedMatrices, size_t begin, size_t end)
+    {
+        size_t count = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t matrixID = mMatrixIDs[i];
+            if (matrixID == kIdentityMatrix || !testBit(changedMatrices, matrixID)) continue;
+            mInstanceDescs[i].setTransform(pMatrices[matrixID]);
+            count++;
+        }
+        return count;
+    }
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/RtAccelerationStructure.h"
+#include "Utils/Math/Matrix.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    /** Builds the instance descriptors of a TLAS.
+
+        The descriptors are described by a layout of groups. Each group holds consecutive instances of the same BLAS,
+        which share the flags and hit group offset and have evenly spaced instance IDs. The transform of each instance
+        is read from an array of global matrices.
+
+        The descriptors are written in parallel chunks. The descriptor array is kept between builds, and as long as
+        the layout is unchanged, only the descriptors of instances whose matrices changed are rewritten.
+    */
+    class FALCOR_API InstanceDescBuilder
+    {
+    public:
+        /// Matrix ID of instances with an identity transform.
+        static constexpr uint32_t kIdentityMatrix = std::numeric_limits<uint32_t>::max();
+
+        struct Group
+        {
+            DeviceAddress blasAddress = 0;                          ///< Address of the BLAS.
+            RtGeometryInstanceFlags flags = RtGeometryInstanceFlags::None;
+            uint32_t instanceContributionToHitGroupIndex = 0;
+            uint32_t firstInstanceID = 0;                           ///< Instance ID of the first instance.
+            uint32_t instanceIDStride = 0;                          ///< Instance ID increment between instances (the number of geometries per instance).
+            uint32_t instanceCount = 0;                             ///< Number of instances.
+
+            bool operator==(const Group& other) const
+            {
+                return blasAddress == other.blasAddress && flags == other.flags &&
+                    instanceContributionToHitGroupIndex == other.instanceContributionToHitGroupIndex &&
+                    firstInstanceID == other.firstInstanceID && instanceIDStride == other.instanceIDStride &&
+                    instanceCount == other.instanceCount;
+            }
+            bool operator!=(const Group& other) const { return !(*this == other); }
+        };
+
+        /** Check if a layout differs from the current layout.
+        */
+        bool isLayoutChanged(const std::vector<Group>& groups) const { return groups != mGroups; }
+
+        /** Set the layout. This invalidates all descriptors.
+            \param[in] groups List of groups.
+            \param[in] matrixIDs Global matrix ID of each instance, in group order. Use kIdentityMatrix for an identity transform.
+        */
+        void setLayout(std::vector<Group> groups, std::vector<uint32_t> matrixIDs);
+
+        /** Write the instance descriptors.
+            If the descriptors were built since the last layout change and a list of changed matrices is given,
+            only the descriptors referencing changed matrices are rewritten. Otherwise all descriptors are written.
+            \param[in] pMatrices Global matrices.
+            \param[in] pChangedMatrices Optional bitset with one bit per global matrix, set if the matrix changed since the last build.
+            \return Number of descriptors written.
+        */
+        size_t build(const float4x4* pMatrices, const std::vector<uint64_t>* pChangedMatrices = nullptr);
+
+        /** Get the number of instances.
+        */
+        size_t getInstanceCount() const { return mMatrixIDs.size(); }
+
+        /** Get the instance descriptors. Only valid after build().
+        */
+        const std::vector<RtInstanceDesc>& getInstanceDescs() const { return mInstanceDescs; }
+
+    private:
+        void writeDescs(const float4x4* pMatrices, size_t begin, size_t end);
+        size_t updateTransforms(const float4x4* pMatrices, const std::vector<uint64_t>& changedMatrices, size_t begin, size_t end);
+
+        std::vector<Group> mGroups;
+        std::vector<size_t> mGroupOffsets;                  ///< Index of the first instance of each group, followed by the total instance count.
+        std::vector<uint32_t> mMatrixIDs;                   ///< Global matrix ID per instance.
+        std::vector<RtInstanceDesc> mInstanceDescs;
+        bool mValid = false;                                ///< True if the descriptors match the layout.
+    };
+}
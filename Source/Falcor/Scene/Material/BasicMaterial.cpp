@@ -611,6 +611,33 @@ namespace Falcor
         return true;
     }
 
+    uint64_t BasicMaterial::getHash() const
+    {
+        // Hash all fields compared by operator==().
+        FNVHash64 hash;
+        hashBase(hash);
+
+        hash.insert(mData.flags);
+        hashValue(hash, mData.displacementScale);
+        hashValue(hash, mData.displacementOffset);
+        hashValue(hash, mData.baseColor);
+        hashValue(hash, mData.specular);
+        hashValue(hash, mData.emissive);
+        hashValue(hash, mData.emissiveFactor);
+        hashValue(hash, float(mData.diffuseTransmission));
+        hashValue(hash, float(mData.specularTransmission));
+        hashValue(hash, mData.transmission);
+        hashValue(hash, mData.volumeAbsorption);
+        hashValue(hash, float(mData.volumeAnisotropy));
+        hashValue(hash, mData.volumeScattering);
+
+        hashValue(hash, mpDefaultSampler->getDesc());
+        hashValue(hash, mpDisplacementMinSampler->getDesc());
+        hashValue(hash, mpDisplacementMaxSampler->getDesc());
+
+        return hash.get();
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
@@ -66,6 +66,15 @@ namespace Falcor
         */
         bool isEqual(const ref<Material>& pOther) const override;
 
+        /** Compute a hash of the material properties compared by isEqual().
+        */
+        uint64_t getHash() const override;
+
+        /** Returns true if update() can run concurrently with other material updates.
+            This is not the case when a changed displacement map needs to be prepared on the GPU.
+        */
+        bool isUpdateThreadSafe() const override { return !(mDisplacementMapChanged && getDisplacementMap()); }
+
         /** Set the alpha mode.
         */
         void setAlphaMode(AlphaMode alphaMode) override;
@@ -26,12 +26,21 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "MERLFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CacheFile.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Image/ImageIO.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Math/MathConstants.slangh"
 #include "Scene/Material/MERLMaterial.h"
 #include "Scene/Material/DiffuseSpecularUtils.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
+#include <atomic>
+#include <execution>
 #include <fstream>
+#include <map>
+#include <mutex>
 
 namespace Falcor
 {
@@ -48,6 +57,53 @@ namespace Falcor
         const double kBlueScale = 1.66 / 1500.0;
 
         const uint32_t kAlbedoLUTSize = MERLMaterialData::kAlbedoLUTSize;
+
+        // Number of samples converted per parallel work item.
+        const size_t kSamplesPerChunk = 1 << 16;
+
+        // Maximum number of BRDFs sharing a scene when computing albedo lookup tables.
+        const size_t kMaxAlbedoLUTBatchSize = 16;
+
+        // Directory of the albedo lookup table cache, relative to the application data directory.
+        const std::string kAlbedoLUTDirectory = "NVIDIA/Falcor/MERLAlbedoLUTCache";
+
+        /** Process-wide cache of loaded BRDFs keyed by content hash.
+        */
+        struct MERLFileCache
+        {
+            std::mutex mutex;
+            std::map<SHA1::MD, std::weak_ptr<MERLFile>> files;
+        };
+
+        MERLFileCache& getCache()
+        {
+            static MERLFileCache cache;
+            return cache;
+        }
+
+        // Serializes albedo lookup table preparation, as BRDFs may be shared between threads.
+        std::mutex sAlbedoLUTMutex;
+
+        /** Hash the content of a BRDF file and its JSON sidecar file.
+        */
+        SHA1::MD hashFileContent(const std::filesystem::path& path)
+        {
+            SHA1 sha1;
+            std::vector<char> buffer(64 * 1024);
+            for (const auto& filePath : { path, std::filesystem::path(path).replace_extension("json") })
+            {
+                std::ifstream fs(filePath, std::ios_base::binary);
+                uint64_t size = 0;
+                while (fs)
+                {
+                    fs.read(buffer.data(), buffer.size());
+                    sha1.update(buffer.data(), (size_t)fs.gcount());
+                    size += (uint64_t)fs.gcount();
+                }
+                sha1.update(size);
+            }
+            return sha1.finalize();
+        }
     }
 
     MERLFile::MERLFile(const std::filesystem::path& path)
@@ -57,10 +113,16 @@ namespace Falcor
     }
 
     bool MERLFile::loadBRDF(const std::filesystem::path& path)
+    {
+        return loadBRDF(path, hashFileContent(path));
+    }
+
+    bool MERLFile::loadBRDF(const std::filesystem::path& path, const SHA1::MD& contentHash)
     {
         mDesc = {};
         mData.clear();
         mAlbedoLUT.clear();
+        mContentHash = contentHash;
 
         std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
         if (!ifs.good())
@@ -111,105 +173,253 @@ namespace Falcor
         FALCOR_ASSERT(data.size() == 3 * n);
         mData.resize(n);
 
-        size_t negCount = 0;
-        size_t infCount = 0;
-        size_t nanCount = 0;
+        std::atomic<size_t> negCount = 0;
+        std::atomic<size_t> infCount = 0;
+        std::atomic<size_t> nanCount = 0;
 
-        for (size_t i = 0; i < n; i++)
+        auto range = NumericRange<size_t>(0, (n + kSamplesPerChunk - 1) / kSamplesPerChunk);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t chunk)
         {
-            float3& v = mData[i];
+            size_t chunkNegCount = 0;
+            size_t chunkInfCount = 0;
+            size_t chunkNanCount = 0;
+
+            for (size_t i = chunk * kSamplesPerChunk; i < std::min(n, (chunk + 1) * kSamplesPerChunk); i++)
+            {
+                float3& v = mData[i];
 
-            // Extract RGB and apply scaling.
-            v.x = static_cast<float>(data[i] * kRedScale);
-            v.y = static_cast<float>(data[i + n] * kGreenScale);
-            v.z = static_cast<float>(data[i + 2 * n] * kBlueScale);
+                // Extract RGB and apply scaling.
+                v.x = static_cast<float>(data[i] * kRedScale);
+                v.y = static_cast<float>(data[i + n] * kGreenScale);
+                v.z = static_cast<float>(data[i + 2 * n] * kBlueScale);
 
-            // Validate data point and set to zero if invalid.
-            bool isNeg = v.x < 0.f || v.y < 0.f || v.z < 0.f;
-            bool isInf = std::isinf(v.x) || std::isinf(v.y) || std::isinf(v.z);
-            bool isNaN = std::isnan(v.x) || std::isnan(v.y) || std::isnan(v.z);
+                // Validate data point and set to zero if invalid.
+                bool isNeg = v.x < 0.f || v.y < 0.f || v.z < 0.f;
+                bool isInf = std::isinf(v.x) || std::isinf(v.y) || std::isinf(v.z);
+                bool isNaN = std::isnan(v.x) || std::isnan(v.y) || std::isnan(v.z);
 
-            if (isNeg) negCount++;
-            if (isInf) infCount++;
-            if (isNaN) nanCount++;
+                if (isNeg) chunkNegCount++;
+                if (isInf) chunkInfCount++;
+                if (isNaN) chunkNanCount++;
+
+                if (isInf || isNaN) v = float3(0.f);
+                else if (isNeg) v = max(v, float3(0.f));
+            }
 
-            if (isInf || isNaN) v = float3(0.f);
-            else if (isNeg) v = max(v, float3(0.f));
+            negCount += chunkNegCount;
+            infCount += chunkInfCount;
+            nanCount += chunkNanCount;
+        });
+
+        if (negCount > 0) logWarning("MERL BRDF {} has {} samples with negative values. Clamped to zero.", mDesc.name, negCount.load());
+        if (infCount > 0) logWarning("MERL BRDF {} has {} samples with inf values. Sample set to zero.", mDesc.name, infCount.load());
+        if (nanCount > 0) logWarning("MERL BRDF {} has {} samples with NaN values. Sample set to zero.", mDesc.name, nanCount.load());
+    }
+
+    std::vector<uint16_t> MERLFile::getDataFloat16() const
+    {
+        // Clamp to the fp16 range so that large values don't turn into infinities.
+        std::vector<float> data(mData.size() * 3);
+        for (size_t i = 0; i < mData.size(); i++)
+        {
+            data[3 * i + 0] = std::min(mData[i].x, HLF_MAX);
+            data[3 * i + 1] = std::min(mData[i].y, HLF_MAX);
+            data[3 * i + 2] = std::min(mData[i].z, HLF_MAX);
         }
 
-        if (negCount > 0) logWarning("MERL BRDF {} has {} samples with negative values. Clamped to zero.", mDesc.name, negCount);
-        if (infCount > 0) logWarning("MERL BRDF {} has {} samples with inf values. Sample set to zero.", mDesc.name, infCount);
-        if (nanCount > 0) logWarning("MERL BRDF {} has {} samples with NaN values. Sample set to zero.", mDesc.name, nanCount);
+        std::vector<uint16_t> result(data.size());
+        math::float32ToFloat16(data, result);
+        return result;
     }
 
-    const std::vector<float4>& MERLFile::prepareAlbedoLUT(ref<Device> pDevice)
+    std::vector<std::shared_ptr<MERLFile>> MERLFile::loadCached(const std::vector<std::filesystem::path>& paths)
     {
-        if (!mAlbedoLUT.empty())
-            return mAlbedoLUT;
+        for (const auto& path : paths)
+        {
+            if (!std::filesystem::is_regular_file(path))
+                FALCOR_THROW("Failed to load MERL BRDF from '{}'. File not found.", path);
+        }
+
+        // Hash all files in parallel.
+        std::vector<SHA1::MD> hashes(paths.size());
+        auto range = NumericRange<size_t>(0, paths.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) { hashes[i] = hashFileContent(paths[i]); });
+
+        // Look up cached BRDFs and collect the unique files that need to be loaded.
+        auto& cache = getCache();
+        std::vector<std::shared_ptr<MERLFile>> files(paths.size());
+        std::map<SHA1::MD, size_t> loads; // Maps content hash to the index of the path to load.
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            for (size_t i = 0; i < paths.size(); i++)
+            {
+                if (auto it = cache.files.find(hashes[i]); it != cache.files.end())
+                    files[i] = it->second.lock();
+                if (!files[i])
+                    loads.try_emplace(hashes[i], i);
+            }
+        }
 
-        FALCOR_CHECK(!mDesc.path.empty(), "No BRDF loaded");
-        const auto texPath = mDesc.path.replace_extension("dds");
+        // Load the missing BRDFs in parallel.
+        std::vector<std::pair<SHA1::MD, size_t>> loadList(loads.begin(), loads.end());
+        std::vector<std::shared_ptr<MERLFile>> loaded(loadList.size());
+        std::vector<uint8_t> loadResults(loadList.size());
+        auto loadRange = NumericRange<size_t>(0, loadList.size());
+        std::for_each(std::execution::par, loadRange.begin(), loadRange.end(), [&](size_t i)
+        {
+            loaded[i] = std::make_shared<MERLFile>();
+            loadResults[i] = loaded[i]->loadBRDF(paths[loadList[i].second], loadList[i].first);
+        });
 
-        // Try loading cached albedo lookup table.
-        if (std::filesystem::is_regular_file(texPath))
+        for (size_t i = 0; i < loadList.size(); i++)
         {
-            const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
+            if (!loadResults[i])
+                FALCOR_THROW("Failed to load MERL BRDF from '{}'", paths[loadList[i].second]);
+        }
 
-            if (albedoLut->getFormat() == kAlbedoLUTFormat &&
-                albedoLut->getWidth() == kAlbedoLUTSize && albedoLut->getHeight() == 1)
+        // Add the loaded BRDFs to the cache. If another thread loaded the same content in the meantime, use its BRDF instead.
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            for (size_t i = 0; i < loadList.size(); i++)
             {
-                const float4* data = reinterpret_cast<const float4*>(albedoLut->getData());
-                mAlbedoLUT.resize(kAlbedoLUTSize);
-                std::copy(data, data + kAlbedoLUTSize, mAlbedoLUT.begin());
+                auto& entry = cache.files[loadList[i].first];
+                if (auto pFile = entry.lock())
+                    loaded[i] = pFile;
+                else
+                    entry = loaded[i];
+                loads[loadList[i].first] = i;
+            }
+        }
 
-                logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                return mAlbedoLUT;
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            if (!files[i])
+                files[i] = loaded[loads.at(hashes[i])];
+        }
+
+        if (!loadList.empty())
+            logInfo("MERLFile: Loaded {} unique BRDFs for {} paths.", loadList.size(), paths.size());
+
+        return files;
+    }
+
+    const std::vector<float4>& MERLFile::prepareAlbedoLUT(ref<Device> pDevice)
+    {
+        prepareAlbedoLUTs(pDevice, { this });
+        return mAlbedoLUT;
+    }
+
+    void MERLFile::prepareAlbedoLUTs(ref<Device> pDevice, const std::vector<MERLFile*>& files)
+    {
+        std::lock_guard<std::mutex> lock(sAlbedoLUTMutex);
+
+        // Try loading cached albedo lookup tables.
+        std::vector<MERLFile*> computeFiles;
+        for (MERLFile* pFile : files)
+        {
+            FALCOR_CHECK(pFile && !pFile->mDesc.path.empty(), "No BRDF loaded");
+            if (!pFile->mAlbedoLUT.empty() || pFile->loadAlbedoLUT())
+                continue;
+            if (std::find(computeFiles.begin(), computeFiles.end(), pFile) == computeFiles.end())
+                computeFiles.push_back(pFile);
+        }
+
+        // Failed to load valid lookup tables. We'll recompute them in batches.
+        for (size_t first = 0; first < computeFiles.size(); first += kMaxAlbedoLUTBatchSize)
+        {
+            size_t last = std::min(computeFiles.size(), first + kMaxAlbedoLUTBatchSize);
+            std::vector<MERLFile*> batch(computeFiles.begin() + first, computeFiles.begin() + last);
+            computeAlbedoLUTs(pDevice, batch, kAlbedoLUTSize);
+
+            for (MERLFile* pFile : batch)
+            {
+                FALCOR_ASSERT(pFile->mAlbedoLUT.size() == kAlbedoLUTSize);
+                pFile->saveAlbedoLUT();
             }
         }
+    }
+
+    std::filesystem::path MERLFile::getAlbedoLUTPath() const
+    {
+        // The table depends only on the BRDF content. Keying it by the content hash instead of placing it next to the BRDF file
+        // makes it independent of which of several identical files was loaded first.
+        return getAppDataDirectory() / kAlbedoLUTDirectory / (SHA1::toString(mContentHash) + ".dds");
+    }
+
+    bool MERLFile::loadAlbedoLUT()
+    {
+        const auto texPath = getAlbedoLUTPath();
+        if (!std::filesystem::is_regular_file(texPath))
+            return false;
 
-        // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pDevice, kAlbedoLUTSize);
-        FALCOR_ASSERT(mAlbedoLUT.size() == kAlbedoLUTSize);
+        const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
 
-        // Cache lookup table as texture on disk.
+        if (albedoLut->getFormat() == kAlbedoLUTFormat &&
+            albedoLut->getWidth() == kAlbedoLUTSize && albedoLut->getHeight() == 1)
         {
-            const uint8_t* data = reinterpret_cast<const uint8_t*>(mAlbedoLUT.data());
-            const auto albedoLut = Bitmap::create(mAlbedoLUT.size(), 1, kAlbedoLUTFormat, data);
+            const float4* data = reinterpret_cast<const float4*>(albedoLut->getData());
+            mAlbedoLUT.resize(kAlbedoLUTSize);
+            std::copy(data, data + kAlbedoLUTSize, mAlbedoLUT.begin());
 
-            ImageIO::saveToDDS(texPath, *albedoLut, ImageIO::CompressionMode::None, false);
-            logInfo("Saved albedo LUT to '{}'.", texPath);
+            logInfo("Loaded albedo LUT for MERL BRDF '{}' from '{}'.", mDesc.name, texPath);
+            return true;
         }
 
-        return mAlbedoLUT;
+        return false;
+    }
+
+    void MERLFile::saveAlbedoLUT() const
+    {
+        // Cache lookup table as texture on disk. Failing to write the cache is not an error, the table is recomputed next time.
+        const auto texPath = getAlbedoLUTPath();
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(mAlbedoLUT.data());
+        const auto albedoLut = Bitmap::create(mAlbedoLUT.size(), 1, kAlbedoLUTFormat, data);
+
+        try
+        {
+            writeFileAtomic(texPath, [&](const std::filesystem::path& path) { ImageIO::saveToDDS(path, *albedoLut, ImageIO::CompressionMode::None, false); });
+            logInfo("Saved albedo LUT for MERL BRDF '{}' to '{}'.", mDesc.name, texPath);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("MERLFile: Failed to save albedo LUT to '{}': {}", texPath, e.what());
+        }
     }
 
-    void MERLFile::computeAlbedoLUT(ref<Device> pDevice, const size_t binCount)
+    void MERLFile::computeAlbedoLUTs(ref<Device> pDevice, const std::vector<MERLFile*>& files, const size_t binCount)
     {
-        logInfo("MERLFile: Computing albedo LUT for MERL BRDF '{}'...", mDesc.name);
+        for (const MERLFile* pFile : files)
+            logInfo("MERLFile: Computing albedo LUT for MERL BRDF '{}'...", pFile->mDesc.name);
 
         std::vector<float> cosThetas(binCount);
         for (uint32_t i = 0; i < binCount; i++) cosThetas[i] = (float)(i + 1) / binCount;
 
-        // Create MERL material based on loaded data.
-        ref<MERLMaterial> pMaterial = make_ref<MERLMaterial>(pDevice, *this);
-
-        // Create and update dummy scene containing the material.
+        // Create dummy scene containing one MERL material per BRDF based on the loaded data.
         Scene::SceneData sceneData;
         sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
-        MaterialID materialID = sceneData.pMaterials->addMaterial(pMaterial);
+        std::vector<MaterialID> materialIDs;
+        for (const MERLFile* pFile : files)
+        {
+            ref<MERLMaterial> pMaterial = make_ref<MERLMaterial>(pDevice, *pFile);
+            materialIDs.push_back(sceneData.pMaterials->addMaterial(pMaterial));
+        }
 
         ref<Scene> pScene = Scene::create(pDevice, std::move(sceneData));
         pScene->update(pDevice->getRenderContext(), 0.0);
 
-        // Create BSDF integrator utility.
+        // Create BSDF integrator utility. It is shared by all BRDFs in the batch.
         BSDFIntegrator integrator(pDevice, pScene);
 
-        // Integrate BSDF.
-        auto albedos = integrator.integrateIsotropic(pDevice->getRenderContext(), materialID, cosThetas);
-
-        // Copy result into RGBA format needed for texture creation.
-        mAlbedoLUT.resize(binCount);
-        for (uint32_t i = 0; i < binCount; i++)
-            mAlbedoLUT[i] = float4(albedos[i], 1.f);
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            // Integrate BSDF.
+            auto albedos = integrator.integrateIsotropic(pDevice->getRenderContext(), materialIDs[i], cosThetas);
+
+            // Copy result into RGBA format needed for texture creation.
+            auto& albedoLUT = files[i]->mAlbedoLUT;
+            albedoLUT.resize(binCount);
+            for (uint32_t j = 0; j < binCount; j++)
+                albedoLUT[j] = float4(albedos[j], 1.f);
+        }
     }
 }
@@ -28,10 +28,12 @@
 #pragma once
 #include "Core/API/fwd.h"
 #include "Core/API/Formats.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Math/Vector.h"
 #include "Scene/Material/DiffuseSpecularData.slang"
 #include <filesystem>
 #include <memory>
+#include <vector>
 
 namespace Falcor
 {
@@ -39,6 +41,13 @@ namespace Falcor
 
     /** Class for loading a measured material from the MERL BRDF database.
         Additional metadata is loaded along with the BRDF if available.
+
+        BRDFs can be loaded through a process-wide cache using loadCached(). The cache is keyed by the
+        file contents, so identical files are only loaded once, even if they are referenced through different paths.
+        A cached BRDF keeps the path it was first loaded from in its description.
+
+        Albedo lookup tables are cached on disk in the application data directory, keyed by the same content hash.
+        They are therefore shared by all copies of a BRDF file, independent of which path loaded it first.
     */
     class FALCOR_API MERLFile
     {
@@ -66,21 +75,50 @@ namespace Falcor
         bool loadBRDF(const std::filesystem::path& path);
 
         /** Prepare an albedo lookup table.
-            The table is loaded from disk or recomputed if needed.
+            The table is loaded from the on-disk cache or recomputed if needed.
             \param[in] pDevice The device.
             \return Albedo lookup table that can be used with `kAlbedoLUTFormat`.
         */
         const std::vector<float4>& prepareAlbedoLUT(ref<Device> pDevice);
 
+        /** Loads a list of MERL BRDFs through the process-wide cache. Throws on error.
+            BRDFs that are not in the cache are loaded in parallel. The cache only holds weak references,
+            so BRDFs are released when the last user releases them.
+            \param[in] paths Paths to the binary MERL files.
+            \return List of BRDFs in the same order as the paths. BRDFs with identical content share the same object.
+        */
+        static std::vector<std::shared_ptr<MERLFile>> loadCached(const std::vector<std::filesystem::path>& paths);
+
+        /** Prepare albedo lookup tables for a list of BRDFs.
+            Tables are loaded from the on-disk cache if available. The remaining tables are computed in batches that share
+            a scene and BSDF integrator, and are then written to the cache.
+            \param[in] pDevice The device.
+            \param[in] files BRDFs to prepare the albedo lookup tables for.
+        */
+        static void prepareAlbedoLUTs(ref<Device> pDevice, const std::vector<MERLFile*>& files);
+
         const Desc& getDesc() const { return mDesc; }
         const std::vector<float3>& getData() const { return mData; }
 
+        /** Get the albedo lookup table. This is empty until prepared using prepareAlbedoLUT() or prepareAlbedoLUTs().
+        */
+        const std::vector<float4>& getAlbedoLUT() const { return mAlbedoLUT; }
+
+        /** Get the BRDF data in fp16 format with three values per sample. Values outside the fp16 range are clamped.
+        */
+        std::vector<uint16_t> getDataFloat16() const;
+
     private:
+        bool loadBRDF(const std::filesystem::path& path, const SHA1::MD& contentHash);
         void prepareData(const int dims[3], const std::vector<double>& data);
-        void computeAlbedoLUT(ref<Device> pDevice, const size_t binCount);
+        bool loadAlbedoLUT();
+        void saveAlbedoLUT() const;
+        std::filesystem::path getAlbedoLUTPath() const;
+        static void computeAlbedoLUTs(ref<Device> pDevice, const std::vector<MERLFile*>& files, const size_t binCount);
 
         Desc mDesc;                     ///< BRDF description and sampling parameters.
         std::vector<float3> mData;      ///< BRDF data in RGB float format.
         std::vector<float4> mAlbedoLUT; ///< Precomputed albedo lookup table.
+        SHA1::MD mContentHash = {};     ///< Hash of the BRDF file and its JSON sidecar. Keys the albedo lookup table on disk.
     };
 }
@@ -28,6 +28,7 @@
 #include "MERLMaterial.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
 #include "Scene/Material/MERLFile.h"
@@ -43,16 +44,20 @@ namespace Falcor
         const char kShaderFile[] = "Rendering/Materials/MERLMaterial.slang";
     }
 
-    MERLMaterial::MERLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
+    MERLMaterial::MERLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path, bool halfPrecision)
         : Material(pDevice, name, MaterialType::MERL)
     {
         FALCOR_CHECK(!path.empty(), "Missing path.");
 
-        MERLFile merlFile(path);
-        init(merlFile);
+        auto pMerlFile = MERLFile::loadCached({ path }).front();
+        init(*pMerlFile, halfPrecision);
+
+        // The cached BRDF may have been loaded from another path with identical content.
+        mPath = path;
+        mBRDFName = path.stem().string();
 
         // Create albedo LUT texture.
-        auto lut = merlFile.prepareAlbedoLUT(mpDevice);
+        const auto& lut = pMerlFile->prepareAlbedoLUT(mpDevice);
         FALCOR_CHECK(!lut.empty() && sizeof(lut[0]) == sizeof(float4), "Expected albedo LUT in float4 format.");
         static_assert(MERLFile::kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
         mpAlbedoLUT = mpDevice->createTexture2D((uint32_t)lut.size(), 1, MERLFile::kAlbedoLUTFormat, 1, 1, lut.data(), ResourceBindFlags::ShaderResource);
@@ -61,19 +66,30 @@ namespace Falcor
     MERLMaterial::MERLMaterial(ref<Device> pDevice, const MERLFile& merlFile)
         : Material(pDevice, "", MaterialType::MERL)
     {
-        init(merlFile);
+        init(merlFile, false);
     }
 
-    void MERLMaterial::init(const MERLFile& merlFile)
+    void MERLMaterial::init(const MERLFile& merlFile, bool halfPrecision)
     {
         mPath = merlFile.getDesc().path;
         mBRDFName = merlFile.getDesc().name;
         mData.extraData = merlFile.getDesc().extraData;
+        mData.setHalfPrecision(halfPrecision);
 
         // Create GPU buffer.
         const auto& brdf = merlFile.getData();
         FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
-        mpBRDFData = mpDevice->createBuffer(brdf.size() * sizeof(brdf[0]), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, brdf.data());
+        if (halfPrecision)
+        {
+            // Pad to a multiple of 4 bytes for raw buffer access.
+            auto brdf16 = merlFile.getDataFloat16();
+            brdf16.resize(align_to<size_t>(2, brdf16.size()));
+            mpBRDFData = mpDevice->createBuffer(brdf16.size() * sizeof(brdf16[0]), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, brdf16.data());
+        }
+        else
+        {
+            mpBRDFData = mpDevice->createBuffer(brdf.size() * sizeof(brdf[0]), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, brdf.data());
+        }
 
         // Create sampler for albedo LUT.
         Sampler::Desc desc;
@@ -91,6 +107,7 @@ namespace Falcor
 
         widget.text("MERL BRDF " + mBRDFName);
         widget.tooltip("Full path the BRDF was loaded from:\n" + mPath.string(), true);
+        widget.text(mData.isHalfPrecision() ? "Storage: fp16" : "Storage: fp32");
 
         if (auto g = widget.group("Approx diffuse/specular sampling"))
         {
@@ -137,10 +154,20 @@ namespace Falcor
 
         if (!isBaseEqual(*other)) return false;
         if (mPath != other->mPath) return false;
+        if (mData.isHalfPrecision() != other->mData.isHalfPrecision()) return false;
 
         return true;
     }
 
+    uint64_t MERLMaterial::getHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        hash.insert(std::filesystem::hash_value(mPath));
+        hash.insert(mData.isHalfPrecision());
+        return hash.get();
+    }
+
     ProgramDesc::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -158,10 +185,10 @@ namespace Falcor
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Material)
 
         pybind11::class_<MERLMaterial, Material, ref<MERLMaterial>> material(m, "MERLMaterial");
-        auto create = [] (const std::string& name, const std::filesystem::path& path)
+        auto create = [] (const std::string& name, const std::filesystem::path& path, bool halfPrecision)
         {
-            return MERLMaterial::create(accessActivePythonSceneBuilder().getDevice(), name, getActiveAssetResolver().resolvePath(path));
+            return MERLMaterial::create(accessActivePythonSceneBuilder().getDevice(), name, getActiveAssetResolver().resolvePath(path), halfPrecision);
         };
-        material.def(pybind11::init(create), "name"_a, "path"_a); // PYTHONDEPRECATED
+        material.def(pybind11::init(create), "name"_a, "path"_a, "halfPrecision"_a = false); // PYTHONDEPRECATED
     }
 }
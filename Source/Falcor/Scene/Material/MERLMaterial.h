@@ -44,14 +44,22 @@ namespace Falcor
     {
         FALCOR_OBJECT(MERLMaterial)
     public:
-        static ref<MERLMaterial> create(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path) { return make_ref<MERLMaterial>(pDevice, name, path); }
+        static ref<MERLMaterial> create(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path, bool halfPrecision = false) { return make_ref<MERLMaterial>(pDevice, name, path, halfPrecision); }
 
-        MERLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path);
+        /** Create a MERL material. The BRDF is loaded through the process-wide MERL cache.
+            \param[in] pDevice The device.
+            \param[in] name Material name.
+            \param[in] path Path to the binary MERL file.
+            \param[in] halfPrecision Store the BRDF samples in fp16 instead of fp32 format on the GPU, halving the buffer size.
+        */
+        MERLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path, bool halfPrecision = false);
         MERLMaterial(ref<Device> pDevice, const MERLFile& merlFile);
 
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        uint64_t getHash() const override;
+        bool isUpdateThreadSafe() const override { return true; }
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
@@ -59,13 +67,13 @@ namespace Falcor
         size_t getMaxBufferCount() const override { return 1; }
 
     protected:
-        void init(const MERLFile& merlFile);
+        void init(const MERLFile& merlFile, bool halfPrecision);
 
         std::filesystem::path mPath;        ///< Full path to the BRDF loaded.
         std::string mBRDFName;              ///< This is the file basename without extension.
 
         MERLMaterialData mData;             ///< Material parameters.
-        ref<Buffer> mpBRDFData;             ///< GPU buffer holding all BRDF data as float3 array.
+        ref<Buffer> mpBRDFData;             ///< GPU buffer holding all BRDF data as float3 or fp16 array.
         ref<Texture> mpAlbedoLUT;           ///< Precomputed albedo lookup table.
         ref<Sampler> mpLUTSampler;          ///< Sampler for accessing the LUT texture.
     };
@@ -46,7 +46,7 @@ namespace Falcor
         const char kShaderFile[] = "Rendering/Materials/MERLMixMaterial.slang";
     }
 
-    MERLMixMaterial::MERLMixMaterial(ref<Device> pDevice, const std::string& name, const std::vector<std::filesystem::path>& paths)
+    MERLMixMaterial::MERLMixMaterial(ref<Device> pDevice, const std::string& name, const std::vector<std::filesystem::path>& paths, bool halfPrecision)
         : Material(pDevice, name, MaterialType::MERLMix)
     {
         FALCOR_CHECK(!paths.empty(), "MERLMixMaterial: Expected at least one path.");
@@ -55,36 +55,53 @@ namespace Falcor
         mTextureSlotInfo[(uint32_t)TextureSlot::Normal] = { "normal", TextureChannelFlags::RGB, false };
         mTextureSlotInfo[(uint32_t)TextureSlot::Index] = { "index", TextureChannelFlags::Red, false };
 
-        // Load all BRDFs.
+        // Load all BRDFs. Files are loaded in parallel and shared with other materials using the same BRDFs.
+        std::vector<std::shared_ptr<MERLFile>> merlFiles = MERLFile::loadCached(paths);
+
+        // Prepare albedo LUTs. Missing LUTs are computed in a batch.
+        std::vector<MERLFile*> lutFiles;
+        for (const auto& pMerlFile : merlFiles)
+            lutFiles.push_back(pMerlFile.get());
+        MERLFile::prepareAlbedoLUTs(mpDevice, lutFiles);
+
         mBRDFs.resize(paths.size());
         std::vector<DiffuseSpecularData> extraData(paths.size());
         std::vector<float4> albedoLut;
         BufferAllocator buffer(128, 0 /* raw buffer */, 128, ResourceBindFlags::ShaderResource);
-        MERLFile merlFile;
 
         for (size_t i = 0; i < paths.size(); i++)
         {
-            if (!merlFile.loadBRDF(paths[i]))
-                FALCOR_THROW("MERLMixMaterial: Failed to load BRDF from '{}'.", paths[i]);
+            const MERLFile& merlFile = *merlFiles[i];
 
             auto& desc = mBRDFs[i];
-            desc.path = merlFile.getDesc().path;
-            desc.name = merlFile.getDesc().name;
+            desc.path = paths[i];
+            desc.name = paths[i].stem().string();
             extraData[i] = merlFile.getDesc().extraData;
 
             // Copy BRDF samples into shared data buffer.
             const auto& brdf = merlFile.getData();
             FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
-            desc.byteSize = brdf.size() * sizeof(brdf[0]);
-            desc.byteOffset = buffer.allocate(desc.byteSize);
-            buffer.setBlob(brdf.data(), desc.byteOffset, desc.byteSize);
+            if (halfPrecision)
+            {
+                const auto brdf16 = merlFile.getDataFloat16();
+                desc.byteSize = brdf16.size() * sizeof(brdf16[0]);
+                desc.byteOffset = buffer.allocate(desc.byteSize);
+                buffer.setBlob(brdf16.data(), desc.byteOffset, desc.byteSize);
+            }
+            else
+            {
+                desc.byteSize = brdf.size() * sizeof(brdf[0]);
+                desc.byteOffset = buffer.allocate(desc.byteSize);
+                buffer.setBlob(brdf.data(), desc.byteOffset, desc.byteSize);
+            }
 
             // Copy albedo LUT into shared table.
-            const auto& lut = merlFile.prepareAlbedoLUT(mpDevice);
+            const auto& lut = merlFile.getAlbedoLUT();
             FALCOR_CHECK(lut.size() == MERLMixMaterialData::kAlbedoLUTSize, "MERLMixMaterial: Unexpected albedo LUT size.");
             albedoLut.insert(albedoLut.end(), lut.begin(), lut.end());
         }
 
+        mData.setHalfPrecision(halfPrecision);
         mData.brdfCount = static_cast<uint32_t>(mBRDFs.size());
         mData.byteStride = mBRDFs.size() > 1 ? mBRDFs[1].byteOffset : 0;
         for (size_t i = 0; i < mBRDFs.size(); i++)
@@ -141,6 +158,7 @@ namespace Falcor
 
         // Display BRDF info.
         widget.text(fmt::format("Loaded MERL BRDFs: {}", mBRDFs.size()));
+        widget.text(mData.isHalfPrecision() ? "Storage: fp16" : "Storage: fp32");
         if (auto g = widget.group("BRDFs"))
         {
             for (size_t i = 0; i < mBRDFs.size(); i++)
@@ -229,12 +247,32 @@ namespace Falcor
                 return false;
         }
 
+        if (mData.isHalfPrecision() != other->mData.isHalfPrecision()) return false;
+
         // Compare samplers.
         if (mpDefaultSampler->getDesc() != other->mpDefaultSampler->getDesc()) return false;
 
         return true;
     }
 
+    uint64_t MERLMixMaterial::getHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+
+        hash.insert(mBRDFs.size());
+        for (const auto& brdf : mBRDFs)
+        {
+            hash.insert(brdf.name.data(), brdf.name.size());
+            hash.insert(std::filesystem::hash_value(brdf.path));
+        }
+        hash.insert(mData.isHalfPrecision());
+
+        hashValue(hash, mpDefaultSampler->getDesc());
+
+        return hash.get();
+    }
+
     ProgramDesc::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -315,10 +353,10 @@ namespace Falcor
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Material)
 
         pybind11::class_<MERLMixMaterial, Material, ref<MERLMixMaterial>> material(m, "MERLMixMaterial");
-        auto create = [](const std::string& name, const std::vector<std::filesystem::path>& paths)
+        auto create = [](const std::string& name, const std::vector<std::filesystem::path>& paths, bool halfPrecision)
         {
-            return MERLMixMaterial::create(accessActivePythonSceneBuilder().getDevice(), name, paths);
+            return MERLMixMaterial::create(accessActivePythonSceneBuilder().getDevice(), name, paths, halfPrecision);
         };
-        material.def(pybind11::init(create), "name"_a, "paths"_a); // PYTHONDEPRECATED
+        material.def(pybind11::init(create), "name"_a, "paths"_a, "halfPrecision"_a = false); // PYTHONDEPRECATED
     }
 }
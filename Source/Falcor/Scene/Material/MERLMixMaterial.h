@@ -47,13 +47,22 @@ namespace Falcor
     {
         FALCOR_OBJECT(MERLMixMaterial)
     public:
-        static ref<MERLMixMaterial> create(ref<Device> pDevice, const std::string& name, const std::vector<std::filesystem::path>& paths) { return make_ref<MERLMixMaterial>(pDevice, name, paths); }
+        static ref<MERLMixMaterial> create(ref<Device> pDevice, const std::string& name, const std::vector<std::filesystem::path>& paths, bool halfPrecision = false) { return make_ref<MERLMixMaterial>(pDevice, name, paths, halfPrecision); }
 
-        MERLMixMaterial(ref<Device> pDevice, const std::string& name, const std::vector<std::filesystem::path>& paths);
+        /** Create a MERLMix material.
+            The BRDFs are loaded in parallel through the process-wide MERL cache, and missing albedo lookup tables are computed in a batch.
+            \param[in] pDevice The device.
+            \param[in] name Material name.
+            \param[in] paths Paths to the binary MERL files.
+            \param[in] halfPrecision Store the BRDF samples in fp16 instead of fp32 format on the GPU, halving the buffer size.
+        */
+        MERLMixMaterial(ref<Device> pDevice, const std::string& name, const std::vector<std::filesystem::path>& paths, bool halfPrecision = false);
 
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        uint64_t getHash() const override;
+        bool isUpdateThreadSafe() const override { return true; }
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
@@ -86,7 +95,7 @@ namespace Falcor
         std::vector<BRDFDesc> mBRDFs;       ///< List of loaded BRDFs.
 
         MERLMixMaterialData mData;          ///< Material parameters.
-        ref<Buffer> mpBRDFData;             ///< GPU buffer holding all BRDF data as float3 arrays.
+        ref<Buffer> mpBRDFData;             ///< GPU buffer holding all BRDF data as float3 or fp16 arrays.
         ref<Texture> mpAlbedoLUT;           ///< Precomputed albedo lookup table.
         ref<Sampler> mpLUTSampler;          ///< Sampler for accessing the LUT texture.
         ref<Sampler> mpIndexSampler;        ///< Sampler for accessing the index map.
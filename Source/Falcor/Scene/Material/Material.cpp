@@ -328,6 +328,50 @@ namespace Falcor
         return true;
     }
 
+    void Material::hashBase(FNVHash64& hash) const
+    {
+        // This function hashes all data compared by isBaseEqual().
+
+        hash.insert(mHeader.packedData);
+        hashValue(hash, mTextureTransform.getTranslation());
+        hashValue(hash, mTextureTransform.getScaling());
+        const quatf& rotation = mTextureTransform.getRotation();
+        for (size_t i = 0; i < 4; i++) hashValue(hash, rotation[i]);
+
+        FALCOR_ASSERT(mTextureSlotInfo.size() == mTextureSlotData.size());
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            hash.insert(hasTextureSlot(slot));
+            if (hasTextureSlot(slot))
+            {
+                const auto& info = mTextureSlotInfo[i];
+                hash.insert(info.name.data(), info.name.size());
+                hash.insert(info.mask);
+                hash.insert(info.srgb);
+                hash.insert(mTextureSlotData[i].pTexture.get());
+            }
+        }
+    }
+
+    void Material::hashValue(FNVHash64& hash, const Sampler::Desc& desc)
+    {
+        // Hash the fields compared by Sampler::Desc::operator==().
+        hash.insert(desc.magFilter);
+        hash.insert(desc.minFilter);
+        hash.insert(desc.mipFilter);
+        hash.insert(desc.maxAnisotropy);
+        hashValue(hash, desc.maxLod);
+        hashValue(hash, desc.minLod);
+        hashValue(hash, desc.lodBias);
+        hash.insert(desc.comparisonFunc);
+        hash.insert(desc.reductionMode);
+        hash.insert(desc.addressModeU);
+        hash.insert(desc.addressModeV);
+        hash.insert(desc.addressModeW);
+        hashValue(hash, desc.borderColor);
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
@@ -38,6 +38,7 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Transform.h"
 #include "MaterialTypeRegistry.h"
@@ -157,12 +158,24 @@ namespace Falcor
         */
         virtual bool isDynamic() const { return false; }
 
+        /** Returns true if update() can run concurrently with the updates of other materials.
+            This requires that update() only modifies the material itself, besides registering resources with the material system.
+        */
+        virtual bool isUpdateThreadSafe() const { return false; }
+
         /** Compares material to another material.
             \param[in] pOther Other material.
             \return true if all materials properties *except* the name are identical.
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Compute a hash of the material properties compared by isEqual().
+            Materials that compare equal have identical hashes, which allows finding duplicates without comparing all pairs.
+            Textures are hashed by object identity, so the hash is only valid within the running process.
+            \return Hash value.
+        */
+        virtual uint64_t getHash() const = 0;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -361,6 +374,21 @@ namespace Falcor
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
         bool isBaseEqual(const Material& other) const;
 
+        /** Insert all data compared by isBaseEqual() into a hash.
+        */
+        void hashBase(FNVHash64& hash) const;
+
+        /** Helpers for implementing getHash().
+            Floating-point values are hashed with negative zero mapped to zero, so that values that compare equal hash identically.
+        */
+        static void hashValue(FNVHash64& hash, float value) { hash.insert(value == 0.f ? 0.f : value); }
+        template<typename T, int N>
+        static void hashValue(FNVHash64& hash, const math::vector<T, N>& value)
+        {
+            for (int i = 0; i < N; i++) hashValue(hash, float(value[i]));
+        }
+        static void hashValue(FNVHash64& hash, const Sampler::Desc& desc);
+
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
         template<typename T>
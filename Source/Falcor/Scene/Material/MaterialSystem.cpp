@@ -30,9 +30,14 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Utils/NumericRange.h"
 #include "MaterialTypeRegistry.h"
 #include "Scene/Lights/LightProfile.h"
+#include <algorithm>
+#include <exception>
+#include <execution>
 #include <numeric>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -49,6 +54,7 @@ namespace Falcor
         const size_t kMaxSamplerCount = 1ull << MaterialHeader::kSamplerIDBits;
         const size_t kMaxTextureCount = 1ull << TextureHandle::kTextureIDBits;
         const size_t kMaxBufferCountPerMaterial = 1; // This is a conservative estimation of how many buffer descriptors to allocate per material. Most materials don't use any auxiliary data buffers.
+        const uint32_t kMaxUploadGap = 64; // Maximum number of unmodified materials between two modified ones that are re-uploaded to merge the writes into one.
 
         // Helper to check if a material is a standard material using the SpecGloss shading model.
         // We keep track of these as an optimization because most scenes do not use this shading model.
@@ -146,6 +152,7 @@ namespace Falcor
     uint32_t MaterialSystem::addTextureSampler(const ref<Sampler>& pSampler)
     {
         FALCOR_ASSERT(pSampler);
+        std::lock_guard<std::mutex> lock(mResourceMutex);
         auto isEqual = [&pSampler](const ref<Sampler>& pOther) {
             return pSampler->getDesc() == pOther->getDesc();
         };
@@ -172,6 +179,7 @@ namespace Falcor
     uint32_t MaterialSystem::addBuffer(const ref<Buffer>& pBuffer)
     {
         FALCOR_ASSERT(pBuffer);
+        std::lock_guard<std::mutex> lock(mResourceMutex);
 
         // Reuse previously added buffers. We compare by pointer as the contents of the buffers is unknown.
         if (auto it = std::find_if(mBuffers.begin(), mBuffers.end(), [&](auto pOther) { return pBuffer == pOther; }); it != mBuffers.end())
@@ -196,6 +204,7 @@ namespace Falcor
     void MaterialSystem::replaceBuffer(uint32_t id, const ref<Buffer>& pBuffer)
     {
         FALCOR_ASSERT(pBuffer);
+        std::lock_guard<std::mutex> lock(mResourceMutex);
         FALCOR_CHECK(id < mBuffers.size(), "'id' is out of bounds.");
 
         mBuffers[id] = pBuffer;
@@ -205,6 +214,7 @@ namespace Falcor
     uint32_t MaterialSystem::addTexture3D(const ref<Texture>& pTexture)
     {
         FALCOR_ASSERT(pTexture && pTexture->getType() == Texture::Type::Texture3D && pTexture->getSampleCount() == 1);
+        std::lock_guard<std::mutex> lock(mResourceMutex);
 
         // Reuse previously added texture.
         if (auto it = std::find_if(mTextures3D.begin(), mTextures3D.end(), [&](auto pOther) { return pTexture == pOther; }); it != mTextures3D.end())
@@ -243,7 +253,7 @@ namespace Falcor
             pMaterial->setDefaultTextureSampler(mpDefaultTextureSampler);
         }
 
-        pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
+        registerUpdateCallback(pMaterial, materialID);
         mMaterials.push_back(pMaterial);
         mMaterialsChanged = true;
 
@@ -264,6 +274,9 @@ namespace Falcor
         // Remove textures that were used by the material and loaded via the texture manager.
         mpTextureManager->removeTextures(material.get());
 
+        // Stop tracking updates of the material.
+        material->registerUpdateCallback({});
+
         // Remove the material.
         mMaterials[materialID.get()] = nullptr;
         mMaterialsChanged = true;
@@ -282,7 +295,7 @@ namespace Falcor
         {
             pReplacement->setDefaultTextureSampler(mpDefaultTextureSampler);
         }
-        pReplacement->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
+        registerUpdateCallback(pReplacement, materialID);
 
         // Replace the material.
         mMaterials[materialID.get()] = pReplacement;
@@ -350,20 +363,31 @@ namespace Falcor
         std::vector<ref<Material>> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
+        // Compute material hashes in parallel.
+        std::vector<uint64_t> hashes(mMaterials.size());
+        auto range = NumericRange<size_t>(0, mMaterials.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) { hashes[i] = mMaterials[i]->getHash(); });
+
         // Find unique set of materials.
+        // Equal materials have identical hashes, so each material is only compared to the unique materials with the same hash.
+        std::unordered_map<uint64_t, std::vector<size_t>> uniqueMaterialsByHash;
+        uniqueMaterialsByHash.reserve(mMaterials.size());
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = uniqueMaterialsByHash[hashes[id.get()]];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](size_t index) { return uniqueMaterials[index]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                bucket.push_back(uniqueMaterials.size());
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[*it]->getName());
+                idMap[id.get()] = MaterialID{ *it };
+                pMaterial->registerUpdateCallback({});
             }
         }
 
@@ -372,6 +396,10 @@ namespace Falcor
         {
             mMaterials = uniqueMaterials;
             mMaterialsChanged = true;
+
+            // Track updates under the new material IDs.
+            for (size_t materialIdx = 0; materialIdx < mMaterials.size(); materialIdx++)
+                registerUpdateCallback(mMaterials[materialIdx], MaterialID{ materialIdx });
         }
 
         return removed;
@@ -401,35 +429,53 @@ namespace Falcor
 
         if (textures.empty()) return;
 
-        // Analyze the textures.
-        logInfo("Analyzing {} material textures.", textures.size());
+        // Use the CPU analysis computed while loading the textures where available, and analyze the remaining textures on the GPU.
+        std::vector<TextureAnalyzer::Result> results(textures.size());
+        std::vector<size_t> gpuIndices;
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            if (auto analysis = mpTextureManager->getTextureAnalysis(textures[i].get()))
+                results[i] = *analysis;
+            else
+                gpuIndices.push_back(i);
+        }
+
+        logInfo("Analyzing {} material textures ({} analyzed during loading).", textures.size(), textures.size() - gpuIndices.size());
 
-        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        if (!gpuIndices.empty())
+        {
+            std::vector<ref<Texture>> gpuTextures;
+            gpuTextures.reserve(gpuIndices.size());
+            for (size_t i : gpuIndices) gpuTextures.push_back(textures[i]);
 
-        TextureAnalyzer analyzer(mpDevice);
-        auto pResults = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
-        analyzer.analyze(pRenderContext, textures, pResults);
+            RenderContext* pRenderContext = mpDevice->getRenderContext();
 
-        // Copy result to staging buffer for readback.
-        // This is mostly to avoid a full flush and the associated perf warning.
-        // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
-        auto pResultsStaging = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
-        pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
-        pRenderContext->submit(false);
-        pRenderContext->signal(mpFence.get());
+            TextureAnalyzer analyzer(mpDevice);
+            auto pResults = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
+            analyzer.analyze(pRenderContext, gpuTextures, pResults);
 
-        // Wait for results to become available. Then optimize the materials.
-        mpFence->wait();
-        const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
-        Material::TextureOptimizationStats stats = {};
+            // Copy result to staging buffer for readback.
+            // This is mostly to avoid a full flush and the associated perf warning.
+            // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
+            auto pResultsStaging = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
+            pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
+            pRenderContext->submit(false);
+            pRenderContext->signal(mpFence.get());
 
+            // Wait for results to become available.
+            mpFence->wait();
+            const TextureAnalyzer::Result* gpuResults = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
+            for (size_t j = 0; j < gpuIndices.size(); j++) results[gpuIndices[j]] = gpuResults[j];
+            pResultsStaging->unmap();
+        }
+
+        // Optimize the materials.
+        Material::TextureOptimizationStats stats = {};
         for (size_t i = 0; i < textures.size(); i++)
         {
             materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
         }
 
-        pResultsStaging->unmap();
-
         // Log optimization stats.
         if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
         {
@@ -467,37 +513,46 @@ namespace Falcor
             reupdateMetadata = true;
         }
 
-        // Update all materials.
-        // Do either a full update of all materials with deferred texture loading, or an update of just the dynamic materials.
+        // Update materials.
+        // Do either a full update of all materials, or an update of just the materials that recorded updates since the last call
+        // (with deferred texture loading) and the dynamic materials.
         // We track per-material update flags along with the combined update flags across all materials.
         // Note that materials can record updates in between calls to update() and/or return flags from their update() calls.
-        Material::UpdateFlags updateFlags = Material::UpdateFlags::None;
         mMaterialsUpdateFlags.resize(mMaterials.size());
         std::fill(mMaterialsUpdateFlags.begin(), mMaterialsUpdateFlags.end(), Material::UpdateFlags::None);
 
-        auto updateMaterial = [&](const MaterialID materialID) {
-            auto& pMaterial = getMaterial(materialID);
-            if (pMaterial->mpDevice != mpDevice)
-                FALCOR_THROW("Material '{}' was created with a different device than the MaterialSystem.", pMaterial->getName());
-            Material::UpdateFlags flags = pMaterial->update(this);
-            // Record update flags.
-            mMaterialsUpdateFlags[materialID.get()] = flags;
-            updateFlags |= flags;
-        };
-
-        if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
+        std::vector<MaterialID> updatedMaterialIDs;
+        bool deferredLoading = forceUpdate;
+        if (forceUpdate)
         {
-            mpTextureManager->beginDeferredLoading();
-
+            updatedMaterialIDs.reserve(mMaterials.size());
             for (size_t materialIdx = 0; materialIdx < mMaterials.size(); ++materialIdx)
-                updateMaterial(MaterialID{ materialIdx });
-
-            mpTextureManager->endDeferredLoading();
+                updatedMaterialIDs.push_back(MaterialID{ materialIdx });
         }
         else
         {
-            for (const auto& materialID : mDynamicMaterialIDs)
-                updateMaterial(materialID);
+            {
+                std::lock_guard<std::mutex> lock(mUpdateMutex);
+                updatedMaterialIDs = mDirtyMaterialIDs;
+            }
+            deferredLoading = !updatedMaterialIDs.empty();
+            updatedMaterialIDs.insert(updatedMaterialIDs.end(), mDynamicMaterialIDs.begin(), mDynamicMaterialIDs.end());
+
+            // Update in order of material ID, as for a full update.
+            std::sort(updatedMaterialIDs.begin(), updatedMaterialIDs.end());
+            updatedMaterialIDs.erase(std::unique(updatedMaterialIDs.begin(), updatedMaterialIDs.end()), updatedMaterialIDs.end());
+        }
+
+        if (deferredLoading) mpTextureManager->beginDeferredLoading();
+        Material::UpdateFlags updateFlags = updateMaterials(updatedMaterialIDs);
+        if (deferredLoading) mpTextureManager->endDeferredLoading();
+
+        // Reset update tracking. Updates recorded during the update() calls above are included in the returned flags.
+        {
+            std::lock_guard<std::mutex> lock(mUpdateMutex);
+            for (const auto& materialID : mDirtyMaterialIDs)
+                mMaterialDirty[materialID.get()] = false;
+            mDirtyMaterialIDs.clear();
         }
 
         if (reupdateMetadata)
@@ -530,15 +585,19 @@ namespace Falcor
         }
 
         // Upload all modified materials.
-        if (forceUpdate || is_set(updateFlags, Material::UpdateFlags::DataChanged))
+        if (forceUpdate)
         {
-            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
-            {
-                if (forceUpdate || is_set(mMaterialsUpdateFlags[materialID], Material::UpdateFlags::DataChanged))
-                {
-                    uploadMaterial(materialID);
-                }
-            }
+            std::vector<MaterialID> materialIDs;
+            materialIDs.reserve(mMaterials.size());
+            for (size_t materialIdx = 0; materialIdx < mMaterials.size(); ++materialIdx)
+                materialIDs.push_back(MaterialID{ materialIdx });
+            uploadMaterials(materialIDs);
+        }
+        else if (is_set(updateFlags, Material::UpdateFlags::DataChanged))
+        {
+            auto isUnchanged = [&](const MaterialID materialID) { return !is_set(mMaterialsUpdateFlags[materialID.get()], Material::UpdateFlags::DataChanged); };
+            updatedMaterialIDs.erase(std::remove_if(updatedMaterialIDs.begin(), updatedMaterialIDs.end(), isUnchanged), updatedMaterialIDs.end());
+            uploadMaterials(updatedMaterialIDs);
         }
 
         auto blockVar = mpMaterialsBlock->getRootVar();
@@ -669,6 +728,8 @@ namespace Falcor
         s.textureTexelCount = textureStats.textureTexelCount;
         s.textureTexelChannelCount = textureStats.textureTexelChannelCount;
         s.textureMemoryInBytes = textureStats.textureMemoryInBytes;
+        s.textureDeduplicatedCount = textureStats.textureDeduplicatedCount;
+        s.textureDeduplicatedMemoryInBytes = textureStats.textureDeduplicatedMemoryInBytes;
 
         return s;
     }
@@ -804,9 +865,105 @@ namespace Falcor
         const auto& pMaterial = mMaterials[materialID];
         FALCOR_ASSERT(pMaterial);
 
-        // TODO: On initial upload of materials, we could improve this by not having separate calls to setElement()
-        // but instead prepare a buffer containing all data.
         FALCOR_ASSERT(mpMaterialDataBuffer);
         mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
     }
+
+    void MaterialSystem::uploadMaterials(const std::vector<MaterialID>& materialIDs)
+    {
+        if (materialIDs.empty()) return;
+        FALCOR_ASSERT(mpMaterialDataBuffer);
+        FALCOR_ASSERT(std::is_sorted(materialIDs.begin(), materialIDs.end()));
+
+        // Gather the data of the given materials into contiguous ranges of material IDs, so that the upload is done with as few
+        // buffer writes as possible. Small gaps of unmodified materials are uploaded as well to merge neighboring ranges.
+        std::vector<MaterialDataBlob> blobs;
+        std::vector<std::pair<uint32_t, uint32_t>> ranges; // First material ID and material count of each range.
+        blobs.reserve(materialIDs.size());
+
+        for (const auto& materialID : materialIDs)
+        {
+            const uint32_t id = materialID.get();
+            FALCOR_ASSERT(id < mMaterials.size() && mMaterials[id]);
+
+            uint32_t first = id;
+            if (!ranges.empty() && id - (ranges.back().first + ranges.back().second) <= kMaxUploadGap)
+                first = ranges.back().first + ranges.back().second;
+            else
+                ranges.push_back({ id, 0 });
+
+            for (uint32_t i = first; i <= id; i++)
+                blobs.push_back(mMaterials[i]->getDataBlob());
+            ranges.back().second += id + 1 - first;
+        }
+
+        size_t blobOffset = 0;
+        for (const auto& [first, count] : ranges)
+        {
+            mpMaterialDataBuffer->setBlob(blobs.data() + blobOffset, first * sizeof(MaterialDataBlob), count * sizeof(MaterialDataBlob));
+            blobOffset += count;
+        }
+    }
+
+    void MaterialSystem::registerUpdateCallback(const ref<Material>& pMaterial, const MaterialID materialID)
+    {
+        pMaterial->registerUpdateCallback([this, materialID](auto flags) { markMaterialUpdates(materialID, flags); });
+    }
+
+    void MaterialSystem::markMaterialUpdates(const MaterialID materialID, Material::UpdateFlags updates)
+    {
+        if (updates == Material::UpdateFlags::None) return;
+
+        std::lock_guard<std::mutex> lock(mUpdateMutex);
+        mMaterialUpdates |= updates;
+
+        const size_t index = materialID.get();
+        if (index >= mMaterialDirty.size()) mMaterialDirty.resize(index + 1, false);
+        if (!mMaterialDirty[index])
+        {
+            mMaterialDirty[index] = true;
+            mDirtyMaterialIDs.push_back(materialID);
+        }
+    }
+
+    Material::UpdateFlags MaterialSystem::updateMaterials(const std::vector<MaterialID>& materialIDs)
+    {
+        // Materials with a thread-safe update() are updated in parallel, the remaining ones serially afterwards.
+        // The shared resource lists are synchronized, but their IDs are assigned in order of first use. The order can vary between runs,
+        // which changes the IDs stored in the material data but not the resources referenced.
+        std::vector<MaterialID> parallelIDs;
+        std::vector<MaterialID> serialIDs;
+        for (const auto& materialID : materialIDs)
+        {
+            const auto& pMaterial = getMaterial(materialID);
+            if (pMaterial->mpDevice != mpDevice)
+                FALCOR_THROW("Material '{}' was created with a different device than the MaterialSystem.", pMaterial->getName());
+            (pMaterial->isUpdateThreadSafe() ? parallelIDs : serialIDs).push_back(materialID);
+        }
+
+        // Exceptions must not escape the parallel algorithm. Rethrow the first one afterwards.
+        std::exception_ptr pException;
+        std::mutex exceptionMutex;
+        std::for_each(std::execution::par, parallelIDs.begin(), parallelIDs.end(), [&](const MaterialID materialID) {
+            try
+            {
+                mMaterialsUpdateFlags[materialID.get()] = mMaterials[materialID.get()]->update(this);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!pException) pException = std::current_exception();
+            }
+        });
+        if (pException) std::rethrow_exception(pException);
+
+        for (const auto& materialID : serialIDs)
+            mMaterialsUpdateFlags[materialID.get()] = mMaterials[materialID.get()]->update(this);
+
+        // Combine the update flags across materials.
+        Material::UpdateFlags updateFlags = Material::UpdateFlags::None;
+        for (const auto& materialID : materialIDs)
+            updateFlags |= mMaterialsUpdateFlags[materialID.get()];
+        return updateFlags;
+    }
 }
@@ -37,6 +37,7 @@
 #include "Utils/Image/TextureManager.h"
 #include "Utils/UI/Gui.h"
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <set>
 
@@ -70,6 +71,8 @@ namespace Falcor
             uint64_t textureTexelCount = 0;             ///< Total number of texels in all textures.
             uint64_t textureTexelChannelCount = 0;      ///< Total number of texel channels in all textures.
             uint64_t textureMemoryInBytes = 0;          ///< Total memory in bytes used by the textures.
+            uint64_t textureDeduplicatedCount = 0;      ///< Number of loaded textures that share a texture with identical content.
+            uint64_t textureDeduplicatedMemoryInBytes = 0; ///< Total memory in bytes saved by sharing textures with identical content.
         };
 
         /** Constructor. Throws an exception if creation failed.
@@ -252,6 +255,10 @@ namespace Falcor
         */
         TextureManager& getTextureManager() { return *mpTextureManager; }
 
+        /** Get the GPU buffer holding the data of all materials, indexed by material ID. Valid after update() was called.
+        */
+        const ref<Buffer>& getMaterialDataBuffer() const { return mpMaterialDataBuffer; }
+
 
         void loadLightProfile(const std::filesystem::path& absoluteFilename, bool normalize);
 
@@ -261,6 +268,10 @@ namespace Falcor
         void updateUI();
         void createParameterBlock();
         void uploadMaterial(const uint32_t materialID);
+        void uploadMaterials(const std::vector<MaterialID>& materialIDs);
+        void registerUpdateCallback(const ref<Material>& pMaterial, const MaterialID materialID);
+        void markMaterialUpdates(const MaterialID materialID, Material::UpdateFlags updates);
+        Material::UpdateFlags updateMaterials(const std::vector<MaterialID>& materialIDs);
 
         ref<Device> mpDevice;
 
@@ -291,6 +302,10 @@ namespace Falcor
         bool mMaterialsChanged = false;                             ///< Flag indicating if materials were added/removed since last update. Per-material updates are tracked by each material's update flags.
 
         Material::UpdateFlags mMaterialUpdates = Material::UpdateFlags::None; ///< Material updates across all materials since last update.
+        std::vector<MaterialID> mDirtyMaterialIDs;                  ///< Material IDs of all materials that recorded updates since last update.
+        std::vector<bool> mMaterialDirty;                           ///< Per-material flag indicating if the material is in mDirtyMaterialIDs.
+        std::mutex mUpdateMutex;                                    ///< Mutex for update tracking, as materials can record updates from concurrent update() calls.
+        std::mutex mResourceMutex;                                  ///< Mutex for the sampler/buffer/3D texture lists, which are shared by concurrent material update() calls.
 
         // GPU resources
         ref<Fence> mpFence;
@@ -50,13 +50,23 @@ namespace Falcor
             return;
         }
 
-        bool srgb = mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
+        loadTexture(pMaterial, slot, path, true, mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb);
+    }
+
+    void MaterialTextureLoader::loadTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb)
+    {
+        FALCOR_ASSERT(pMaterial);
+        if (!pMaterial->hasTextureSlot(slot))
+        {
+            logWarning("MaterialTextureLoader::loadTexture() - Material '{}' does not have texture slot '{}'. Ignoring call.", pMaterial->getName(), to_string(slot));
+            return;
+        }
 
         // Request texture to be loaded.
         auto handle = mTextureManager.loadTexture(
             path,
-            true /*mips*/,
-            srgb,
+            generateMipLevels,
+            loadAsSrgb,
             ResourceBindFlags::ShaderResource,
             true /*async*/,
             Bitmap::ImportFlags::None,
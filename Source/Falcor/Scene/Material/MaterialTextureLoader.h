@@ -55,6 +55,15 @@ namespace Falcor
         */
         void loadTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path);
 
+        /** Request loading a material texture with explicit load options.
+            \param[in] pMaterial Material to load texture into.
+            \param[in] slot Slot to load texture into.
+            \param[in] path Texture file path.
+            \param[in] generateMipLevels Whether the full mip-chain should be generated.
+            \param[in] loadAsSrgb Load the texture as sRGB if supported. Takes precedence over the loader's sRGB setting.
+        */
+        void loadTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb);
+
         void finishLoading()
         {
             assignTextures();
@@ -135,6 +135,14 @@ namespace Falcor
         return true;
     }
 
+    uint64_t RGLMaterial::getHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        hash.insert(std::filesystem::hash_value(mPath));
+        return hash.get();
+    }
+
     ProgramDesc::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
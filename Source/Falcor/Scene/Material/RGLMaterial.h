@@ -50,6 +50,8 @@ namespace Falcor
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        uint64_t getHash() const override;
+        bool isUpdateThreadSafe() const override { return true; }
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
@@ -28,6 +28,7 @@
 #include "Scene.h"
 #include "SceneDefines.slangh"
 #include "SceneBuilder.h"
+#include "InstanceDescBuilder.h"
 #include "Importer.h"
 #include "Scene/Material/SerializedMaterialParams.h"
 #include "Curves/CurveConfig.h"
@@ -48,6 +49,7 @@
 #include "Utils/UI/InputTypes.h"
 #include "Utils/Scripting/ScriptWriter.h"
 #include "Utils/NumericRange.h"
+#include "Utils/DirtyRangeTracker.h"
 
 #include <fstream>
 #include <numeric>
@@ -67,6 +69,9 @@ namespace Falcor
         // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
         const size_t kMaxBLASBuildMemory = 1ull << 29;
 
+        // Geometry instances with changed flags that are at most this many instances apart are uploaded with a single copy.
+        const size_t kInstanceUploadMergeDistance = 8;
+
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
         const std::string kMeshBufferName = "meshes";
@@ -226,6 +231,31 @@ namespace Falcor
         // Setup volume grid -> id map.
         for (size_t i = 0; i < mGrids.size(); ++i) mGridIDs.emplace(mGrids[i], (uint32_t)i);
 
+        // Setup grid slots of streamed grid sequences. Each streamed sequence occupies a single grid ID,
+        // which is rebound to the grid of the current frame during playback.
+        for (const auto& pGridVolume : mGridVolumes)
+        {
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridVolume::GridSlot::Count; ++slotIndex)
+            {
+                auto slot = (GridVolume::GridSlot)slotIndex;
+                if (!pGridVolume->getGridSequenceStreamer(slot)) continue;
+                const auto& pGrid = pGridVolume->getGrid(slot);
+                if (!pGrid)
+                {
+                    logWarning("GridVolume '{}' has a streamed grid sequence without a valid grid in the current frame. Streaming is disabled.", pGridVolume->getName());
+                    continue;
+                }
+                // The grid may not be part of the scene grids if the streamer was recreated (e.g. when loading from the scene cache).
+                auto it = mGridIDs.find(pGrid);
+                if (it == mGridIDs.end())
+                {
+                    it = mGridIDs.emplace(pGrid, (uint32_t)mGrids.size()).first;
+                    mGrids.push_back(pGrid);
+                }
+                mStreamedGrids.push_back({pGridVolume.get(), slot, it->second});
+            }
+        }
+
         // Set default SDF grid config.
         setSDFGridConfig();
 
@@ -248,10 +278,10 @@ namespace Falcor
         for (const auto &mesh : sceneData.cachedMeshes)
         {
             if (!mMeshDesc[mesh.meshID.get()].isAnimated()) FALCOR_THROW("Cached Mesh Animation: Referenced mesh ID is not dynamic");
-            if (mesh.timeSamples.size() != mesh.vertexData.size()) FALCOR_THROW("Cached Mesh Animation: Time sample count mismatch.");
-            for (const auto &vertices : mesh.vertexData)
+            if (mesh.timeSamples.size() != mesh.getKeyframeCount()) FALCOR_THROW("Cached Mesh Animation: Time sample count mismatch.");
+            for (size_t i = 0; i < mesh.getKeyframeCount(); i++)
             {
-                if (vertices.size() != mMeshDesc[mesh.meshID.get()].vertexCount) FALCOR_THROW("Cached Mesh Animation: Vertex count mismatch.");
+                if (mesh.getVertexCount(i) != mMeshDesc[mesh.meshID.get()].vertexCount) FALCOR_THROW("Cached Mesh Animation: Vertex count mismatch.");
             }
         }
         for (const auto& cache : sceneData.cachedCurves)
@@ -263,7 +293,7 @@ namespace Falcor
         }
 
         // Must be placed after curve data/AABB creation.
-        mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes));
+        mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.vertexCacheStreamingOptions);
 
         // Finalize scene.
         finalize();
@@ -906,13 +936,17 @@ namespace Falcor
     {
         if (mGeometryInstanceData.empty()) return;
 
-        bool dataChanged = false;
+        DirtyRangeTracker dirtyInstances(kInstanceUploadMergeDistance);
         const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-        for (auto& inst : mGeometryInstanceData)
+        for (size_t i = 0; i < mGeometryInstanceData.size(); i++)
         {
+            auto& inst = mGeometryInstanceData[i];
             if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
             {
+                // The flags only depend on the transform, so instances with unchanged transforms are skipped.
+                if (!forceUpdate && !mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID })) continue;
+
                 uint32_t prevFlags = inst.flags;
 
                 FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
@@ -930,14 +964,20 @@ namespace Falcor
                 if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
                 else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
 
-                dataChanged |= (inst.flags != prevFlags);
+                if (inst.flags != prevFlags) dirtyInstances.markDirty(i);
             }
         }
 
-        if (forceUpdate || dataChanged)
+        if (forceUpdate)
         {
             uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
             mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+            mSceneStats.instanceUploadBytes += byteSize;
+        }
+        else
+        {
+            // Upload the changed instances only.
+            mSceneStats.instanceUploadBytes += dirtyInstances.upload(mpDevice->getRenderContext(), mpGeometryInstancesBuffer.get(), mGeometryInstanceData.data(), sizeof(GeometryInstanceData));
         }
     }
 
@@ -1671,6 +1711,19 @@ namespace Falcor
         // Early out if no volumes have changed.
         if (!forceUpdate && combinedUpdates == GridVolume::UpdateFlags::None) return IScene::UpdateFlags::None;
 
+        // Swap in the current grids of streamed grid sequences.
+        for (const auto& streamedGrid : mStreamedGrids)
+        {
+            if (!forceUpdate && !is_set(streamedGrid.pGridVolume->getUpdates(), GridVolume::UpdateFlags::GridsChanged)) continue;
+            const auto& pGrid = streamedGrid.pGridVolume->getGrid(streamedGrid.slot);
+            auto& pBoundGrid = mGrids[streamedGrid.gridID.get()];
+            if (!pGrid || pGrid == pBoundGrid) continue;
+            mGridIDs.erase(pBoundGrid);
+            pBoundGrid = pGrid;
+            mGridIDs[pGrid] = streamedGrid.gridID;
+            if (!forceUpdate) pGrid->bindShaderData(mpSceneBlock->getRootVar()["grids"][streamedGrid.gridID.get()]);
+        }
+
         // Upload grids.
         if (forceUpdate)
         {
@@ -1864,7 +1917,11 @@ namespace Falcor
             bindParameterBlock();
         }
 
-        if (mpAnimationController->animate(pRenderContext, currentTime))
+        mSceneStats.instanceUploadBytes = 0;
+        bool animated = mpAnimationController->animate(pRenderContext, currentTime);
+        mSceneStats.transformUploadBytes = mpAnimationController->getUploadedBytes();
+
+        if (animated)
         {
             mUpdates |= IScene::UpdateFlags::SceneGraphChanged;
             if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= IScene::UpdateFlags::MeshesChanged;
@@ -1874,9 +1931,15 @@ namespace Falcor
                 if (mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID }))
                 {
                     mUpdates |= IScene::UpdateFlags::GeometryMoved;
+                    break;
                 }
             }
 
+            // Accumulate the changed matrices until the next TLAS build.
+            const auto& matricesChanged = mpAnimationController->getMatrixChangeFlags();
+            mTlasChangedMatrices.resize(matricesChanged.size(), 0);
+            for (size_t i = 0; i < matricesChanged.size(); i++) mTlasChangedMatrices[i] |= matricesChanged[i];
+
             // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
             if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= IScene::UpdateFlags::CurvesMoved;
             if (mpAnimationController->hasAnimatedMeshCaches()) mUpdates |= IScene::UpdateFlags::MeshesChanged;
@@ -2167,6 +2230,8 @@ namespace Falcor
                 << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
                 << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
                 << "  Animation data memory: " << formatByteSize(s.animationMemoryInBytes) << std::endl
+                << "  Instance data uploaded (last frame): " << formatByteSize(s.instanceUploadBytes) << std::endl
+                << "  Transform data uploaded (last frame): " << formatByteSize(s.transformUploadBytes) << std::endl
                 << "  Curve count: " << s.curveCount << std::endl
                 << "  Curve instance count: " << s.curveInstanceCount << std::endl
                 << "  Unique curve segment count: " << s.uniqueCurveSegmentCount << std::endl
@@ -2210,6 +2275,8 @@ namespace Falcor
                 << "  Texture count (compressed): " << s.materials.textureCompressedCount << std::endl
                 << "  Texture texel count: " << s.materials.textureTexelCount << std::endl
                 << "  Texture memory: " << formatByteSize(s.materials.textureMemoryInBytes) << std::endl
+                << "  Texture count (deduplicated): " << s.materials.textureDeduplicatedCount << std::endl
+                << "  Texture memory saved by deduplication: " << formatByteSize(s.materials.textureDeduplicatedMemoryInBytes) << std::endl
                 << "  Bytes/texel (average): " << std::fixed << std::setprecision(2) << bytesPerTexel << std::endl
                 << "  Channels/texel (average): " << std::fixed << std::setprecision(2) << channelsPerTexel << std::endl
                 << std::endl;
@@ -3502,25 +3569,25 @@ namespace Falcor
         }
     }
 
-    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const
+    void Scene::fillInstanceDesc(uint32_t rayTypeCount, bool perMeshHitEntry)
     {
-        instanceDescs.clear();
+        // Describe the instances as groups of instances sharing a BLAS. This is cheap as the number of groups is small.
+        // The per-instance descriptors are only regenerated in full if the layout changed, otherwise only instances with changed transforms are updated.
+        std::vector<InstanceDescBuilder::Group> groups;
         uint32_t instanceContributionToHitGroupIndex = 0;
         uint32_t instanceID = 0;
 
         for (size_t i = 0; i < mMeshGroups.size(); i++)
         {
             const auto& meshList = mMeshGroups[i].meshList;
-            const bool isStatic = mMeshGroups[i].isStatic;
 
             FALCOR_ASSERT(mBlasData[i].blasGroupIndex < mBlasGroups.size());
             const auto& pBlas = mBlasGroups[mBlasData[i].blasGroupIndex].pBlas;
             FALCOR_ASSERT(pBlas);
 
-            RtInstanceDesc desc = {};
-            desc.accelerationStructure = pBlas->getGpuAddress() + mBlasData[i].blasByteOffset;
-            desc.instanceMask = 0xFF;
-            desc.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
+            InstanceDescBuilder::Group group;
+            group.blasAddress = pBlas->getGpuAddress() + mBlasData[i].blasByteOffset;
+            group.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
 
             instanceContributionToHitGroupIndex += rayTypeCount * (uint32_t)meshList.size();
 
@@ -3537,7 +3604,7 @@ namespace Falcor
             // from the ray origin, in object space in a left-handed coordinate system.
             // Note that Falcor uses a right-handed coordinate system, so we have to invert the flag.
             // Since these winding direction rules are defined in object space, they are unaffected by instance transforms.
-            if (frontFaceCW) desc.flags = desc.flags | RtGeometryInstanceFlags::TriangleFrontCounterClockwise;
+            if (frontFaceCW) group.flags = RtGeometryInstanceFlags::TriangleFrontCounterClockwise;
 
             // From the scene builder we can expect the following:
             //
@@ -3549,49 +3616,14 @@ namespace Falcor
             // - The meshes are guaranteed to be non-instanced or be identically instanced, one INSTANCE_DESC per TLAS instance is needed.
             // - The global matrices are the same for all meshes in an instance.
             //
-            FALCOR_ASSERT(!meshList.empty());
-            size_t instanceCount = mMeshIdToInstanceIds[meshList[0].get()].size();
+            group.instanceCount = (uint32_t)mMeshIdToInstanceIds[meshList[0].get()].size();
+            FALCOR_ASSERT(group.instanceCount > 0);
 
-            FALCOR_ASSERT(instanceCount > 0);
-            for (size_t instanceIdx = 0; instanceIdx < instanceCount; instanceIdx++)
-            {
-                // Validate that the ordering is matching our expectations:
-                // InstanceID() + GeometryIndex() should look up the correct mesh instance.
-                for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
-                {
-                    const auto& instances = mMeshIdToInstanceIds[meshList[geometryIndex].get()];
-                    FALCOR_ASSERT(instances.size() == instanceCount);
-                    FALCOR_ASSERT(instances[instanceIdx] == instanceID + geometryIndex);
-                }
-
-                desc.instanceID = instanceID;
-                instanceID += (uint32_t)meshList.size();
-
-                float4x4 transform4x4 = float4x4::identity();
-                if (!isStatic)
-                {
-                    // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
-                    // Just pick the matrix from the first mesh.
-                    const uint32_t matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
-                    transform4x4 = mpAnimationController->getGlobalMatrices()[matrixId];
-
-                    // Verify that all meshes have matching tranforms.
-                    for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
-                    {
-                        FALCOR_ASSERT(matrixId == mGeometryInstanceData[desc.instanceID + geometryIndex].globalMatrixID);
-                    }
-                }
-                std::memcpy(desc.transform, &transform4x4, sizeof(desc.transform));
+            group.firstInstanceID = instanceID;
+            group.instanceIDStride = (uint32_t)meshList.size();
+            instanceID += group.instanceCount * group.instanceIDStride;
 
-                // Verify that instance data has the correct instanceIndex and geometryIndex.
-                for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
-                {
-                    FALCOR_ASSERT((uint32_t)instanceDescs.size() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
-                    FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].geometryIndex);
-                }
-
-                instanceDescs.push_back(desc);
-            }
+            groups.push_back(group);
         }
 
         uint32_t totalBlasCount = (uint32_t)mMeshGroups.size() + (mCurveDesc.empty() ? 0 : 1) + getSDFGridGeometryCount() + (mCustomPrimitiveDesc.empty() ? 0 : 1);
@@ -3606,38 +3638,24 @@ namespace Falcor
             const auto& pBlas = mBlasGroups[blasData.blasGroupIndex].pBlas;
             FALCOR_ASSERT(pBlas);
 
-            RtInstanceDesc desc = {};
-            desc.accelerationStructure = pBlas->getGpuAddress() + blasData.blasByteOffset;
-            desc.instanceMask = 0xFF;
-            desc.instanceID = instanceID;
+            InstanceDescBuilder::Group group;
+            group.blasAddress = pBlas->getGpuAddress() + blasData.blasByteOffset;
+            group.firstInstanceID = instanceID;
+            group.instanceCount = 1;
             instanceID += (uint32_t)mCurveDesc.size();
 
             // Start procedural primitive hit group after the triangle hit groups.
-            desc.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
+            group.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
 
             instanceContributionToHitGroupIndex += rayTypeCount * (uint32_t)mCurveDesc.size();
 
-            // For cached curves, the matrices for all curves in an instance are guaranteed to be the same.
-            // Just pick the matrix from the first curve.
-            auto it = std::find_if(mGeometryInstanceData.begin(), mGeometryInstanceData.end(), [](const auto& inst) { return inst.getType() == GeometryType::Curve; });
-            FALCOR_ASSERT(it != mGeometryInstanceData.end());
-            const uint32_t matrixId = it->globalMatrixID;
-            desc.setTransform(mpAnimationController->getGlobalMatrices()[matrixId]);
-
-            // Verify that instance data has the correct instanceIndex and geometryIndex.
-            for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)mCurveDesc.size(); geometryIndex++)
-            {
-                FALCOR_ASSERT((uint32_t)instanceDescs.size() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
-                FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].geometryIndex);
-            }
-
-            instanceDescs.push_back(desc);
+            groups.push_back(group);
         }
 
         // One instance per SDF grid instance.
+        bool sdfGridInstancesHaveUniqueBLASes = true;
         if (!mSDFGrids.empty())
         {
-            bool sdfGridInstancesHaveUniqueBLASes = true;
             switch (mSDFGridConfig.implementation)
             {
             case SDFGrid::Type::NormalizedDenseGrid:
@@ -3659,22 +3677,16 @@ namespace Falcor
                 const BlasData& blasData = mBlasData[blasDataIndex + (sdfGridInstancesHaveUniqueBLASes ? instance.geometryID : 0)];
                 const auto& pBlas = mBlasGroups[blasData.blasGroupIndex].pBlas;
 
-                RtInstanceDesc desc = {};
-                desc.accelerationStructure = pBlas->getGpuAddress() + blasData.blasByteOffset;
-                desc.instanceMask = 0xFF;
-                desc.instanceID = instanceID;
+                InstanceDescBuilder::Group group;
+                group.blasAddress = pBlas->getGpuAddress() + blasData.blasByteOffset;
+                group.firstInstanceID = instanceID;
+                group.instanceCount = 1;
                 instanceID++;
 
                 // Start SDF grid hit group after the curve hit groups.
-                desc.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
-
-                desc.setTransform(mpAnimationController->getGlobalMatrices()[instance.globalMatrixID]);
-
-                // Verify that instance data has the correct instanceIndex and geometryIndex.
-                FALCOR_ASSERT((uint32_t)instanceDescs.size() == instance.instanceIndex);
-                FALCOR_ASSERT(0 == instance.geometryIndex);
+                group.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
 
-                instanceDescs.push_back(desc);
+                groups.push_back(group);
             }
 
             blasDataIndex += (sdfGridInstancesHaveUniqueBLASes ? mSDFGrids.size() : 1);
@@ -3688,21 +3700,107 @@ namespace Falcor
             const auto& pBlas = mBlasGroups[mBlasData.back().blasGroupIndex].pBlas;
             FALCOR_ASSERT(pBlas);
 
-            RtInstanceDesc desc = {};
-            desc.accelerationStructure = pBlas->getGpuAddress() + mBlasData.back().blasByteOffset;
-            desc.instanceMask = 0xFF;
-            desc.instanceID = instanceID;
+            InstanceDescBuilder::Group group;
+            group.blasAddress = pBlas->getGpuAddress() + mBlasData.back().blasByteOffset;
+            group.firstInstanceID = instanceID;
+            group.instanceCount = 1;
             instanceID += (uint32_t)mCustomPrimitiveDesc.size();
 
             // Start procedural primitive hit group after the curve hit group.
-            desc.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
+            group.instanceContributionToHitGroupIndex = perMeshHitEntry ? instanceContributionToHitGroupIndex : 0;
 
             instanceContributionToHitGroupIndex += rayTypeCount * (uint32_t)mCustomPrimitiveDesc.size();
 
-            float4x4 identityMat = float4x4::identity();
-            std::memcpy(desc.transform, &identityMat, sizeof(desc.transform));
-            instanceDescs.push_back(desc);
+            groups.push_back(group);
         }
+
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        if (mInstanceDescBuilder.isLayoutChanged(groups))
+        {
+            // Gather the matrix ID of each instance.
+            std::vector<uint32_t> matrixIDs;
+            matrixIDs.reserve(mGeometryInstanceData.size());
+
+            for (size_t i = 0; i < mMeshGroups.size(); i++)
+            {
+                const auto& meshList = mMeshGroups[i].meshList;
+                const auto& group = groups[i];
+
+                for (uint32_t instanceIdx = 0; instanceIdx < group.instanceCount; instanceIdx++)
+                {
+                    const uint32_t firstInstanceID = group.firstInstanceID + instanceIdx * group.instanceIDStride;
+
+                    // Validate that the ordering is matching our expectations:
+                    // InstanceID() + GeometryIndex() should look up the correct mesh instance.
+                    // Also verify that instance data has the correct instanceIndex and geometryIndex.
+                    for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
+                    {
+                        const auto& instances = mMeshIdToInstanceIds[meshList[geometryIndex].get()];
+                        FALCOR_ASSERT(instances.size() == group.instanceCount);
+                        FALCOR_ASSERT(instances[instanceIdx] == firstInstanceID + geometryIndex);
+                        FALCOR_ASSERT((uint32_t)matrixIDs.size() == mGeometryInstanceData[firstInstanceID + geometryIndex].instanceIndex);
+                        FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[firstInstanceID + geometryIndex].geometryIndex);
+                    }
+
+                    if (mMeshGroups[i].isStatic)
+                    {
+                        matrixIDs.push_back(InstanceDescBuilder::kIdentityMatrix);
+                    }
+                    else
+                    {
+                        // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
+                        // Just pick the matrix from the first mesh.
+                        const uint32_t matrixId = mGeometryInstanceData[firstInstanceID].globalMatrixID;
+
+                        // Verify that all meshes have matching tranforms.
+                        for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
+                        {
+                            FALCOR_ASSERT(matrixId == mGeometryInstanceData[firstInstanceID + geometryIndex].globalMatrixID);
+                        }
+                        matrixIDs.push_back(matrixId);
+                    }
+                }
+            }
+
+            if (!mCurveDesc.empty())
+            {
+                // For cached curves, the matrices for all curves in an instance are guaranteed to be the same.
+                // Just pick the matrix from the first curve.
+                auto it = std::find_if(mGeometryInstanceData.begin(), mGeometryInstanceData.end(), [](const auto& inst) { return inst.getType() == GeometryType::Curve; });
+                FALCOR_ASSERT(it != mGeometryInstanceData.end());
+
+                // Verify that instance data has the correct instanceIndex and geometryIndex.
+                const uint32_t firstInstanceID = groups[mMeshGroups.size()].firstInstanceID;
+                for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)mCurveDesc.size(); geometryIndex++)
+                {
+                    FALCOR_ASSERT((uint32_t)matrixIDs.size() == mGeometryInstanceData[firstInstanceID + geometryIndex].instanceIndex);
+                    FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[firstInstanceID + geometryIndex].geometryIndex);
+                }
+                matrixIDs.push_back(it->globalMatrixID);
+            }
+
+            for (const GeometryInstanceData& instance : mGeometryInstanceData)
+            {
+                if (instance.getType() != GeometryType::SDFGrid) continue;
+
+                // Verify that instance data has the correct instanceIndex and geometryIndex.
+                FALCOR_ASSERT((uint32_t)matrixIDs.size() == instance.instanceIndex);
+                FALCOR_ASSERT(0 == instance.geometryIndex);
+                matrixIDs.push_back(instance.globalMatrixID);
+            }
+
+            if (!mCustomPrimitiveDesc.empty())
+            {
+                matrixIDs.push_back(InstanceDescBuilder::kIdentityMatrix);
+            }
+
+            mInstanceDescBuilder.setLayout(std::move(groups), std::move(matrixIDs));
+        }
+
+        // Write the descriptors. After a layout change all descriptors are written, otherwise only those with matrices changed since the last build.
+        mInstanceDescBuilder.build(globalMatrices.data(), &mTlasChangedMatrices);
+        std::fill(mTlasChangedMatrices.begin(), mTlasChangedMatrices.end(), 0);
     }
 
     void Scene::invalidateTlasCache()
@@ -3724,11 +3822,12 @@ namespace Falcor
 
         // Prepare instance descs.
         // Note if there are no instances, we'll build an empty TLAS.
-        fillInstanceDesc(mInstanceDescs, rayTypeCount, perMeshHitEntry);
+        fillInstanceDesc(rayTypeCount, perMeshHitEntry);
+        const auto& instanceDescs = mInstanceDescBuilder.getInstanceDescs();
 
         RtAccelerationStructureBuildInputs inputs = {};
         inputs.kind = RtAccelerationStructureKind::TopLevel;
-        inputs.descCount = (uint32_t)mInstanceDescs.size();
+        inputs.descCount = (uint32_t)instanceDescs.size();
         inputs.flags = RtAccelerationStructureBuildFlags::None;
 
         // Add build flags for dynamic scenes if TLAS should be updating instead of rebuilt
@@ -3790,7 +3889,7 @@ namespace Falcor
         if (inputs.descCount > 0)
         {
             GpuMemoryHeap::Allocation allocation = mpDevice->getUploadHeap()->allocate(inputs.descCount * sizeof(RtInstanceDesc), sizeof(RtInstanceDesc));
-            std::memcpy(allocation.pData, mInstanceDescs.data(), inputs.descCount * sizeof(RtInstanceDesc));
+            std::memcpy(allocation.pData, instanceDescs.data(), inputs.descCount * sizeof(RtInstanceDesc));
             asDesc.inputs.instanceDescs = allocation.getGpuAddress();
             mpDevice->getUploadHeap()->release(allocation);
         }
@@ -4124,6 +4223,8 @@ namespace Falcor
         d["vertexMemoryInBytes"] = stats.vertexMemoryInBytes;
         d["geometryMemoryInBytes"] = stats.geometryMemoryInBytes;
         d["animationMemoryInBytes"] = stats.animationMemoryInBytes;
+        d["instanceUploadBytes"] = stats.instanceUploadBytes;
+        d["transformUploadBytes"] = stats.transformUploadBytes;
 
         // Curve stats
         d["curveCount"] = stats.curveCount;
@@ -4153,6 +4254,8 @@ namespace Falcor
         d["textureTexelCount"] = stats.materials.textureTexelCount;
         d["textureTexelChannelCount"] = stats.materials.textureTexelChannelCount;
         d["textureMemoryInBytes"] = stats.materials.textureMemoryInBytes;
+        d["textureDeduplicatedCount"] = stats.materials.textureDeduplicatedCount;
+        d["textureDeduplicatedMemoryInBytes"] = stats.materials.textureDeduplicatedMemoryInBytes;
 
         // Raytracing stats
         d["blasGroupCount"] = stats.blasGroupCount;
@@ -28,6 +28,7 @@
 #pragma once
 #include "SceneIDs.h"
 #include "SceneTypes.slang"
+#include "InstanceDescBuilder.h"
 #include "HitInfo.h"
 #include "IScene.h"
 #include "Animation/Animation.h"
@@ -266,6 +267,7 @@ namespace Falcor
             std::vector<std::vector<uint32_t>> meshIdToInstanceIds; ///< Mapping of what instances belong to which mesh.
             std::vector<MeshGroup> meshGroups;                      ///< List of mesh groups. Each group maps to a BLAS for ray tracing.
             std::vector<CachedMesh> cachedMeshes;                   ///< Cached data for vertex-animated meshes.
+            std::optional<VertexCacheStreamer::Options> vertexCacheStreamingOptions; ///< Options for streaming vertex cache keyframes during playback. If not set, all keyframes are kept resident on the GPU.
             uint32_t prevVertexCount = 0;                           ///< Number of vertices that the AnimationController needs to allocate to store previous frame vertices.
 
             bool useCompressedHitInfo = false;                      ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
@@ -317,6 +319,8 @@ namespace Falcor
             uint64_t vertexMemoryInBytes = 0;           ///< Total memory in bytes used by the vertex buffer.
             uint64_t geometryMemoryInBytes = 0;         ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives, instances etc.).
             uint64_t animationMemoryInBytes = 0;        ///< Total memory in bytes used by the animation system (transforms, skinning buffers).
+            uint64_t instanceUploadBytes = 0;           ///< Bytes of geometry instance data uploaded to the GPU in the last update.
+            uint64_t transformUploadBytes = 0;          ///< Bytes of transform matrices uploaded to the GPU in the last update.
 
             // Curve stats
             uint64_t curveCount = 0;                    ///< Number of curves.
@@ -1172,7 +1176,7 @@ namespace Falcor
         /** Generate data for creating a TLAS.
             #SCENE TODO: Add argument to build descs based off a draw list.
         */
-        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+        void fillInstanceDesc(uint32_t rayTypeCount, bool perMeshHitEntry);
 
         /** Generate top level acceleration structure for the scene. Automatically determines whether to build or refit.
             \param[in] rayCount Number of ray types in the shader. Required to setup how instances index into the Shader Table.
@@ -1307,6 +1311,13 @@ namespace Falcor
         std::vector<ref<GridVolume>> mGridVolumes;                  ///< All loaded grid volumes.
         std::vector<ref<Grid>> mGrids;                              ///< All loaded grids.
         std::unordered_map<ref<Grid>, SdfGridID> mGridIDs;          ///< Lookup table for grid IDs.
+        struct StreamedGrid
+        {
+            GridVolume* pGridVolume;
+            GridVolume::GridSlot slot;
+            SdfGridID gridID;
+        };
+        std::vector<StreamedGrid> mStreamedGrids;                   ///< Grid slots whose grid is replaced during playback of streamed grid sequences.
         ref<LightCollection> mpLightCollection;                     ///< Class for managing emissive geometry. This is created lazily upon first use.
         ref<EnvMap> mpEnvMap;                                       ///< Environment map or nullptr if not loaded.
         bool mEnvMapChanged = false;                                ///< Flag indicating that the environment map has changed since last frame.
@@ -1369,7 +1380,8 @@ namespace Falcor
         UpdateMode mTlasUpdateMode = UpdateMode::Rebuild;   ///< How the TLAS should be updated when there are changes in the scene.
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
 
-        std::vector<RtInstanceDesc> mInstanceDescs;         ///< Shared between TLAS builds to avoid reallocating CPU memory.
+        InstanceDescBuilder mInstanceDescBuilder;           ///< TLAS instance descriptors. Shared between TLAS builds, and only rewritten where changed.
+        std::vector<uint64_t> mTlasChangedMatrices;         ///< Flag per global matrix, set if the matrix changed since the last TLAS build.
 
         struct TlasData
         {
@@ -29,6 +29,7 @@
 #include "SceneCache.h"
 #include "Importer.h"
 #include "Curves/CurveConfig.h"
+#include "Volume/GridCache.h"
 #include "Material/StandardMaterial.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
@@ -36,6 +37,7 @@
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/Math/Float16.h"
 #include "Utils/ObjectIDPython.h"
 #include "Utils/NumericRange.h"
 #include <mikktspace.h>
@@ -193,7 +195,8 @@ namespace Falcor
 
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            // Vertex cache streaming only affects how the cached keyframes are loaded, not the cache content.
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::StreamVertexCaches));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -201,6 +204,18 @@ namespace Falcor
             return sha1.finalize();
 
         }
+
+        std::optional<VertexCacheStreamer::Options> getVertexCacheStreamingOptions(const Settings& settings, SceneBuilder::Flags buildFlags)
+        {
+            if (!is_set(buildFlags, SceneBuilder::Flags::StreamVertexCaches)) return {};
+
+            // Streaming options can be overridden with the 'VertexCacheStreaming' settings, e.g. {"VertexCacheStreaming": {"residentKeyframeCount": 16}}.
+            VertexCacheStreamer::Options options;
+            options.residentKeyframeCount = settings.getOption("VertexCacheStreaming:residentKeyframeCount", options.residentKeyframeCount);
+            options.prefetchFrameCount = settings.getOption("VertexCacheStreaming:prefetchFrameCount", options.prefetchFrameCount);
+            options.threadCount = settings.getOption("VertexCacheStreaming:threadCount", options.threadCount);
+            return options;
+        }
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const Settings& settings, Flags flags)
@@ -210,6 +225,10 @@ namespace Falcor
     {
         mAssetResolver = AssetResolver::getDefaultResolver();
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+        mSceneData.pMaterials->getTextureManager().setContentDeduplication(is_set(mFlags, Flags::DeduplicateTextures));
+        mSceneData.pMaterials->getTextureManager().setTextureCache(is_set(mFlags, Flags::UseTextureCache));
+        // Grids are loaded through static functions and streamed after the scene is built, so the grid cache is enabled globally.
+        if (is_set(mFlags, Flags::UseGridCache)) GridCache::setEnabled(true);
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -234,7 +253,9 @@ namespace Falcor
         {
             try
             {
-                mpScene = Scene::create(pDevice, SceneCache::readCache(pDevice, mSceneCacheKey));
+                auto sceneData = SceneCache::readCache(pDevice, mSceneCacheKey);
+                sceneData.vertexCacheStreamingOptions = getVertexCacheStreamingOptions(mSettings, mFlags);
+                mpScene = Scene::create(pDevice, std::move(sceneData));
                 return;
             }
             catch (const std::exception& e)
@@ -390,6 +411,7 @@ namespace Falcor
         for (auto& sdfInstanceData : mSceneData.sdfGridInstances) sdfInstanceData.instanceIndex = tlasInstanceIndex++;
 
         mSceneData.useCompressedHitInfo = is_set(mFlags, Flags::UseCompressedHitInfo);
+        mSceneData.vertexCacheStreamingOptions = getVertexCacheStreamingOptions(mSettings, mFlags);
 
         // Write scene cache if requested.
         if (mWriteSceneCache)
@@ -948,6 +970,17 @@ namespace Falcor
         mpMaterialTextureLoader->loadTexture(pMaterial, slot, resolvedPath);
     }
 
+    void SceneBuilder::loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb)
+    {
+        FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
+        if (!mpMaterialTextureLoader)
+        {
+            mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
+        }
+        std::filesystem::path resolvedPath = mAssetResolver.resolvePath(path);
+        mpMaterialTextureLoader->loadTexture(pMaterial, slot, resolvedPath, generateMipLevels, loadAsSrgb);
+    }
+
     void SceneBuilder::waitForMaterialTextureLoading()
     {
         mpMaterialTextureLoader.reset();
@@ -2603,13 +2636,24 @@ namespace Falcor
                 float2 maxTexCrd = float2(-std::numeric_limits<float>::infinity());
                 float2 maxError = float2(0);
 
+                // Round trip the texture coordinates through fp16 in bulk.
+                std::vector<float2> texCrds(mesh.staticVertexCount);
+                std::vector<uint16_t> texCrds16(mesh.staticVertexCount * 2);
+                for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
+                    texCrds[i] = mSceneData.meshStaticData[mesh.staticVertexOffset + i].texCrd;
+                fstd::span<float> texCrdsFloat(reinterpret_cast<float*>(texCrds.data()), texCrds16.size());
+                math::float32ToFloat16(texCrdsFloat, texCrds16);
+
+                std::vector<float2> quantizedTexCrds(mesh.staticVertexCount);
+                math::float16ToFloat32(texCrds16, fstd::span<float>(reinterpret_cast<float*>(quantizedTexCrds.data()), texCrds16.size()));
+
                 for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
                 {
                     auto& v = mSceneData.meshStaticData[mesh.staticVertexOffset + i];
-                    float2 texCrd = v.texCrd;
+                    float2 texCrd = texCrds[i];
                     minTexCrd = min(minTexCrd, texCrd);
                     maxTexCrd = max(maxTexCrd, texCrd);
-                    v.texCrd = f16tof32(f32tof16(texCrd));
+                    v.texCrd = quantizedTexCrds[i];
                     maxError = max(maxError, abs(v.texCrd - texCrd));
                 }
 
@@ -2962,6 +3006,10 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("StreamVertexCaches", SceneBuilder::Flags::StreamVertexCaches);
+        flags.value("DeduplicateTextures", SceneBuilder::Flags::DeduplicateTextures);
+        flags.value("UseTextureCache", SceneBuilder::Flags::UseTextureCache);
+        flags.value("UseGridCache", SceneBuilder::Flags::UseGridCache);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2984,7 +3032,7 @@ namespace Falcor
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
         sceneBuilder.def("getMaterial", &SceneBuilder::getMaterial, "name"_a);
-        sceneBuilder.def("loadMaterialTexture", &SceneBuilder::loadMaterialTexture, "material"_a, "slot"_a, "path"_a);
+        sceneBuilder.def("loadMaterialTexture", pybind11::overload_cast<const ref<Material>&, Material::TextureSlot, const std::filesystem::path&>(&SceneBuilder::loadMaterialTexture), "material"_a, "slot"_a, "path"_a);
         sceneBuilder.def("waitForMaterialTextureLoading", &SceneBuilder::waitForMaterialTextureLoading);
         sceneBuilder.def("addGridVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID);
         sceneBuilder.def("addVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID); // PYTHONDEPRECATED
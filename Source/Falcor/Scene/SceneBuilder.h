@@ -77,6 +77,10 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            StreamVertexCaches              = 0x20000,  ///< Stream vertex cache keyframes from disk during playback instead of keeping all keyframes in GPU memory.
+            DeduplicateTextures             = 0x40000,  ///< Share textures with identical content (file contents or decoded pixels) that are loaded from different files.
+            UseTextureCache                 = 0x80000,  ///< Cache textures as block compressed DDS files with mips on disk and load them from there (see TextureCache). Block compression is lossy.
+            UseGridCache                    = 0x100000, ///< Enable the grid cache (see GridCache), which stores volume grids converted to NanoVDB and their bricked representation on disk. The grid cache is a global setting and stays enabled.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -527,6 +531,15 @@ namespace Falcor
         */
         void loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path);
 
+        /** Request loading a material texture with explicit load options.
+            \param[in] pMaterial Material to load texture into.
+            \param[in] slot Slot to load texture into.
+            \param[in] path Texture file path.
+            \param[in] generateMipLevels Whether the full mip-chain should be generated.
+            \param[in] loadAsSrgb Load the texture as sRGB if supported. Takes precedence over the AssumeLinearSpaceTextures flag.
+        */
+        void loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb);
+
         /** Wait until all material textures are loaded.
         */
         void waitForMaterialTextureLoading();
@@ -31,10 +31,12 @@
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
 #include "Utils/Logger.h"
+#include "Utils/CacheFile.h"
 
 #include <lz4_stream/lz4_stream.h>
 
 #include <fstream>
+#include <random>
 
 namespace Falcor
 {
@@ -43,7 +45,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 28;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -236,24 +238,25 @@ namespace Falcor
 
         logInfo("Writing scene cache to '{}'.", cachePath);
 
-        // Create directories if not existing.
-        std::filesystem::create_directories(cachePath.parent_path());
+        // Keyframes are written to a new file on every write, as the previous keyframe file may still be memory mapped by a loaded scene.
+        std::filesystem::path keyframePath;
+        if (!sceneData.cachedMeshes.empty() || !sceneData.cachedCurves.empty()) keyframePath = createKeyframePath(key);
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) FALCOR_THROW("Failed to create scene cache file '{}'.", cachePath);
-
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
-
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
-        if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", cachePath);
+        writeFileAtomic(cachePath, [&](std::ostream& fs)
+        {
+            // Write header (uncompressed).
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            // Write cache (compressed).
+            lz4_stream::basic_ostream<kBlockSize> zs(fs);
+            OutputStream stream(zs);
+            writeSceneData(stream, sceneData, keyframePath);
+        });
+
+        removeKeyframeFiles(key, keyframePath);
     }
 
     Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
@@ -274,7 +277,7 @@ namespace Falcor
         // Read cache (compressed).
         lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
         InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
+        auto sceneData = readSceneData(stream, pDevice, cachePath.parent_path());
         if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
         return sceneData;
     }
@@ -284,10 +287,53 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
+    std::filesystem::path SceneCache::createKeyframePath(const Key& key)
+    {
+        auto path = getCachePath(key);
+        path += fmt::format(".{:08x}.keyframes", std::random_device()());
+        return path;
+    }
+
+    void SceneCache::removeKeyframeFiles(const Key& key, const std::filesystem::path& keepPath)
+    {
+        // Keyframe files are named '<key>.<id>.keyframes'. Files that are still memory mapped may fail to be removed, they are removed by a later write.
+        const std::string prefix = SHA1::toString(key) + ".";
+        const std::string suffix = ".keyframes";
+        auto cachePath = getCachePath(key);
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(cachePath.parent_path(), ec))
+        {
+            const auto filename = entry.path().filename().string();
+            if (filename.size() != prefix.size() + 8 + suffix.size() || filename.rfind(prefix, 0) != 0 || entry.path().extension() != suffix) continue;
+            if (filename == keepPath.filename().string()) continue;
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+
     // SceneData
 
-    void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
+    void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData, const std::filesystem::path& keyframePath)
     {
+        // Vertex cache keyframes are written to a separate file, the scene cache only stores its name and the chunk indices.
+        // The keyframe file is complete before the scene cache referencing it is moved in place.
+        std::vector<std::vector<uint32_t>> meshKeyframeChunks(sceneData.cachedMeshes.size());
+        std::vector<std::vector<uint32_t>> curveKeyframeChunks(sceneData.cachedCurves.size());
+        if (!keyframePath.empty())
+        {
+            writeFileAtomic(keyframePath, [&](const std::filesystem::path& tmpPath)
+            {
+                VertexCacheFile::Writer writer(tmpPath);
+                auto writeKeyframes = [&](const auto& cache, std::vector<uint32_t>& chunks)
+                {
+                    chunks.resize(cache.getKeyframeCount());
+                    for (size_t i = 0; i < chunks.size(); i++) chunks[i] = writer.addChunk(cache.loadKeyframe(i));
+                };
+                for (size_t i = 0; i < sceneData.cachedMeshes.size(); i++) writeKeyframes(sceneData.cachedMeshes[i], meshKeyframeChunks[i]);
+                for (size_t i = 0; i < sceneData.cachedCurves.size(); i++) writeKeyframes(sceneData.cachedCurves[i], curveKeyframeChunks[i]);
+                writer.close();
+            });
+        }
+
         writeMarker(stream, "Paths");
         stream.write((uint32_t)sceneData.importPaths.size());
         for (const auto& pPath: sceneData.importPaths) stream.write(pPath);
@@ -363,13 +409,14 @@ namespace Falcor
             stream.write(group.isStatic);
             stream.write(group.isDisplaced);
         }
+        stream.write(keyframePath.filename());
         stream.write((uint32_t)sceneData.cachedMeshes.size());
-        for (const auto& cachedMesh : sceneData.cachedMeshes)
+        for (size_t i = 0; i < sceneData.cachedMeshes.size(); i++)
         {
+            const auto& cachedMesh = sceneData.cachedMeshes[i];
             stream.write(cachedMesh.meshID);
             stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            stream.write(meshKeyframeChunks[i]);
         }
         stream.write(sceneData.useCompressedHitInfo);
         stream.write(sceneData.has16BitIndices);
@@ -387,14 +434,14 @@ namespace Falcor
         stream.write(sceneData.curveStaticData);
 
         stream.write((uint32_t)sceneData.cachedCurves.size());
-        for (const auto& cachedCurve : sceneData.cachedCurves)
+        for (size_t i = 0; i < sceneData.cachedCurves.size(); i++)
         {
+            const auto& cachedCurve = sceneData.cachedCurves[i];
             stream.write(cachedCurve.tessellationMode);
             stream.write(cachedCurve.geometryID);
             stream.write(cachedCurve.timeSamples);
             stream.write(cachedCurve.indexData);
-            stream.write((uint32_t)cachedCurve.vertexData.size());
-            for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            stream.write(curveKeyframeChunks[i]);
         }
 
         writeMarker(stream, "CustomPrimitives");
@@ -404,8 +451,26 @@ namespace Falcor
         writeMarker(stream, "End");
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice)
+    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice, const std::filesystem::path& cacheDirectory)
     {
+        std::filesystem::path keyframePath;
+        // Keyframes stay on disk and are read on demand by the vertex cache animation.
+        std::shared_ptr<VertexCacheFile> pKeyframeFile;
+        auto readKeyframes = [&](auto& cache)
+        {
+            stream.read(cache.keyframeChunks);
+            if (!pKeyframeFile)
+            {
+                pKeyframeFile = VertexCacheFile::open(keyframePath);
+                if (!pKeyframeFile) FALCOR_THROW("Failed to open scene cache keyframe file '{}'.", keyframePath);
+            }
+            for (uint32_t chunk : cache.keyframeChunks)
+            {
+                if (chunk >= pKeyframeFile->getChunkCount()) FALCOR_THROW("Invalid keyframe in scene cache keyframe file '{}'.", keyframePath);
+            }
+            cache.pKeyframeFile = pKeyframeFile;
+        };
+
         Scene::SceneData sceneData;
         sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
 
@@ -489,13 +554,13 @@ namespace Falcor
             stream.read(group.isStatic);
             stream.read(group.isDisplaced);
         }
+        keyframePath = cacheDirectory / stream.read<std::filesystem::path>();
         sceneData.cachedMeshes.resize(stream.read<uint32_t>());
         for (auto& cachedMesh : sceneData.cachedMeshes)
         {
             stream.read(cachedMesh.meshID);
             stream.read(cachedMesh.timeSamples);
-            cachedMesh.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedMesh.vertexData) stream.read(data);
+            readKeyframes(cachedMesh);
         }
         stream.read(sceneData.useCompressedHitInfo);
         stream.read(sceneData.has16BitIndices);
@@ -519,8 +584,7 @@ namespace Falcor
             stream.read(cachedCurve.geometryID);
             stream.read(cachedCurve.timeSamples);
             stream.read(cachedCurve.indexData);
-            cachedCurve.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedCurve.vertexData) stream.read(data);
+            readKeyframes(cachedCurve);
         }
 
         readMarker(stream, "CustomPrimitives");
@@ -853,6 +917,14 @@ namespace Falcor
                 stream.write(id);
             }
         }
+        for (const auto& pStreamer : pGridVolume->mStreamers)
+        {
+            stream.write(pStreamer != nullptr);
+            if (!pStreamer) continue;
+            stream.write(pStreamer->getPaths());
+            stream.write(pStreamer->getGridname());
+            stream.write(pStreamer->getOptions());
+        }
         stream.write(pGridVolume->mGridFrame);
         stream.write(pGridVolume->mGridFrameCount);
         stream.write(pGridVolume->mBounds);
@@ -877,6 +949,14 @@ namespace Falcor
                 pGrid = id == uint32_t(-1) ? nullptr : grids[id];
             }
         }
+        for (auto& pStreamer : pGridVolume->mStreamers)
+        {
+            if (!stream.read<bool>()) continue;
+            auto paths = stream.read<std::vector<std::filesystem::path>>();
+            auto gridname = stream.read<std::string>();
+            auto options = stream.read<GridSequenceStreamer::Options>();
+            pStreamer = GridSequenceStreamer::create(pDevice, std::move(paths), std::move(gridname), options);
+        }
         stream.read(pGridVolume->mGridFrame);
         stream.read(pGridVolume->mGridFrameCount);
         stream.read(pGridVolume->mBounds);
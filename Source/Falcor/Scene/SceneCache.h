@@ -28,6 +28,7 @@
 #pragma once
 #include "Scene.h"
 #include "Animation/Animation.h"
+#include "Animation/VertexCacheFile.h"
 #include "Camera/Camera.h"
 #include "Lights/EnvMap.h"
 #include "Lights/Light.h"
@@ -53,6 +54,9 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        Vertex cache keyframes are stored in a separate keyframe file next to the cache. They are not loaded with the
+        cache but read on demand, which allows streaming them during playback. Every cache write creates a new keyframe
+        file, so that keyframe files memory mapped by loaded scenes are never overwritten.
     */
     class FALCOR_API SceneCache
     {
@@ -83,9 +87,11 @@ namespace Falcor
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path createKeyframePath(const Key& key);
+        static void removeKeyframeFiles(const Key& key, const std::filesystem::path& keepPath);
 
-        static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
+        static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData, const std::filesystem::path& keyframePath);
+        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice, const std::filesystem::path& cacheDirectory);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
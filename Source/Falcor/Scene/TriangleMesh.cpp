@@ -43,9 +43,9 @@ namespace Falcor
         return ref<TriangleMesh>(new TriangleMesh());
     }
 
-    ref<TriangleMesh> TriangleMesh::create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
+    ref<TriangleMesh> TriangleMesh::create(VertexList vertices, IndexList indices, bool frontFaceCW)
     {
-        return ref<TriangleMesh>(new TriangleMesh(vertices, indices, frontFaceCW));
+        return ref<TriangleMesh>(new TriangleMesh(std::move(vertices), std::move(indices), frontFaceCW));
     }
 
     ref<TriangleMesh> TriangleMesh::createDummy()
@@ -190,7 +190,7 @@ namespace Falcor
             }
         }
 
-        return create(vertices, indices);
+        return create(std::move(vertices), std::move(indices));
     }
 
     ref<TriangleMesh> TriangleMesh::createFromFile(const std::filesystem::path& path, ImportFlags importFlags)
@@ -270,7 +270,7 @@ namespace Falcor
             }
         }
 
-        return create(vertices, indices);
+        return create(std::move(vertices), std::move(indices));
     }
 
     ref<TriangleMesh> TriangleMesh::createFromFile(const std::filesystem::path& path, bool smoothNormals)
@@ -316,9 +316,9 @@ namespace Falcor
     TriangleMesh::TriangleMesh()
     {}
 
-    TriangleMesh::TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
-        : mVertices(vertices)
-        , mIndices(indices)
+    TriangleMesh::TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW)
+        : mVertices(std::move(vertices))
+        , mIndices(std::move(indices))
         , mFrontFaceCW(frontFaceCW)
     {}
 
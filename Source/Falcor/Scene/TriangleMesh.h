@@ -71,12 +71,12 @@ namespace Falcor
         static ref<TriangleMesh> create();
 
         /** Creates a triangle mesh.
-            \param[in] vertices Vertex list.
-            \param[in] indices Index list.
+            \param[in] vertices Vertex list. Pass an rvalue to avoid copying the vertex data.
+            \param[in] indices Index list. Pass an rvalue to avoid copying the index data.
             \param[in] frontFaceCW Triangle winding.
             \return Returns the triangle mesh.
         */
-        static ref<TriangleMesh> create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW = false);
+        static ref<TriangleMesh> create(VertexList vertices, IndexList indices, bool frontFaceCW = false);
 
         /** Creates a dummy mesh (single degenerate triangle).
             \return Returns the triangle mesh.
@@ -188,7 +188,7 @@ namespace Falcor
 
     private:
         TriangleMesh();
-        TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW);
+        TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW);
 
         std::string mName;
         std::vector<Vertex> mVertices;
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Grid.h"
 #include "GridConverter.h"
+#include "GridCache.h"
 #include "Core/API/Device.h"
 #include "Core/Program/ShaderVar.h"
 #include "Utils/StringUtils.h"
@@ -89,7 +90,18 @@ namespace Falcor
         return ref<Grid>(new Grid(pDevice, std::move(handle)));
     }
 
+    struct Grid::HostData
+    {
+        nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle;
+        std::unique_ptr<NanoVDBConverterBC4> pConverter;
+    };
+
     ref<Grid> Grid::createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    {
+        return createFromHostData(pDevice, decodeFromFile(path, gridname));
+    }
+
+    std::shared_ptr<Grid::HostData> Grid::decodeFromFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!std::filesystem::exists(path))
         {
@@ -97,19 +109,45 @@ namespace Falcor
             return nullptr;
         }
 
-        if (hasExtension(path, "nvdb"))
+        const bool isNanoVDB = hasExtension(path, "nvdb");
+        if (!isNanoVDB && !hasExtension(path, "vdb"))
         {
-            return createFromNanoVDBFile(pDevice, path, gridname);
+            logWarning("Error when loading grid. Unsupported grid file '{}'.", path);
+            return nullptr;
         }
-        else if (hasExtension(path, "vdb"))
+
+        // NanoVDB files are read directly, only their bricked representation is looked up in the grid cache.
+        if (isNanoVDB) return decodeNanoVDBFile(path, gridname);
+
+        // Look up the converted grid in the grid cache. This skips both the OpenVDB to NanoVDB conversion and the brick building.
+        std::optional<GridCache::Key> cacheKey;
+        if (GridCache::isEnabled())
         {
-            return createFromOpenVDBFile(pDevice, path, gridname);
+            cacheKey = GridCache::computeKey(path, gridname, NanoVDBConverterBC4::getSettingsKey());
+            if (cacheKey)
+            {
+                if (auto pHostData = readHostDataFromCache(*cacheKey))
+                {
+                    logDebug("Loaded grid '{}' in '{}' from the grid cache.", gridname, path);
+                    return pHostData;
+                }
+            }
         }
-        else
+
+        auto pHostData = decodeOpenVDBFile(path, gridname);
+
+        if (pHostData && cacheKey)
         {
-            logWarning("Error when loading grid. Unsupported grid file '{}'.", path);
-            return nullptr;
+            GridCache::write(*cacheKey, &pHostData->gridHandle, [&](std::ostream& stream) { pHostData->pConverter->write(stream); });
         }
+
+        return pHostData;
+    }
+
+    ref<Grid> Grid::createFromHostData(ref<Device> pDevice, const std::shared_ptr<HostData>& pHostData)
+    {
+        if (!pHostData) return nullptr;
+        return ref<Grid>(new Grid(pDevice, *pHostData));
     }
 
     void Grid::renderUI(Gui::Widgets& widget)
@@ -164,10 +202,14 @@ namespace Falcor
     uint64_t Grid::getGridSizeInBytes() const
     {
         const uint64_t nvdb = mpBuffer ? mpBuffer->getSize() : (uint64_t)0;
-        const uint64_t bricks = (mBrickedGrid.range ? mBrickedGrid.range->getTextureSizeInBytes() : (uint64_t)0) +
+        return nvdb + getBrickedGridSizeInBytes();
+    }
+
+    uint64_t Grid::getBrickedGridSizeInBytes() const
+    {
+        return (mBrickedGrid.range ? mBrickedGrid.range->getTextureSizeInBytes() : (uint64_t)0) +
             (mBrickedGrid.indirection ? mBrickedGrid.indirection->getTextureSizeInBytes() : (uint64_t)0) +
             (mBrickedGrid.atlas ? mBrickedGrid.atlas->getTextureSizeInBytes() : (uint64_t)0);
-        return nvdb + bricks;
     }
 
     AABB Grid::getWorldBounds() const
@@ -203,16 +245,16 @@ namespace Falcor
     }
 
     Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+        : Grid(pDevice, *createHostData(std::move(gridHandle)))
+    {
+    }
+
+    Grid::Grid(ref<Device> pDevice, HostData& hostData)
         : mpDevice(pDevice)
-        , mGridHandle(std::move(gridHandle))
+        , mGridHandle(std::move(hostData.gridHandle))
         , mpFloatGrid(mGridHandle.grid<float>())
         , mAccessor(mpFloatGrid->getAccessor())
     {
-        if (!mpFloatGrid->hasMinMax())
-        {
-            nanovdb::gridStats(*mpFloatGrid);
-        }
-
         // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
         mpBuffer = mpDevice->createStructuredBuffer(
             sizeof(uint32_t),
@@ -221,11 +263,57 @@ namespace Falcor
             MemoryType::DeviceLocal,
             mGridHandle.data()
         );
-        using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
+        mBrickedGrid = hostData.pConverter->upload(mpDevice);
+        hostData.pConverter.reset();
     }
 
-    ref<Grid> Grid::createFromNanoVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    std::shared_ptr<Grid::HostData> Grid::createHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, bool useGridCache)
+    {
+        auto pHostData = std::make_shared<HostData>();
+        pHostData->gridHandle = std::move(gridHandle);
+
+        auto floatGrid = pHostData->gridHandle.grid<float>();
+        if (!floatGrid->hasMinMax())
+        {
+            nanovdb::gridStats(*floatGrid);
+        }
+
+        // Look up the bricked representation in the grid cache. The grid itself is not stored in the entry.
+        std::optional<GridCache::Key> cacheKey;
+        if (useGridCache && GridCache::isEnabled())
+        {
+            cacheKey = GridCache::computeKey(pHostData->gridHandle, NanoVDBConverterBC4::getSettingsKey());
+            pHostData->pConverter = std::make_unique<NanoVDBConverterBC4>(floatGrid);
+            if (GridCache::read(*cacheKey, nullptr, [&](std::istream& stream) { return pHostData->pConverter->read(stream); }))
+            {
+                return pHostData;
+            }
+        }
+
+        pHostData->pConverter = std::make_unique<NanoVDBConverterBC4>(floatGrid);
+        pHostData->pConverter->build();
+
+        if (cacheKey)
+        {
+            GridCache::write(*cacheKey, nullptr, [&](std::ostream& stream) { pHostData->pConverter->write(stream); });
+        }
+
+        return pHostData;
+    }
+
+    std::shared_ptr<Grid::HostData> Grid::readHostDataFromCache(const GridCache::Key& key)
+    {
+        auto pHostData = std::make_shared<HostData>();
+        auto readConverter = [&](std::istream& stream)
+        {
+            pHostData->pConverter = std::make_unique<NanoVDBConverterBC4>(pHostData->gridHandle.grid<float>());
+            return pHostData->pConverter->read(stream);
+        };
+        if (!GridCache::read(key, &pHostData->gridHandle, readConverter)) return nullptr;
+        return pHostData;
+    }
+
+    std::shared_ptr<Grid::HostData> Grid::decodeNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
@@ -253,10 +341,10 @@ namespace Falcor
             return nullptr;
         }
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return createHostData(std::move(handle), true);
     }
 
-    ref<Grid> Grid::createFromOpenVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    std::shared_ptr<Grid::HostData> Grid::decodeOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         openvdb::initialize();
 
@@ -296,7 +384,7 @@ namespace Falcor
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
         auto handle = nanovdb::openToNanoVDB(floatGrid);
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return createHostData(std::move(handle));
     }
 
 
@@ -31,6 +31,7 @@
 #include "Core/Macros.h"
 #include "Core/Object.h"
 #include "Core/API/Buffer.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Matrix.h"
 #include "Utils/UI/Gui.h"
@@ -89,6 +90,25 @@ namespace Falcor
         */
         static ref<Grid> createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname);
 
+        /** Grid data decoded on the CPU, ready to be uploaded to the GPU.
+        */
+        struct HostData;
+
+        /** Decode a grid from a file without accessing the GPU.
+            This is safe to call from multiple threads, for example to load a grid sequence in parallel.
+            \param[in] path File path of the grid (absolute or relative to working directory).
+            \param[in] gridname Name of the grid to load.
+            \return The decoded grid data, or nullptr if the grid failed to load.
+        */
+        static std::shared_ptr<HostData> decodeFromFile(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Create a grid from decoded data. This uploads the data to the GPU and must be called from the main thread.
+            \param[in] pDevice GPU device.
+            \param[in] pHostData Decoded grid data. The data is consumed by this call.
+            \return A new grid, or nullptr if pHostData is nullptr.
+        */
+        static ref<Grid> createFromHostData(ref<Device> pDevice, const std::shared_ptr<HostData>& pHostData);
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -119,9 +139,14 @@ namespace Falcor
         uint64_t getVoxelCount() const;
 
         /** Get the size of the grid in bytes as allocated in GPU memory.
+            This includes both the NanoVDB buffer and the brick textures.
         */
         uint64_t getGridSizeInBytes() const;
 
+        /** Get the size of the brick textures in bytes as allocated in GPU memory.
+        */
+        uint64_t getBrickedGridSizeInBytes() const;
+
         /** Get the grid's bounds in world space.
         */
         AABB getWorldBounds() const;
@@ -146,9 +171,12 @@ namespace Falcor
 
     private:
         Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        Grid(ref<Device> pDevice, HostData& hostData);
 
-        static ref<Grid> createFromNanoVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
-        static ref<Grid> createFromOpenVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
+        static std::shared_ptr<HostData> createHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, bool useGridCache = false);
+        static std::shared_ptr<HostData> readHostDataFromCache(const SHA1::MD& key);
+        static std::shared_ptr<HostData> decodeNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static std::shared_ptr<HostData> decodeOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
 
         ref<Device> mpDevice;
 
@@ -0,0 +1,279 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridCache.h"
+#include "Core/Error.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CacheFile.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <lz4_stream/lz4_stream.h>
+
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Specifies the current cache file version.
+            This needs to be incremented every time the file format changes!
+        */
+        const uint32_t kVersion = 2;
+
+        /** Default grid cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/GridCache";
+
+        const size_t kBlockSize = 1 * 1024 * 1024;
+        const uint64_t kMaxCompressionRatio = 256;
+
+        const char* kMagic = "FalcorG$";
+
+        struct CacheState
+        {
+            std::mutex mutex;
+            bool initialized = false;
+            bool enabled = false;
+            std::filesystem::path directory;
+            GridCache::Stats stats;
+        };
+
+        CacheState& getState()
+        {
+            static CacheState state;
+            return state;
+        }
+
+        void initDirectory(CacheState& state)
+        {
+            if (state.initialized) return;
+            // Setting the environment variable opts into the cache.
+            if (auto envPath = getEnvironmentVariable("FALCOR_GRID_CACHE_PATH"))
+            {
+                state.directory = *envPath;
+                state.enabled = true;
+            }
+            else
+            {
+                state.directory = getAppDataDirectory() / kDirectory;
+            }
+            state.initialized = true;
+        }
+
+        double elapsedSeconds(CpuTimer::TimePoint start)
+        {
+            return CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) * 1e-3;
+        }
+    }
+
+    void GridCache::setDirectory(const std::filesystem::path& directory)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        initDirectory(state);
+        state.directory = directory;
+    }
+
+    std::filesystem::path GridCache::getDirectory()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        initDirectory(state);
+        return state.directory;
+    }
+
+    void GridCache::setEnabled(bool enabled)
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        initDirectory(state);
+        state.enabled = enabled;
+    }
+
+    bool GridCache::isEnabled()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        initDirectory(state);
+        return state.enabled && !state.directory.empty();
+    }
+
+    std::optional<GridCache::Key> GridCache::computeKey(const std::filesystem::path& path, const std::string& gridname, const std::string& settings)
+    {
+        auto t0 = CpuTimer::getCurrentTimePoint();
+
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs.good()) return {};
+
+        SHA1 sha1;
+        sha1.update(kVersion);
+        sha1.update(std::string_view(gridname));
+        sha1.update(std::string_view(settings));
+
+        std::vector<char> buffer(1024 * 1024);
+        while (fs)
+        {
+            fs.read(buffer.data(), buffer.size());
+            sha1.update(buffer.data(), (size_t)fs.gcount());
+        }
+        if (fs.bad()) return {};
+
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats.hashTime += elapsedSeconds(t0);
+        return sha1.finalize();
+    }
+
+    GridCache::Key GridCache::computeKey(const nanovdb::GridHandle<nanovdb::HostBuffer>& gridHandle, const std::string& settings)
+    {
+        auto t0 = CpuTimer::getCurrentTimePoint();
+
+        SHA1 sha1;
+        sha1.update(kVersion);
+        sha1.update(std::string_view(settings));
+        sha1.update(gridHandle.data(), gridHandle.size());
+
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats.hashTime += elapsedSeconds(t0);
+        return sha1.finalize();
+    }
+
+    bool GridCache::read(const Key& key, nanovdb::GridHandle<nanovdb::HostBuffer>* pGridHandle, const ReadFunc& readFunc)
+    {
+        auto t0 = CpuTimer::getCurrentTimePoint();
+
+        auto readEntry = [&]()
+        {
+            if (!isEnabled()) return false;
+            auto directory = getDirectory();
+
+            auto path = getEntryPath(directory, key);
+            std::ifstream fs(path, std::ios_base::binary);
+            if (!fs.good()) return false;
+
+            std::error_code ec;
+            uint64_t fileSize = std::filesystem::file_size(path, ec);
+            if (ec) return false;
+
+            // Read header (uncompressed).
+            CacheFileHeader header;
+            fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (fs.eof() || !header.isValid(kMagic, kVersion)) return false;
+
+            // Read grid (if stored) and converter data (compressed). A grid size of zero means the entry has no grid.
+            lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
+            uint64_t size = 0;
+            zs.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (!zs.good() || (size != 0) != (pGridHandle != nullptr)) return false;
+            // Reject corrupt sizes before allocating, the data can't be compressed by more than the LZ4 maximum ratio.
+            if (size / kMaxCompressionRatio > fileSize) return false;
+
+            if (pGridHandle)
+            {
+                auto buffer = nanovdb::HostBuffer::create(size);
+                zs.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+                if (!zs.good()) return false;
+
+                *pGridHandle = nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer));
+                if (!pGridHandle->grid<float>()) return false;
+            }
+
+            return readFunc(zs) && !zs.bad() && !fs.bad();
+        };
+
+        bool hit = readEntry();
+        if (!hit && pGridHandle) pGridHandle->reset();
+
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (hit)
+        {
+            state.stats.hitCount++;
+            state.stats.readTime += elapsedSeconds(t0);
+        }
+        else
+        {
+            state.stats.missCount++;
+        }
+        return hit;
+    }
+
+    void GridCache::write(const Key& key, const nanovdb::GridHandle<nanovdb::HostBuffer>* pGridHandle, const WriteFunc& writeFunc)
+    {
+        if (!isEnabled()) return;
+        auto directory = getDirectory();
+
+        try
+        {
+            writeFileAtomic(getEntryPath(directory, key), [&](std::ostream& fs)
+            {
+                // Write header (uncompressed).
+                CacheFileHeader header(kMagic, kVersion);
+                fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+                // Write grid and converter data (compressed).
+                lz4_stream::basic_ostream<kBlockSize> zs(fs);
+                uint64_t size = pGridHandle ? pGridHandle->size() : 0;
+                zs.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                if (pGridHandle) zs.write(reinterpret_cast<const char*>(pGridHandle->data()), size);
+                writeFunc(zs);
+            });
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write grid cache entry {}: {}", SHA1::toString(key), e.what());
+            return;
+        }
+
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats.writeCount++;
+    }
+
+    GridCache::Stats GridCache::getStats()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.stats;
+    }
+
+    void GridCache::resetStats()
+    {
+        auto& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats = {};
+    }
+
+    std::filesystem::path GridCache::getEntryPath(const std::filesystem::path& directory, const Key& key)
+    {
+        return directory / SHA1::toString(key);
+    }
+}
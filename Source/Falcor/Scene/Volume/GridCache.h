@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4244 4267)
+#endif
+#include <nanovdb/util/GridHandle.h>
+#include <nanovdb/util/HostBuffer.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+namespace Falcor
+{
+    /** Persistent on-disk cache of converted volume grids.
+
+        Loading a grid from an OpenVDB file requires converting it to NanoVDB and building the bricked (BC4 compressed)
+        representation used for rendering. Both steps are expensive, so their results are stored in a cache directory
+        and reused when the same grid is loaded again.
+
+        Entries are keyed on the content hash of the source file, the name of the grid and the converter settings,
+        so modified files or converter changes never return stale results. Grids loaded from NanoVDB files don't need
+        a conversion, so their entries only store the bricked representation and are keyed on the grid data.
+        The cache is safe to use from multiple threads and processes, entries are written atomically.
+
+        The cache is opt-in. It is enabled by setting the FALCOR_GRID_CACHE_PATH environment variable, by loading a
+        scene with SceneBuilder::Flags::UseGridCache or by calling setEnabled(). The cache directory defaults to a
+        subdirectory of the application data directory and can be overridden with FALCOR_GRID_CACHE_PATH or
+        setDirectory(). An empty directory disables the cache.
+    */
+    class FALCOR_API GridCache
+    {
+    public:
+        using Key = SHA1::MD;
+
+        struct Stats
+        {
+            uint64_t hitCount = 0;      ///< Number of lookups that returned a valid entry.
+            uint64_t missCount = 0;     ///< Number of lookups without a valid entry.
+            uint64_t writeCount = 0;    ///< Number of entries written.
+            double hashTime = 0.0;      ///< Time spent hashing source files in seconds.
+            double readTime = 0.0;      ///< Time spent reading cache entries in seconds.
+        };
+
+        /** Callback writing the converter data of an entry.
+        */
+        using WriteFunc = std::function<void(std::ostream&)>;
+
+        /** Callback reading the converter data of an entry. Returns false if the data is invalid.
+        */
+        using ReadFunc = std::function<bool(std::istream&)>;
+
+        /** Set the cache directory.
+            \param[in] directory Cache directory. An empty path disables the cache.
+        */
+        static void setDirectory(const std::filesystem::path& directory);
+
+        /** Get the cache directory. Returns an empty path if the cache is disabled.
+        */
+        static std::filesystem::path getDirectory();
+
+        /** Enable or disable the cache. The cache is disabled by default unless FALCOR_GRID_CACHE_PATH is set.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled and has a cache directory.
+        */
+        static bool isEnabled();
+
+        /** Compute the cache key for a grid loaded from a file that needs to be converted to NanoVDB.
+            \param[in] path File path of the source grid.
+            \param[in] gridname Name of the grid.
+            \param[in] settings String identifying the converter settings.
+            \return The cache key, or an empty optional if the source file can't be read.
+        */
+        static std::optional<Key> computeKey(const std::filesystem::path& path, const std::string& gridname, const std::string& settings);
+
+        /** Compute the cache key for a NanoVDB grid that is already in memory.
+            \param[in] gridHandle NanoVDB grid.
+            \param[in] settings String identifying the converter settings.
+            \return The cache key.
+        */
+        static Key computeKey(const nanovdb::GridHandle<nanovdb::HostBuffer>& gridHandle, const std::string& settings);
+
+        /** Read a cache entry.
+            \param[in] key Cache key.
+            \param[out] pGridHandle If not nullptr, receives the NanoVDB grid stored in the entry. Entries written without a grid
+                         are only valid if this is nullptr, and vice versa.
+            \param[in] readFunc Callback reading the converter data. Called after the grid has been read.
+            \return True if a valid entry was found.
+        */
+        static bool read(const Key& key, nanovdb::GridHandle<nanovdb::HostBuffer>* pGridHandle, const ReadFunc& readFunc);
+
+        /** Write a cache entry. Failures are logged but not considered an error.
+            \param[in] key Cache key.
+            \param[in] pGridHandle NanoVDB grid to store, or nullptr to only store the converter data.
+            \param[in] writeFunc Callback writing the converter data.
+        */
+        static void write(const Key& key, const nanovdb::GridHandle<nanovdb::HostBuffer>* pGridHandle, const WriteFunc& writeFunc);
+
+        /** Get the cache statistics.
+        */
+        static Stats getStats();
+
+        /** Reset the cache statistics.
+        */
+        static void resetStats();
+
+    private:
+        static std::filesystem::path getEntryPath(const std::filesystem::path& directory, const Key& key);
+    };
+}
@@ -33,6 +33,7 @@
 #include "Utils/Logger.h"
 #include "Utils/HostDeviceShared.slangh"
 #include "Utils/NumericRange.h"
+#include "Utils/Math/Float16.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Timing/CpuTimer.h"
 
@@ -48,6 +49,8 @@
 #include <algorithm>
 #include <atomic>
 #include <execution>
+#include <istream>
+#include <ostream>
 #include <vector>
 
 namespace Falcor
@@ -66,6 +69,28 @@ namespace Falcor
 
         BrickedGrid convert(ref<Device> pDevice);
 
+        /** Build the bricked grid on the CPU. This does not access the device and can run on any thread.
+        */
+        void build();
+
+        /** Create the GPU textures from the data computed in build().
+        */
+        BrickedGrid upload(ref<Device> pDevice);
+
+        /** Write the data computed in build() to a stream.
+        */
+        void write(std::ostream& stream) const;
+
+        /** Read data previously written with write(). This replaces the call to build().
+            \return False if the data does not match the grid the converter was created for.
+        */
+        bool read(std::istream& stream);
+
+        /** Get a string identifying the converter settings. Used to key cached conversion results.
+            This needs to change every time the conversion results change!
+        */
+        static std::string getSettingsKey() { return fmt::format("bits={},brick={},mips=4,version=1", kBitsPerTexel, kBrickSize); }
+
     private:
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
@@ -91,12 +116,6 @@ namespace Falcor
             return float2(std::max(a.x, b.x), std::min(a.y, b.y));
         }
 
-        inline float2 unpackMajMin(const uint32_t* data)
-        {
-            const uint16_t* data16 = (const uint16_t*)data;
-            return float2(f16tof32(data16[0]), f16tof32(data16[1]));
-        }
-
         inline void expandMinorantMajorant(float value, float& min_inout, float& maj_inout)
         {
             if (value < min_inout) min_inout = value;
@@ -251,8 +270,19 @@ namespace Falcor
     template <typename TexelType, unsigned int kBitsPerTexel>
     void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
+        // Each range entry packs the majorant and minorant as two halfs. Unpack the source mip and pack the target mip in bulk.
+        size_t srcOffset = (mip > 1) ? mLeafCount[mip - 2] : 0;
+        size_t srcCount = mLeafCount[mip - 1] - srcOffset;
+        size_t dstCount = mLeafCount[mip] - mLeafCount[mip - 1];
+        std::vector<float2> majMinSrc(srcCount);
+        std::vector<float2> majMinDst(dstCount);
+        math::float16ToFloat32(
+            fstd::span<const uint16_t>(reinterpret_cast<const uint16_t*>(mRangeData.data() + srcOffset), srcCount * 2),
+            fstd::span<float>(reinterpret_cast<float*>(majMinSrc.data()), srcCount * 2)
+        );
+
+        float2* rangedst = majMinDst.data();
+        const float2* rangesrc = majMinSrc.data();
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
@@ -269,35 +299,92 @@ namespace Falcor
                 {
                     float2 majmin_dst = combineMajMin(
                         combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
+                            combineMajMin(rangesrc[0], rangesrc[1]),
+                            combineMajMin(rangesrc[rowstride_src], rangesrc[1 + rowstride_src])
                         ),
                         combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
+                            combineMajMin(rangesrc[slicestride_src], rangesrc[slicestride_src + 1]),
+                            combineMajMin(rangesrc[slicestride_src + rowstride_src], rangesrc[slicestride_src + 1 + rowstride_src])
                         )
                     );
-                    *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
+                    *rangedst++ = majmin_dst;
                 } // x
             } // y
         } // z
+
+        math::float32ToFloat16(
+            fstd::span<const float>(reinterpret_cast<const float*>(majMinDst.data()), dstCount * 2),
+            fstd::span<uint16_t>(reinterpret_cast<uint16_t*>(mRangeData.data() + mLeafCount[mip - 1]), dstCount * 2)
+        );
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(ref<Device> pDevice)
+    {
+        build();
+        return upload(pDevice);
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::build()
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
         auto range = NumericRange<int>(0, mLeafDim[0].z);
         std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
         for (int mip = 1; mip < 4; ++mip) computeMip(mip);
 
+        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::upload(ref<Device> pDevice)
+    {
         BrickedGrid bricks;
         bricks.range = pDevice->createTexture3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource);
         bricks.indirection = pDevice->createTexture3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource);
         bricks.atlas = pDevice->createTexture3D(getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource);
-
-        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
         return bricks;
     }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::write(std::ostream& stream) const
+    {
+        auto writeVector = [&stream](const auto& v)
+        {
+            uint64_t size = v.size();
+            stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            stream.write(reinterpret_cast<const char*>(v.data()), size * sizeof(v[0]));
+        };
+
+        uint32_t nonEmptyCount = mNonEmptyCount.load();
+        stream.write(reinterpret_cast<const char*>(&mAtlasSizeBricks), sizeof(mAtlasSizeBricks));
+        stream.write(reinterpret_cast<const char*>(&nonEmptyCount), sizeof(nonEmptyCount));
+        writeVector(mRangeData);
+        writeVector(mPtrData);
+        writeVector(mAtlasData);
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    bool NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::read(std::istream& stream)
+    {
+        // The layout is fully determined by the grid, so the sizes computed in the constructor must match.
+        auto readVector = [&stream](auto& v)
+        {
+            uint64_t size = 0;
+            stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (!stream.good() || size != v.size()) return false;
+            stream.read(reinterpret_cast<char*>(v.data()), size * sizeof(v[0]));
+            return stream.good();
+        };
+
+        uint3 atlasSizeBricks;
+        uint32_t nonEmptyCount = 0;
+        stream.read(reinterpret_cast<char*>(&atlasSizeBricks), sizeof(atlasSizeBricks));
+        stream.read(reinterpret_cast<char*>(&nonEmptyCount), sizeof(nonEmptyCount));
+        if (!stream.good() || any(atlasSizeBricks != mAtlasSizeBricks)) return false;
+        if (!readVector(mRangeData) || !readVector(mPtrData) || !readVector(mAtlasData)) return false;
+        mNonEmptyCount.store(nonEmptyCount);
+        return true;
+    }
 }
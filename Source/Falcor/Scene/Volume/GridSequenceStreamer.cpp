@@ -0,0 +1,192 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridSequenceStreamer.h"
+#include "Core/API/Device.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace Falcor
+{
+    GridSequenceStreamer::GridSequenceStreamer(ref<Device> pDevice, std::vector<std::filesystem::path> paths, std::string gridname, const Options& options)
+        : mpDevice(pDevice)
+        , mPaths(std::move(paths))
+        , mGridname(std::move(gridname))
+        , mOptions(options)
+        , mFrames(mPaths.size())
+    {
+        // The current frame and the prefetch window need to fit into the cache.
+        mOptions.cacheSize = std::max(mOptions.cacheSize, mOptions.prefetchCount + 1);
+        uint32_t threadCount = mOptions.threadCount > 0 ? mOptions.threadCount : std::max(mOptions.prefetchCount, 1u);
+        mpThreadPool = std::make_unique<BS::thread_pool>(threadCount);
+    }
+
+    GridSequenceStreamer::~GridSequenceStreamer()
+    {
+        mpThreadPool->wait_for_tasks();
+    }
+
+    const ref<Grid>& GridSequenceStreamer::getGrid(uint32_t frame)
+    {
+        static const ref<Grid> kNullGrid;
+        if (frame >= mFrames.size()) return kNullGrid;
+
+        mStats.requestCount++;
+        mCurrentFrame = frame;
+
+        auto& f = mFrames[frame];
+        if (!f.pGrid && !f.failed)
+        {
+            requestLoad(frame);
+            if (f.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                CpuTimer timer;
+                timer.update();
+                f.pending.wait();
+                timer.update();
+                mStats.stallCount++;
+                mStats.stallTime += timer.delta();
+            }
+            finishLoad(frame);
+        }
+
+        f.lastUsed = ++mUseCounter;
+        return f.pGrid;
+    }
+
+    void GridSequenceStreamer::prefetch(uint32_t frame)
+    {
+        if (mFrames.empty()) return;
+        mCurrentFrame = std::min(frame, (uint32_t)mFrames.size() - 1);
+
+        // Upload grids that finished decoding in the meantime.
+        for (uint32_t i = 0; i < (uint32_t)mFrames.size(); ++i)
+        {
+            auto& f = mFrames[i];
+            if (f.pending.valid() && f.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) finishLoad(i);
+        }
+
+        // Start loading the frames following the current frame. Playback wraps around at the end of the sequence.
+        uint32_t count = std::min(mOptions.prefetchCount, (uint32_t)mFrames.size() - 1);
+        for (uint32_t i = 1; i <= count; ++i)
+        {
+            requestLoad((mCurrentFrame + i) % (uint32_t)mFrames.size());
+        }
+    }
+
+    bool GridSequenceStreamer::isResident(uint32_t frame) const
+    {
+        return frame < mFrames.size() && mFrames[frame].pGrid != nullptr;
+    }
+
+    void GridSequenceStreamer::resetStats()
+    {
+        Stats stats;
+        stats.residentCount = mStats.residentCount;
+        stats.residentBytes = mStats.residentBytes;
+        stats.residentBrickBytes = mStats.residentBrickBytes;
+        stats.peakResidentBytes = mStats.residentBytes;
+        mStats = stats;
+    }
+
+    void GridSequenceStreamer::renderUI(Gui::Widgets& widget)
+    {
+        std::ostringstream oss;
+        oss << "Resident grids: " << mStats.residentCount << " / " << mOptions.cacheSize << std::endl
+            << "Prefetch frames: " << mOptions.prefetchCount << std::endl
+            << "Memory: " << formatByteSize(mStats.residentBytes) << " (bricks " << formatByteSize(mStats.residentBrickBytes) << ", peak " << formatByteSize(mStats.peakResidentBytes) << ")" << std::endl
+            << "Loads: " << mStats.loadCount << ", evictions: " << mStats.evictCount << std::endl
+            << "Stalls: " << mStats.stallCount << " of " << mStats.requestCount << " requests (" << mStats.stallTime * 1000.0 << " ms)" << std::endl;
+        widget.text(oss.str());
+        if (widget.button("Reset stats")) resetStats();
+    }
+
+    void GridSequenceStreamer::requestLoad(uint32_t frame)
+    {
+        auto& f = mFrames[frame];
+        if (f.pGrid || f.failed || f.pending.valid()) return;
+
+        // Decoding doesn't access the device, so it can run on the worker threads.
+        f.pending = mpThreadPool->submit([path = mPaths[frame], gridname = mGridname]() { return Grid::decodeFromFile(path, gridname); });
+    }
+
+    void GridSequenceStreamer::finishLoad(uint32_t frame)
+    {
+        auto& f = mFrames[frame];
+        FALCOR_ASSERT(f.pending.valid());
+
+        f.pGrid = Grid::createFromHostData(mpDevice, f.pending.get());
+        if (!f.pGrid)
+        {
+            f.failed = true;
+            return;
+        }
+
+        f.lastUsed = ++mUseCounter;
+        mStats.loadCount++;
+        mStats.residentCount++;
+        mStats.residentBytes += f.pGrid->getGridSizeInBytes();
+        mStats.residentBrickBytes += f.pGrid->getBrickedGridSizeInBytes();
+        mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+
+        evict();
+    }
+
+    bool GridSequenceStreamer::isInPrefetchWindow(uint32_t frame) const
+    {
+        uint32_t frameCount = (uint32_t)mFrames.size();
+        uint32_t distance = (frame + frameCount - mCurrentFrame) % frameCount;
+        return distance <= mOptions.prefetchCount;
+    }
+
+    void GridSequenceStreamer::evict()
+    {
+        while (mStats.residentCount > mOptions.cacheSize)
+        {
+            // Find the least recently used grid outside the prefetch window.
+            uint32_t victim = uint32_t(-1);
+            for (uint32_t i = 0; i < (uint32_t)mFrames.size(); ++i)
+            {
+                const auto& f = mFrames[i];
+                if (!f.pGrid || isInPrefetchWindow(i)) continue;
+                if (victim == uint32_t(-1) || f.lastUsed < mFrames[victim].lastUsed) victim = i;
+            }
+            if (victim == uint32_t(-1)) break;
+
+            auto& f = mFrames[victim];
+            mStats.residentBytes -= f.pGrid->getGridSizeInBytes();
+            mStats.residentBrickBytes -= f.pGrid->getBrickedGridSizeInBytes();
+            mStats.residentCount--;
+            mStats.evictCount++;
+            f.pGrid = nullptr;
+        }
+    }
+}
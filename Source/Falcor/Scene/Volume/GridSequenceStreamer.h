@@ -0,0 +1,158 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/UI/Gui.h"
+#include <BS_thread_pool/BS_thread_pool.hpp>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Streams a sequence of grids from disk for playback.
+        Only a bounded number of grids is kept resident in memory. When a frame is selected, the following frames
+        are decoded asynchronously on a pool of worker threads and uploaded to the GPU once decoding has finished.
+        Grids that fall out of the prefetch window are evicted in least-recently-used order.
+        Note: All functions must be called from the main thread, decoding is the only work done on worker threads.
+    */
+    class FALCOR_API GridSequenceStreamer : public Object
+    {
+        FALCOR_OBJECT(GridSequenceStreamer)
+    public:
+        struct Options
+        {
+            uint32_t cacheSize = 8;     ///< Maximum number of grids resident in memory. Clamped to at least prefetchCount + 1.
+            uint32_t prefetchCount = 4; ///< Number of frames following the current frame to load ahead of time.
+            uint32_t threadCount = 0;   ///< Number of decoding threads. If zero, prefetchCount threads are used.
+        };
+
+        struct Stats
+        {
+            uint64_t requestCount = 0;       ///< Number of frame requests.
+            uint64_t stallCount = 0;         ///< Number of frame requests that had to wait for the grid to load.
+            double stallTime = 0.0;          ///< Total time spent waiting for grids to load in seconds.
+            uint64_t loadCount = 0;          ///< Number of grids loaded.
+            uint64_t evictCount = 0;         ///< Number of grids evicted from the cache.
+            uint32_t residentCount = 0;      ///< Number of grids currently resident.
+            uint64_t residentBytes = 0;      ///< GPU memory used by the resident grids, including the brick textures.
+            uint64_t residentBrickBytes = 0; ///< GPU memory used by the brick textures of the resident grids.
+            uint64_t peakResidentBytes = 0;  ///< Peak GPU memory used by the resident grids, including the brick textures.
+        };
+
+        /** Create a grid sequence streamer.
+            \param[in] pDevice GPU device.
+            \param[in] paths File paths of the grids, one per frame.
+            \param[in] gridname Name of the grid to load from each file.
+            \param[in] options Streaming options.
+            \return A new object.
+        */
+        static ref<GridSequenceStreamer> create(ref<Device> pDevice, std::vector<std::filesystem::path> paths, std::string gridname, const Options& options = {})
+        {
+            return make_ref<GridSequenceStreamer>(pDevice, std::move(paths), std::move(gridname), options);
+        }
+
+        GridSequenceStreamer(ref<Device> pDevice, std::vector<std::filesystem::path> paths, std::string gridname, const Options& options);
+        ~GridSequenceStreamer();
+
+        /** Get the number of frames in the sequence.
+        */
+        uint32_t getFrameCount() const { return (uint32_t)mPaths.size(); }
+
+        /** Get the file paths of the grids.
+        */
+        const std::vector<std::filesystem::path>& getPaths() const { return mPaths; }
+
+        /** Get the name of the grid loaded from each file.
+        */
+        const std::string& getGridname() const { return mGridname; }
+
+        /** Get the streaming options.
+        */
+        const Options& getOptions() const { return mOptions; }
+
+        /** Get the grid of a frame.
+            If the grid is not resident yet, this blocks until it is loaded, which is recorded as a stall.
+            \param[in] frame Frame index.
+            \return The grid, or nullptr if the grid failed to load.
+        */
+        const ref<Grid>& getGrid(uint32_t frame);
+
+        /** Start loading the frames following the given frame and upload grids that finished decoding.
+            This call never blocks.
+            \param[in] frame Current frame index.
+        */
+        void prefetch(uint32_t frame);
+
+        /** Check if the grid of a frame is resident.
+        */
+        bool isResident(uint32_t frame) const;
+
+        /** Get the streaming statistics.
+        */
+        const Stats& getStats() const { return mStats; }
+
+        /** Reset the streaming statistics. The resident counts are kept.
+        */
+        void resetStats();
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        struct Frame
+        {
+            ref<Grid> pGrid;
+            std::future<std::shared_ptr<Grid::HostData>> pending;
+            uint64_t lastUsed = 0;
+            bool failed = false;
+        };
+
+        void requestLoad(uint32_t frame);
+        void finishLoad(uint32_t frame);
+        bool isInPrefetchWindow(uint32_t frame) const;
+        void evict();
+
+        ref<Device> mpDevice;
+        std::vector<std::filesystem::path> mPaths;
+        std::string mGridname;
+        Options mOptions;
+
+        std::vector<Frame> mFrames;
+        uint32_t mCurrentFrame = 0;
+        uint64_t mUseCounter = 0;
+        Stats mStats;
+
+        std::unique_ptr<BS::thread_pool> mpThreadPool;
+    };
+}
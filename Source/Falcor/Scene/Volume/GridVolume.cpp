@@ -27,10 +27,13 @@
  **************************************************************************/
 #include "GridVolume.h"
 #include "Grid.h"
+#include "GridCache.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "GlobalState.h"
+#include <BS_thread_pool/BS_thread_pool.hpp>
 #include <set>
 #include <filesystem>
 
@@ -49,6 +52,37 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+
+        bool findGridFiles(const std::filesystem::path& path, std::vector<std::filesystem::path>& paths)
+        {
+            if (!std::filesystem::exists(path))
+            {
+                logWarning("'{}' does not exist.", path);
+                return false;
+            }
+            if (!std::filesystem::is_directory(path))
+            {
+                logWarning("'{}' is not a directory.", path);
+                return false;
+            }
+
+            // Enumerate grid files.
+            paths.clear();
+            for (auto it : std::filesystem::directory_iterator(path))
+            {
+                if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
+            }
+
+            // Sort by length first, then alpha-numerically.
+            auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
+                auto sa = a.string();
+                auto sb = b.string();
+                return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
+            };
+            std::sort(paths.begin(), paths.end(), cmp);
+
+            return true;
+        }
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -78,6 +112,13 @@ namespace Falcor
 
             bool playback = isPlaybackEnabled();
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
+
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+            {
+                if (!mStreamers[slotIndex]) continue;
+                const char* name = (GridSlot)slotIndex == GridSlot::Density ? "Density Grid Streaming" : "Emission Grid Streaming";
+                if (auto group = widget.group(name)) mStreamers[slotIndex]->renderUI(group);
+            }
         }
 
         if (const auto& densityGrid = getDensityGrid())
@@ -127,13 +168,28 @@ namespace Falcor
 
     GridVolume::GridSequence GridVolume::createGridSequence(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
     {
-        GridSequence grids;
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        const uint64_t cacheHitCount = GridCache::getStats().hitCount;
+
+        // Decode the grids in parallel, then upload them to the GPU in order on this thread.
+        // Previously converted grids are read from the grid cache by the decode tasks.
+        BS::thread_pool threadPool;
+        std::vector<std::future<std::shared_ptr<Grid::HostData>>> decoded;
         for (const auto& path : paths)
         {
-            auto grid = Grid::createFromFile(pDevice, path, gridname);
+            decoded.push_back(threadPool.submit([&path, &gridname]() { return Grid::decodeFromFile(path, gridname); }));
+        }
+
+        GridSequence grids;
+        for (auto& hostData : decoded)
+        {
+            auto grid = Grid::createFromHostData(pDevice, hostData.get());
             if (keepEmpty || grid) grids.push_back(grid);
         }
 
+        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        logInfo("Loaded grid sequence of {} frames in {:.1f}ms ({} from grid cache).", paths.size(), dt, GridCache::getStats().hitCount - cacheHitCount);
+
         return grids;
     }
 
@@ -146,49 +202,66 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
     {
-        if (!std::filesystem::exists(path))
-        {
-            logWarning("'{}' does not exist.", path);
-            return 0;
-        }
-        if (!std::filesystem::is_directory(path))
-        {
-            logWarning("'{}' is not a directory.", path);
-            return 0;
-        }
-
-        // Enumerate grid files.
         std::vector<std::filesystem::path> paths;
-        for (auto it : std::filesystem::directory_iterator(path))
-        {
-            if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
-        }
-
-        // Sort by length first, then alpha-numerically.
-        auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
-            auto sa = a.string();
-            auto sb = b.string();
-            return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
-        };
-        std::sort(paths.begin(), paths.end(), cmp);
+        if (!findGridFiles(path, paths)) return 0;
 
         return loadGridSequence(slot, paths, gridname, keepEmpty);
     }
 
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStreamer::Options& options)
+    {
+        auto pStreamer = GridSequenceStreamer::create(mpDevice, paths, gridname, options);
+        setGridSequenceStreamer(slot, pStreamer);
+        return pStreamer->getFrameCount();
+    }
+
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStreamer::Options& options)
+    {
+        std::vector<std::filesystem::path> paths;
+        if (!findGridFiles(path, paths)) return 0;
+
+        return streamGridSequence(slot, paths, gridname, options);
+    }
+
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
     {
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        if (mGrids[slotIndex] != grids)
+        if (mGrids[slotIndex] != grids || mStreamers[slotIndex])
         {
             mGrids[slotIndex] = grids;
+            mStreamers[slotIndex] = nullptr;
             updateSequence();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
         }
     }
 
+    void GridVolume::setGridSequenceStreamer(GridSlot slot, const ref<GridSequenceStreamer>& pStreamer)
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        if (mStreamers[slotIndex] != pStreamer)
+        {
+            mGrids[slotIndex].clear();
+            mStreamers[slotIndex] = pStreamer;
+            if (pStreamer) pStreamer->prefetch(mGridFrame);
+            updateSequence();
+            updateBounds();
+            markUpdates(UpdateFlags::GridsChanged);
+        }
+    }
+
+    const ref<GridSequenceStreamer>& GridVolume::getGridSequenceStreamer(GridSlot slot) const
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        return mStreamers[slotIndex];
+    }
+
     const GridVolume::GridSequence& GridVolume::getGridSequence(GridSlot slot) const
     {
         uint32_t slotIndex = (uint32_t)slot;
@@ -209,6 +282,11 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
+        if (const auto& pStreamer = mStreamers[slotIndex])
+        {
+            return pStreamer->getFrameCount() > 0 ? pStreamer->getGrid(std::min(mGridFrame, pStreamer->getFrameCount() - 1)) : kNullGrid;
+        }
+
         const auto& gridSequence = mGrids[slotIndex];
         uint32_t gridIndex = std::min(mGridFrame, (uint32_t)gridSequence.size() - 1);
         return gridSequence.empty() ? kNullGrid : gridSequence[gridIndex];
@@ -221,6 +299,11 @@ namespace Falcor
         {
             std::copy_if(grids.begin(), grids.end(), std::inserter(uniqueGrids, uniqueGrids.begin()), [] (const auto& grid) { return grid != nullptr; });
         }
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+        {
+            if (!mStreamers[slotIndex]) continue;
+            if (const auto& grid = getGrid((GridSlot)slotIndex)) uniqueGrids.insert(grid);
+        }
         return std::vector<ref<Grid>>(uniqueGrids.begin(), uniqueGrids.end());
     }
 
@@ -229,6 +312,10 @@ namespace Falcor
         if (mGridFrame != gridFrame)
         {
             mGridFrame = gridFrame;
+            for (const auto& pStreamer : mStreamers)
+            {
+                if (pStreamer) pStreamer->prefetch(mGridFrame);
+            }
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -329,6 +416,10 @@ namespace Falcor
     {
         mGridFrameCount = 1;
         for (const auto& grids : mGrids) mGridFrameCount = std::max(mGridFrameCount, (uint32_t)grids.size());
+        for (const auto& pStreamer : mStreamers)
+        {
+            if (pStreamer) mGridFrameCount = std::max(mGridFrameCount, pStreamer->getFrameCount());
+        }
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
@@ -422,6 +513,40 @@ namespace Falcor
             "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true
         ); // PYTHONDEPRECATED
 
+        auto streamGridSequence = [](GridVolume& self, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname, uint32_t cacheSize, uint32_t prefetchCount, uint32_t threadCount)
+        {
+            return self.streamGridSequence(slot, getActiveAssetResolver().resolvePath(path), gridname, {cacheSize, prefetchCount, threadCount});
+        };
+        volume.def("streamGridSequence", streamGridSequence, "slot"_a, "path"_a, "gridname"_a, "cacheSize"_a = 8, "prefetchCount"_a = 4, "threadCount"_a = 0);
+        auto streamGridSequenceFiles = [](GridVolume& self, GridVolume::GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, uint32_t cacheSize, uint32_t prefetchCount, uint32_t threadCount)
+        {
+            std::vector<std::filesystem::path> resolvedPaths;
+            for (const auto& path : paths)
+                resolvedPaths.push_back(getActiveAssetResolver().resolvePath(path));
+            return self.streamGridSequence(slot, resolvedPaths, gridname, {cacheSize, prefetchCount, threadCount});
+        };
+        volume.def("streamGridSequence", streamGridSequenceFiles, "slot"_a, "paths"_a, "gridname"_a, "cacheSize"_a = 8, "prefetchCount"_a = 4, "threadCount"_a = 0);
+        volume.def("getStreamingStats", [](const GridVolume& self, GridVolume::GridSlot slot)
+            {
+                pybind11::dict d;
+                if (const auto& pStreamer = self.getGridSequenceStreamer(slot))
+                {
+                    const auto& stats = pStreamer->getStats();
+                    d["requestCount"] = stats.requestCount;
+                    d["stallCount"] = stats.stallCount;
+                    d["stallTime"] = stats.stallTime;
+                    d["loadCount"] = stats.loadCount;
+                    d["evictCount"] = stats.evictCount;
+                    d["residentCount"] = stats.residentCount;
+                    d["residentBytes"] = stats.residentBytes;
+                    d["residentBrickBytes"] = stats.residentBrickBytes;
+                    d["peakResidentBytes"] = stats.peakResidentBytes;
+                }
+                return d;
+            },
+            "slot"_a
+        );
+
         m.attr("Volume") = m.attr("GridVolume"); // PYTHONDEPRECATED
     }
 }
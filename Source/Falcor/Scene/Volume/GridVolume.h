@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridSequenceStreamer.h"
 #include "GridVolumeData.slang"
 #include "Core/Macros.h"
 #include "Utils/Math/AABB.h"
@@ -146,10 +147,41 @@ namespace Falcor
         */
         uint32_t loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
 
+        /** Stream a sequence of grids from files to a grid slot.
+            Instead of loading all grids up front, only a bounded number of grids is kept in memory and the grids
+            following the current frame are loaded asynchronously. See GridSequenceStreamer.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStreamer::Options& options = {});
+
+        /** Stream a sequence of grids from a directory to a grid slot.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStreamer::Options& options = {});
+
         /** Set the grid sequence for the specified slot.
         */
         void setGridSequence(GridSlot slot, const GridSequence& grids);
 
+        /** Set a streamed grid sequence for the specified slot.
+            Note: This will replace any existing grid sequence for that slot.
+        */
+        void setGridSequenceStreamer(GridSlot slot, const ref<GridSequenceStreamer>& pStreamer);
+
+        /** Get the streamed grid sequence for the specified slot, or nullptr if the slot is not streamed.
+        */
+        const ref<GridSequenceStreamer>& getGridSequenceStreamer(GridSlot slot) const;
+
         /** Get the grid sequence for the specified slot.
         */
         const GridSequence& getGridSequence(GridSlot slot) const;
@@ -164,6 +196,7 @@ namespace Falcor
         const ref<Grid>& getGrid(GridSlot slot) const;
 
         /** Get a list of all grids used for this volume.
+            For streamed grid sequences, only the grid of the current frame is included.
         */
         std::vector<ref<Grid>> getAllGrids() const;
 
@@ -292,6 +325,7 @@ namespace Falcor
         ref<Device> mpDevice;
         std::string mName;
         std::array<GridSequence, (size_t)GridSlot::Count> mGrids;
+        std::array<ref<GridSequenceStreamer>, (size_t)GridSlot::Count> mStreamers;
         uint32_t mGridFrame = 0;
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
@@ -42,13 +42,21 @@
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <pugixml.hpp>
+#include <nlohmann/json.hpp>
 #include <BS_thread_pool/BS_thread_pool_light.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <fstream>
 #include <regex>
+#include <thread>
 #include <cstdint>
 
+#if FALCOR_MSVC
+#include <intrin.h>
+#endif
+
 namespace Falcor
 {
 namespace unittest
@@ -61,6 +69,7 @@ struct TestDesc
     unittest::Options options;
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    CPUBenchmarkFunc cpuBenchmarkFunc;
 };
 
 struct TestResult
@@ -76,8 +85,16 @@ struct TestResult
     std::vector<std::string> messages;
     std::string extraMessage;
     uint64_t elapsedMS = 0;
+    std::optional<BenchmarkResult> benchmark;
 };
 
+/// Fraction of the minimum measurement time spent on warm-up.
+static constexpr double kBenchmarkWarmupFraction = 0.1;
+/// Target number of samples. Determines the number of iterations per sample.
+static constexpr uint32_t kBenchmarkTargetSampleCount = 50;
+static constexpr uint32_t kBenchmarkMinSampleCount = 5;
+static constexpr uint32_t kBenchmarkMaxSampleCount = 10000;
+
 static std::vector<TestDesc>& getTestRegistry()
 {
     static std::vector<TestDesc> registry;
@@ -143,6 +160,16 @@ void registerGPUTest(std::filesystem::path path, std::string name, unittest::Opt
     getTestRegistry().push_back(desc);
 }
 
+void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, CPUBenchmarkFunc func)
+{
+    TestDesc desc;
+    desc.path = std::move(path);
+    desc.name = std::move(name);
+    desc.options = std::move(options);
+    desc.cpuBenchmarkFunc = std::move(func);
+    getTestRegistry().push_back(desc);
+}
+
 /// Prints the UnitTest report line, making sure it is always printed to the console once.
 template<typename... Args>
 void reportLine(const std::string_view format, Args&&... args)
@@ -211,7 +238,131 @@ inline void writeXmlReport(const std::filesystem::path& path, const std::vector<
     doc.save_file(path.native().c_str());
 }
 
-inline TestResult runTest(const Test& test, DevicePool& devicePool)
+inline std::string formatDuration(double seconds)
+{
+    if (seconds < 1e-6)
+        return fmt::format("{:.2f} ns", seconds * 1e9);
+    if (seconds < 1e-3)
+        return fmt::format("{:.2f} us", seconds * 1e6);
+    if (seconds < 1.0)
+        return fmt::format("{:.2f} ms", seconds * 1e3);
+    return fmt::format("{:.2f} s", seconds);
+}
+
+inline std::string formatRate(double rate, const char* unit)
+{
+    static const char* kPrefixes[] = {"", "k", "M", "G", "T"};
+    size_t prefix = 0;
+    while (rate >= 1000.0 && prefix + 1 < std::size(kPrefixes))
+    {
+        rate /= 1000.0;
+        ++prefix;
+    }
+    return fmt::format("{:.2f} {}{}/s", rate, kPrefixes[prefix], unit);
+}
+
+inline std::string formatBenchmarkResult(const BenchmarkResult& result)
+{
+    std::string str = fmt::format(
+        "median {} (p10 {}, p90 {}, min {}), {} iteration{} in {} sample{}",
+        formatDuration(result.median),
+        formatDuration(result.p10),
+        formatDuration(result.p90),
+        formatDuration(result.min),
+        result.iterations,
+        plural(result.iterations, "s"),
+        result.samples,
+        plural(result.samples, "s")
+    );
+    if (result.itemsPerSecond > 0.0)
+        str += ", " + formatRate(result.itemsPerSecond, "items");
+    if (result.bytesPerSecond > 0.0)
+        str += ", " + formatRate(result.bytesPerSecond, "B");
+    for (const auto& [name, value] : result.counters)
+        str += fmt::format(", {} = {}", name, value);
+    return str;
+}
+
+/**
+ * Write a benchmark report in JSON format.
+ * The report contains the run context and the statistics of each benchmark, so reports of different runs can be compared.
+ * @param[in] path File path.
+ * @param[in] options Run options.
+ * @param[in] report List of benchmarks/results.
+ */
+inline void writeBenchmarkReport(
+    const std::filesystem::path& path,
+    const RunOptions& options,
+    const std::vector<std::pair<Test, TestResult>>& report
+)
+{
+    nlohmann::json benchmarks = nlohmann::json::array();
+    for (const auto& [test, result] : report)
+    {
+        nlohmann::json entry;
+        entry["suite"] = test.suiteName;
+        entry["name"] = test.name;
+        switch (result.status)
+        {
+        case TestResult::Status::Passed:
+            entry["status"] = "passed";
+            break;
+        case TestResult::Status::Skipped:
+            entry["status"] = "skipped";
+            break;
+        case TestResult::Status::Failed:
+        default:
+            entry["status"] = "failed";
+            break;
+        }
+
+        if (result.benchmark)
+        {
+            const BenchmarkResult& benchmark = *result.benchmark;
+            entry["iterations"] = benchmark.iterations;
+            entry["samples"] = benchmark.samples;
+            entry["time_ns"] = {
+                {"min", benchmark.min * 1e9},
+                {"p10", benchmark.p10 * 1e9},
+                {"median", benchmark.median * 1e9},
+                {"p90", benchmark.p90 * 1e9},
+                {"max", benchmark.max * 1e9},
+                {"mean", benchmark.mean * 1e9},
+                {"stddev", benchmark.stddev * 1e9},
+            };
+            if (benchmark.itemsPerSecond > 0.0)
+                entry["items_per_second"] = benchmark.itemsPerSecond;
+            if (benchmark.bytesPerSecond > 0.0)
+                entry["bytes_per_second"] = benchmark.bytesPerSecond;
+            if (!benchmark.counters.empty())
+                entry["counters"] = benchmark.counters;
+        }
+
+        benchmarks.push_back(std::move(entry));
+    }
+
+    nlohmann::json context;
+    context["falcor_version"] = getLongVersionString();
+#ifdef _DEBUG
+    context["build_type"] = "debug";
+#else
+    context["build_type"] = "release";
+#endif
+    context["hardware_concurrency"] = std::thread::hardware_concurrency();
+    context["min_time"] = options.benchmarkMinTime;
+    context["repeat"] = options.repeat;
+
+    nlohmann::json doc;
+    doc["context"] = std::move(context);
+    doc["benchmarks"] = std::move(benchmarks);
+
+    std::ofstream file(path);
+    if (!file)
+        FALCOR_THROW("Failed to open benchmark report file '{}'.", path);
+    file << doc.dump(4) << std::endl;
+}
+
+inline TestResult runTest(const Test& test, DevicePool& devicePool, const RunOptions& options)
 {
     if (!test.skipMessage.empty())
         return {TestResult::Status::Skipped, {test.skipMessage}};
@@ -228,6 +379,15 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
             test.cpuFunc(cpuCtx);
             result.messages = cpuCtx.getFailureMessages();
         }
+        else if (test.cpuBenchmarkFunc)
+        {
+            CPUBenchmarkContext benchmarkCtx(test.benchmarkMinTime > 0.0 ? test.benchmarkMinTime : options.benchmarkMinTime);
+            test.cpuBenchmarkFunc(benchmarkCtx);
+            result.messages = benchmarkCtx.getFailureMessages();
+            result.benchmark = benchmarkCtx.getResult();
+            if (!result.benchmark)
+                result.extraMessage = "Benchmark did not call CPUBenchmarkContext::run().";
+        }
         else if (test.gpuFunc)
         {
             ref<Device> pDevice;
@@ -270,7 +430,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
         result.extraMessage = e.what();
     }
 
-    if (!result.messages.empty())
+    if (!result.messages.empty() || (test.cpuBenchmarkFunc && !result.benchmark && result.status == TestResult::Status::Passed))
         result.status = TestResult::Status::Failed;
 
     if (!result.extraMessage.empty())
@@ -300,7 +460,9 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
     // Gather tests.
     std::vector<Test> tests = enumerateTests();
-    tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    tests = filterTests(
+        tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type, options.benchmark
+    );
 
     std::vector<TestResult> results(tests.size());
 
@@ -311,7 +473,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
     {
         threadPool.push_task(
-            [&abort, &tests, &results, &devicePool, testIndex]()
+            [&abort, &tests, &results, &devicePool, &options, testIndex]()
             {
                 if (abort)
                     return;
@@ -322,7 +484,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
                 reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
 
-                result = runTest(test, devicePool);
+                result = runTest(test, devicePool, options);
 
                 std::string statusTag;
                 switch (result.status)
@@ -392,7 +554,9 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     // Gather tests.
     std::vector<Test> tests = enumerateTests();
-    tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    tests = filterTests(
+        tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type, options.benchmark
+    );
 
     // Split tests into suites.
     std::map<std::string, std::vector<Test>> suites;
@@ -430,7 +594,7 @@ inline int32_t runTestsSerial(const RunOptions& options)
                 if (options.repeat > 1)
                     repeats = fmt::format("[{}/{}]", repeatIndex + 1, options.repeat);
                 reportLine("[ RUN      ] {}:{}{}", suiteName, test.name, repeats);
-                TestResult result = runTest(test, devicePool);
+                TestResult result = runTest(test, devicePool, options);
                 report.emplace_back(test, result);
 
                 std::string statusTag;
@@ -448,6 +612,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
                 }
                 if (!result.extraMessage.empty())
                     reportLine("{}", result.extraMessage);
+                if (result.benchmark)
+                    reportLine("[ BENCHMARK] {}", formatBenchmarkResult(*result.benchmark));
                 reportLine("{} {}:{}{} ({} ms)", statusTag, suiteName, test.name, repeats, result.elapsedMS);
                 suiteMS += result.elapsedMS;
                 if (success && result.status == TestResult::Status::Failed)
@@ -473,6 +639,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     if (!options.xmlReportPath.empty())
         writeXmlReport(options.xmlReportPath, report);
+    if (!options.benchmarkReportPath.empty())
+        writeBenchmarkReport(options.benchmarkReportPath, options, report);
 
     reportLine(
         "[==========] {} test{} from {} test suite{} ran. ({} ms total)",
@@ -507,7 +675,8 @@ int32_t runTests(const RunOptions& options)
     Threading::start();
     Scripting::start();
 
-    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options) : runTestsSerial(options);
+    // Benchmarks are always run serially to avoid interference between them.
+    int32_t failureCount = options.parallel > 1 && !options.benchmark ? runTestsParallel(options) : runTestsSerial(options);
 
     Scripting::shutdown();
     Threading::shutdown();
@@ -529,10 +698,12 @@ std::vector<Test> enumerateTests()
         test.tags = desc.options.tags;
         test.skipMessage = desc.options.skipMessage;
         test.deviceType = Device::Type::Default;
+        test.benchmarkMinTime = desc.options.benchmarkMinTime;
         test.cpuFunc = desc.cpuFunc;
         test.gpuFunc = desc.gpuFunc;
+        test.cpuBenchmarkFunc = desc.cpuBenchmarkFunc;
 
-        if (test.cpuFunc)
+        if (test.cpuFunc || test.cpuBenchmarkFunc)
         {
             tests.push_back(test);
         }
@@ -577,7 +748,8 @@ std::vector<Test> filterTests(
     std::string testSuiteFilter,
     std::string testCaseFilter,
     std::string tagFilter,
-    Device::Type deviceType
+    Device::Type deviceType,
+    bool benchmarks
 )
 {
     std::vector<Test> filtered;
@@ -624,6 +796,10 @@ std::vector<Test> filterTests(
             continue;
         if (deviceType != Device::Type::Default && test.deviceType != deviceType)
             continue;
+        // GPU tests that only measure timings are tagged with "benchmark" and run together with the CPU benchmarks.
+        bool isBenchmark = test.cpuBenchmarkFunc || test.tags.count("benchmark") == 1;
+        if (isBenchmark != benchmarks)
+            continue;
         filtered.push_back(test);
     }
 
@@ -645,6 +821,101 @@ void UnitTestContext::reportFailure(const std::string& message)
 
 ///////////////////////////////////////////////////////////////////////////
 
+void CPUBenchmarkContext::runBatched(const std::function<void(uint64_t)>& batch)
+{
+    FALCOR_CHECK(!mResult, "CPUBenchmarkContext::run() can only be called once per benchmark.");
+
+    using Clock = std::chrono::steady_clock;
+    auto measure = [&batch](uint64_t iterations)
+    {
+        auto startTime = Clock::now();
+        batch(iterations);
+        return std::chrono::duration<double>(Clock::now() - startTime).count();
+    };
+
+    // Warm up and calibrate. Double the iteration count until a single batch takes at least the target
+    // sample time, then keep running batches until the warm-up time is spent.
+    const double sampleTime = mMinTime / kBenchmarkTargetSampleCount;
+    const double warmupTime = mMinTime * kBenchmarkWarmupFraction;
+    uint64_t iterations = 1;
+    double batchTime = measure(iterations);
+    double totalWarmupTime = batchTime;
+    while (batchTime < sampleTime && iterations < (uint64_t(1) << 40))
+    {
+        iterations *= 2;
+        batchTime = measure(iterations);
+        totalWarmupTime += batchTime;
+    }
+    while (totalWarmupTime < warmupTime)
+        totalWarmupTime += measure(iterations);
+
+    // Pick the iteration count per sample from the calibrated time per iteration.
+    double iterationTime = batchTime / iterations;
+    uint64_t iterationsPerSample = iterationTime > 0.0 ? std::max<uint64_t>(1, uint64_t(sampleTime / iterationTime)) : iterations;
+
+    // Take samples until the minimum measurement time is reached.
+    std::vector<double> samples;
+    double totalTime = 0.0;
+    while ((totalTime < mMinTime || samples.size() < kBenchmarkMinSampleCount) && samples.size() < kBenchmarkMaxSampleCount)
+    {
+        double time = measure(iterationsPerSample);
+        totalTime += time;
+        samples.push_back(time / iterationsPerSample);
+    }
+
+    // Compute statistics.
+    BenchmarkResult result;
+    result.iterations = iterationsPerSample * samples.size();
+    result.samples = (uint32_t)samples.size();
+
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p)
+    {
+        double x = p * (sorted.size() - 1);
+        size_t i = std::min(size_t(x), sorted.size() - 1);
+        size_t j = std::min(i + 1, sorted.size() - 1);
+        return sorted[i] + (sorted[j] - sorted[i]) * (x - i);
+    };
+    result.min = sorted.front();
+    result.p10 = percentile(0.1);
+    result.median = percentile(0.5);
+    result.p90 = percentile(0.9);
+    result.max = sorted.back();
+
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+    result.mean = sum / samples.size();
+    double variance = 0.0;
+    for (double sample : samples)
+        variance += (sample - result.mean) * (sample - result.mean);
+    result.stddev = samples.size() > 1 ? std::sqrt(variance / (samples.size() - 1)) : 0.0;
+
+    if (result.median > 0.0)
+    {
+        result.itemsPerSecond = mItemsPerIteration / result.median;
+        result.bytesPerSecond = mBytesPerIteration / result.median;
+    }
+    result.counters = mCounters;
+
+    mResult = std::move(result);
+}
+
+void CPUBenchmarkContext::escape(const void* p)
+{
+    // Make the compiler assume that the pointed-to memory is read, so the computation producing it is kept.
+#if FALCOR_MSVC
+    static const void* volatile sSink;
+    sSink = p;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r"(p) : "memory");
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////
+
 void GPUUnitTestContext::createProgram(
     const std::filesystem::path& path,
     const std::string& entry,
@@ -798,4 +1069,39 @@ CPU_TEST(TestTags, TAGS("tag1", "tag2", "tag3"))
     EXPECT(true);
 }
 
+CPU_TEST(TestBenchmarkContext)
+{
+    CPUBenchmarkContext benchmarkCtx(0.01);
+    std::vector<float> values(1000, 1.f);
+    benchmarkCtx.setItemsPerIteration(values.size());
+    benchmarkCtx.run(
+        [&]()
+        {
+            float sum = 0.f;
+            for (float v : values)
+                sum += v;
+            benchmarkCtx.doNotOptimize(sum);
+        }
+    );
+    benchmarkCtx.setCounter("count", 42.0);
+
+    ASSERT(benchmarkCtx.getResult().has_value());
+    const BenchmarkResult& result = *benchmarkCtx.getResult();
+    EXPECT_GE(result.samples, 5u);
+    EXPECT_GE(result.iterations, result.samples);
+    EXPECT_LE(result.min, result.p10);
+    EXPECT_LE(result.p10, result.median);
+    EXPECT_LE(result.median, result.p90);
+    EXPECT_LE(result.p90, result.max);
+    EXPECT_GT(result.itemsPerSecond, 0.0);
+    EXPECT_EQ(result.bytesPerSecond, 0.0);
+    EXPECT_EQ(result.counters.at("count"), 42.0);
+    EXPECT_THROW(benchmarkCtx.run([]() {}));
+}
+
+CPU_BENCHMARK(TestCPUBenchmark, BENCHMARK_MIN_TIME(0.1))
+{
+    ctx.run([&]() { ctx.doNotOptimize(std::sqrt(2.0)); });
+}
+
 } // namespace Falcor
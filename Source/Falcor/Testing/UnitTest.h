@@ -40,6 +40,7 @@
 #include <filesystem>
 #include <functional>
 #include <map>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
@@ -93,15 +94,20 @@ struct RunOptions
     std::filesystem::path xmlReportPath;
     uint32_t parallel = 1;
     uint32_t repeat = 1;
+    bool benchmark = false;                    ///< Run benchmarks instead of tests. Benchmarks are always run serially.
+    std::filesystem::path benchmarkReportPath; ///< Benchmark report output file (JSON).
+    double benchmarkMinTime = 0.5;             ///< Minimum measurement time per benchmark in seconds.
 };
 
 FALCOR_API int32_t runTests(const RunOptions& options);
 
 class CPUUnitTestContext;
 class GPUUnitTestContext;
+class CPUBenchmarkContext;
 
 using CPUTestFunc = std::function<void(CPUUnitTestContext& ctx)>;
 using GPUTestFunc = std::function<void(GPUUnitTestContext& ctx)>;
+using CPUBenchmarkFunc = std::function<void(CPUBenchmarkContext& ctx)>;
 
 struct Test
 {
@@ -110,21 +116,28 @@ struct Test
     std::set<std::string> tags;
     std::string skipMessage;
     Device::Type deviceType;
+    double benchmarkMinTime = 0.0;
 
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    CPUBenchmarkFunc cpuBenchmarkFunc;
 };
 
 /// Enumerate all tests.
 FALCOR_API std::vector<Test> enumerateTests();
 
-/// Filter tests by suite and case name.
+/**
+ * Filter tests by suite and case name.
+ * Benchmarks are CPU_BENCHMARKs and tests tagged with "benchmark". If benchmarks is true, only benchmarks are returned,
+ * otherwise benchmarks are excluded.
+ */
 FALCOR_API std::vector<Test> filterTests(
     std::vector<Test> tests,
     std::string testSuiteFilter,
     std::string testCaseFilter,
     std::string tagFilter,
-    Device::Type deviceType
+    Device::Type deviceType,
+    bool benchmarks = false
 );
 
 class FALCOR_API UnitTestContext
@@ -153,6 +166,101 @@ private:
 class FALCOR_API CPUUnitTestContext : public UnitTestContext
 {};
 
+/**
+ * Statistics of a benchmark run. All times are in seconds per iteration.
+ */
+struct BenchmarkResult
+{
+    uint64_t iterations = 0; ///< Total number of measured iterations.
+    uint32_t samples = 0;    ///< Number of timed samples. Each sample runs the same number of iterations.
+    double min = 0.0;
+    double p10 = 0.0;
+    double median = 0.0;
+    double p90 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double itemsPerSecond = 0.0; ///< Throughput based on the median time, zero if no item count was set.
+    double bytesPerSecond = 0.0; ///< Throughput based on the median time, zero if no byte count was set.
+    std::map<std::string, double> counters;
+};
+
+/**
+ * Context for CPU benchmarks.
+ *
+ * The benchmark body sets up its data and then calls run() with the code to measure. run() first warms up
+ * the code, then picks the number of iterations per sample so that timer overhead is negligible and keeps
+ * taking samples until the minimum measurement time is reached. Statistics are computed over the per-iteration
+ * time of each sample. The EXPECT/ASSERT macros can be used to validate results.
+ */
+class FALCOR_API CPUBenchmarkContext : public UnitTestContext
+{
+public:
+    CPUBenchmarkContext(double minTime) : mMinTime(minTime) {}
+
+    /**
+     * Measure a function. Can only be called once per benchmark.
+     * @param[in] func Function to measure. Called once per iteration.
+     */
+    template<typename Func>
+    void run(Func&& func)
+    {
+        runBatched(
+            [&func](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                    func();
+            }
+        );
+    }
+
+    /**
+     * Set the number of items processed per iteration. Used to report throughput in items per second.
+     * Must be called before run().
+     */
+    void setItemsPerIteration(uint64_t items) { mItemsPerIteration = items; }
+
+    /**
+     * Set the number of bytes processed per iteration. Used to report throughput in bytes per second.
+     * Must be called before run().
+     */
+    void setBytesPerIteration(uint64_t bytes) { mBytesPerIteration = bytes; }
+
+    /**
+     * Set a custom counter that is reported along with the timings (e.g. a node or level count).
+     */
+    void setCounter(const std::string& name, double value)
+    {
+        mCounters[name] = value;
+        if (mResult)
+            mResult->counters[name] = value;
+    }
+
+    /**
+     * Prevent the compiler from optimizing away the computation of a value.
+     */
+    template<typename T>
+    static void doNotOptimize(const T& value)
+    {
+        escape(&value);
+    }
+
+    /**
+     * Returns the result, or an empty optional if run() was not called.
+     */
+    const std::optional<BenchmarkResult>& getResult() const { return mResult; }
+
+private:
+    void runBatched(const std::function<void(uint64_t)>& batch);
+    static void escape(const void* p);
+
+    double mMinTime;
+    uint64_t mItemsPerIteration = 0;
+    uint64_t mBytesPerIteration = 0;
+    std::map<std::string, double> mCounters;
+    std::optional<BenchmarkResult> mResult;
+};
+
 class FALCOR_API GPUUnitTestContext : public UnitTestContext
 {
 public:
@@ -310,11 +418,19 @@ struct DeviceTypes
     std::set<Device::Type> deviceTypes;
 };
 
+struct BenchmarkMinTime
+{
+    BenchmarkMinTime(double seconds_) : seconds(seconds_) {}
+
+    double seconds;
+};
+
 struct Options
 {
     std::set<std::string> tags;
     std::string skipMessage;
     std::set<Device::Type> deviceTypes;
+    double benchmarkMinTime = 0.0;
 };
 
 inline void applyArg(Options& options, Tags&& arg)
@@ -332,6 +448,11 @@ inline void applyArg(Options& options, DeviceTypes&& arg)
     options.deviceTypes.insert(arg.deviceTypes.begin(), arg.deviceTypes.end());
 }
 
+inline void applyArg(Options& options, BenchmarkMinTime&& arg)
+{
+    options.benchmarkMinTime = arg.seconds;
+}
+
 inline void applyArg(Options& options, Device::Type deviceType)
 {
     options.deviceTypes.insert(deviceType);
@@ -351,6 +472,7 @@ void applyArgs(Options& options, Args&&... args)
 
 FALCOR_API void registerCPUTest(std::filesystem::path path, std::string name, unittest::Options options, CPUTestFunc func);
 FALCOR_API void registerGPUTest(std::filesystem::path path, std::string name, unittest::Options options, GPUTestFunc func);
+FALCOR_API void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, CPUBenchmarkFunc func);
 
 /**
  * StreamSink is a utility class used by the testing framework that either
@@ -533,6 +655,8 @@ inline std::optional<std::string> createBinaryMessage(std::string_view lhsStr, s
 using UnitTestContext = unittest::UnitTestContext;
 using CPUUnitTestContext = unittest::CPUUnitTestContext;
 using GPUUnitTestContext = unittest::GPUUnitTestContext;
+using CPUBenchmarkContext = unittest::CPUBenchmarkContext;
+using BenchmarkResult = unittest::BenchmarkResult;
 
 /**
  * Macro to define a CPU unit test. The optional arguments include:
@@ -592,6 +716,11 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
  *
  * GPU_TEST(Test6, Device::Type::D3D12) {} // Test is only run on D3D12 (same as above)
  *
+ * GPU tests that only measure performance should be tagged with "benchmark". They are then excluded from
+ * normal test runs and only run when FalcorTest is started with --benchmark:
+ *
+ * GPU_TEST(Test7, TAGS("benchmark")) {} // Test is only run in benchmark mode
+ *
  * Note: All GPU tests are implicitly tagged with "gpu".
  */
 #define GPU_TEST(name, ...)                                                     \
@@ -609,6 +738,39 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
     } RegisterGPUTest##name;                                                    \
     static void GPUUnitTest##name(GPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/**
+ * Macro to define a CPU benchmark. Benchmarks are only run when FalcorTest is started with --benchmark.
+ * The optional arguments are the same as for CPU_TEST, plus:
+ *
+ * - BENCHMARK_MIN_TIME(seconds): Override the minimum measurement time (expands to unittest::BenchmarkMinTime).
+ *
+ * Example:
+ *
+ * CPU_BENCHMARK(Bench1)
+ * {
+ *     std::vector<float> data = createData(); // Setup is not measured.
+ *     ctx.setItemsPerIteration(data.size());
+ *     ctx.run([&]() { ctx.doNotOptimize(process(data)); });
+ * }
+ *
+ * Note: All CPU benchmarks are implicitly tagged with "cpu" and "benchmark".
+ */
+#define CPU_BENCHMARK(name, ...)                                                      \
+    static void CPUBenchmark##name(CPUBenchmarkContext& ctx);                         \
+    struct CPUBenchmarkRegisterer##name                                               \
+    {                                                                                 \
+        CPUBenchmarkRegisterer##name()                                                \
+        {                                                                             \
+            std::filesystem::path path = __FILE__;                                    \
+            unittest::Options options;                                                \
+            applyArgs(options, ##__VA_ARGS__);                                        \
+            options.tags.insert("cpu");                                               \
+            options.tags.insert("benchmark");                                         \
+            unittest::registerCPUBenchmark(path, #name, options, CPUBenchmark##name); \
+        }                                                                             \
+    } RegisterCPUBenchmark##name;                                                     \
+    static void CPUBenchmark##name(CPUBenchmarkContext& ctx) /* over to the user for the braces */
+
 // clang-format off
 
 /// Used as an argument of CPU_TEST/GPU_TEST to tag a test with a set of strings.
@@ -617,6 +779,8 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
 #define SKIP(msg) ::Falcor::unittest::Skip{msg}
 /// Used as an argument of GPU_TEST to mark a test to only run for certain devices.
 #define DEVICE_TYPES(...) ::Falcor::unittest::DeviceTypes{__VA_ARGS__}
+/// Used as an argument of CPU_BENCHMARK to override the minimum measurement time in seconds.
+#define BENCHMARK_MIN_TIME(seconds) ::Falcor::unittest::BenchmarkMinTime{seconds}
 
 // clang-format on
 
@@ -0,0 +1,85 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CacheFile.h"
+#include "Core/Error.h"
+#include "Utils/StringFormatters.h"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+CacheFileHeader::CacheFileHeader(const char* magic_, uint32_t version_) : version(version_)
+{
+    std::memcpy(magic, magic_, sizeof(magic));
+}
+
+bool CacheFileHeader::isValid(const char* magic_, uint32_t version_) const
+{
+    return std::memcmp(magic, magic_, sizeof(magic)) == 0 && version == version_;
+}
+
+void writeFileAtomic(const std::filesystem::path& path, const std::function<void(const std::filesystem::path&)>& writeFunc)
+{
+    // Use a random suffix so that concurrent writers of the same file don't interfere.
+    std::filesystem::path tmpPath = path;
+    tmpPath += fmt::format(".{:x}.tmp{}", std::random_device()(), path.extension().string());
+
+    try
+    {
+        if (path.has_parent_path())
+            std::filesystem::create_directories(path.parent_path());
+        writeFunc(tmpPath);
+        std::filesystem::rename(tmpPath, path);
+    }
+    catch (const std::exception&)
+    {
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+        throw;
+    }
+}
+
+void writeFileAtomic(const std::filesystem::path& path, const std::function<void(std::ostream&)>& writeFunc)
+{
+    writeFileAtomic(
+        path,
+        [&](const std::filesystem::path& tmpPath)
+        {
+            std::ofstream fs(tmpPath, std::ios_base::binary);
+            if (!fs.good())
+                FALCOR_THROW("Failed to create file '{}'.", tmpPath);
+            writeFunc(fs);
+            fs.close();
+            if (fs.fail())
+                FALCOR_THROW("Failed to write file '{}'.", tmpPath);
+        }
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,73 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+
+namespace Falcor
+{
+/**
+ * Header at the start of binary cache files.
+ * Identifies the type of cache file by an 8 character magic string and the version of its format.
+ * Files with a different magic string or version are treated as invalid.
+ */
+struct CacheFileHeader
+{
+    uint8_t magic[8]{};
+    uint32_t version{};
+
+    CacheFileHeader() = default;
+    /// Create a header. `magic` must have (at least) 8 characters.
+    CacheFileHeader(const char* magic, uint32_t version);
+
+    bool isValid(const char* magic, uint32_t version) const;
+};
+
+/**
+ * Write a file atomically.
+ * The content is written to a temporary file in the same directory, which is moved in place once complete. Concurrent
+ * readers in this or other processes therefore see either the previous file or the complete new file, never a
+ * partially written one. The parent directory is created if it does not exist.
+ * Throws an exception if writing fails, the temporary file is removed in that case.
+ * @param[in] path Destination path.
+ * @param[in] writeFunc Function writing the content to the temporary file at the given path. The temporary file has the
+ * same extension as the destination.
+ */
+FALCOR_API void writeFileAtomic(const std::filesystem::path& path, const std::function<void(const std::filesystem::path&)>& writeFunc);
+
+/**
+ * Write a binary file atomically (see above).
+ * @param[in] path Destination path.
+ * @param[in] writeFunc Function writing the content to a binary stream.
+ */
+FALCOR_API void writeFileAtomic(const std::filesystem::path& path, const std::function<void(std::ostream&)>& writeFunc);
+} // namespace Falcor
@@ -0,0 +1,160 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "DirtyRangeTracker.h"
+#include "Core/API/CopyContext.h"
+#include "Core/Error.h"
+
+#include <algorithm>
+
+namespace Falcor
+{
+void DirtyRangeTracker::setMergeDistance(size_t mergeDistance)
+{
+    mMergeDistance = mergeDistance;
+    mCoalesced = mRanges.size() <= 1;
+}
+
+void DirtyRangeTracker::markDirty(size_t begin, size_t end)
+{
+    if (begin >= end)
+        return;
+
+    // Extend the last range if the new range continues it, which is the common case when marking elements in order.
+    if (!mRanges.empty())
+    {
+        Range& last = mRanges.back();
+        if (begin >= last.begin && begin <= last.end + mMergeDistance)
+        {
+            last.end = std::max(last.end, end);
+            return;
+        }
+        if (begin < last.begin)
+            mCoalesced = false;
+    }
+    mRanges.push_back({begin, end});
+}
+
+void DirtyRangeTracker::markDirty(const std::vector<uint64_t>& bits, size_t count)
+{
+    FALCOR_CHECK(bits.size() * 64 >= count, "Bitset holds fewer than {} elements.", count);
+
+    const size_t wordCount = (count + 63) / 64;
+    for (size_t w = 0; w < wordCount; w++)
+    {
+        uint64_t word = bits[w];
+        if (word == 0)
+            continue;
+
+        const size_t base = w * 64;
+        if (word == ~uint64_t(0))
+        {
+            markDirty(base, std::min(base + 64, count));
+            continue;
+        }
+
+        // Find runs of set bits in the word.
+        size_t i = 0;
+        while (i < 64 && word != 0)
+        {
+            if ((word & 1) == 0)
+            {
+                word >>= 1;
+                i++;
+                continue;
+            }
+            size_t begin = i;
+            while (i < 64 && (word & 1) != 0)
+            {
+                word >>= 1;
+                i++;
+            }
+            markDirty(base + begin, std::min(base + i, count));
+        }
+    }
+}
+
+void DirtyRangeTracker::markDirty(const DirtyRangeTracker& other)
+{
+    for (const auto& range : other.getRanges())
+        markDirty(range.begin, range.end);
+}
+
+const std::vector<DirtyRangeTracker::Range>& DirtyRangeTracker::getRanges() const
+{
+    coalesce();
+    return mRanges;
+}
+
+size_t DirtyRangeTracker::getDirtyCount() const
+{
+    size_t count = 0;
+    for (const auto& range : getRanges())
+        count += range.size();
+    return count;
+}
+
+uint64_t DirtyRangeTracker::upload(CopyContext* pCopyContext, const Buffer* pBuffer, const void* pData, size_t elementSize) const
+{
+    FALCOR_ASSERT(pCopyContext && pBuffer && pData);
+
+    const auto& ranges = getRanges();
+    if (ranges.empty())
+        return 0;
+
+    std::vector<CopyContext::BufferRegion> regions;
+    regions.reserve(ranges.size());
+    uint64_t byteSize = 0;
+    for (const auto& range : ranges)
+    {
+        regions.push_back({range.begin * elementSize, range.size() * elementSize});
+        byteSize += range.size() * elementSize;
+    }
+
+    pCopyContext->updateBufferRegions(pBuffer, pData, regions);
+    return byteSize;
+}
+
+void DirtyRangeTracker::coalesce() const
+{
+    if (mCoalesced)
+        return;
+
+    std::sort(mRanges.begin(), mRanges.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+
+    size_t last = 0;
+    for (size_t i = 1; i < mRanges.size(); i++)
+    {
+        if (mRanges[i].begin <= mRanges[last].end + mMergeDistance)
+            mRanges[last].end = std::max(mRanges[last].end, mRanges[i].end);
+        else
+            mRanges[++last] = mRanges[i];
+    }
+    mRanges.resize(last + 1);
+    mCoalesced = true;
+}
+} // namespace Falcor
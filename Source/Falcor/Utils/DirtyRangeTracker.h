@@ -0,0 +1,131 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+class CopyContext;
+
+/**
+ * Utility class for tracking modified elements of a CPU array mirrored in a GPU buffer.
+ *
+ * Modified element ranges are recorded as they are marked dirty, and coalesced into a
+ * minimal sorted set of non-overlapping ranges on request. Ranges separated by at most
+ * `mergeDistance` clean elements are merged, trading a few redundantly uploaded elements
+ * for fewer copy commands.
+ *
+ * The dirty ranges can be uploaded with upload(), which stages all ranges in a single
+ * allocation of the device upload heap and records one copy command per range.
+ */
+class FALCOR_API DirtyRangeTracker
+{
+public:
+    /// Half-open range [begin, end) of element indices.
+    struct Range
+    {
+        size_t begin = 0;
+        size_t end = 0;
+
+        size_t size() const { return end - begin; }
+        bool operator==(const Range& other) const { return begin == other.begin && end == other.end; }
+    };
+
+    /**
+     * Constructor.
+     * @param[in] mergeDistance Maximum number of clean elements between two dirty ranges for them to be merged.
+     */
+    explicit DirtyRangeTracker(size_t mergeDistance = 0) : mMergeDistance(mergeDistance) {}
+
+    void setMergeDistance(size_t mergeDistance);
+    size_t getMergeDistance() const { return mMergeDistance; }
+
+    /**
+     * Mark a single element as dirty.
+     * @param[in] index Element index.
+     */
+    void markDirty(size_t index) { markDirty(index, index + 1); }
+
+    /**
+     * Mark a range of elements as dirty.
+     * @param[in] begin First element index.
+     * @param[in] end One past the last element index.
+     */
+    void markDirty(size_t begin, size_t end);
+
+    /**
+     * Mark all elements whose bit is set in a bitset as dirty.
+     * @param[in] bits Bitset with one bit per element, stored in 64-bit words.
+     * @param[in] count Number of elements.
+     */
+    void markDirty(const std::vector<uint64_t>& bits, size_t count);
+
+    /**
+     * Mark all dirty ranges of another tracker as dirty.
+     */
+    void markDirty(const DirtyRangeTracker& other);
+
+    /// Returns true if any element is dirty.
+    bool isDirty() const { return !mRanges.empty(); }
+
+    /**
+     * Get the coalesced dirty ranges, sorted by element index.
+     */
+    const std::vector<Range>& getRanges() const;
+
+    /**
+     * Get the number of elements covered by the coalesced dirty ranges.
+     */
+    size_t getDirtyCount() const;
+
+    /// Clear all dirty ranges.
+    void clear() { mRanges.clear(); mCoalesced = true; }
+
+    /**
+     * Upload the dirty elements of an array to a GPU buffer. The tracker is not cleared.
+     * @param[in] pCopyContext Copy context to record the copies on.
+     * @param[in] pBuffer Destination buffer. Element i is written to byte offset i * elementSize.
+     * @param[in] pData Pointer to the CPU array.
+     * @param[in] elementSize Size of an element in bytes.
+     * @return Number of bytes uploaded.
+     */
+    uint64_t upload(CopyContext* pCopyContext, const Buffer* pBuffer, const void* pData, size_t elementSize) const;
+
+private:
+    void coalesce() const;
+
+    size_t mMergeDistance = 0;
+    mutable std::vector<Range> mRanges;
+    mutable bool mCoalesced = true;
+};
+} // namespace Falcor
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Bitmap.h"
+#include "ExrWriter.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
@@ -118,15 +119,28 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
  */
 static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
 {
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
+    size_t pixelCount = size_t(width) * height;
+    fstd::span<const float16_t> src(reinterpret_cast<const float16_t*>(pData), pixelCount * channelCount);
+
+    if (channelCount == 4)
+    {
+        std::vector<float> newData(pixelCount * 4u);
+        math::float16ToFloat32(src, newData);
+        return newData;
+    }
+
+    std::vector<float> srcData(src.size());
+    math::float16ToFloat32(src, srcData);
+
+    std::vector<float> newData(pixelCount * 4u, 0.f);
+    const float* pSrc = srcData.data();
     float* pDst = newData.data();
 
-    for (uint32_t i = 0; i < width * height; ++i)
+    for (size_t i = 0; i < pixelCount; ++i)
     {
         for (uint32_t c = 0; c < channelCount; ++c)
         {
-            *pDst++ = float(*pSrc++);
+            *pDst++ = *pSrc++;
         }
         pDst += (4 - channelCount);
     }
@@ -205,6 +219,60 @@ static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t w
     return floatData;
 }
 
+/**
+ * Saves an image to an EXR file using the native OpenEXR writer.
+ * Float formats are written directly from the source data. Integer formats and half formats with less than
+ * three channels are converted to RGBA float first. Channel types and compression follow the previous
+ * FreeImage based export: half with PIZ compression by default, half with B44 compression if lossy, and
+ * float without compression if uncompressed (unless ExrFloat16 is set).
+ */
+static void saveExrImage(
+    const std::filesystem::path& path,
+    uint32_t width,
+    uint32_t height,
+    Bitmap::ExportFlags exportFlags,
+    ResourceFormat resourceFormat,
+    const void* pData
+)
+{
+    std::vector<float> floatData;
+    if (isConvertibleToRGBA32Float(resourceFormat) &&
+        (getFormatType(resourceFormat) != FormatType::Float || getFormatChannelCount(resourceFormat) < 3))
+    {
+        floatData = convertToRGBA32Float(resourceFormat, width, height, pData);
+        pData = floatData.data();
+        resourceFormat = ResourceFormat::RGBA32Float;
+    }
+    else if (getFormatType(resourceFormat) != FormatType::Float)
+    {
+        FALCOR_THROW("Only support for float or 16/32-bit integer images as EXR files.");
+    }
+
+    const bool exportAlpha = is_set(exportFlags, Bitmap::ExportFlags::ExportAlpha);
+    if (exportAlpha && getFormatChannelCount(resourceFormat) != 4)
+        FALCOR_THROW("Requesting to export alpha-channel to EXR file, but the resource doesn't have an alpha-channel");
+
+    ExrWriter::Options options;
+    ExrWriter::PixelType pixelType = ExrWriter::PixelType::Half;
+    if (is_set(exportFlags, Bitmap::ExportFlags::Uncompressed))
+    {
+        options.compression = ExrWriter::Compression::None;
+        if (!is_set(exportFlags, Bitmap::ExportFlags::ExrFloat16))
+            pixelType = ExrWriter::PixelType::Float;
+    }
+    else if (is_set(exportFlags, Bitmap::ExportFlags::Lossy))
+    {
+        options.compression = ExrWriter::Compression::B44;
+    }
+    else
+    {
+        options.compression = ExrWriter::Compression::PIZ;
+    }
+
+    TextureChannelFlags mask = exportAlpha ? TextureChannelFlags::RGBA : TextureChannelFlags::RGB;
+    ExrWriter::write(path, {ExrWriter::createLayer("", width, height, resourceFormat, pData, mask, pixelType)}, options);
+}
+
 /**
  * Converts 96bpp to 128bpp RGBA without clamping.
  * Note that we can't use FreeImage_ConvertToRGBAF() as it clamps to [0,1].
@@ -265,18 +333,30 @@ static FIBITMAP* convertToRGBA16Float(FIBITMAP* pDib)
     const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
     BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
 
+    // Convert rows to float16_t in bulk. If the source format doesn't have alpha, convert into a temporary row and add a "dummy" alpha of 1.0.
+    const uint32_t srcChannelCount = type == FIT_RGBAF ? 4 : 3;
+    const uint16_t kOne = float16_t(1.0f).toBits();
+    std::vector<uint16_t> rgbRow(srcChannelCount == 3 ? width * 3 : 0);
+
     for (uint32_t y = 0; y < height; y++)
     {
-        const FIRGBAF* src_pixel = (FIRGBAF*)src_bits;
-        FIRGBA16* dst_pixel = (tagFIRGBA16*)dst_bits;
+        fstd::span<const float> src_row(reinterpret_cast<const float*>(src_bits), width * srcChannelCount);
+        uint16_t* dst_row = reinterpret_cast<uint16_t*>(dst_bits);
 
-        for (uint32_t x = 0; x < width; x++)
+        if (srcChannelCount == 4)
         {
-            // Convert pixels to float16_t directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
-            dst_pixel[x].red = float16_t(src_pixel[x].red).toBits();
-            dst_pixel[x].green = float16_t(src_pixel[x].green).toBits();
-            dst_pixel[x].blue = float16_t(src_pixel[x].blue).toBits();
-            dst_pixel[x].alpha = float16_t(type == FIT_RGBAF ? src_pixel[x].alpha : 1.0f).toBits();
+            math::float32ToFloat16(src_row, fstd::span<uint16_t>(dst_row, width * 4));
+        }
+        else
+        {
+            math::float32ToFloat16(src_row, rgbRow);
+            for (uint32_t x = 0; x < width; x++)
+            {
+                dst_row[x * 4 + 0] = rgbRow[x * 3 + 0];
+                dst_row[x * 4 + 1] = rgbRow[x * 3 + 1];
+                dst_row[x * 4 + 2] = rgbRow[x * 3 + 2];
+                dst_row[x * 4 + 3] = kOne;
+            }
         }
         src_bits += src_pitch;
         dst_bits += dst_pitch;
@@ -602,9 +682,15 @@ void Bitmap::saveImage(
     FALCOR_CHECK(fileFormat != FileFormat::DdsFile, "Cannot save DDS files. Use ImageIO instead.");
     if (is_set(exportFlags, ExportFlags::Uncompressed) && is_set(exportFlags, ExportFlags::Lossy))
         FALCOR_THROW("Incompatible flags: lossy cannot be combined with uncompressed.");
-    if (is_set(exportFlags, ExportFlags::ExrFloat16) &&
-        (!is_set(exportFlags, ExportFlags::Uncompressed) || fileFormat != FileFormat::ExrFile))
-        FALCOR_THROW("Incompatible flags: EXR float16 can only be set for uncompressed EXR files.");
+    if (is_set(exportFlags, ExportFlags::ExrFloat16) && fileFormat != FileFormat::ExrFile)
+        FALCOR_THROW("Incompatible flags: EXR float16 can only be set for EXR files.");
+
+    // EXR files are written with OpenEXR directly. Note that the image data is always assumed to be top-down.
+    if (fileFormat == FileFormat::ExrFile)
+    {
+        saveExrImage(path, width, height, exportFlags, resourceFormat, pData);
+        return;
+    }
 
     int flags = 0;
     FIBITMAP* pImage = nullptr;
@@ -628,7 +714,7 @@ void Bitmap::saveImage(
         }
     }
 
-    if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
+    if (fileFormat == Bitmap::FileFormat::PfmFile)
     {
         std::vector<float> floatData;
         if (isConvertibleToRGBA32Float(resourceFormat))
@@ -640,24 +726,16 @@ void Bitmap::saveImage(
         }
         else if (bytesPerPixel != 16 && bytesPerPixel != 12)
         {
-            FALCOR_THROW("Only support for 32-bit/channel RGB/RGBA or 16-bit RGBA images as PFM/EXR files.");
+            FALCOR_THROW("Only support for 32-bit/channel RGB/RGBA or 16-bit RGBA images as PFM files.");
         }
 
-        const bool exportAlpha = is_set(exportFlags, ExportFlags::ExportAlpha);
-
-        if (fileFormat == Bitmap::FileFormat::PfmFile)
-        {
-            FALCOR_CHECK(!is_set(exportFlags, ExportFlags::Lossy), "PFM does not support lossy compression mode.");
-            FALCOR_CHECK(!exportAlpha, "PFM does not support alpha channel.");
-        }
-
-        if (exportAlpha && bytesPerPixel != 16)
-            FALCOR_THROW("Requesting to export alpha-channel to EXR file, but the resource doesn't have an alpha-channel");
+        FALCOR_CHECK(!is_set(exportFlags, ExportFlags::Lossy), "PFM does not support lossy compression mode.");
+        FALCOR_CHECK(!is_set(exportFlags, ExportFlags::ExportAlpha), "PFM does not support alpha channel.");
 
         // Upload the image manually and flip it vertically
-        bool scanlineCopy = exportAlpha ? bytesPerPixel == 16 : bytesPerPixel == 12;
+        bool scanlineCopy = bytesPerPixel == 12;
 
-        pImage = FreeImage_AllocateT(exportAlpha ? FIT_RGBAF : FIT_RGBF, width, height);
+        pImage = FreeImage_AllocateT(FIT_RGBF, width, height);
         BYTE* head = (BYTE*)pData;
         for (unsigned y = 0; y < height; y++)
         {
@@ -668,7 +746,6 @@ void Bitmap::saveImage(
             }
             else
             {
-                FALCOR_ASSERT(exportAlpha == false);
                 for (unsigned x = 0; x < width; x++)
                 {
                     dstBits[x * 3 + 0] = (((float*)head)[x * 4 + 0]);
@@ -678,21 +755,6 @@ void Bitmap::saveImage(
             }
             head += bytesPerPixel * width;
         }
-
-        if (fileFormat == Bitmap::FileFormat::ExrFile)
-        {
-            flags = 0;
-            if (is_set(exportFlags, ExportFlags::Uncompressed))
-            {
-                flags |= EXR_NONE;
-                if (!is_set(exportFlags, ExportFlags::ExrFloat16))
-                    flags |= EXR_FLOAT;
-            }
-            else if (is_set(exportFlags, ExportFlags::Lossy))
-            {
-                flags |= EXR_B44 | EXR_ZIP;
-            }
-        }
     }
     else
     {
@@ -0,0 +1,254 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ExrWriter.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfMultiPartOutputFile.h>
+#include <ImfOutputPart.h>
+#include <ImfPartType.h>
+#include <ImfStandardAttributes.h>
+#include <ImfThreading.h>
+
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+Imf::Compression getImfCompression(ExrWriter::Compression compression)
+{
+    switch (compression)
+    {
+    case ExrWriter::Compression::None:
+        return Imf::NO_COMPRESSION;
+    case ExrWriter::Compression::RLE:
+        return Imf::RLE_COMPRESSION;
+    case ExrWriter::Compression::ZIPS:
+        return Imf::ZIPS_COMPRESSION;
+    case ExrWriter::Compression::ZIP:
+        return Imf::ZIP_COMPRESSION;
+    case ExrWriter::Compression::PIZ:
+        return Imf::PIZ_COMPRESSION;
+    case ExrWriter::Compression::PXR24:
+        return Imf::PXR24_COMPRESSION;
+    case ExrWriter::Compression::B44:
+        return Imf::B44_COMPRESSION;
+    case ExrWriter::Compression::DWAA:
+        return Imf::DWAA_COMPRESSION;
+    case ExrWriter::Compression::DWAB:
+        return Imf::DWAB_COMPRESSION;
+    default:
+        FALCOR_THROW("Unknown EXR compression mode.");
+    }
+}
+
+Imf::PixelType getImfPixelType(ExrWriter::PixelType pixelType)
+{
+    return pixelType == ExrWriter::PixelType::Half ? Imf::HALF : Imf::FLOAT;
+}
+
+/// Returns the number of bits per channel of a format supported as source, or 0 if the format is not supported.
+uint32_t getSourceChannelBits(ResourceFormat format)
+{
+    if (format == ResourceFormat::Unknown || getFormatType(format) != FormatType::Float)
+        return 0;
+    uint32_t bits = getNumChannelBits(format, 0);
+    if (bits != 16 && bits != 32)
+        return 0;
+    for (uint32_t c = 1; c < getFormatChannelCount(format); c++)
+    {
+        if (getNumChannelBits(format, c) != bits)
+            return 0;
+    }
+    return bits;
+}
+
+/// Returns the number of threads to use for compression and makes sure the OpenEXR thread pool is large enough.
+int prepareThreads(uint32_t threadCount)
+{
+    int count = threadCount > 0 ? (int)threadCount : (int)std::thread::hardware_concurrency();
+
+    // OpenEXR distributes line blocks over its global thread pool.
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (Imf::globalThreadCount() < count)
+        Imf::setGlobalThreadCount(count);
+    return count;
+}
+
+void validateLayer(const ExrWriter::Layer& layer)
+{
+    FALCOR_CHECK(layer.width > 0 && layer.height > 0, "Layer '{}' has zero size.", layer.name);
+    FALCOR_CHECK(layer.pData != nullptr, "Layer '{}' has no pixel data.", layer.name);
+    FALCOR_CHECK(getSourceChannelBits(layer.format) != 0, "Layer '{}' has unsupported format {}.", layer.name, to_string(layer.format));
+    FALCOR_CHECK(!layer.channels.empty(), "Layer '{}' has no channels.", layer.name);
+    FALCOR_CHECK(
+        layer.rowPitch == 0 || layer.rowPitch >= layer.width * getFormatBytesPerBlock(layer.format),
+        "Layer '{}' has a row pitch smaller than a row of pixels.",
+        layer.name
+    );
+    for (const auto& channel : layer.channels)
+    {
+        FALCOR_CHECK(
+            channel.sourceChannel < getFormatChannelCount(layer.format),
+            "Channel '{}' of layer '{}' refers to source channel {}, but the format only has {} channels.",
+            channel.name,
+            layer.name,
+            channel.sourceChannel,
+            getFormatChannelCount(layer.format)
+        );
+    }
+}
+
+/// Add the channels of a layer to a header and the corresponding slices to a frame buffer.
+void addLayer(const ExrWriter::Layer& layer, Imf::Header& header, Imf::FrameBuffer& frameBuffer)
+{
+    const uint32_t bytesPerChannel = getSourceChannelBits(layer.format) / 8;
+    const size_t xStride = getFormatBytesPerBlock(layer.format);
+    const size_t yStride = layer.rowPitch ? layer.rowPitch : layer.width * xStride;
+    const Imf::PixelType sourceType = bytesPerChannel == 2 ? Imf::HALF : Imf::FLOAT;
+
+    for (const auto& channel : layer.channels)
+    {
+        std::string name = layer.name.empty() ? channel.name : layer.name + "." + channel.name;
+        FALCOR_CHECK(header.channels().findChannel(name) == nullptr, "Duplicate EXR channel name '{}'.", name);
+
+        // OpenEXR converts between the source type and the pixel type in the file while writing.
+        char* pBase = const_cast<char*>(static_cast<const char*>(layer.pData)) + channel.sourceChannel * bytesPerChannel;
+        header.channels().insert(name, Imf::Channel(getImfPixelType(channel.pixelType)));
+        frameBuffer.insert(name, Imf::Slice(sourceType, pBase, xStride, yStride));
+    }
+}
+} // namespace
+
+std::vector<ExrWriter::Channel> ExrWriter::getChannels(ResourceFormat format, TextureChannelFlags mask, PixelType pixelType)
+{
+    static const char* kNames[] = {"R", "G", "B", "A"};
+
+    std::vector<Channel> channels;
+    uint32_t channelCount = getFormatChannelCount(format);
+    for (uint32_t c = 0; c < channelCount && c < 4; c++)
+    {
+        if (is_set(mask, TextureChannelFlags(1u << c)))
+            channels.push_back(Channel{kNames[c], c, pixelType});
+    }
+    return channels;
+}
+
+ExrWriter::Layer ExrWriter::createLayer(
+    std::string name,
+    uint32_t width,
+    uint32_t height,
+    ResourceFormat format,
+    const void* pData,
+    TextureChannelFlags mask,
+    PixelType pixelType
+)
+{
+    Layer layer;
+    layer.name = std::move(name);
+    layer.width = width;
+    layer.height = height;
+    layer.format = format;
+    layer.pData = pData;
+    layer.channels = getChannels(format, mask, pixelType);
+    return layer;
+}
+
+void ExrWriter::write(const std::filesystem::path& path, const std::vector<Layer>& layers, const Options& options)
+{
+    FALCOR_CHECK(!layers.empty(), "No layers to write.");
+    for (const auto& layer : layers)
+        validateLayer(layer);
+
+    const bool multiPart = options.multiPart && layers.size() > 1;
+    if (multiPart)
+    {
+        std::set<std::string> names;
+        for (const auto& layer : layers)
+        {
+            FALCOR_CHECK(!layer.name.empty(), "Layers written to a multi-part EXR file must be named.");
+            FALCOR_CHECK(names.insert(layer.name).second, "Duplicate EXR layer name '{}'.", layer.name);
+        }
+    }
+    else
+    {
+        for (const auto& layer : layers)
+        {
+            FALCOR_CHECK(
+                layer.width == layers[0].width && layer.height == layers[0].height,
+                "Layers written to a single-part EXR file must have identical dimensions."
+            );
+        }
+    }
+
+    // Set up one header and frame buffer per part.
+    size_t partCount = multiPart ? layers.size() : 1;
+    std::vector<Imf::Header> headers;
+    std::vector<Imf::FrameBuffer> frameBuffers(partCount);
+    for (size_t i = 0; i < partCount; i++)
+    {
+        Imf::Header header((int)layers[i].width, (int)layers[i].height);
+        header.compression() = getImfCompression(options.compression);
+        if (options.compression == Compression::DWAA || options.compression == Compression::DWAB)
+            Imf::addDwaCompressionLevel(header, options.dwaCompressionLevel);
+        if (multiPart)
+        {
+            header.setName(layers[i].name);
+            header.setType(Imf::SCANLINEIMAGE);
+        }
+        headers.push_back(header);
+    }
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        size_t part = multiPart ? i : 0;
+        addLayer(layers[i], headers[part], frameBuffers[part]);
+    }
+
+    try
+    {
+        Imf::MultiPartOutputFile file(path.string().c_str(), headers.data(), (int)headers.size(), false, prepareThreads(options.threadCount));
+        for (size_t i = 0; i < partCount; i++)
+        {
+            Imf::OutputPart part(file, (int)i);
+            part.setFrameBuffer(frameBuffers[i]);
+            part.writePixels((int)headers[i].dataWindow().size().y + 1);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        FALCOR_THROW("Failed to write EXR file '{}': {}", path, e.what());
+    }
+}
+} // namespace Falcor
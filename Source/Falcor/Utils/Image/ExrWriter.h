@@ -0,0 +1,146 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Native OpenEXR writer.
+ *
+ * Writes scanline EXR files directly from caller-provided pixel data, without an intermediate Bitmap copy.
+ * Each channel can be stored as half or float independently of the source format, and compression of the
+ * line blocks is distributed over multiple threads. Several layers (e.g. AOVs of a capture) can be written
+ * to a single file, either as separate parts of a multi-part file or as prefixed channels of a single part.
+ */
+class FALCOR_API ExrWriter
+{
+public:
+    /// Compression of the line blocks. See the OpenEXR documentation for details.
+    enum class Compression
+    {
+        None,
+        RLE,   ///< Run length encoding, lossless.
+        ZIPS,  ///< Zlib compression of single scanlines, lossless.
+        ZIP,   ///< Zlib compression of 16 scanline blocks, lossless.
+        PIZ,   ///< Wavelet compression of 32 scanline blocks, lossless. Good for noisy images.
+        PXR24, ///< Lossy for float channels (rounded to 24 bits), lossless for half channels.
+        B44,   ///< Lossy compression of half channels with a fixed rate. Float channels are stored uncompressed.
+        DWAA,  ///< Lossy DCT based compression of 32 scanline blocks.
+        DWAB,  ///< Lossy DCT based compression of 256 scanline blocks.
+    };
+
+    /// Pixel type of a channel in the file.
+    enum class PixelType
+    {
+        Half,
+        Float,
+    };
+
+    /// Description of a channel to write.
+    struct Channel
+    {
+        std::string name;                       ///< Channel name, e.g. "R". Prefixed with the layer name in the file.
+        uint32_t sourceChannel = 0;             ///< Index of the channel in the source pixels.
+        PixelType pixelType = PixelType::Float; ///< Pixel type stored in the file.
+    };
+
+    /// Description of a layer to write. The pixel data is referenced, not copied.
+    struct Layer
+    {
+        std::string name;                                ///< Layer name. Used as part name and as channel name prefix ("name.R").
+        uint32_t width = 0;                              ///< Width in pixels.
+        uint32_t height = 0;                             ///< Height in pixels.
+        ResourceFormat format = ResourceFormat::Unknown; ///< Format of the source pixels. Must be a 16-bit or 32-bit float format.
+        const void* pData = nullptr;                     ///< Source pixels in top-down order. Must stay valid until write() returns.
+        size_t rowPitch = 0;                             ///< Size of a source row in bytes, or 0 if rows are tightly packed.
+        std::vector<Channel> channels;                   ///< Channels to write.
+    };
+
+    struct Options
+    {
+        Compression compression = Compression::ZIP; ///< Compression of the line blocks.
+        float dwaCompressionLevel = 45.f;           ///< Compression level for DWAA/DWAB. Higher values give smaller files.
+        uint32_t threadCount = 0;                   ///< Number of threads used for compression, or 0 for the number of hardware threads.
+        bool multiPart = true;                      ///< Write each layer as a separate part. Otherwise all layers are written to a
+                                                    ///< single part, which requires the layers to have identical dimensions.
+    };
+
+    /**
+     * Get the standard channels (R, G, B, A) of a format.
+     * @param[in] format Format of the source pixels.
+     * @param[in] mask Channels to include. Channels not present in the format are skipped.
+     * @param[in] pixelType Pixel type stored in the file for all channels.
+     * @return List of channels.
+     */
+    static std::vector<Channel> getChannels(
+        ResourceFormat format,
+        TextureChannelFlags mask = TextureChannelFlags::RGBA,
+        PixelType pixelType = PixelType::Float
+    );
+
+    /**
+     * Create a layer with the standard channels of a format.
+     * @param[in] name Layer name, or an empty string for unprefixed channel names.
+     * @param[in] width Width in pixels.
+     * @param[in] height Height in pixels.
+     * @param[in] format Format of the source pixels.
+     * @param[in] pData Source pixels in top-down order, tightly packed.
+     * @param[in] mask Channels to include.
+     * @param[in] pixelType Pixel type stored in the file for all channels.
+     * @return The layer description.
+     */
+    static Layer createLayer(
+        std::string name,
+        uint32_t width,
+        uint32_t height,
+        ResourceFormat format,
+        const void* pData,
+        TextureChannelFlags mask = TextureChannelFlags::RGBA,
+        PixelType pixelType = PixelType::Float
+    );
+
+    /**
+     * Write layers to an EXR file.
+     * Throws an exception if the layers are invalid or the file can't be written.
+     * @param[in] path Path of the file to write.
+     * @param[in] layers Layers to write. Layer names must be unique.
+     * @param[in] options Write options.
+     */
+    static void write(const std::filesystem::path& path, const std::vector<Layer>& layers, const Options& options);
+
+    /**
+     * Write layers to an EXR file using the default options.
+     */
+    static void write(const std::filesystem::path& path, const std::vector<Layer>& layers) { write(path, layers, Options()); }
+};
+} // namespace Falcor
@@ -38,6 +38,7 @@
 #include <nvtt/nvtt.h>
 
 #include <filesystem>
+#include <memory>
 
 namespace Falcor
 {
@@ -55,8 +56,10 @@ struct ImportData
     uint32_t mipLevels;
     bool hasDX10Header = false;
 
-    // Data to be imported
-    std::vector<uint8_t> imageData;
+    // Data to be imported. Points into the memory mapped file, which is kept open as long as the data is used.
+    std::unique_ptr<MemoryMappedFile> pFile;
+    const uint8_t* pImageData = nullptr;
+    size_t imageSize = 0;
 };
 
 struct ExportData
@@ -522,7 +525,8 @@ void readDDSHeader(ImportData& data, const void* pHeaderData, size_t& headerSize
 // Loads the information and data for the specified image. This function does not handle creation of the texture for the image.
 void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& data)
 {
-    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    data.pFile = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    const MemoryMappedFile& file = *data.pFile;
     if (!file.isOpen())
     {
         FALCOR_THROW("Failed to open file.");
@@ -547,10 +551,9 @@ void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& dat
         FALCOR_THROW("No image data after DDS header.");
     }
 
-    // Read image data.
-    size_t imageSize = file.getSize() - headerSize;
-    data.imageData.resize(imageSize);
-    std::memcpy(data.imageData.data(), reinterpret_cast<const uint8_t*>(file.getData()) + headerSize, imageSize);
+    // Reference the image data in place, it is uploaded directly from the file mapping.
+    data.imageSize = file.getSize() - headerSize;
+    data.pImageData = reinterpret_cast<const uint8_t*>(file.getData()) + headerSize;
 }
 } // namespace
 
@@ -574,10 +577,15 @@ Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& p
     }
 
     // Create from first image
-    return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
+    return Bitmap::create(data.width, data.height, data.format, data.pImageData);
 }
 
-ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+ref<Texture> ImageIO::loadTextureFromDDS(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool loadAsSrgb,
+    ResourceBindFlags bindFlags
+)
 {
     ImportData data;
     try
@@ -595,16 +603,16 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
     switch (data.type)
     {
     case Resource::Type::Texture1D:
-        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.pImageData, bindFlags);
         break;
     case Resource::Type::Texture2D:
-        pTex = pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.pImageData, bindFlags);
         break;
     case Resource::Type::TextureCube:
-        pTex = pDevice->createTextureCube(data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTextureCube(data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.pImageData, bindFlags);
         break;
     case Resource::Type::Texture3D:
-        pTex = pDevice->createTexture3D(data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture3D(data.width, data.height, data.depth, data.format, data.mipLevels, data.pImageData, bindFlags);
         break;
     default:
         logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
@@ -86,9 +86,15 @@ public:
      * @param[in] path Path of file to load.
      * @param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not
      * changed.
+     * @param[in] bindFlags The bind flags to create the texture with.
      * @return Texture object containing image data if loading was successful. Otherwise, nullptr.
      */
-    static ref<Texture> loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb);
+    static ref<Texture> loadTextureFromDDS(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
+    );
 
     /**
      * Saves a bitmap to a DDS file.
@@ -26,7 +26,20 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureAnalyzer.h"
+#include "Bitmap.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FALCOR_TEXTURE_ANALYZER_SSE2 1
+#include <emmintrin.h>
+#endif
 
 namespace Falcor
 {
@@ -39,6 +52,302 @@ static_assert((uint32_t)TextureChannelFlags::Blue == 0x4);
 static_assert((uint32_t)TextureChannelFlags::Alpha == 0x8);
 
 const char kShaderFilename[] = "Utils/Image/TextureAnalyzer.cs.slang";
+
+const uint32_t kRangePos = (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos;
+const uint32_t kRangeNeg = (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg;
+const uint32_t kRangeInf = (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf;
+const uint32_t kRangeNaN = (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN;
+
+/// Layout of the bitmap formats supported by the CPU analyzer.
+enum class ComponentType
+{
+    Unorm8,
+    Unorm16,
+    Float16,
+    Float32,
+};
+
+struct BitmapLayout
+{
+    ComponentType type;
+    uint32_t channelCount;    ///< Number of channels stored per texel.
+    bool bgr = false;         ///< Red and blue channels are swapped in memory.
+    bool ignoreAlpha = false; ///< The alpha channel is not used and reads as one.
+};
+
+std::optional<BitmapLayout> getBitmapLayout(ResourceFormat format)
+{
+    switch (format)
+    {
+    case ResourceFormat::R8Unorm:
+        return BitmapLayout{ComponentType::Unorm8, 1};
+    case ResourceFormat::RG8Unorm:
+        return BitmapLayout{ComponentType::Unorm8, 2};
+    case ResourceFormat::RGBA8Unorm:
+    case ResourceFormat::RGBA8UnormSrgb:
+        return BitmapLayout{ComponentType::Unorm8, 4};
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRA8UnormSrgb:
+        return BitmapLayout{ComponentType::Unorm8, 4, true};
+    case ResourceFormat::BGRX8Unorm:
+    case ResourceFormat::BGRX8UnormSrgb:
+        return BitmapLayout{ComponentType::Unorm8, 4, true, true};
+    case ResourceFormat::R16Unorm:
+        return BitmapLayout{ComponentType::Unorm16, 1};
+    case ResourceFormat::RG16Unorm:
+        return BitmapLayout{ComponentType::Unorm16, 2};
+    case ResourceFormat::RGBA16Unorm:
+        return BitmapLayout{ComponentType::Unorm16, 4};
+    case ResourceFormat::R16Float:
+        return BitmapLayout{ComponentType::Float16, 1};
+    case ResourceFormat::RG16Float:
+        return BitmapLayout{ComponentType::Float16, 2};
+    case ResourceFormat::RGBA16Float:
+        return BitmapLayout{ComponentType::Float16, 4};
+    case ResourceFormat::R32Float:
+        return BitmapLayout{ComponentType::Float32, 1};
+    case ResourceFormat::RG32Float:
+        return BitmapLayout{ComponentType::Float32, 2};
+    case ResourceFormat::RGB32Float:
+        return BitmapLayout{ComponentType::Float32, 3};
+    case ResourceFormat::RGBA32Float:
+        return BitmapLayout{ComponentType::Float32, 4};
+    default:
+        return {};
+    }
+}
+
+/// Analysis of a single color channel.
+struct ChannelStats
+{
+    bool varying = false;
+    uint32_t range = 0;
+    float value = 0.f;
+    float minValue = 0.f;
+    float maxValue = 0.f;
+};
+
+using TexelStats = std::array<ChannelStats, 4>;
+
+ChannelStats getConstantChannelStats(float value)
+{
+    ChannelStats stats;
+    stats.range = value > 0.f ? kRangePos : 0;
+    stats.value = stats.minValue = stats.maxValue = value;
+    return stats;
+}
+
+/**
+ * Analyze a bitmap of 8-bit unorm format. For unorm values, all statistics follow from the per-channel min/max values.
+ * The channel stats are returned in memory order.
+ */
+void analyzeUnorm8(const Bitmap& bitmap, uint32_t channelCount, TexelStats& stats)
+{
+    // Byte i of each 16-byte block holds channel i % channelCount, as the channel count divides the block size
+    // and rows start with a texel.
+    FALCOR_ASSERT(16 % channelCount == 0);
+    std::array<uint8_t, 16> minBytes;
+    std::array<uint8_t, 16> maxBytes;
+    minBytes.fill(0xff);
+    maxBytes.fill(0);
+
+    const size_t rowSize = (size_t)bitmap.getWidth() * channelCount;
+#if FALCOR_TEXTURE_ANALYZER_SSE2
+    __m128i vMin = _mm_set1_epi8(-1);
+    __m128i vMax = _mm_setzero_si128();
+#endif
+    for (uint32_t y = 0; y < bitmap.getHeight(); y++)
+    {
+        const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+        size_t i = 0;
+#if FALCOR_TEXTURE_ANALYZER_SSE2
+        for (; i + 16 <= rowSize; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i));
+            vMin = _mm_min_epu8(vMin, v);
+            vMax = _mm_max_epu8(vMax, v);
+        }
+#endif
+        for (; i < rowSize; i++)
+        {
+            minBytes[i % 16] = std::min(minBytes[i % 16], pRow[i]);
+            maxBytes[i % 16] = std::max(maxBytes[i % 16], pRow[i]);
+        }
+    }
+#if FALCOR_TEXTURE_ANALYZER_SSE2
+    std::array<uint8_t, 16> simdMin;
+    std::array<uint8_t, 16> simdMax;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(simdMin.data()), vMin);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(simdMax.data()), vMax);
+    for (size_t i = 0; i < 16; i++)
+    {
+        minBytes[i] = std::min(minBytes[i], simdMin[i]);
+        maxBytes[i] = std::max(maxBytes[i], simdMax[i]);
+    }
+#endif
+
+    for (uint32_t c = 0; c < channelCount; c++)
+    {
+        uint8_t minByte = 0xff;
+        uint8_t maxByte = 0;
+        for (uint32_t i = c; i < 16; i += channelCount)
+        {
+            minByte = std::min(minByte, minBytes[i]);
+            maxByte = std::max(maxByte, maxBytes[i]);
+        }
+
+        // All texels equal the first texel iff min equals max.
+        auto& s = stats[c];
+        s.varying = minByte != maxByte;
+        s.range = maxByte > 0 ? kRangePos : 0;
+        s.value = bitmap.getData()[c] / 255.f;
+        s.minValue = minByte / 255.f;
+        s.maxValue = maxByte / 255.f;
+    }
+}
+
+/// Accumulated statistics of floating-point texels.
+struct FloatStats
+{
+    float4 minValue = float4(std::numeric_limits<float>::max());
+    float4 maxValue = float4(-std::numeric_limits<float>::max());
+    uint32_t varying = 0; ///< Per-channel bit masks.
+    uint32_t pos = 0;
+    uint32_t neg = 0;
+    uint32_t inf = 0;
+    uint32_t nan = 0;
+};
+
+/**
+ * Accumulate statistics of a row of texels. NaN values are ignored in the min/max values, matching the GPU.
+ */
+void accumulateTexels(const float4* pTexels, size_t count, const float4& ref, FloatStats& stats)
+{
+    size_t i = 0;
+#if FALCOR_TEXTURE_ANALYZER_SSE2
+    const __m128 vRef = _mm_loadu_ps(&ref.x);
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 vInfinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 vMin = _mm_loadu_ps(&stats.minValue.x);
+    __m128 vMax = _mm_loadu_ps(&stats.maxValue.x);
+    __m128 vVarying = _mm_setzero_ps();
+    __m128 vPos = _mm_setzero_ps();
+    __m128 vNeg = _mm_setzero_ps();
+    __m128 vInf = _mm_setzero_ps();
+    __m128 vNaN = _mm_setzero_ps();
+    for (; i < count; i++)
+    {
+        __m128 v = _mm_loadu_ps(&pTexels[i].x);
+        vVarying = _mm_or_ps(vVarying, _mm_cmpneq_ps(v, vRef));
+        vPos = _mm_or_ps(vPos, _mm_cmpgt_ps(v, vZero));
+        vNeg = _mm_or_ps(vNeg, _mm_cmplt_ps(v, vZero));
+        vInf = _mm_or_ps(vInf, _mm_cmpeq_ps(_mm_and_ps(v, vAbsMask), vInfinity));
+        vNaN = _mm_or_ps(vNaN, _mm_cmpunord_ps(v, v));
+        // Min/max return the second operand if either operand is NaN.
+        vMin = _mm_min_ps(v, vMin);
+        vMax = _mm_max_ps(v, vMax);
+    }
+    _mm_storeu_ps(&stats.minValue.x, vMin);
+    _mm_storeu_ps(&stats.maxValue.x, vMax);
+    stats.varying |= (uint32_t)_mm_movemask_ps(vVarying);
+    stats.pos |= (uint32_t)_mm_movemask_ps(vPos);
+    stats.neg |= (uint32_t)_mm_movemask_ps(vNeg);
+    stats.inf |= (uint32_t)_mm_movemask_ps(vInf);
+    stats.nan |= (uint32_t)_mm_movemask_ps(vNaN);
+#endif
+    for (; i < count; i++)
+    {
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            const float v = pTexels[i][c];
+            const uint32_t bit = 1u << c;
+            stats.varying |= v != ref[c] ? bit : 0;
+            stats.pos |= v > 0.f ? bit : 0;
+            stats.neg |= v < 0.f ? bit : 0;
+            stats.inf |= std::isinf(v) ? bit : 0;
+            stats.nan |= std::isnan(v) ? bit : 0;
+            if (v < stats.minValue[c])
+                stats.minValue[c] = v;
+            if (v > stats.maxValue[c])
+                stats.maxValue[c] = v;
+        }
+    }
+}
+
+/**
+ * Decode a row of texels to float4. Channels that are not stored keep their value.
+ */
+void decodeRow(const uint8_t* pRow, const BitmapLayout& layout, uint32_t width, std::vector<float>& values, float4* pTexels)
+{
+    const size_t count = (size_t)width * layout.channelCount;
+    values.resize(count);
+    switch (layout.type)
+    {
+    case ComponentType::Unorm16:
+    {
+        const uint16_t* pSrc = reinterpret_cast<const uint16_t*>(pRow);
+        for (size_t i = 0; i < count; i++)
+            values[i] = pSrc[i] / 65535.f;
+        break;
+    }
+    case ComponentType::Float16:
+        math::float16ToFloat32(fstd::span<const uint16_t>(reinterpret_cast<const uint16_t*>(pRow), count), values);
+        break;
+    case ComponentType::Float32:
+        std::memcpy(values.data(), pRow, count * sizeof(float));
+        break;
+    default:
+        FALCOR_UNREACHABLE();
+    }
+
+    for (uint32_t x = 0; x < width; x++)
+    {
+        for (uint32_t c = 0; c < layout.channelCount; c++)
+            pTexels[x][c] = values[(size_t)x * layout.channelCount + c];
+    }
+}
+
+/**
+ * Analyze a bitmap of 16-bit or 32-bit format. The texels are decoded row by row to float4, missing channels read as (0,0,1).
+ */
+void analyzeFloat(const Bitmap& bitmap, const BitmapLayout& layout, TexelStats& stats)
+{
+    const uint32_t width = bitmap.getWidth();
+    std::vector<float> values;
+    std::vector<float4> texels(width, float4(0.f, 0.f, 0.f, 1.f));
+
+    decodeRow(bitmap.getData(), layout, 1, values, texels.data());
+    const float4 ref = texels[0];
+
+    FloatStats floatStats;
+    for (uint32_t y = 0; y < bitmap.getHeight(); y++)
+    {
+        const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+        if (layout.type == ComponentType::Float32 && layout.channelCount == 4)
+        {
+            // Texels are already in the expected layout.
+            accumulateTexels(reinterpret_cast<const float4*>(pRow), width, ref, floatStats);
+            continue;
+        }
+        decodeRow(pRow, layout, width, values, texels.data());
+        accumulateTexels(texels.data(), width, ref, floatStats);
+    }
+
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        const uint32_t bit = 1u << c;
+        auto& s = stats[c];
+        s.varying = (floatStats.varying & bit) != 0;
+        s.range = ((floatStats.pos & bit) ? kRangePos : 0) | ((floatStats.neg & bit) ? kRangeNeg : 0) |
+                  ((floatStats.inf & bit) ? kRangeInf : 0) | ((floatStats.nan & bit) ? kRangeNaN : 0);
+        s.value = ref[c];
+        // Channels with only NaN values don't have a min/max value. These are clamped to zero below, as on the GPU.
+        bool hasValues = floatStats.minValue[c] <= floatStats.maxValue[c];
+        s.minValue = hasValues ? floatStats.minValue[c] : 0.f;
+        s.maxValue = hasValues ? floatStats.maxValue[c] : 0.f;
+    }
+}
 } // namespace
 
 // Verify that the result struct matches the size expected by the shader.
@@ -49,6 +358,57 @@ size_t TextureAnalyzer::getResultSize()
     return sizeof(TextureAnalyzer::Result);
 }
 
+std::optional<TextureAnalyzer::Result> TextureAnalyzer::analyze(const Bitmap& bitmap, bool loadAsSrgb)
+{
+    const ResourceFormat format = bitmap.getFormat();
+    const auto layout = getBitmapLayout(format);
+    if (!layout || bitmap.getWidth() == 0 || bitmap.getHeight() == 0)
+        return {};
+
+    // Gather the channel stats as read by a shader. Channels that are not stored read as (0,0,1).
+    TexelStats stats = {
+        getConstantChannelStats(0.f), getConstantChannelStats(0.f), getConstantChannelStats(0.f), getConstantChannelStats(1.f)
+    };
+    if (layout->type == ComponentType::Unorm8)
+        analyzeUnorm8(bitmap, layout->channelCount, stats);
+    else
+        analyzeFloat(bitmap, *layout, stats);
+
+    if (layout->bgr)
+        std::swap(stats[0], stats[2]);
+    if (layout->ignoreAlpha)
+        stats[3] = getConstantChannelStats(1.f);
+
+    Result result = {};
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        const auto& s = stats[c];
+        result.mask |= (s.varying ? 1u : 0u) << c;
+        result.mask |= s.range << (4 + 4 * c);
+        result.value[c] = s.value;
+        // Clamp to zero to match the GPU analyzer.
+        result.minValue[c] = std::max(s.minValue, 0.f);
+        result.maxValue[c] = std::max(s.maxValue, 0.f);
+    }
+
+    if (isSrgbFormat(format) || (loadAsSrgb && linearToSrgbFormat(format) != format))
+        result = convertToSrgb(result);
+
+    return result;
+}
+
+TextureAnalyzer::Result TextureAnalyzer::convertToSrgb(const Result& result)
+{
+    Result srgbResult = result;
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        srgbResult.value[c] = sRGBToLinear(result.value[c]);
+        srgbResult.minValue[c] = sRGBToLinear(result.minValue[c]);
+        srgbResult.maxValue[c] = sRGBToLinear(result.maxValue[c]);
+    }
+    return srgbResult;
+}
+
 TextureAnalyzer::TextureAnalyzer(ref<Device> pDevice) : mpDevice(pDevice)
 {
     mpClearPass = ComputePass::create(mpDevice, kShaderFilename, "clear");
@@ -33,10 +33,12 @@
 #include "Core/Pass/ComputePass.h"
 #include "Utils/Math/Vector.h"
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace Falcor
 {
+class Bitmap;
 class RenderContext;
 
 /**
@@ -145,6 +147,26 @@ public:
      */
     static size_t getResultSize();
 
+    /**
+     * Analyze a bitmap on the CPU.
+     * This produces the same result as analyzing a texture created from the bitmap on the GPU, but doesn't require the
+     * texture to be created. Texels are interpreted as read by a shader, i.e. unorm formats are normalized, missing
+     * channels read as (0,0,1) and BGR formats are swizzled. The analysis uses SIMD instructions where available.
+     * @param[in] bitmap The bitmap to analyze.
+     * @param[in] loadAsSrgb If true, the result is for a texture created with the corresponding sRGB format (if supported).
+     * @return The analysis result, or an empty optional if the bitmap format is not supported (e.g. compressed formats).
+     */
+    static std::optional<Result> analyze(const Bitmap& bitmap, bool loadAsSrgb = false);
+
+    /**
+     * Convert the result for a texture of 8-bit unorm format to the result for the same data in the corresponding sRGB format.
+     * The color values are converted from sRGB to linear. The alpha channel and the flags are unchanged, as the
+     * conversion is monotonic and maps zero to zero.
+     * @param[in] result Result for the texture in linear format.
+     * @return Result for the texture in sRGB format.
+     */
+    static Result convertToSrgb(const Result& result);
+
 private:
     void checkFormatSupport(const ref<Texture> pInput, uint32_t mipLevel, uint32_t arraySlice) const;
 
@@ -0,0 +1,374 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureCache.h"
+#include "Core/Error.h"
+#include "Core/API/Device.h"
+#include "Core/API/Texture.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CacheFile.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/**
+ * Specifies the current cache entry version.
+ * This needs to be incremented every time the transcoding changes!
+ */
+const uint32_t kVersion = 2;
+
+/**
+ * Default texture cache directory (subdirectory in the application data directory).
+ */
+const std::string kDirectory = "NVIDIA/Falcor/TextureCache";
+
+struct CacheState
+{
+    std::mutex mutex;
+    bool initialized = false;
+    bool compression = true;
+    std::filesystem::path directory;
+    TextureCache::Stats stats;
+};
+
+CacheState& getState()
+{
+    static CacheState state;
+    return state;
+}
+
+void initDirectory(CacheState& state)
+{
+    if (state.initialized)
+        return;
+    if (auto envPath = getEnvironmentVariable("FALCOR_TEXTURE_CACHE_PATH"))
+        state.directory = *envPath;
+    else
+        state.directory = getAppDataDirectory() / kDirectory;
+    state.initialized = true;
+}
+
+double elapsedSeconds(CpuTimer::TimePoint start)
+{
+    return CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) * 1e-3;
+}
+
+/**
+ * Content information stored alongside the image of a cache entry.
+ */
+struct ContentInfo
+{
+    uint32_t version = kVersion;
+    ResourceFormat format = ResourceFormat::Unknown; ///< Format of the source image.
+    std::array<uint8_t, 16> texel = {};              ///< First texel of the source image.
+    TextureAnalyzer::Result analysis = {};           ///< Analysis of the source image in its (linear) format.
+
+    bool isConstant() const { return analysis.isConstant(TextureChannelFlags::RGBA); }
+};
+
+static_assert(std::is_trivially_copyable_v<ContentInfo>);
+
+std::optional<ContentInfo> createContentInfo(const Bitmap& bitmap)
+{
+    auto analysis = TextureAnalyzer::analyze(bitmap);
+    if (!analysis)
+        return {};
+
+    ContentInfo info;
+    info.format = bitmap.getFormat();
+    FALCOR_ASSERT(getFormatBytesPerBlock(info.format) <= info.texel.size());
+    std::memcpy(info.texel.data(), bitmap.getData(), getFormatBytesPerBlock(info.format));
+    info.analysis = *analysis;
+    return info;
+}
+
+std::optional<ContentInfo> readContentInfo(const std::filesystem::path& path)
+{
+    std::ifstream fs(path, std::ios_base::binary);
+    ContentInfo info;
+    if (!fs.read(reinterpret_cast<char*>(&info), sizeof(info)) || info.version != kVersion)
+        return {};
+    return info;
+}
+
+void writeContentInfo(std::ostream& stream, const ContentInfo& info)
+{
+    stream.write(reinterpret_cast<const char*>(&info), sizeof(info));
+}
+
+} // namespace
+
+void TextureCache::setDirectory(const std::filesystem::path& directory)
+{
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.directory = directory;
+    state.initialized = true;
+}
+
+std::filesystem::path TextureCache::getDirectory()
+{
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    initDirectory(state);
+    return state.directory;
+}
+
+void TextureCache::setCompressionEnabled(bool enabled)
+{
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.compression = enabled;
+}
+
+bool TextureCache::isCompressionEnabled()
+{
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.compression;
+}
+
+std::optional<TextureCache::Key> TextureCache::computeKey(
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    Bitmap::ImportFlags importFlags
+)
+{
+    auto t0 = CpuTimer::getCurrentTimePoint();
+
+    std::ifstream fs(path, std::ios_base::binary);
+    if (!fs.good())
+        return {};
+
+    SHA1 sha1;
+    sha1.update(kVersion);
+    sha1.update(generateMipLevels);
+    sha1.update((uint32_t)importFlags);
+    sha1.update(isCompressionEnabled());
+
+    std::vector<char> buffer(1024 * 1024);
+    while (fs)
+    {
+        fs.read(buffer.data(), buffer.size());
+        sha1.update(buffer.data(), (size_t)fs.gcount());
+    }
+    if (fs.bad())
+        return {};
+
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stats.hashTime += elapsedSeconds(t0);
+    return sha1.finalize();
+}
+
+std::optional<ImageIO::CompressionMode> TextureCache::getCompressionMode(const Bitmap& bitmap)
+{
+    // Only formats that are transcoded losslessly by ImageIO::saveToDDS() when stored uncompressed are supported.
+    // Block compression requires the base level dimensions to be a multiple of 4.
+    bool compress = isCompressionEnabled() && bitmap.getWidth() % 4 == 0 && bitmap.getHeight() % 4 == 0;
+    switch (bitmap.getFormat())
+    {
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRX8Unorm:
+        return compress ? ImageIO::CompressionMode::BC7 : ImageIO::CompressionMode::None;
+    case ResourceFormat::RGB32Float:
+        return compress ? ImageIO::CompressionMode::BC6 : ImageIO::CompressionMode::None;
+    case ResourceFormat::RGBA32Float:
+    case ResourceFormat::RGBA16Float:
+        return ImageIO::CompressionMode::None;
+    case ResourceFormat::R8Unorm:
+        // Uncompressed single channel images would be expanded to four channels.
+        if (compress)
+            return ImageIO::CompressionMode::BC4;
+        return {};
+    case ResourceFormat::RG8Unorm:
+        // Two channel images can only be stored with BC5.
+        if (compress)
+            return ImageIO::CompressionMode::BC5;
+        return {};
+    default:
+        return {};
+    }
+}
+
+ref<Texture> TextureCache::read(
+    ref<Device> pDevice,
+    const Key& key,
+    bool loadAsSrgb,
+    ResourceBindFlags bindFlags,
+    std::optional<TextureAnalyzer::Result>* pAnalysis
+)
+{
+    auto t0 = CpuTimer::getCurrentTimePoint();
+
+    ref<Texture> pTexture;
+    std::optional<ContentInfo> info;
+    auto directory = getDirectory();
+    if (!directory.empty())
+    {
+        info = readContentInfo(getContentInfoPath(directory, key));
+        auto path = getEntryPath(directory, key);
+        if (info && info->isConstant())
+        {
+            // Constant images are stored without image data. Create a texture with a single texel, which samples identically.
+            try
+            {
+                ResourceFormat format = loadAsSrgb ? linearToSrgbFormat(info->format) : info->format;
+                pTexture = pDevice->createTexture2D(1, 1, format, 1, 1, info->texel.data(), bindFlags);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to create constant texture for texture cache entry {}: {}", SHA1::toString(key), e.what());
+            }
+        }
+        else if (std::filesystem::exists(path))
+        {
+            try
+            {
+                pTexture = ImageIO::loadTextureFromDDS(pDevice, path, loadAsSrgb, bindFlags);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to read texture cache entry {}: {}", SHA1::toString(key), e.what());
+            }
+
+            // Entries are written atomically, so an entry that fails to load is corrupt and is removed to be rewritten.
+            if (!pTexture)
+            {
+                std::error_code ec;
+                std::filesystem::remove(path, ec);
+            }
+        }
+    }
+
+    if (pTexture && info && pAnalysis)
+    {
+        // Convert the analysis if the texture is created with the sRGB variant of the source format.
+        bool srgb = loadAsSrgb && linearToSrgbFormat(info->format) != info->format;
+        *pAnalysis = srgb ? TextureAnalyzer::convertToSrgb(info->analysis) : info->analysis;
+    }
+
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (pTexture)
+    {
+        state.stats.hitCount++;
+        if (info && info->isConstant())
+            state.stats.constantCount++;
+        state.stats.readTime += elapsedSeconds(t0);
+    }
+    else
+    {
+        state.stats.missCount++;
+    }
+    return pTexture;
+}
+
+bool TextureCache::write(const Key& key, const Bitmap& bitmap, bool generateMipLevels)
+{
+    auto t0 = CpuTimer::getCurrentTimePoint();
+
+    auto directory = getDirectory();
+    if (directory.empty())
+        return false;
+
+    // Analyze the source image. Constant images are stored without image data, so their format doesn't need to be supported.
+    std::optional<ContentInfo> info = createContentInfo(bitmap);
+    bool isConstant = info && info->isConstant();
+
+    std::optional<ImageIO::CompressionMode> mode;
+    if (!isConstant)
+    {
+        mode = getCompressionMode(bitmap);
+        if (!mode)
+        {
+            logDebug("Texture format {} is not supported by the texture cache.", to_string(bitmap.getFormat()));
+            return false;
+        }
+    }
+
+    try
+    {
+        // Write the image first, so that readers finding the content info of a non-constant entry also find its image.
+        if (!isConstant)
+        {
+            writeFileAtomic(
+                getEntryPath(directory, key),
+                [&](const std::filesystem::path& path) { ImageIO::saveToDDS(path, bitmap, *mode, generateMipLevels); }
+            );
+        }
+        if (info)
+        {
+            writeFileAtomic(getContentInfoPath(directory, key), [&](std::ostream& stream) { writeContentInfo(stream, *info); });
+        }
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Failed to write texture cache entry {}: {}", SHA1::toString(key), e.what());
+        return false;
+    }
+
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stats.writeCount++;
+    state.stats.writeTime += elapsedSeconds(t0);
+    return true;
+}
+
+TextureCache::Stats TextureCache::getStats()
+{
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.stats;
+}
+
+void TextureCache::resetStats()
+{
+    auto& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stats = {};
+}
+
+std::filesystem::path TextureCache::getEntryPath(const std::filesystem::path& directory, const Key& key)
+{
+    return directory / (SHA1::toString(key) + ".dds");
+}
+
+std::filesystem::path TextureCache::getContentInfoPath(const std::filesystem::path& directory, const Key& key)
+{
+    return directory / (SHA1::toString(key) + ".info");
+}
+} // namespace Falcor
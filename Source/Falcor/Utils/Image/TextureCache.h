@@ -0,0 +1,165 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "TextureAnalyzer.h"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/Resource.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <optional>
+
+namespace Falcor
+{
+/**
+ * Persistent on-disk cache of transcoded textures.
+ *
+ * Decoding PNG/JPG/EXR images and generating their mip chains is repeated every time a scene is loaded, and the
+ * resulting textures are stored uncompressed. The cache stores the decoded image as a DDS file with block compression
+ * (where the format allows it) and a precomputed mip chain. Later loads create the texture directly from the memory
+ * mapped DDS file, which is both faster and uses less memory on the GPU.
+ *
+ * Entries are keyed on the content hash of the source file, the import flags, the mip setting and the compression
+ * setting, so modified files never return stale results. The sRGB flag and bind flags are applied when reading an
+ * entry and are not part of the key. Entries are written atomically, so the cache can be shared between processes.
+ *
+ * Block compression is lossy. Compression can be disabled with setCompressionEnabled(), in which case textures are
+ * cached uncompressed with mips.
+ *
+ * Each entry also stores the CPU analysis of the source image (see TextureAnalyzer::analyze()), which is returned
+ * when reading the entry. Images where all texels are identical don't store any image data, these entries are read
+ * as a texture with a single texel.
+ *
+ * The cache directory defaults to a subdirectory of the application data directory and can be overridden
+ * with the FALCOR_TEXTURE_CACHE_PATH environment variable or setDirectory(). An empty directory disables the cache.
+ */
+class FALCOR_API TextureCache
+{
+public:
+    using Key = SHA1::MD;
+
+    struct Stats
+    {
+        uint64_t hitCount = 0;      ///< Number of lookups that returned a valid entry.
+        uint64_t missCount = 0;     ///< Number of lookups without a valid entry.
+        uint64_t writeCount = 0;    ///< Number of entries written.
+        uint64_t constantCount = 0; ///< Number of hits that returned a constant texture without reading image data.
+        double hashTime = 0.0;      ///< Time spent hashing source files in seconds.
+        double readTime = 0.0;      ///< Time spent reading cache entries in seconds.
+        double writeTime = 0.0;     ///< Time spent transcoding and writing cache entries in seconds.
+    };
+
+    /**
+     * Set the cache directory.
+     * @param[in] directory Cache directory. An empty path disables the cache.
+     */
+    static void setDirectory(const std::filesystem::path& directory);
+
+    /**
+     * Get the cache directory. Returns an empty path if the cache is disabled.
+     */
+    static std::filesystem::path getDirectory();
+
+    /**
+     * Check if the cache is enabled.
+     */
+    static bool isEnabled() { return !getDirectory().empty(); }
+
+    /**
+     * Enable/disable block compression of cache entries. Enabled by default.
+     */
+    static void setCompressionEnabled(bool enabled);
+
+    /**
+     * Check if block compression of cache entries is enabled.
+     */
+    static bool isCompressionEnabled();
+
+    /**
+     * Compute the cache key for a texture.
+     * @param[in] path File path of the source image.
+     * @param[in] generateMipLevels Whether the texture has a full mip chain.
+     * @param[in] importFlags Flags used when importing the source image.
+     * @return The cache key, or an empty optional if the source file can't be read.
+     */
+    static std::optional<Key> computeKey(const std::filesystem::path& path, bool generateMipLevels, Bitmap::ImportFlags importFlags);
+
+    /**
+     * Get the compression mode used to store a bitmap.
+     * BC7 is used for 8-bit color, BC4/BC5 for one/two channel 8-bit images and BC6 for RGB floating point images.
+     * Block compression requires the dimensions to be a multiple of 4, other images are stored uncompressed.
+     * @param[in] bitmap The bitmap to store.
+     * @return The compression mode, or an empty optional if the bitmap format can't be cached.
+     */
+    static std::optional<ImageIO::CompressionMode> getCompressionMode(const Bitmap& bitmap);
+
+    /**
+     * Read a cache entry.
+     * @param[in] pDevice GPU device.
+     * @param[in] key Cache key.
+     * @param[in] loadAsSrgb If true, create the texture with the corresponding sRGB format.
+     * @param[in] bindFlags The bind flags to create the texture with.
+     * @param[out] pAnalysis Optional pointer to receive the analysis of the source image for the created texture format.
+     * The analysis is left unchanged if not available.
+     * @return The texture, or nullptr if no valid entry was found.
+     */
+    static ref<Texture> read(
+        ref<Device> pDevice,
+        const Key& key,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags,
+        std::optional<TextureAnalyzer::Result>* pAnalysis = nullptr
+    );
+
+    /**
+     * Write a cache entry. Failures are logged but not considered an error.
+     * The source image is analyzed and constant images are stored without image data, regardless of their format.
+     * @param[in] key Cache key.
+     * @param[in] bitmap Decoded source image.
+     * @param[in] generateMipLevels If true, a full mip chain is generated and stored.
+     * @return True if the entry was written.
+     */
+    static bool write(const Key& key, const Bitmap& bitmap, bool generateMipLevels);
+
+    /**
+     * Get the cache statistics.
+     */
+    static Stats getStats();
+
+    /**
+     * Reset the cache statistics.
+     */
+    static void resetStats();
+
+private:
+    static std::filesystem::path getEntryPath(const std::filesystem::path& directory, const Key& key);
+    static std::filesystem::path getContentInfoPath(const std::filesystem::path& directory, const Key& key);
+};
+} // namespace Falcor
@@ -28,10 +28,13 @@
 #include "TextureManager.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
 
 #include <execution>
+#include <fstream>
+#include <numeric>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
 // Until then `TextureManager` should only called from the main thread.
@@ -43,6 +46,19 @@ namespace
 {
 const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
 static_assert(TextureManager::CpuTextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+const bool kTopDown = true; // Memory layout when loading from file, matching Texture::createFromFile().
+
+// Content hashes are prefixed by their kind, so that file and pixel hashes can share one map.
+const uint8_t kFileContentHash = 0;
+const uint8_t kPixelContentHash = 1;
+
+void hashLoadOptions(SHA1& sha1, bool generateMipLevels, bool loadAsSRGB, ResourceBindFlags bindFlags)
+{
+    sha1.update(generateMipLevels);
+    sha1.update(loadAsSRGB);
+    sha1.update((uint32_t)bindFlags);
+}
 } // namespace
 
 TextureManager::TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount)
@@ -324,25 +340,28 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
 #else
         // Load texture from main thread.
         ref<Texture> pTexture;
-        if (paths.size() > 1)
+        std::optional<TextureAnalyzer::Result> analysis;
+        if (mContentDeduplication)
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags, importFlags);
+            ContentLoad load = loadTextureContent(textureKey, hashFileContent(textureKey));
+            registerContent(load);
+            pTexture = load.pTexture;
+            analysis = load.analysis;
         }
         else
         {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags);
+            pTexture = loadTextureFromFiles(textureKey, analysis);
         }
 
         // Add new texture desc.
-        TextureDesc desc = {TextureState::Loaded, pTexture};
+        TextureDesc desc = {TextureState::Loaded, pTexture, analysis};
         handle = addDesc(desc);
 
         // Add to key-to-handle map.
         mKeyToHandle[textureKey] = handle;
 
         // Add to texture-to-handle map.
-        if (pTexture)
-            mTextureToHandle[pTexture.get()] = handle;
+        registerTexture(pTexture, handle);
 
         mCondition.notify_all();
 #endif
@@ -407,30 +426,64 @@ void TextureManager::endDeferredLoading()
     if (jobs.empty())
         return;
 
+    // Determine which jobs to load. With content deduplication, the file contents are hashed first
+    // and of all jobs with identical files only the first one is loaded.
+    std::vector<size_t> loadJobs;
+    std::vector<size_t> sourceJobs(jobs.size());
+    std::vector<ContentLoad> contentLoads;
+    if (mContentDeduplication)
+    {
+        contentLoads.resize(jobs.size());
+        NumericRange<size_t> hashRange(0, jobs.size());
+        std::for_each(
+            std::execution::par,
+            hashRange.begin(),
+            hashRange.end(),
+            [&](size_t i) { contentLoads[i].fileHash = hashFileContent(jobs[i].key); }
+        );
+
+        std::map<SHA1::MD, size_t> firstJobs;
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            auto [it, inserted] = firstJobs.try_emplace(contentLoads[i].fileHash, i);
+            sourceJobs[i] = it->second;
+            if (inserted)
+                loadJobs.push_back(i);
+        }
+    }
+    else
+    {
+        loadJobs.resize(jobs.size());
+        std::iota(loadJobs.begin(), loadJobs.end(), 0);
+        std::iota(sourceJobs.begin(), sourceJobs.end(), 0);
+    }
+
     // Load textures in parallel.
     std::atomic<size_t> texturesLoaded;
-    NumericRange<size_t> jobRange(0, jobs.size());
+    NumericRange<size_t> jobRange(0, loadJobs.size());
     std::for_each(
         std::execution::par_unseq,
         jobRange.begin(),
         jobRange.end(),
-        [&](size_t i)
+        [&](size_t j)
         {
+            const size_t i = loadJobs[j];
             const auto& job = jobs[i];
             auto& desc = getDesc(job.handle);
-            if (job.key.fullPaths.size() == 1)
+            if (mContentDeduplication)
             {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags
-                );
-                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
+                contentLoads[i] = loadTextureContent(job.key, contentLoads[i].fileHash);
+                desc.pTexture = contentLoads[i].pTexture;
+                desc.analysis = contentLoads[i].analysis;
             }
             else
             {
-                desc.pTexture =
-                    Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags);
-                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
+                desc.pTexture = loadTextureFromFiles(job.key, desc.analysis);
             }
+            if (job.key.fullPaths.size() == 1)
+                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
+            else
+                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
             if (texturesLoaded.fetch_add(1) % 10 == 9)
             {
                 logDebug("Flush");
@@ -441,15 +494,63 @@ void TextureManager::endDeferredLoading()
     );
     mpDevice->wait();
 
+    // Resolve duplicates. Textures loaded in this batch with identical decoded pixels are shared,
+    // and jobs that were skipped due to identical files get the texture of the job that was loaded.
+    if (mContentDeduplication)
+    {
+        for (size_t i : loadJobs)
+        {
+            auto& load = contentLoads[i];
+            if (load.pixelHash)
+            {
+                if (auto pTexture = findTextureByContent(*load.pixelHash))
+                    load.pTexture = pTexture;
+            }
+            registerContent(load);
+            getDesc(jobs[i].handle).pTexture = load.pTexture;
+        }
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            const auto& sourceDesc = getDesc(jobs[sourceJobs[i]].handle);
+            auto& desc = getDesc(jobs[i].handle);
+            desc.pTexture = sourceDesc.pTexture;
+            desc.analysis = sourceDesc.analysis;
+        }
+    }
+
     // Mark loaded textures and add them to lookup table.
     for (const auto& job : jobs)
     {
         auto& desc = getDesc(job.handle);
         desc.state = desc.pTexture ? TextureState::Loaded : TextureState::Invalid;
-        mTextureToHandle[desc.pTexture.get()] = job.handle;
+        registerTexture(desc.pTexture, job.handle);
     }
 }
 
+void TextureManager::setContentDeduplication(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mContentDeduplication = enabled;
+}
+
+bool TextureManager::isContentDeduplicationEnabled() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mContentDeduplication;
+}
+
+void TextureManager::setTextureCache(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTextureCache = enabled;
+}
+
+bool TextureManager::isTextureCacheEnabled() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTextureCache;
+}
+
 void TextureManager::removeTexture(const CpuTextureHandle& handle)
 {
     if (!handle)
@@ -494,8 +595,30 @@ void TextureManager::removeNonUdimTexture(const CpuTextureHandle& handle)
 
     if (desc.pTexture)
     {
-        FALCOR_ASSERT(mTextureToHandle.find(desc.pTexture.get()) != mTextureToHandle.end());
-        mTextureToHandle.erase(desc.pTexture.get());
+        const Texture* pTexture = desc.pTexture.get();
+        FALCOR_ASSERT(mTextureToHandle.find(pTexture) != mTextureToHandle.end());
+        if (auto it = mTextureShareCount.find(pTexture); it != mTextureShareCount.end())
+        {
+            // The texture is shared with other handles due to content deduplication. Keep it managed under one of them.
+            if (--it->second == 0)
+                mTextureShareCount.erase(it);
+            if (mTextureToHandle[pTexture] == handle)
+            {
+                auto other = std::find_if(
+                    mTextureDescs.begin(), mTextureDescs.end(), [&](const TextureDesc& d) { return &d != &desc && d.pTexture.get() == pTexture; }
+                );
+                FALCOR_ASSERT(other != mTextureDescs.end());
+                mTextureToHandle[pTexture] = CpuTextureHandle{static_cast<uint32_t>(std::distance(mTextureDescs.begin(), other))};
+            }
+        }
+        else
+        {
+            mTextureToHandle.erase(pTexture);
+
+            // Remove content hashes referring to the texture.
+            for (auto it = mContentToTexture.begin(); it != mContentToTexture.end();)
+                it = it->second.get() == pTexture ? mContentToTexture.erase(it) : std::next(it);
+        }
     }
 
     // Clear texture desc.
@@ -550,6 +673,12 @@ TextureManager::TextureDesc TextureManager::getTextureDesc(const CpuTextureHandl
     return mTextureDescs[handle.getID()];
 }
 
+std::optional<TextureAnalyzer::Result> TextureManager::getTextureAnalysis(const Texture* pTexture) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return findAnalysis(pTexture);
+}
+
 size_t TextureManager::getTextureDescCount() const
 {
     std::lock_guard<std::mutex> lock(mMutex);
@@ -629,10 +758,18 @@ TextureManager::Stats TextureManager::getStats() const
 {
     std::lock_guard<std::mutex> lock(mMutex);
     TextureManager::Stats s;
+    std::set<const Texture*> textures;
     for (const auto& t : mTextureDescs)
     {
         if (!t.pTexture)
             continue;
+        // Textures shared by multiple handles due to content deduplication are only counted once.
+        if (!textures.insert(t.pTexture.get()).second)
+        {
+            s.textureDeduplicatedCount++;
+            s.textureDeduplicatedMemoryInBytes += t.pTexture->getTextureSizeInBytes();
+            continue;
+        }
         uint64_t texelCount = t.pTexture->getTexelCount();
         uint32_t channelCount = getFormatChannelCount(t.pTexture->getFormat());
         s.textureCount++;
@@ -676,6 +813,199 @@ TextureManager::TextureDesc& TextureManager::getDesc(const CpuTextureHandle& han
     return mTextureDescs[handle.getID()];
 }
 
+void TextureManager::registerTexture(const ref<Texture>& pTexture, const CpuTextureHandle& handle)
+{
+    // Add to texture-to-handle map. With content deduplication the texture can already be managed under another handle,
+    // in which case the texture keeps its first handle and is marked as shared.
+    if (!pTexture)
+        return;
+    if (!mTextureToHandle.try_emplace(pTexture.get(), handle).second)
+        mTextureShareCount[pTexture.get()]++;
+}
+
+SHA1::MD TextureManager::hashFileContent(const TextureKey& key)
+{
+    SHA1 sha1;
+    sha1.update(kFileContentHash);
+    hashLoadOptions(sha1, key.generateMipLevels, key.loadAsSRGB, key.bindFlags);
+    sha1.update((uint32_t)key.importFlags);
+
+    std::vector<char> buffer(64 * 1024);
+    for (const auto& path : key.fullPaths)
+    {
+        std::ifstream fs(path, std::ios_base::binary);
+        uint64_t size = 0;
+        while (fs)
+        {
+            fs.read(buffer.data(), buffer.size());
+            sha1.update(buffer.data(), (size_t)fs.gcount());
+            size += (uint64_t)fs.gcount();
+        }
+        // Terminate each file with its size so that the mip levels of mipped textures can't alias.
+        sha1.update(size);
+    }
+    return sha1.finalize();
+}
+
+SHA1::MD TextureManager::hashPixelContent(const Bitmap& bitmap, const TextureKey& key)
+{
+    SHA1 sha1;
+    sha1.update(kPixelContentHash);
+    hashLoadOptions(sha1, key.generateMipLevels, key.loadAsSRGB, key.bindFlags);
+    sha1.update(bitmap.getWidth());
+    sha1.update(bitmap.getHeight());
+    sha1.update((uint32_t)bitmap.getFormat());
+    sha1.update(bitmap.getData(), bitmap.getSize());
+    return sha1.finalize();
+}
+
+ref<Texture> TextureManager::loadTextureFromFiles(const TextureKey& key, std::optional<TextureAnalyzer::Result>& analysis) const
+{
+    if (key.fullPaths.size() > 1)
+        return Texture::createMippedFromFiles(mpDevice, key.fullPaths, key.loadAsSRGB, key.bindFlags, key.importFlags);
+    if (hasExtension(key.fullPaths[0], "dds"))
+        return Texture::createFromFile(mpDevice, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags);
+
+    std::optional<TextureCache::Key> cacheKey = getTextureCacheKey(key);
+    if (cacheKey)
+    {
+        ref<Texture> pTexture = loadTextureFromCache(key, *cacheKey, analysis);
+        if (pTexture)
+            return pTexture;
+    }
+
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(key.fullPaths[0], kTopDown, key.importFlags);
+    return pBitmap ? createTextureFromBitmap(key, *pBitmap, cacheKey, analysis) : nullptr;
+}
+
+std::optional<TextureCache::Key> TextureManager::getTextureCacheKey(const TextureKey& key) const
+{
+    // Only textures loaded from a single image file are cached. Block compressed textures can't be bound
+    // for unordered access or as render targets, so textures requesting these bind flags are loaded as usual.
+    if (!mTextureCache || key.fullPaths.size() != 1 || hasExtension(key.fullPaths[0], "dds"))
+        return {};
+    if (is_set(key.bindFlags, ResourceBindFlags::UnorderedAccess) || is_set(key.bindFlags, ResourceBindFlags::RenderTarget))
+        return {};
+    if (!TextureCache::isEnabled())
+        return {};
+    return TextureCache::computeKey(key.fullPaths[0], key.generateMipLevels, key.importFlags);
+}
+
+ref<Texture> TextureManager::loadTextureFromCache(
+    const TextureKey& key,
+    const TextureCache::Key& cacheKey,
+    std::optional<TextureAnalyzer::Result>& analysis
+) const
+{
+    ref<Texture> pTexture = TextureCache::read(mpDevice, cacheKey, key.loadAsSRGB, key.bindFlags, &analysis);
+    if (pTexture)
+    {
+        // Report the original image as source, the cache entry is an implementation detail.
+        pTexture->setSourcePath(key.fullPaths[0]);
+        pTexture->setImportFlags(key.importFlags);
+        logDebug("Loaded texture '{}' from texture cache.", key.fullPaths[0]);
+    }
+    return pTexture;
+}
+
+ref<Texture> TextureManager::createTextureFromBitmap(
+    const TextureKey& key,
+    const Bitmap& bitmap,
+    const std::optional<TextureCache::Key>& cacheKey,
+    std::optional<TextureAnalyzer::Result>& analysis
+) const
+{
+    // Create the texture from the newly written cache entry, so that the first load matches all later loads.
+    // Fall back to the uncompressed bitmap if the format can't be cached or the entry can't be written.
+    if (cacheKey && TextureCache::write(*cacheKey, bitmap, key.generateMipLevels))
+    {
+        ref<Texture> pTexture = loadTextureFromCache(key, *cacheKey, analysis);
+        if (pTexture)
+            return pTexture;
+    }
+
+    ref<Texture> pTexture = Texture::createFromBitmap(mpDevice, bitmap, key.generateMipLevels, key.loadAsSRGB, key.bindFlags);
+    if (pTexture)
+    {
+        pTexture->setSourcePath(key.fullPaths[0]);
+        pTexture->setImportFlags(key.importFlags);
+
+        // Analyze the texture contents while the decoded image is still in host memory.
+        analysis = TextureAnalyzer::analyze(bitmap, key.loadAsSRGB);
+    }
+    return pTexture;
+}
+
+TextureManager::ContentLoad TextureManager::loadTextureContent(const TextureKey& key, const SHA1::MD& fileHash) const
+{
+    // Note: This only reads the content and texture maps. The caller either holds the mutex or is in the parallel phase of
+    // endDeferredLoading(), during which the maps are not modified.
+    ContentLoad load;
+    load.fileHash = fileHash;
+
+    // Share a texture loaded from identical files.
+    load.pTexture = findTextureByContent(fileHash);
+    if (load.pTexture)
+    {
+        load.analysis = findAnalysis(load.pTexture.get());
+        return load;
+    }
+
+    // Mipped textures and DDS files are only deduplicated by file contents.
+    if (key.fullPaths.size() > 1 || hasExtension(key.fullPaths[0], "dds"))
+    {
+        load.pTexture = loadTextureFromFiles(key, load.analysis);
+        return load;
+    }
+
+    // Load from the texture cache. This skips decoding, so textures loaded from the cache are only deduplicated by file contents.
+    std::optional<TextureCache::Key> cacheKey = getTextureCacheKey(key);
+    if (cacheKey)
+    {
+        load.pTexture = loadTextureFromCache(key, *cacheKey, load.analysis);
+        if (load.pTexture)
+            return load;
+    }
+
+    // Decode the image and share a texture with identical pixels. This catches images that only differ in metadata.
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(key.fullPaths[0], kTopDown, key.importFlags);
+    if (!pBitmap)
+        return load;
+
+    load.pixelHash = hashPixelContent(*pBitmap, key);
+    load.pTexture = findTextureByContent(*load.pixelHash);
+    if (load.pTexture)
+    {
+        logDebug("Texture '{}' has identical content to the texture loaded from '{}'.", key.fullPaths[0], load.pTexture->getSourcePath());
+        load.analysis = findAnalysis(load.pTexture.get());
+        return load;
+    }
+
+    load.pTexture = createTextureFromBitmap(key, *pBitmap, cacheKey, load.analysis);
+    return load;
+}
+
+std::optional<TextureAnalyzer::Result> TextureManager::findAnalysis(const Texture* pTexture) const
+{
+    auto it = mTextureToHandle.find(pTexture);
+    return it != mTextureToHandle.end() ? mTextureDescs[it->second.getID()].analysis : std::nullopt;
+}
+
+ref<Texture> TextureManager::findTextureByContent(const SHA1::MD& hash) const
+{
+    auto it = mContentToTexture.find(hash);
+    return it != mContentToTexture.end() ? it->second : nullptr;
+}
+
+void TextureManager::registerContent(const ContentLoad& load)
+{
+    if (!load.pTexture)
+        return;
+    mContentToTexture.try_emplace(load.fileHash, load.pTexture);
+    if (load.pixelHash)
+        mContentToTexture.try_emplace(*load.pixelHash, load.pTexture);
+}
+
 void TextureManager::registerOwner(const CpuTextureHandle& handle, const Object* owner)
 {
     // Register object as owner of texture.
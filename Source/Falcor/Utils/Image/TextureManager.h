@@ -27,17 +27,21 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "TextureAnalyzer.h"
+#include "TextureCache.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
 #include "Core/Program/ShaderVar.h"
 #include "Scene/Material/TextureHandle.slang"
+#include "Utils/CryptoUtils.h"
 #include <condition_variable>
 #include <limits>
 #include <map>
 #include <set>
 #include <memory>
+#include <optional>
 #include <mutex>
 #include <thread>
 
@@ -68,11 +72,13 @@ public:
 
     struct Stats
     {
-        uint64_t textureCount = 0;             ///< Number of unique textures. A texture can be referenced by multiple materials.
-        uint64_t textureCompressedCount = 0;   ///< Number of unique compressed textures.
-        uint64_t textureTexelCount = 0;        ///< Total number of texels in all textures.
-        uint64_t textureTexelChannelCount = 0; ///< Total number of texel channels in all textures.
-        uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures.
+        uint64_t textureCount = 0;                     ///< Number of unique textures. A texture can be referenced by multiple materials.
+        uint64_t textureCompressedCount = 0;           ///< Number of unique compressed textures.
+        uint64_t textureTexelCount = 0;                ///< Total number of texels in all textures.
+        uint64_t textureTexelChannelCount = 0;         ///< Total number of texel channels in all textures.
+        uint64_t textureMemoryInBytes = 0;             ///< Total memory in bytes used by the textures.
+        uint64_t textureDeduplicatedCount = 0;         ///< Number of loaded textures that share a texture with identical content.
+        uint64_t textureDeduplicatedMemoryInBytes = 0; ///< Total memory in bytes saved by sharing textures with identical content.
     };
 
     /**
@@ -132,8 +138,9 @@ public:
     /// Struct describing a managed texture.
     struct TextureDesc
     {
-        TextureState state = TextureState::Invalid; ///< Current state of the texture.
-        ref<Texture> pTexture;                      ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        TextureState state = TextureState::Invalid;      ///< Current state of the texture.
+        ref<Texture> pTexture;                           ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        std::optional<TextureAnalyzer::Result> analysis; ///< CPU analysis of the texture contents, if computed during loading.
 
         bool isValid() const { return state != TextureState::Invalid; }
     };
@@ -205,6 +212,36 @@ public:
     void beginDeferredLoading();
     void endDeferredLoading();
 
+    /**
+     * Enable or disable deduplication of loaded textures by content.
+     * When enabled, a texture loaded from file shares an already loaded texture if the file contents are identical,
+     * or if the decoded pixels are identical (e.g. images that only differ in metadata), and the load options match.
+     * Each load still returns its own handle, but the handles refer to the same texture object.
+     * @param[in] enabled True to enable content deduplication.
+     */
+    void setContentDeduplication(bool enabled);
+
+    /**
+     * Returns true if content deduplication is enabled.
+     */
+    bool isContentDeduplicationEnabled() const;
+
+    /**
+     * Enable or disable the persistent texture cache (see TextureCache).
+     * When enabled, textures loaded from single image files (other than DDS) are transcoded to block compressed
+     * DDS files with precomputed mips on first load, and later loads create the textures directly from these files.
+     * Textures with unordered access or render target bind flags are not cached.
+     * The cache also stores the CPU analysis of each texture. Textures where all texels are identical are created
+     * with a single texel on later loads, without reading any image data.
+     * @param[in] enabled True to enable the texture cache.
+     */
+    void setTextureCache(bool enabled);
+
+    /**
+     * Returns true if the texture cache is enabled.
+     */
+    bool isTextureCacheEnabled() const;
+
     /**
      * Remove a texture.
      * @param[in] handle Texture handle.
@@ -243,6 +280,15 @@ public:
         return getTextureDesc(resolveUdimTexture(handle, udimID));
     }
 
+    /**
+     * Get the CPU analysis of a managed texture.
+     * Textures loaded from image files are analyzed on the CPU while the decoded image is in host memory,
+     * or the analysis is read from the texture cache. The result is the same as from TextureAnalyzer on the GPU.
+     * @param[in] pTexture The texture.
+     * @return The analysis result, or an empty optional if the texture is not managed or wasn't analyzed (e.g. DDS files).
+     */
+    std::optional<TextureAnalyzer::Result> getTextureAnalysis(const Texture* pTexture) const;
+
     /**
      * Get list of UDIM IDs for a texture.
      * If the texture is not using UDIMs, an empty list is returned.
@@ -339,9 +385,39 @@ private:
         }
     };
 
+    /// Result of loading a texture with content deduplication.
+    struct ContentLoad
+    {
+        ref<Texture> pTexture;                           ///< Loaded texture, or previously loaded texture with identical content.
+        SHA1::MD fileHash;                               ///< Hash of the file contents and load options.
+        std::optional<SHA1::MD> pixelHash;               ///< Hash of the decoded pixels and load options, if the files were decoded.
+        std::optional<TextureAnalyzer::Result> analysis; ///< CPU analysis of the texture, if available.
+    };
+
     CpuTextureHandle addDesc(const TextureDesc& desc);
     TextureDesc& getDesc(const CpuTextureHandle& handle);
     void registerOwner(const CpuTextureHandle& handle, const Object* owner);
+    void registerTexture(const ref<Texture>& pTexture, const CpuTextureHandle& handle);
+
+    static SHA1::MD hashFileContent(const TextureKey& key);
+    static SHA1::MD hashPixelContent(const Bitmap& bitmap, const TextureKey& key);
+    ref<Texture> loadTextureFromFiles(const TextureKey& key, std::optional<TextureAnalyzer::Result>& analysis) const;
+    std::optional<TextureCache::Key> getTextureCacheKey(const TextureKey& key) const;
+    ref<Texture> loadTextureFromCache(
+        const TextureKey& key,
+        const TextureCache::Key& cacheKey,
+        std::optional<TextureAnalyzer::Result>& analysis
+    ) const;
+    ref<Texture> createTextureFromBitmap(
+        const TextureKey& key,
+        const Bitmap& bitmap,
+        const std::optional<TextureCache::Key>& cacheKey,
+        std::optional<TextureAnalyzer::Result>& analysis
+    ) const;
+    ContentLoad loadTextureContent(const TextureKey& key, const SHA1::MD& fileHash) const;
+    ref<Texture> findTextureByContent(const SHA1::MD& hash) const;
+    std::optional<TextureAnalyzer::Result> findAnalysis(const Texture* pTexture) const;
+    void registerContent(const ContentLoad& load);
 
     ref<Device> mpDevice;
 
@@ -353,6 +429,8 @@ private:
     std::vector<CpuTextureHandle> mFreeList;                     ///< List of unused handles.
     std::map<TextureKey, CpuTextureHandle> mKeyToHandle;         ///< Map from texture key to handle.
     std::map<const Texture*, CpuTextureHandle> mTextureToHandle; ///< Map from texture ptr to handle.
+    std::map<const Texture*, size_t> mTextureShareCount;         ///< Number of additional handles sharing a texture due to content deduplication.
+    std::map<SHA1::MD, ref<Texture>> mContentToTexture;          ///< Map from content hash (file contents or decoded pixels) to texture.
     /// Map from UDIM-1001 to an actual textureID, -1 if the texture does not exist (e.g., there is 1001 and 1003, so 1002 [1] == -1)
     std::vector<int32_t> mUdimIndirection;
     /// For each udim indirection range, writes (at the first element), how long that range is (there is 0 everywhere else)
@@ -369,6 +447,8 @@ private:
     std::map<const Object*, Handles> mObjectToHandles;    ///< Map from object to set of texture handles used by the object.
 
     bool mUseDeferredLoading = false;
+    bool mContentDeduplication = false;
+    bool mTextureCache = false;
 
     AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
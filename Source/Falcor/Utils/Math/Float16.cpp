@@ -33,6 +33,24 @@
  */
 
 #include "Float16.h"
+#include "Core/Error.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FALCOR_FLOAT16_AVX2 1
+#if FALCOR_MSVC
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define FALCOR_FLOAT16_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if FALCOR_FLOAT16_AVX2 && (FALCOR_GCC || FALCOR_CLANG)
+#define FALCOR_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#else
+#define FALCOR_TARGET_AVX2
+#endif
 
 namespace Falcor
 {
@@ -261,5 +279,227 @@ float float16ToFloat32(uint16_t value)
     return result.f;
 }
 
+namespace
+{
+using Float32ToFloat16Func = void (*)(const float*, uint16_t*, size_t);
+using Float16ToFloat32Func = void (*)(const uint16_t*, float*, size_t);
+
+void float32ToFloat16Scalar(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = float32ToFloat16(pSrc[i]);
+}
+
+void float16ToFloat32Scalar(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = float16ToFloat32(pSrc[i]);
+}
+
+//
+// The vectorized float to half conversions below don't use the hardware conversion instructions,
+// as these round to nearest even while the scalar version rounds half away from zero.
+// Instead, they implement the scalar algorithm with integer operations, handling all cases
+// branch-free and blending the results. Unlike the scalar version, they don't raise a
+// floating point overflow exception for values that are too large.
+//
+
+#if FALCOR_FLOAT16_AVX2
+
+bool isAVX2Supported()
+{
+#if FALCOR_MSVC
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool hasF16C = (info[2] & (1 << 29)) != 0;
+    const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+    if (!hasF16C || !hasOSXSAVE || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+}
+
+FALCOR_TARGET_AVX2 void float32ToFloat16AVX2(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    const __m256i kOne = _mm256_set1_epi32(1);
+    const __m256i kInfinity = _mm256_set1_epi32(0x7c00);
+    const __m256i kRoundBit = _mm256_set1_epi32(0x1000);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i));
+        __m256i s = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x8000));
+        __m256i e = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xff)), _mm256_set1_epi32(127 - 15));
+        __m256i m = _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff));
+
+        // Normalized: round "0.5" up, a carry out of the significand propagates into the exponent. Overflow clamps to infinity.
+        __m256i mr = _mm256_add_epi32(m, _mm256_slli_epi32(_mm256_and_si256(m, kRoundBit), 1));
+        __m256i normal = _mm256_min_epi32(_mm256_add_epi32(_mm256_slli_epi32(e, 10), _mm256_srli_epi32(mr, 13)), kInfinity);
+
+        // Denormalized: shift the significand including the implicit one into place and round. Tiny values flush to zero.
+        __m256i md = _mm256_srlv_epi32(_mm256_or_si256(m, _mm256_set1_epi32(0x00800000)), _mm256_sub_epi32(kOne, e));
+        md = _mm256_add_epi32(md, _mm256_slli_epi32(_mm256_and_si256(md, kRoundBit), 1));
+        __m256i denormal = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(-10), e), _mm256_srli_epi32(md, 13));
+
+        // Infinity and NaN: keep the 10 leftmost significand bits, making sure a NaN doesn't turn into an infinity.
+        __m256i mn = _mm256_srli_epi32(m, 13);
+        __m256i nanBit = _mm256_andnot_si256(
+            _mm256_cmpeq_epi32(m, _mm256_setzero_si256()), _mm256_and_si256(_mm256_cmpeq_epi32(mn, _mm256_setzero_si256()), kOne)
+        );
+        __m256i special = _mm256_or_si256(kInfinity, _mm256_or_si256(mn, nanBit));
+
+        __m256i isDenormal = _mm256_cmpgt_epi32(kOne, e);
+        __m256i isSpecial = _mm256_cmpeq_epi32(e, _mm256_set1_epi32(0xff - (127 - 15)));
+        __m256i h = _mm256_blendv_epi8(normal, denormal, isDenormal);
+        h = _mm256_or_si256(s, _mm256_blendv_epi8(h, special, isSpecial));
+
+        // Pack to 16 bits. The pack instruction works on 128-bit lanes, so gather the two low 64-bit blocks afterwards.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(h, h), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm256_castsi256_si128(packed));
+    }
+
+    float32ToFloat16Scalar(pSrc + i, pDst + i, count - i);
+}
+
+FALCOR_TARGET_AVX2 void float16ToFloat32AVX2(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        __m256 f = _mm256_cvtph_ps(h);
+
+        // The hardware conversion quiets signaling NaNs. Preserve the significand bits like the scalar version.
+        __m256i h32 = _mm256_cvtepu16_epi32(h);
+        __m256i isNan = _mm256_cmpgt_epi32(_mm256_and_si256(h32, _mm256_set1_epi32(0x7fff)), _mm256_set1_epi32(0x7c00));
+        __m256i nan = _mm256_or_si256(
+            _mm256_slli_epi32(_mm256_and_si256(h32, _mm256_set1_epi32(0x8000)), 16),
+            _mm256_or_si256(_mm256_set1_epi32(0x7f800000), _mm256_slli_epi32(_mm256_and_si256(h32, _mm256_set1_epi32(0x3ff)), 13))
+        );
+        f = _mm256_blendv_ps(f, _mm256_castsi256_ps(nan), _mm256_castsi256_ps(isNan));
+        _mm256_storeu_ps(pDst + i, f);
+    }
+
+    float16ToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+#endif // FALCOR_FLOAT16_AVX2
+
+#if FALCOR_FLOAT16_NEON
+
+void float32ToFloat16NEON(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    const int32x4_t kZero = vdupq_n_s32(0);
+    const int32x4_t kOne = vdupq_n_s32(1);
+    const int32x4_t kInfinity = vdupq_n_s32(0x7c00);
+    const int32x4_t kRoundBit = vdupq_n_s32(0x1000);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        int32x4_t bits = vreinterpretq_s32_f32(vld1q_f32(pSrc + i));
+        int32x4_t s = vandq_s32(vshrq_n_s32(bits, 16), vdupq_n_s32(0x8000));
+        int32x4_t e = vsubq_s32(vandq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(0xff)), vdupq_n_s32(127 - 15));
+        int32x4_t m = vandq_s32(bits, vdupq_n_s32(0x007fffff));
+
+        // See the AVX2 version for details. Variable right shifts are left shifts by a negative amount.
+        int32x4_t mr = vaddq_s32(m, vshlq_n_s32(vandq_s32(m, kRoundBit), 1));
+        int32x4_t normal = vminq_s32(vaddq_s32(vshlq_n_s32(e, 10), vshrq_n_s32(mr, 13)), kInfinity);
+
+        int32x4_t md = vshlq_s32(vorrq_s32(m, vdupq_n_s32(0x00800000)), vsubq_s32(e, kOne));
+        md = vaddq_s32(md, vshlq_n_s32(vandq_s32(md, kRoundBit), 1));
+        int32x4_t denormal = vbicq_s32(vshrq_n_s32(md, 13), vreinterpretq_s32_u32(vcltq_s32(e, vdupq_n_s32(-10))));
+
+        int32x4_t mn = vshrq_n_s32(m, 13);
+        uint32x4_t nanBit = vandq_u32(vmvnq_u32(vceqq_s32(m, kZero)), vceqq_s32(mn, kZero));
+        int32x4_t special = vorrq_s32(kInfinity, vorrq_s32(mn, vandq_s32(vreinterpretq_s32_u32(nanBit), kOne)));
+
+        int32x4_t h = vbslq_s32(vcltq_s32(e, kOne), denormal, normal);
+        h = vorrq_s32(s, vbslq_s32(vceqq_s32(e, vdupq_n_s32(0xff - (127 - 15))), special, h));
+        vst1_u16(pDst + i, vmovn_u32(vreinterpretq_u32_s32(h)));
+    }
+
+    float32ToFloat16Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void float16ToFloat32NEON(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint16x4_t h = vld1_u16(pSrc + i);
+        float32x4_t f = vcvt_f32_f16(vreinterpret_f16_u16(h));
+
+        // The hardware conversion quiets signaling NaNs. Preserve the significand bits like the scalar version.
+        uint32x4_t h32 = vmovl_u16(h);
+        uint32x4_t isNan = vcgtq_u32(vandq_u32(h32, vdupq_n_u32(0x7fff)), vdupq_n_u32(0x7c00));
+        uint32x4_t nan = vorrq_u32(
+            vshlq_n_u32(vandq_u32(h32, vdupq_n_u32(0x8000)), 16),
+            vorrq_u32(vdupq_n_u32(0x7f800000), vshlq_n_u32(vandq_u32(h32, vdupq_n_u32(0x3ff)), 13))
+        );
+        f = vbslq_f32(isNan, vreinterpretq_f32_u32(nan), f);
+        vst1q_f32(pDst + i, f);
+    }
+
+    float16ToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+#endif // FALCOR_FLOAT16_NEON
+
+struct Float16Converters
+{
+    Float32ToFloat16Func float32ToFloat16 = float32ToFloat16Scalar;
+    Float16ToFloat32Func float16ToFloat32 = float16ToFloat32Scalar;
+    const char* name = "Scalar";
+
+    Float16Converters()
+    {
+#if FALCOR_FLOAT16_AVX2
+        if (isAVX2Supported())
+        {
+            float32ToFloat16 = float32ToFloat16AVX2;
+            float16ToFloat32 = float16ToFloat32AVX2;
+            name = "AVX2+F16C";
+        }
+#elif FALCOR_FLOAT16_NEON
+        float32ToFloat16 = float32ToFloat16NEON;
+        float16ToFloat32 = float16ToFloat32NEON;
+        name = "NEON";
+#endif
+    }
+};
+
+const Float16Converters& getConverters()
+{
+    static const Float16Converters converters;
+    return converters;
+}
+} // namespace
+
+void float32ToFloat16(fstd::span<const float> src, fstd::span<uint16_t> dst)
+{
+    FALCOR_CHECK(src.size() == dst.size(), "Source and destination sizes don't match ({} vs {}).", src.size(), dst.size());
+    getConverters().float32ToFloat16(src.data(), dst.data(), src.size());
+}
+
+void float16ToFloat32(fstd::span<const uint16_t> src, fstd::span<float> dst)
+{
+    FALCOR_CHECK(src.size() == dst.size(), "Source and destination sizes don't match ({} vs {}).", src.size(), dst.size());
+    getConverters().float16ToFloat32(src.data(), dst.data(), src.size());
+}
+
+const char* getFloat16ConversionImplementation()
+{
+    return getConverters().name;
+}
+
 } // namespace math
 } // namespace Falcor
@@ -29,6 +29,8 @@
 
 #include "Core/Macros.h"
 
+#include <fstd/span.h>
+
 #include <cstdint>
 #include <limits>
 
@@ -100,6 +102,39 @@ private:
     uint16_t mBits;
 };
 
+/**
+ * Convert an array of floats to half floats.
+ * Uses AVX2/F16C or NEON when supported by the CPU and falls back to the scalar version otherwise.
+ * The result is bit-exact with float32ToFloat16() (rounding, denormals, infinities and NaN payloads).
+ * @param src Source values.
+ * @param dst Destination values, must have the same size as src.
+ */
+FALCOR_API void float32ToFloat16(fstd::span<const float> src, fstd::span<uint16_t> dst);
+
+/**
+ * Convert an array of half floats to floats.
+ * Uses AVX2/F16C or NEON when supported by the CPU and falls back to the scalar version otherwise.
+ * The result is bit-exact with float16ToFloat32().
+ * @param src Source values.
+ * @param dst Destination values, must have the same size as src.
+ */
+FALCOR_API void float16ToFloat32(fstd::span<const uint16_t> src, fstd::span<float> dst);
+
+static_assert(sizeof(float16_t) == sizeof(uint16_t));
+
+inline void float32ToFloat16(fstd::span<const float> src, fstd::span<float16_t> dst)
+{
+    float32ToFloat16(src, fstd::span<uint16_t>(reinterpret_cast<uint16_t*>(dst.data()), dst.size()));
+}
+
+inline void float16ToFloat32(fstd::span<const float16_t> src, fstd::span<float> dst)
+{
+    float16ToFloat32(fstd::span<const uint16_t>(reinterpret_cast<const uint16_t*>(src.data()), src.size()), dst);
+}
+
+/// Returns the name of the implementation used by the bulk conversion functions ("AVX2+F16C", "NEON" or "Scalar").
+FALCOR_API const char* getFloat16ConversionImplementation();
+
 #if FALCOR_MSVC
 #pragma warning(push)
 #pragma warning(disable : 4455) // disable warning about literal suffixes not starting with an underscore
@@ -55,6 +55,7 @@ namespace Mogwai
         const std::string kScene = "scene";
         const std::string kClock = "clock";
         const std::string kProfiler = "profiler";
+        const std::string kDevice = "device";
         const std::string kSceneUpdateCallback = "sceneUpdateCallback";
 
         const std::string kRendererVar = "m";
@@ -154,6 +155,7 @@ namespace Mogwai
         renderer.def_property_readonly(kActiveGraph.c_str(), &Renderer::getActiveGraph);
         renderer.def_property_readonly(kClock.c_str(), [] (Renderer* pRenderer) { return &pRenderer->getGlobalClock(); });
         renderer.def_property_readonly(kProfiler.c_str(), [] (Renderer* pRenderer) { return pRenderer->getDevice()->getProfiler(); });
+        renderer.def_property_readonly(kDevice.c_str(), [] (Renderer* pRenderer) { return pRenderer->getDevice(); });
 
         auto getUI = [](Renderer* pRenderer) { return pRenderer->isUiEnabled(); };
         auto setUI = [](Renderer* pRenderer, bool show) { pRenderer->toggleUI(show); };
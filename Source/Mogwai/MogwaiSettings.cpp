@@ -223,7 +223,7 @@ namespace Mogwai
         {
             g.text("Program compilation:\n");
 
-            const auto& s = mpRenderer->getDevice()->getProgramManager()->getCompilationStats();
+            auto s = mpRenderer->getDevice()->getProgramManager()->getCompilationStats();
             double totalTime, downstreamTime;
             mpRenderer->getDevice()->getSlangGlobalSession()->getCompilerElapsedTime(&totalTime, &downstreamTime);
             std::ostringstream oss;
@@ -235,6 +235,21 @@ namespace Mogwai
                 << "Program kernels time (max): " << s.programKernelsMaxTime << " s" << std::endl
                 << "Total shader code-gen time: " << totalTime << " s" << std::endl
                 << "Downstream compilation time: " << downstreamTime << " s" << std::endl;
+            if (s.precompileRequestCount > 0)
+            {
+                oss << "Precompiled versions: " << s.precompileRequestCount << " (" << s.precompileFailedCount << " failed)" << std::endl
+                    << "Precompile time (wall-clock): " << s.precompileWallTime << " s" << std::endl;
+                for (size_t i = 0; i < s.threadStats.size(); ++i)
+                    oss << "  Thread " << i << ": " << s.threadStats[i].programVersionCount << " versions, " << s.threadStats[i].busyTime
+                        << " s" << std::endl;
+            }
+            const auto pProgramManager = mpRenderer->getDevice()->getProgramManager();
+            if (!pProgramManager->getProgramCachePath().empty())
+            {
+                auto cacheStats = pProgramManager->getProgramCacheStats();
+                oss << "Program cache: " << cacheStats.hitCount << " hits, " << cacheStats.missCount << " misses, " << cacheStats.writeCount
+                    << " writes" << std::endl;
+            }
             g.text(oss.str());
 
             if (g.button("Reset"))
@@ -29,6 +29,7 @@
 #include "RenderGraph/RenderPassHelpers.h"
 #include "RenderGraph/RenderPassStandardFlags.h"
 // #include "Rendering/Lights/EmissiveUniformSampler.h"
+#include "Utils/Image/ExrWriter.h"
 #include "Utils/UI/Gui.h"
 #include <fmt/format.h>
 
@@ -41,6 +42,9 @@ const std::string kInputAccumulatedColor = "accumulatedColor";
 const std::string kOutputPosition = "posW";
 const std::string kOutputAccumulatedColor = "accumulatedColor";
 
+// Maximum number of captures being written in the background. Each holds on to its readback data.
+const size_t kMaxPendingWrites = 4;
+
 } // namespace
 
 const Falcor::ChannelList kInputChannels = {
@@ -81,6 +85,12 @@ RadiosityCollecter::RadiosityCollecter(ref<Device> pDevice, const Properties& pr
     needCatpreNextFrame = false;
 }
 
+RadiosityCollecter::~RadiosityCollecter()
+{
+    for (auto& pendingWrite : mPendingWrites)
+        pendingWrite.wait();
+}
+
 Properties RadiosityCollecter::getProperties() const
 {
     return {};
@@ -163,12 +173,67 @@ void RadiosityCollecter::captureAndSaveCollectedData(ref<Texture> posWTexture, r
         );
         cameraInfoCSVFile.flush();
 
-        // Save textures to the directory
-        std::filesystem::path posWPath = outputDir / "posw.exr";
-        std::filesystem::path accumulatedColorPath = outputDir / "color.exr";
+        // Read back the textures and write them asynchronously, directly from the readback data.
+        // Positions are stored as float, colors as half precision.
+        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        auto pPosWData = std::make_shared<std::vector<uint8_t>>(pRenderContext->readTextureSubresource(posWTexture.get(), 0));
+        auto pColorData = std::make_shared<std::vector<uint8_t>>(pRenderContext->readTextureSubresource(accumulatedColorTexture.get(), 0));
+
+        const bool multiPart = mWriteMultiPart;
+        auto posWLayer = ExrWriter::createLayer(
+            multiPart ? "posW" : "",
+            posWTexture->getWidth(),
+            posWTexture->getHeight(),
+            posWTexture->getFormat(),
+            pPosWData->data(),
+            TextureChannelFlags::RGB,
+            ExrWriter::PixelType::Float
+        );
+        auto colorLayer = ExrWriter::createLayer(
+            multiPart ? "color" : "",
+            accumulatedColorTexture->getWidth(),
+            accumulatedColorTexture->getHeight(),
+            accumulatedColorTexture->getFormat(),
+            pColorData->data(),
+            TextureChannelFlags::RGB,
+            ExrWriter::PixelType::Half
+        );
+
+        ExrWriter::Options options;
+        options.compression = ExrWriter::Compression::PIZ;
+
+        // Drop finished writes and throttle capturing if too many are still in flight.
+        while (!mPendingWrites.empty() && mPendingWrites.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            mPendingWrites.pop_front();
+        while (mPendingWrites.size() >= kMaxPendingWrites)
+        {
+            mPendingWrites.front().wait();
+            mPendingWrites.pop_front();
+        }
 
-        posWTexture->captureToFile(0, 0, posWPath, Bitmap::FileFormat::ExrFile);
-        accumulatedColorTexture->captureToFile(0, 0, accumulatedColorPath, Bitmap::FileFormat::ExrFile);
+        // The task holds on to the readback data until the files are written.
+        mPendingWrites.push_back(std::async(
+            std::launch::async,
+            [outputDir, multiPart, posWLayer, colorLayer, options, pPosWData, pColorData]()
+            {
+                try
+                {
+                    if (multiPart)
+                    {
+                        ExrWriter::write(outputDir / "capture.exr", {posWLayer, colorLayer}, options);
+                    }
+                    else
+                    {
+                        ExrWriter::write(outputDir / "posw.exr", {posWLayer}, options);
+                        ExrWriter::write(outputDir / "color.exr", {colorLayer}, options);
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    logError("Failed to save collected data to '{}': {}", outputDir, e.what());
+                }
+            }
+        ));
 
         imageCount++;
     }
@@ -181,5 +246,7 @@ void RadiosityCollecter::captureAndSaveCollectedData(ref<Texture> posWTexture, r
 void RadiosityCollecter::renderUI(Gui::Widgets& widget)
 {
     widget.textbox("output directory", mOutputDirectory);
+    widget.checkbox("single multi-part file", mWriteMultiPart);
+    widget.tooltip("Write posW and color as parts of a single 'capture.exr' file instead of separate files.");
     needCatpreNextFrame = widget.button("capture");
 }
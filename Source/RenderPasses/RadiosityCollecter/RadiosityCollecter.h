@@ -28,7 +28,9 @@
 #pragma once
 #include "Falcor.h"
 #include "RenderGraph/RenderPass.h"
+#include <deque>
 #include <fstream>
+#include <future>
 
 using namespace Falcor;
 
@@ -43,6 +45,7 @@ public:
     }
 
     RadiosityCollecter(ref<Device> pDevice, const Properties& props);
+    ~RadiosityCollecter();
 
     virtual Properties getProperties() const override;
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
@@ -66,5 +69,7 @@ private:
     std::filesystem::path cameraInfoCSVFileLocation;
 
     bool needCatpreNextFrame;
+    bool mWriteMultiPart = false; ///< Write all AOVs of a capture to a single multi-part EXR file.
+    std::deque<std::future<void>> mPendingWrites; ///< EXR writes still in flight, oldest first.
 protected:
 };
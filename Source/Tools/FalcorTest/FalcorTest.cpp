@@ -56,6 +56,11 @@ int runMain(int argc, char** argv)
     args::ValueFlag<std::string> tagFilterFlag(parser, "tags", "Filter test cases by tags.", {'t', "tags"});
     args::ValueFlag<std::string> xmlReportFlag(parser, "path", "XML report output file.", {'x', "xml-report"});
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
+    args::Flag benchmarkFlag(parser, "", "Run benchmarks instead of tests.", {"benchmark"});
+    args::ValueFlag<std::string> benchmarkReportFlag(parser, "path", "Benchmark report output file (JSON).", {"benchmark-report"});
+    args::ValueFlag<double> benchmarkMinTimeFlag(
+        parser, "seconds", "Minimum measurement time per benchmark (default: 0.5).", {"benchmark-min-time"}
+    );
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag enableAftermathFlag(parser, "", "Enable Aftermath GPU crash dump.", {"enable-aftermath"});
 
@@ -129,11 +134,26 @@ int runMain(int argc, char** argv)
         options.parallel = args::get(parallelFlag);
     if (repeatFlag)
         options.repeat = args::get(repeatFlag);
+    if (benchmarkFlag)
+        options.benchmark = true;
+    if (benchmarkReportFlag)
+        options.benchmarkReportPath = args::get(benchmarkReportFlag);
+    if (benchmarkMinTimeFlag)
+    {
+        options.benchmarkMinTime = args::get(benchmarkMinTimeFlag);
+        if (options.benchmarkMinTime <= 0.0)
+        {
+            std::cerr << "Invalid benchmark min time, must be larger than zero" << std::endl;
+            return 1;
+        }
+    }
 
     if (listTestSuites || listTestCases || listTags)
     {
         std::vector<unittest::Test> tests = unittest::enumerateTests();
-        tests = unittest::filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+        tests = unittest::filterTests(
+            tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type, options.benchmark
+        );
 
         if (listTestSuites)
         {
@@ -0,0 +1,192 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ProgramCache.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream fs(path, std::ios_base::binary);
+    fs.write(content.data(), content.size());
+}
+
+std::filesystem::path createTestDirectory(const std::string& name)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+ProgramCache::Key createKey(const std::string& name)
+{
+    return SHA1::compute(name.data(), name.size());
+}
+
+ProgramCache::Entry createEntry(const std::filesystem::path& dependencyPath)
+{
+    ProgramCache::Entry entry;
+    entry.dependencies.push_back({dependencyPath.string(), ProgramCache::hashFile(dependencyPath)});
+    entry.modules.push_back({"common", "common.slang", {1, 2, 3}});
+    entry.modules.push_back({"main", "main.cs.slang", std::vector<uint8_t>(1000)});
+    for (size_t i = 0; i < entry.modules[1].irBlob.size(); ++i)
+        entry.modules[1].irBlob[i] = uint8_t(i * 7);
+    entry.translationUnits = {1};
+    return entry;
+}
+
+/// Find the single entry file written to the cache directory.
+std::filesystem::path findEntryFile(const std::filesystem::path& directory)
+{
+    for (const auto& it : std::filesystem::recursive_directory_iterator(directory))
+        if (it.is_regular_file())
+            return it.path();
+    return {};
+}
+
+void overwriteBytes(const std::filesystem::path& path, size_t offset, const void* data, size_t len)
+{
+    std::fstream fs(path, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+    fs.seekp(offset);
+    fs.write(reinterpret_cast<const char*>(data), len);
+}
+} // namespace
+
+CPU_TEST(ProgramCache_RoundTrip)
+{
+    std::filesystem::path directory = createTestDirectory("ProgramCache_RoundTrip");
+    writeFile(directory / "source.slang", "void main() {}");
+
+    ProgramCache cache(directory / "cache");
+    ProgramCache::Entry entry = createEntry(directory / "source.slang");
+
+    EXPECT(!cache.read(createKey("a")));
+    cache.write(createKey("a"), entry);
+
+    auto result = cache.read(createKey("a"));
+    ASSERT(result.has_value());
+    ASSERT_EQ(result->dependencies.size(), 1);
+    EXPECT_EQ(result->dependencies[0].path, entry.dependencies[0].path);
+    EXPECT(result->dependencies[0].hash == entry.dependencies[0].hash);
+    ASSERT_EQ(result->modules.size(), entry.modules.size());
+    for (size_t i = 0; i < entry.modules.size(); ++i)
+    {
+        EXPECT_EQ(result->modules[i].name, entry.modules[i].name);
+        EXPECT_EQ(result->modules[i].path, entry.modules[i].path);
+        EXPECT(result->modules[i].irBlob == entry.modules[i].irBlob) << "module " << i;
+    }
+    EXPECT(result->translationUnits == entry.translationUnits);
+
+    // Other keys are not affected.
+    EXPECT(!cache.read(createKey("b")));
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.hitCount, 1);
+    EXPECT_EQ(stats.missCount, 2);
+    EXPECT_EQ(stats.writeCount, 1);
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(ProgramCache_DependencyInvalidation)
+{
+    std::filesystem::path directory = createTestDirectory("ProgramCache_DependencyInvalidation");
+    writeFile(directory / "source.slang", "void main() {}");
+
+    ProgramCache cache(directory / "cache");
+    cache.write(createKey("a"), createEntry(directory / "source.slang"));
+    EXPECT(cache.read(createKey("a")).has_value());
+
+    // Changing the content of a dependency invalidates the entry.
+    writeFile(directory / "source.slang", "void main() { return; }");
+    EXPECT(!cache.read(createKey("a")));
+
+    // Restoring the content makes it valid again, only the content is compared and not the file time.
+    writeFile(directory / "source.slang", "void main() {}");
+    EXPECT(cache.read(createKey("a")).has_value());
+
+    // Removing a dependency invalidates the entry.
+    std::filesystem::remove(directory / "source.slang");
+    EXPECT(!cache.read(createKey("a")));
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(ProgramCache_CorruptEntry)
+{
+    std::filesystem::path directory = createTestDirectory("ProgramCache_CorruptEntry");
+    writeFile(directory / "source.slang", "void main() {}");
+
+    ProgramCache cache(directory / "cache");
+    const ProgramCache::Key key = createKey("a");
+    const ProgramCache::Entry entry = createEntry(directory / "source.slang");
+
+    cache.write(key, entry);
+    std::filesystem::path entryPath = findEntryFile(directory / "cache");
+    ASSERT(!entryPath.empty());
+    const size_t fileSize = std::filesystem::file_size(entryPath);
+
+    // Truncated entries are misses.
+    for (size_t size : {size_t(0), size_t(5), size_t(16), size_t(40), fileSize / 2, fileSize - 1})
+    {
+        cache.write(key, entry);
+        std::filesystem::resize_file(entryPath, size);
+        EXPECT(!cache.read(key)) << "size = " << size;
+    }
+
+    // Huge sizes are rejected without allocating. The header is 12 bytes, followed by the dependency count
+    // and the size of the first dependency path.
+    const uint32_t hugeCount = 0xffffffffu;
+    const uint64_t hugeSize = 0xffffffffffffull;
+    cache.write(key, entry);
+    overwriteBytes(entryPath, 12, &hugeCount, sizeof(hugeCount));
+    EXPECT(!cache.read(key));
+
+    cache.write(key, entry);
+    overwriteBytes(entryPath, 16, &hugeSize, sizeof(hugeSize));
+    EXPECT(!cache.read(key));
+
+    // The size of the compressed module section follows the dependency path and hash.
+    const size_t moduleSectionSizeOffset = 24 + entry.dependencies[0].path.size() + sizeof(SHA1::MD);
+    cache.write(key, entry);
+    overwriteBytes(entryPath, moduleSectionSizeOffset, &hugeSize, sizeof(hugeSize));
+    EXPECT(!cache.read(key));
+
+    // The entry is valid again after rewriting it.
+    cache.write(key, entry);
+    EXPECT(cache.read(key).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -0,0 +1,79 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Pass/ComputePass.h"
+#include "Core/Program/ProgramManager.h"
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Tests/Core/ProgramManagerTests.cs.slang";
+const uint32_t kNumElems = 256;
+const uint32_t kVariantCount = 8;
+} // namespace
+
+GPU_TEST(ProgramManagerPrecompile)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ProgramManager* pProgramManager = pDevice->getProgramManager();
+
+    ref<ComputePass> pPass = ComputePass::create(pDevice, kShaderFile, "main", DefineList{{"VALUE", "0"}});
+    ref<Program> pProgram = pPass->getProgram();
+
+    std::vector<ProgramManager::PrecompileRequest> requests;
+    for (uint32_t i = 0; i < kVariantCount; ++i)
+        requests.push_back({pProgram, DefineList{{"VALUE", std::to_string(i)}}, pProgram->getTypeConformances()});
+
+    // The first request duplicates the already compiled version and is skipped.
+    pProgramManager->resetCompilationStats();
+    EXPECT_EQ(pProgramManager->precompilePrograms(requests, 4), 0);
+    EXPECT_EQ(pProgramManager->getCompilationStats().precompileRequestCount, kVariantCount - 1);
+    EXPECT_EQ(pProgramManager->getCompilationStats().programVersionCount, kVariantCount - 1);
+
+    // Requesting the same versions again is a no-op.
+    EXPECT_EQ(pProgramManager->precompilePrograms(requests, 4), 0);
+    EXPECT_EQ(pProgramManager->getCompilationStats().precompileRequestCount, kVariantCount - 1);
+
+    ref<Buffer> pResult = pDevice->createStructuredBuffer(sizeof(uint32_t), kNumElems, ResourceBindFlags::UnorderedAccess);
+
+    for (uint32_t i = 0; i < kVariantCount; ++i)
+    {
+        pPass->addDefine("VALUE", std::to_string(i), true);
+        pPass->getRootVar()["result"] = pResult;
+        pPass->execute(ctx.getRenderContext(), kNumElems, 1, 1);
+
+        std::vector<uint32_t> result = pResult->getElements<uint32_t>();
+        for (uint32_t j = 0; j < kNumElems; ++j)
+            EXPECT_EQ(result[j], j + i) << "variant = " << i << ", j = " << j;
+    }
+
+    // Using the precompiled versions must not trigger any further front-end compilation.
+    EXPECT_EQ(pProgramManager->getCompilationStats().programVersionCount, kVariantCount - 1);
+}
+} // namespace Falcor
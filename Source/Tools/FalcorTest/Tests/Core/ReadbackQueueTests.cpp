@@ -0,0 +1,130 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/API/ReadbackQueue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<uint32_t> createTestData(size_t count, uint32_t seed)
+{
+    std::vector<uint32_t> data(count);
+    for (size_t i = 0; i < count; i++)
+        data[i] = uint32_t(i) * 7919u + seed;
+    return data;
+}
+} // namespace
+
+GPU_TEST(ReadbackQueue_Batch)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+
+    // Use an odd width so the staging row pitch differs from the tightly packed row size.
+    const uint32_t width = 37, height = 19, mipLevels = 2;
+    std::vector<uint32_t> texData0 = createTestData(width * height, 1);
+    std::vector<uint32_t> texData1 = createTestData((width / 2) * (height / 2), 2);
+    std::vector<uint32_t> bufData = createTestData(1000, 3);
+
+    ref<Texture> pTexture =
+        pDevice->createTexture2D(width, height, ResourceFormat::R32Uint, 1, mipLevels, nullptr, ResourceBindFlags::ShaderResource);
+    pTexture->setSubresourceBlob(pTexture->getSubresourceIndex(0, 0), texData0.data(), texData0.size() * sizeof(uint32_t));
+    pTexture->setSubresourceBlob(pTexture->getSubresourceIndex(0, 1), texData1.data(), texData1.size() * sizeof(uint32_t));
+    ref<Buffer> pBuffer = pDevice->createTypedBuffer<uint32_t>(
+        (uint32_t)bufData.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, bufData.data()
+    );
+
+    ref<ReadbackQueue> pQueue = make_ref<ReadbackQueue>(pDevice, 2);
+    std::vector<ReadbackQueue::Item> items = {
+        {pTexture, pTexture->getSubresourceIndex(0, 0)},
+        {pTexture, pTexture->getSubresourceIndex(0, 1)},
+        {pBuffer, 0},
+    };
+
+    auto verify = [&](ReadbackQueue::Batch& batch)
+    {
+        ASSERT_EQ(batch.getItemCount(), 3);
+        EXPECT_EQ(batch.getLayout(0).width, width);
+        EXPECT_EQ(batch.getLayout(0).height, height);
+        EXPECT_EQ(batch.getLayout(1).width, width / 2);
+        EXPECT_EQ(batch.getLayout(2).width, (uint32_t)bufData.size());
+        EXPECT_EQ(batch.getLayout(2).format, ResourceFormat::R32Uint);
+        EXPECT(std::memcmp(batch.getData(0), texData0.data(), texData0.size() * sizeof(uint32_t)) == 0);
+        EXPECT(std::memcmp(batch.getData(1), texData1.data(), texData1.size() * sizeof(uint32_t)) == 0);
+        EXPECT(std::memcmp(batch.getData(2), bufData.data(), bufData.size() * sizeof(uint32_t)) == 0);
+    };
+
+    // Keep more batches in flight than there are ring slots. Enqueuing into an occupied slot resolves the older batch.
+    ref<ReadbackQueue::Batch> pBatch0 = pQueue->enqueue(pRenderContext, items);
+    ref<ReadbackQueue::Batch> pBatch1 = pQueue->enqueue(pRenderContext, items);
+    ref<ReadbackQueue::Batch> pBatch2 = pQueue->enqueue(pRenderContext, items);
+    EXPECT(pBatch0->isResolved());
+    EXPECT(!pBatch1->isResolved());
+
+    verify(*pBatch0);
+    verify(*pBatch1);
+    verify(*pBatch2);
+    EXPECT(pBatch2->isReady());
+
+    // Copy directly into caller-provided memory, except for the second item.
+    ref<ReadbackQueue::Batch> pBatch3 = pQueue->enqueue(pRenderContext, items);
+    std::vector<uint32_t> tex0(texData0.size());
+    std::vector<uint32_t> buf(bufData.size());
+    pBatch3->wait({tex0.data(), nullptr, buf.data()});
+    EXPECT(!pBatch3->isInHostMemory(0));
+    EXPECT(pBatch3->isInHostMemory(1));
+    EXPECT(tex0 == texData0);
+    EXPECT(buf == bufData);
+    EXPECT(std::memcmp(pBatch3->getData(1), texData1.data(), texData1.size() * sizeof(uint32_t)) == 0);
+
+    // Waiting with destinations on a batch that was already resolved by slot reuse copies out of its host memory.
+    ref<ReadbackQueue::Batch> pBatch4 = pQueue->enqueue(pRenderContext, items);
+    ref<ReadbackQueue::Batch> pBatch5 = pQueue->enqueue(pRenderContext, items);
+    ref<ReadbackQueue::Batch> pBatch6 = pQueue->enqueue(pRenderContext, items);
+    ASSERT(pBatch4->isResolved());
+    std::vector<uint32_t> tex1(texData1.size());
+    std::fill(buf.begin(), buf.end(), 0);
+    pBatch4->wait({nullptr, tex1.data(), buf.data()});
+    EXPECT(tex1 == texData1);
+    EXPECT(buf == bufData);
+    EXPECT(pBatch4->isInHostMemory(1));
+    EXPECT_THROW(pBatch4->wait({tex0.data()}));
+
+    // Resolved items that went to caller-provided memory cannot be copied again.
+    EXPECT_THROW(pBatch3->wait({tex0.data(), nullptr, nullptr}));
+    verify(*pBatch5);
+    verify(*pBatch6);
+
+    // Dropping an unresolved batch releases its slot.
+    pQueue->enqueue(pRenderContext, items);
+    verify(*pQueue->enqueue(pRenderContext, items));
+}
+} // namespace Falcor
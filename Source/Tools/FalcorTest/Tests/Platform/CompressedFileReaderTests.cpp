@@ -0,0 +1,127 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Platform/OS.h"
+#include "Core/Platform/CompressedFileReader.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// gzip compressed "0123456789abcdef" repeated 1024 times.
+const uint8_t kCompressedData[] = {
+    // clang-format off
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xc7, 0xc9, 0x01, 0xc0, 0x10,
+    0x00, 0x00, 0xb0, 0x95, 0x94, 0xba, 0xc6, 0x41, 0xd9, 0x7f, 0x84, 0x6e, 0xe1, 0x95, 0xfc, 0x12,
+    0x9e, 0x98, 0xde, 0x5c, 0x6a, 0xeb, 0x63, 0xae, 0x6f, 0x9f, 0xe0, 0xee, 0xee, 0xee, 0xee, 0xee,
+    0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee,
+    0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xd7, 0xff, 0x03, 0x8b, 0xb4, 0x1d,
+    0x05, 0x00, 0x40, 0x00, 0x00,
+    // clang-format on
+};
+
+std::string getExpectedData()
+{
+    std::string str;
+    for (size_t i = 0; i < 1024; ++i)
+        str += "0123456789abcdef";
+    return str;
+}
+
+void writeFile(const std::filesystem::path& path, const void* data, size_t size)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(data), size);
+}
+} // namespace
+
+CPU_TEST(CompressedFileReader_Closed)
+{
+    CompressedFileReader file;
+    EXPECT_FALSE(file.isOpen());
+    EXPECT_TRUE(file.isEOF());
+
+    // Allowed to close a closed file.
+    file.close();
+    EXPECT_FALSE(file.isOpen());
+}
+
+CPU_TEST(CompressedFileReader_NonExisting)
+{
+    CompressedFileReader file("__file_that_does_not_exist__");
+    EXPECT_FALSE(file.isOpen());
+}
+
+CPU_TEST(CompressedFileReader_Read)
+{
+    const std::filesystem::path tempPath = std::filesystem::absolute("test_compressed_file_reader.gz");
+    writeFile(tempPath, kCompressedData, sizeof(kCompressedData));
+
+    const std::string expected = getExpectedData();
+
+    // Read in chunks of various sizes.
+    for (size_t chunkSize : {1, 7, 1000, 100000})
+    {
+        CompressedFileReader file(tempPath);
+        ASSERT_TRUE(file.isOpen());
+
+        std::string result;
+        std::vector<char> chunk(chunkSize);
+        while (!file.isEOF())
+        {
+            size_t size = file.read(chunk.data(), chunk.size());
+            result.append(chunk.data(), size);
+        }
+        EXPECT(result == expected);
+        EXPECT_EQ(file.read(chunk.data(), chunk.size()), 0);
+    }
+
+    // Compare against decompressing the whole file.
+    EXPECT(decompressFile(tempPath) == expected);
+
+    std::filesystem::remove(tempPath);
+}
+
+CPU_TEST(CompressedFileReader_Truncated)
+{
+    const std::filesystem::path tempPath = std::filesystem::absolute("test_compressed_file_reader_truncated.gz");
+    writeFile(tempPath, kCompressedData, sizeof(kCompressedData) / 2);
+
+    CompressedFileReader file(tempPath);
+    ASSERT_TRUE(file.isOpen());
+    std::vector<char> buffer(64 * 1024);
+    EXPECT_THROW(file.read(buffer.data(), buffer.size()));
+
+    file.close();
+    std::filesystem::remove(tempPath);
+}
+} // namespace Falcor
@@ -0,0 +1,306 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridVolume.h"
+#include "Scene/Volume/GridCache.h"
+#include "Scene/Volume/GridSequenceStreamer.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <nanovdb/util/IO.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+struct GridSequenceFiles
+{
+    std::filesystem::path directory;
+    std::vector<std::filesystem::path> paths;
+    std::vector<uint64_t> voxelCounts;
+    std::string gridname;
+
+    ~GridSequenceFiles() { std::filesystem::remove_all(directory); }
+};
+
+/// Write a sequence of growing spheres to NanoVDB files.
+void writeGridSequence(ref<Device> pDevice, const std::string& name, uint32_t frameCount, GridSequenceFiles& files)
+{
+    files.directory = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(files.directory);
+    std::filesystem::create_directories(files.directory);
+
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        auto pGrid = Grid::createSphere(pDevice, 1.f + 0.05f * i, 0.05f);
+        auto path = files.directory / fmt::format("frame_{:04}.nvdb", i);
+        nanovdb::io::writeGrid(path.string(), pGrid->getGridHandle());
+        files.paths.push_back(path);
+        files.voxelCounts.push_back(pGrid->getVoxelCount());
+        files.gridname = pGrid->getGridHandle().gridMetaData()->gridName();
+    }
+}
+
+/// Enable the grid cache in a temporary directory for the lifetime of the object.
+struct ScopedGridCacheDirectory
+{
+    std::filesystem::path prevDirectory;
+    bool prevEnabled;
+
+    ScopedGridCacheDirectory(const std::filesystem::path& directory)
+        : prevDirectory(GridCache::getDirectory()), prevEnabled(GridCache::isEnabled())
+    {
+        GridCache::setDirectory(directory);
+        GridCache::setEnabled(true);
+        GridCache::resetStats();
+    }
+    ~ScopedGridCacheDirectory()
+    {
+        GridCache::setDirectory(prevDirectory);
+        GridCache::setEnabled(prevEnabled);
+    }
+};
+
+void expectEqualGrids(GPUUnitTestContext& ctx, const ref<Grid>& pA, const ref<Grid>& pB)
+{
+    ASSERT(pA != nullptr);
+    ASSERT(pB != nullptr);
+    EXPECT_EQ(pA->getVoxelCount(), pB->getVoxelCount());
+    EXPECT_EQ(pA->getMinValue(), pB->getMinValue());
+    EXPECT_EQ(pA->getMaxValue(), pB->getMaxValue());
+    EXPECT(all(pA->getMinIndex() == pB->getMinIndex()));
+    EXPECT(all(pA->getMaxIndex() == pB->getMaxIndex()));
+    EXPECT_EQ(pA->getGridSizeInBytes(), pB->getGridSizeInBytes());
+    EXPECT_EQ(pA->getGridHandle().size(), pB->getGridHandle().size());
+    EXPECT(std::memcmp(pA->getGridHandle().data(), pB->getGridHandle().data(), pA->getGridHandle().size()) == 0);
+}
+} // namespace
+
+GPU_TEST(GridCache)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const uint32_t kFrameCount = 4;
+    GridSequenceFiles files;
+    writeGridSequence(pDevice, "FalcorGridCacheTest", kFrameCount, files);
+
+    // Load reference grids with the cache disabled.
+    GridVolume::GridSequence refGrids;
+    {
+        ScopedGridCacheDirectory cacheDirectory("");
+        EXPECT(!GridCache::isEnabled());
+        refGrids = GridVolume::createGridSequence(pDevice, files.paths, files.gridname);
+        EXPECT_EQ(GridCache::getStats().writeCount, 0u);
+    }
+    ASSERT_EQ(refGrids.size(), kFrameCount);
+
+    ScopedGridCacheDirectory cacheDirectory(files.directory / "cache");
+    EXPECT(GridCache::isEnabled());
+
+    // First load converts the grids and populates the cache.
+    auto grids = GridVolume::createGridSequence(pDevice, files.paths, files.gridname);
+    EXPECT_EQ(GridCache::getStats().hitCount, 0u);
+    EXPECT_EQ(GridCache::getStats().missCount, kFrameCount);
+    EXPECT_EQ(GridCache::getStats().writeCount, kFrameCount);
+
+    // Second load reads all grids from the cache.
+    GridCache::resetStats();
+    auto cachedGrids = GridVolume::createGridSequence(pDevice, files.paths, files.gridname);
+    EXPECT_EQ(GridCache::getStats().hitCount, kFrameCount);
+    EXPECT_EQ(GridCache::getStats().missCount, 0u);
+    EXPECT_EQ(GridCache::getStats().writeCount, 0u);
+
+    ASSERT_EQ(grids.size(), kFrameCount);
+    ASSERT_EQ(cachedGrids.size(), kFrameCount);
+    for (uint32_t i = 0; i < kFrameCount; ++i)
+    {
+        expectEqualGrids(ctx, refGrids[i], grids[i]);
+        expectEqualGrids(ctx, refGrids[i], cachedGrids[i]);
+        const int3 center = (refGrids[i]->getMinIndex() + refGrids[i]->getMaxIndex()) / 2;
+        EXPECT_EQ(refGrids[i]->getValue(center), cachedGrids[i]->getValue(center));
+    }
+
+    // NanoVDB sources are not copied into the cache, the entries only hold the bricked representation.
+    uint64_t entryBytes = 0;
+    uint64_t sourceBytes = 0;
+    for (const auto& it : std::filesystem::directory_iterator(files.directory / "cache"))
+        entryBytes += it.file_size();
+    for (const auto& path : files.paths)
+        sourceBytes += std::filesystem::file_size(path);
+    EXPECT_LT(entryBytes, sourceBytes);
+
+    // A modified source file must not hit the cache.
+    GridCache::resetStats();
+    EXPECT(Grid::decodeFromFile(files.paths[0], "missing") == nullptr);
+    auto pModified = Grid::createBox(pDevice, 1.f, 1.f, 1.f, 0.05f);
+    nanovdb::io::writeGrid(files.paths[0].string(), pModified->getGridHandle());
+    auto pGrid = Grid::createFromFile(pDevice, files.paths[0], files.gridname);
+    EXPECT_EQ(GridCache::getStats().hitCount, 0u);
+    EXPECT_EQ(GridCache::getStats().missCount, 1u);
+    ASSERT(pGrid != nullptr);
+    EXPECT_EQ(pGrid->getVoxelCount(), pModified->getVoxelCount());
+
+    // The cache is opt-in, no entries are read or written while it is disabled.
+    GridCache::setEnabled(false);
+    EXPECT(!GridCache::isEnabled());
+    GridCache::resetStats();
+    Grid::createFromFile(pDevice, files.paths[1], files.gridname);
+    EXPECT_EQ(GridCache::getStats().hitCount + GridCache::getStats().missCount + GridCache::getStats().writeCount, 0u);
+}
+
+GPU_TEST(GridSequenceStreamer)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const uint32_t kFrameCount = 16;
+    GridSequenceFiles files;
+    writeGridSequence(pDevice, "FalcorGridSequenceStreamerTest", kFrameCount, files);
+    ScopedGridCacheDirectory cacheDirectory(files.directory / "cache");
+
+    GridSequenceStreamer::Options options;
+    options.cacheSize = 4;
+    options.prefetchCount = 2;
+    options.threadCount = 2;
+    auto pStreamer = GridSequenceStreamer::create(pDevice, files.paths, files.gridname, options);
+    EXPECT_EQ(pStreamer->getFrameCount(), kFrameCount);
+
+    // Play the sequence twice to test wrap-around and eviction.
+    for (uint32_t pass = 0; pass < 2; ++pass)
+    {
+        for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+        {
+            pStreamer->prefetch(frame);
+            const auto& pGrid = pStreamer->getGrid(frame);
+            ASSERT(pGrid != nullptr);
+            EXPECT_EQ(pGrid->getVoxelCount(), files.voxelCounts[frame]);
+            EXPECT_LE(pStreamer->getStats().residentCount, options.cacheSize);
+        }
+    }
+
+    // Seek backwards.
+    const auto& pGrid = pStreamer->getGrid(kFrameCount / 2);
+    ASSERT(pGrid != nullptr);
+    EXPECT_EQ(pGrid->getVoxelCount(), files.voxelCounts[kFrameCount / 2]);
+
+    const auto& stats = pStreamer->getStats();
+    EXPECT_EQ(stats.requestCount, 2 * kFrameCount + 1);
+    EXPECT_GT(stats.evictCount, 0u);
+    EXPECT_LE(stats.residentCount, options.cacheSize);
+
+    // The memory statistics cover both the NanoVDB buffers and the brick textures of the resident grids.
+    uint64_t residentBytes = 0;
+    uint64_t residentBrickBytes = 0;
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        if (!pStreamer->isResident(frame))
+            continue;
+        const auto& pResident = pStreamer->getGrid(frame);
+        residentBytes += pResident->getGridSizeInBytes();
+        residentBrickBytes += pResident->getBrickedGridSizeInBytes();
+    }
+    EXPECT_GT(residentBrickBytes, 0u);
+    EXPECT_LT(residentBrickBytes, residentBytes);
+    EXPECT_EQ(stats.residentBytes, residentBytes);
+    EXPECT_EQ(stats.residentBrickBytes, residentBrickBytes);
+    EXPECT_GE(stats.peakResidentBytes, residentBytes);
+
+    // Stream through a grid volume.
+    auto pVolume = GridVolume::create(pDevice, "volume");
+    EXPECT_EQ(pVolume->streamGridSequence(GridVolume::GridSlot::Density, files.paths, files.gridname, options), kFrameCount);
+    EXPECT_EQ(pVolume->getGridFrameCount(), kFrameCount);
+    EXPECT(pVolume->getGridSequence(GridVolume::GridSlot::Density).empty());
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        pVolume->setGridFrame(frame);
+        ASSERT(pVolume->getDensityGrid() != nullptr);
+        EXPECT_EQ(pVolume->getDensityGrid()->getVoxelCount(), files.voxelCounts[frame]);
+    }
+    EXPECT_EQ(pVolume->getAllGrids().size(), 1u);
+}
+
+GPU_TEST(GridSequencePlaybackBenchmark, TAGS("benchmark"))
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const uint32_t kFrameCount = 48;
+    const auto kFrameTime = std::chrono::milliseconds(10);
+    GridSequenceFiles files;
+    writeGridSequence(pDevice, "FalcorGridSequencePlaybackBenchmark", kFrameCount, files);
+    ScopedGridCacheDirectory cacheDirectory(""); // Measure the full conversion cost.
+
+    // Load the full sequence up front.
+    CpuTimer timer;
+    timer.update();
+    uint64_t eagerBytes = 0;
+    uint64_t eagerBrickBytes = 0;
+    {
+        auto grids = GridVolume::createGridSequence(pDevice, files.paths, files.gridname);
+        for (const auto& pGrid : grids)
+        {
+            eagerBytes += pGrid ? pGrid->getGridSizeInBytes() : 0;
+            eagerBrickBytes += pGrid ? pGrid->getBrickedGridSizeInBytes() : 0;
+        }
+    }
+    timer.update();
+    double eagerLoadTime = timer.delta();
+
+    // Play back the sequence with streaming, simulating a fixed render time per frame.
+    auto pStreamer = GridSequenceStreamer::create(pDevice, files.paths, files.gridname);
+    timer.update();
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        pStreamer->prefetch(frame);
+        EXPECT(pStreamer->getGrid(frame) != nullptr);
+        std::this_thread::sleep_for(kFrameTime);
+    }
+    timer.update();
+
+    const auto& stats = pStreamer->getStats();
+    logInfo(
+        "Grid sequence playback ({} frames): eager load {:.3f} s, {} ({} bricks); streaming playback {:.3f} s, {} stall frames ({:.3f} s), "
+        "peak {}",
+        kFrameCount,
+        eagerLoadTime,
+        formatByteSize(eagerBytes),
+        formatByteSize(eagerBrickBytes),
+        timer.delta(),
+        stats.stallCount,
+        stats.stallTime,
+        formatByteSize(stats.peakResidentBytes)
+    );
+
+    EXPECT_LE(stats.residentCount, pStreamer->getOptions().cacheSize);
+    EXPECT_LT(stats.peakResidentBytes, eagerBytes);
+    EXPECT_GE(stats.stallCount, 1u); // The first frame always stalls.
+}
+} // namespace Falcor
@@ -0,0 +1,200 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/InstanceDescBuilder.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using Group = InstanceDescBuilder::Group;
+
+struct SyntheticScene
+{
+    std::vector<Group> groups;
+    std::vector<uint32_t> matrixIDs;
+    std::vector<float4x4> matrices;
+};
+
+/// Create a synthetic instance set. Each group has a random number of instances and geometries per instance.
+SyntheticScene createScene(std::mt19937& rng, uint32_t groupCount, uint32_t maxInstancesPerGroup, uint32_t rayTypeCount)
+{
+    SyntheticScene scene;
+    uint32_t instanceID = 0;
+    uint32_t hitGroupIndex = 0;
+    for (uint32_t i = 0; i < groupCount; i++)
+    {
+        Group group;
+        group.blasAddress = 0x10000 + i * 256;
+        group.flags = (i % 3 == 0) ? RtGeometryInstanceFlags::TriangleFrontCounterClockwise : RtGeometryInstanceFlags::None;
+        group.instanceContributionToHitGroupIndex = hitGroupIndex;
+        group.firstInstanceID = instanceID;
+        group.instanceIDStride = 1 + rng() % 4;
+        group.instanceCount = 1 + rng() % maxInstancesPerGroup;
+        instanceID += group.instanceCount * group.instanceIDStride;
+        hitGroupIndex += rayTypeCount * group.instanceIDStride;
+
+        // Every 8th group is static and uses the identity transform.
+        for (uint32_t j = 0; j < group.instanceCount; j++)
+        {
+            if (i % 8 == 0)
+            {
+                scene.matrixIDs.push_back(InstanceDescBuilder::kIdentityMatrix);
+            }
+            else
+            {
+                scene.matrixIDs.push_back((uint32_t)scene.matrices.size());
+                scene.matrices.push_back(math::matrixFromTranslation(float3((float)i, (float)j, 1.f)));
+            }
+        }
+        scene.groups.push_back(group);
+    }
+    return scene;
+}
+
+/// Serial reference, matching the original packing in Scene::fillInstanceDesc().
+void fillReference(const SyntheticScene& scene, std::vector<RtInstanceDesc>& instanceDescs)
+{
+    instanceDescs.clear();
+    size_t instanceIndex = 0;
+    for (const auto& group : scene.groups)
+    {
+        RtInstanceDesc desc = {};
+        desc.accelerationStructure = group.blasAddress;
+        desc.instanceMask = 0xFF;
+        desc.flags = group.flags;
+        desc.instanceContributionToHitGroupIndex = group.instanceContributionToHitGroupIndex;
+        for (uint32_t i = 0; i < group.instanceCount; i++)
+        {
+            desc.instanceID = group.firstInstanceID + i * group.instanceIDStride;
+            uint32_t matrixID = scene.matrixIDs[instanceIndex++];
+            desc.setTransform(matrixID == InstanceDescBuilder::kIdentityMatrix ? float4x4::identity() : scene.matrices[matrixID]);
+            instanceDescs.push_back(desc);
+        }
+    }
+}
+
+size_t countMismatches(const std::vector<RtInstanceDesc>& a, const std::vector<RtInstanceDesc>& b)
+{
+    if (a.size() != b.size())
+        return std::max(a.size(), b.size());
+    size_t count = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        bool equal = std::memcmp(a[i].transform, b[i].transform, sizeof(a[i].transform)) == 0 && a[i].instanceID == b[i].instanceID &&
+                     a[i].instanceMask == b[i].instanceMask &&
+                     a[i].instanceContributionToHitGroupIndex == b[i].instanceContributionToHitGroupIndex && a[i].flags == b[i].flags &&
+                     a[i].accelerationStructure == b[i].accelerationStructure;
+        count += equal ? 0 : 1;
+    }
+    return count;
+}
+} // namespace
+
+CPU_TEST(InstanceDescBuilderUpdate)
+{
+    std::mt19937 rng(1);
+    SyntheticScene scene = createScene(rng, 1000, 100, 2);
+
+    InstanceDescBuilder builder;
+    EXPECT(builder.isLayoutChanged(scene.groups));
+    builder.setLayout(scene.groups, scene.matrixIDs);
+    EXPECT(!builder.isLayoutChanged(scene.groups));
+    EXPECT_EQ(builder.getInstanceCount(), scene.matrixIDs.size());
+
+    // The first build writes all descriptors, even if changed matrices are given.
+    std::vector<uint64_t> changed((scene.matrices.size() + 63) / 64, 0);
+    EXPECT_EQ(builder.build(scene.matrices.data(), &changed), scene.matrixIDs.size());
+
+    std::vector<RtInstanceDesc> reference;
+    fillReference(scene, reference);
+    EXPECT_EQ(countMismatches(reference, builder.getInstanceDescs()), 0u);
+
+    // Change a few matrices and update incrementally.
+    std::vector<uint32_t> changedIDs = {0, 17, 500, (uint32_t)scene.matrices.size() - 1};
+    for (uint32_t id : changedIDs)
+    {
+        scene.matrices[id] = math::matrixFromScaling(float3(2.f));
+        changed[id / 64] |= uint64_t(1) << (id % 64);
+    }
+    EXPECT_EQ(builder.build(scene.matrices.data(), &changed), changedIDs.size());
+    fillReference(scene, reference);
+    EXPECT_EQ(countMismatches(reference, builder.getInstanceDescs()), 0u);
+
+    // A changed hit group offset changes the layout.
+    scene.groups[3].instanceContributionToHitGroupIndex++;
+    EXPECT(builder.isLayoutChanged(scene.groups));
+}
+
+CPU_BENCHMARK(InstanceDescBuilderFullBuildBench)
+{
+    // Packing all instance descriptors of a large synthetic scene.
+    std::mt19937 rng(2);
+    SyntheticScene scene = createScene(rng, 10000, 100, 2);
+
+    InstanceDescBuilder builder;
+    builder.setLayout(scene.groups, scene.matrixIDs);
+
+    ctx.setItemsPerIteration(scene.matrixIDs.size());
+    ctx.run([&]() { builder.build(scene.matrices.data()); });
+}
+
+CPU_BENCHMARK(InstanceDescBuilderIncrementalBuildBench)
+{
+    // Updating the instance descriptors of a large synthetic scene with 0.1% of the instances moved.
+    std::mt19937 rng(2);
+    SyntheticScene scene = createScene(rng, 10000, 100, 2);
+
+    InstanceDescBuilder builder;
+    builder.setLayout(scene.groups, scene.matrixIDs);
+    builder.build(scene.matrices.data());
+
+    std::vector<uint64_t> changed((scene.matrices.size() + 63) / 64, 0);
+    for (size_t i = 0; i < scene.matrices.size() / 1000; i++)
+    {
+        size_t id = rng() % scene.matrices.size();
+        changed[id / 64] |= uint64_t(1) << (id % 64);
+    }
+
+    ctx.setItemsPerIteration(scene.matrixIDs.size());
+    ctx.run([&]() { builder.build(scene.matrices.data(), &changed); });
+}
+
+CPU_BENCHMARK(InstanceDescBuilderReferenceBench)
+{
+    // Serial reference packing of the same scene, for comparison.
+    std::mt19937 rng(2);
+    SyntheticScene scene = createScene(rng, 10000, 100, 2);
+    std::vector<RtInstanceDesc> reference;
+
+    ctx.setItemsPerIteration(scene.matrixIDs.size());
+    ctx.run([&]() { fillReference(scene, reference); });
+}
+} // namespace Falcor
@@ -29,6 +29,7 @@
 #include "Core/AssetResolver.h"
 #include "Scene/Material/MERLFile.h"
 #include "Scene/Material/MERLMaterialData.slang"
+#include "Utils/Math/Float16.h"
 
 namespace Falcor
 {
@@ -57,4 +58,42 @@ GPU_TEST(MERLFile)
         EXPECT_EQ(v.z, expected.z);
     }
 }
+
+CPU_TEST(MERLFile_LoadCached)
+{
+    // TODO: This is not ideal, we should only access files in the runtime directory.
+    const std::filesystem::path path = getProjectDirectory() / "media/test_scenes/materials/data/gray-lambert.binary";
+
+    // Identical files are loaded once and shared.
+    auto files = MERLFile::loadCached({path, path});
+    ASSERT_EQ(files.size(), 2u);
+    EXPECT(files[0] != nullptr);
+    EXPECT(files[0] == files[1]);
+    EXPECT_EQ(files[0]->getDesc().name, "gray-lambert");
+
+    // The cache holds on to the BRDF as long as it is in use.
+    auto cachedFiles = MERLFile::loadCached({path});
+    EXPECT(cachedFiles[0] == files[0]);
+
+    // A copy of the file at another path shares the BRDF, which keeps the path it was first loaded from.
+    const std::filesystem::path copyPath = getRuntimeDirectory() / "merl-file-copy.binary";
+    std::filesystem::copy_file(path, copyPath, std::filesystem::copy_options::overwrite_existing);
+    auto copiedFiles = MERLFile::loadCached({copyPath});
+    EXPECT(copiedFiles[0] == files[0]);
+    EXPECT(copiedFiles[0]->getDesc().path == path);
+    std::filesystem::remove(copyPath);
+
+    // Check fp16 storage.
+    const auto& data = files[0]->getData();
+    const auto data16 = files[0]->getDataFloat16();
+    ASSERT_EQ(data16.size(), data.size() * 3);
+    for (size_t i = 0; i < data.size(); i += 997)
+    {
+        EXPECT_EQ(data16[3 * i + 0], math::float32ToFloat16(data[i].x));
+        EXPECT_EQ(data16[3 * i + 1], math::float32ToFloat16(data[i].y));
+        EXPECT_EQ(data16[3 * i + 2], math::float32ToFloat16(data[i].z));
+    }
+
+    EXPECT_THROW(MERLFile::loadCached({path.parent_path() / "missing.binary"}));
+}
 } // namespace Falcor
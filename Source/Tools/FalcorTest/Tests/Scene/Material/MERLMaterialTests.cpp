@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/MERLFile.h"
+#include "Scene/Material/MERLMaterial.h"
+#include "Scene/Material/MERLMixMaterial.h"
+#include "Utils/Math/MathConstants.slangh"
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Tests/Scene/Material/MERLMaterialTests.cs.slang";
+
+const uint32_t kDirectionCount = 4096;
+
+/// Relative tolerance of fp16 storage. Rounding to 11 significant bits has a relative error of at most 2^-11.
+const float kHalfTolerance = 1e-3f;
+
+/**
+ * Write a synthetic MERL file. Neighboring samples and the channels of a sample all have different values,
+ * so that reading misaligned fp16 data gives wrong results.
+ * The values stay well within the fp16 range after the per-channel scaling applied by the loader.
+ */
+void writeMERLFile(const std::filesystem::path& path, uint32_t seed)
+{
+    const int dims[3] = {90, 90, 180};
+    const size_t n = (size_t)dims[0] * dims[1] * dims[2];
+    std::vector<double> data(3 * n);
+    for (size_t c = 0; c < 3; c++)
+        for (size_t i = 0; i < n; i++)
+            data[c * n + i] = 15.0 * (1 + (i * 7 + c * 131 + seed) % 1000);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+    file.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(double));
+}
+
+/// Returns a uniformly distributed direction in the upper hemisphere.
+float3 sampleHemisphere(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist;
+    float z = std::max(dist(rng), 1e-3f);
+    float r = std::sqrt(1.f - z * z);
+    float phi = 2.f * (float)M_PI * dist(rng);
+    return float3(r * std::cos(phi), r * std::sin(phi), z);
+}
+} // namespace
+
+GPU_TEST(MERLMaterial_HalfPrecision)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const std::vector<std::filesystem::path> paths = {
+        getRuntimeDirectory() / "merl-material-test-0.binary",
+        getRuntimeDirectory() / "merl-material-test-1.binary",
+    };
+    for (uint32_t i = 0; i < paths.size(); i++)
+        writeMERLFile(paths[i], i * 500);
+
+    // Create MERL and MERLMix materials storing the BRDFs in fp32 and fp16 format.
+    struct Eval
+    {
+        MaterialID materialID;
+        uint32_t brdfIndex;
+        bool halfPrecision;
+    };
+    std::vector<Eval> evals;
+    MaterialSystem materialSystem(pDevice);
+    for (bool halfPrecision : {false, true})
+    {
+        auto materialID = materialSystem.addMaterial(MERLMaterial::create(pDevice, "MERL", paths[0], halfPrecision));
+        evals.push_back({materialID, 0, halfPrecision});
+
+        // Evaluate the second BRDF of the mix, which is stored at a non-zero offset in the data buffer.
+        materialID = materialSystem.addMaterial(MERLMixMaterial::create(pDevice, "MERLMix", paths, halfPrecision));
+        evals.push_back({materialID, 0, halfPrecision});
+        evals.push_back({materialID, 1, halfPrecision});
+    }
+    materialSystem.update(true);
+
+    // The reference data is shared with the materials through the BRDF cache.
+    auto merlFiles = MERLFile::loadCached(paths);
+
+    std::mt19937 rng(1);
+    std::vector<float3> wi(kDirectionCount), wo(kDirectionCount);
+    for (uint32_t i = 0; i < kDirectionCount; i++)
+    {
+        wi[i] = sampleHemisphere(rng);
+        wo[i] = sampleHemisphere(rng);
+    }
+    std::vector<uint2> evalData;
+    for (const auto& eval : evals)
+        evalData.push_back(uint2(eval.materialID.get(), eval.brdfIndex));
+
+    ctx.createProgram(kShaderFile, "testEval", materialSystem.getDefines());
+    materialSystem.bindShaderData(ctx["gMaterials"]);
+    ctx.allocateStructuredBuffer("gWi", kDirectionCount, wi.data(), wi.size() * sizeof(float3));
+    ctx.allocateStructuredBuffer("gWo", kDirectionCount, wo.data(), wo.size() * sizeof(float3));
+    ctx.allocateStructuredBuffer("gEvals", (uint32_t)evalData.size(), evalData.data(), evalData.size() * sizeof(uint2));
+    ctx.allocateStructuredBuffer("gSampleIndex", kDirectionCount);
+    ctx.allocateStructuredBuffer("gResult", kDirectionCount * (uint32_t)evals.size());
+    ctx["TestCB"]["directionCount"] = kDirectionCount;
+    ctx["TestCB"]["evalCount"] = (uint32_t)evals.size();
+    ctx.runProgram(kDirectionCount);
+
+    std::vector<uint32_t> sampleIndices = ctx.readBuffer<uint32_t>("gSampleIndex");
+    std::vector<float3> result = ctx.readBuffer<float3>("gResult");
+
+    // Samples are 6B in fp16 format. Even sample indices start at a 4B aligned address and odd ones don't.
+    uint32_t oddCount = 0;
+    for (uint32_t idx : sampleIndices)
+        oddCount += idx & 1;
+    EXPECT_GT(oddCount, 0u);
+    EXPECT_LT(oddCount, kDirectionCount);
+
+    for (size_t j = 0; j < evals.size(); j++)
+    {
+        const auto& data = merlFiles[evals[j].brdfIndex]->getData();
+        for (uint32_t i = 0; i < kDirectionCount; i++)
+        {
+            uint32_t idx = sampleIndices[i];
+            ASSERT_LT(idx, (uint32_t)data.size());
+            float3 expected = data[idx] * wo[i].z;
+            float3 f = result[j * kDirectionCount + i];
+            float3 tolerance = evals[j].halfPrecision ? expected * kHalfTolerance : expected * 1e-6f;
+            EXPECT(math::all(math::abs(f - expected) <= tolerance))
+                << "material=" << evals[j].materialID.get() << " brdf=" << evals[j].brdfIndex << " sample=" << idx
+                << " result=" << to_string(f) << " expected=" << to_string(expected);
+        }
+    }
+
+    for (const auto& path : paths)
+        std::filesystem::remove(path);
+}
+} // namespace Falcor
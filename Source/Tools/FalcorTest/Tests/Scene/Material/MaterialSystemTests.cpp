@@ -0,0 +1,287 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Create a set of standard materials using `uniqueCount` different parameter sets, some of them textured.
+std::vector<ref<Material>> createMaterials(ref<Device> pDevice, size_t materialCount, size_t uniqueCount, uint32_t seed)
+{
+    std::vector<ref<Texture>> textures;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t texel = 0xff000000 | i;
+        textures.push_back(pDevice->createTexture2D(1, 1, ResourceFormat::RGBA8Unorm, 1, 1, &texel));
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<ref<Material>> materials;
+    materials.reserve(materialCount);
+    for (size_t i = 0; i < materialCount; i++)
+    {
+        uint32_t variant = rng() % uniqueCount;
+        auto pMaterial = StandardMaterial::create(pDevice, "material" + std::to_string(i));
+        pMaterial->setBaseColor(float4(float(variant % 7) / 7.f, float(variant % 11) / 11.f, float(variant % 13) / 13.f, 1.f));
+        pMaterial->setRoughness(float(variant % 5) / 5.f);
+        if (variant % 3 == 0) pMaterial->setBaseColorTexture(textures[variant % textures.size()]);
+        materials.push_back(pMaterial);
+    }
+    return materials;
+}
+
+/// Reference implementation comparing every material against all unique materials.
+std::vector<MaterialID> findDuplicatesReference(const std::vector<ref<Material>>& materials)
+{
+    std::vector<ref<Material>> uniqueMaterials;
+    std::vector<MaterialID> idMap(materials.size());
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&](const auto& m) { return m->isEqual(materials[i]); });
+        idMap[i] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+        if (it == uniqueMaterials.end()) uniqueMaterials.push_back(materials[i]);
+    }
+    return idMap;
+}
+
+/// Overwrite the GPU material data with zeros, so that the next update() only leaves valid data for the materials it uploads.
+void clearMaterialData(const MaterialSystem& materialSystem)
+{
+    const auto& pBuffer = materialSystem.getMaterialDataBuffer();
+    std::vector<uint8_t> zeros(pBuffer->getSize(), 0);
+    pBuffer->setBlob(zeros.data(), 0, zeros.size());
+}
+
+/// Returns the IDs of the materials whose GPU material data matches the material.
+std::vector<uint32_t> getUploadedMaterialIDs(const MaterialSystem& materialSystem, const std::vector<ref<Material>>& materials)
+{
+    auto blobs = materialSystem.getMaterialDataBuffer()->getElements<MaterialDataBlob>(0, (uint32_t)materials.size());
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < (uint32_t)materials.size(); i++)
+    {
+        MaterialDataBlob blob = materials[i]->getDataBlob();
+        if (std::memcmp(&blobs[i], &blob, sizeof(blob)) == 0) ids.push_back(i);
+    }
+    return ids;
+}
+} // namespace
+
+GPU_TEST(MaterialHash)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Adding the materials to a material system assigns the default texture sampler.
+    MaterialSystem materialSystem(pDevice);
+    auto pA = StandardMaterial::create(pDevice, "a");
+    auto pB = StandardMaterial::create(pDevice, "b");
+    materialSystem.addMaterial(pA);
+    materialSystem.addMaterial(pB);
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->getHash(), pB->getHash());
+
+    // Negative zero compares equal to zero.
+    pA->setEmissiveColor(float3(-0.f));
+    pB->setEmissiveColor(float3(0.f));
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->getHash(), pB->getHash());
+
+    pA->setRoughness(0.25f);
+    EXPECT(!pA->isEqual(pB));
+    EXPECT_NE(pA->getHash(), pB->getHash());
+    pB->setRoughness(0.25f);
+    EXPECT_EQ(pA->getHash(), pB->getHash());
+
+    // Textures are compared by identity.
+    uint32_t texel = 0xffffffff;
+    auto pTexture = pDevice->createTexture2D(1, 1, ResourceFormat::RGBA8Unorm, 1, 1, &texel);
+    auto pOtherTexture = pDevice->createTexture2D(1, 1, ResourceFormat::RGBA8Unorm, 1, 1, &texel);
+    pA->setBaseColorTexture(pTexture);
+    EXPECT_NE(pA->getHash(), pB->getHash());
+    pB->setBaseColorTexture(pTexture);
+    EXPECT_EQ(pA->getHash(), pB->getHash());
+    pB->setBaseColorTexture(pOtherTexture);
+    EXPECT_NE(pA->getHash(), pB->getHash());
+    pB->setBaseColorTexture(pTexture);
+
+    // Samplers are compared by desc.
+    pA->setDefaultTextureSampler(pDevice->createSampler(Sampler::Desc().setFilterMode(TextureFilteringMode::Point, TextureFilteringMode::Point, TextureFilteringMode::Point)));
+    EXPECT(!pA->isEqual(pB));
+    EXPECT_NE(pA->getHash(), pB->getHash());
+    pB->setDefaultTextureSampler(pDevice->createSampler(Sampler::Desc().setFilterMode(TextureFilteringMode::Point, TextureFilteringMode::Point, TextureFilteringMode::Point)));
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->getHash(), pB->getHash());
+}
+
+GPU_TEST(RemoveDuplicateMaterials)
+{
+    auto materials = createMaterials(ctx.getDevice(), 2000, 100, 1);
+
+    MaterialSystem materialSystem(ctx.getDevice());
+    for (const auto& pMaterial : materials) materialSystem.addMaterial(pMaterial);
+    auto reference = findDuplicatesReference(materials);
+
+    std::vector<MaterialID> idMap;
+    size_t removed = materialSystem.removeDuplicateMaterials(idMap);
+
+    ASSERT_EQ(idMap.size(), materials.size());
+    for (size_t i = 0; i < materials.size(); i++) EXPECT_EQ(idMap[i], reference[i]);
+    EXPECT_EQ(materialSystem.getMaterialCount() + removed, materials.size());
+    for (size_t i = 0; i < materials.size(); i++) EXPECT(materialSystem.getMaterial(idMap[i])->isEqual(materials[i]));
+}
+
+GPU_TEST(RemoveDuplicateMaterialsBenchmark, TAGS("benchmark"))
+{
+    // Deduplication of a large synthetic material set, compared with the pairwise reference on a subset.
+    const size_t kMaterialCount = 20000;
+    const size_t kUniqueCount = 5000;
+    const size_t kReferenceCount = 5000;
+    auto materials = createMaterials(ctx.getDevice(), kMaterialCount, kUniqueCount, 2);
+
+    MaterialSystem materialSystem(ctx.getDevice());
+    for (const auto& pMaterial : materials) materialSystem.addMaterial(pMaterial);
+
+    CpuTimer timer;
+    timer.update();
+    auto reference = findDuplicatesReference(std::vector<ref<Material>>(materials.begin(), materials.begin() + kReferenceCount));
+    timer.update();
+    double referenceTime = timer.delta();
+
+    std::vector<MaterialID> idMap;
+    timer.update();
+    size_t removed = materialSystem.removeDuplicateMaterials(idMap);
+    timer.update();
+    double time = timer.delta();
+
+    for (size_t i = 0; i < kReferenceCount; i++) EXPECT_EQ(idMap[i], reference[i]);
+    logInfo(
+        "RemoveDuplicateMaterialsBenchmark: {} materials, {} removed in {:.3f} ms (pairwise reference on {} materials {:.3f} ms).",
+        kMaterialCount,
+        removed,
+        time * 1000.0,
+        kReferenceCount,
+        referenceTime * 1000.0
+    );
+}
+
+GPU_TEST(MaterialSystemUpdate)
+{
+    auto materials = createMaterials(ctx.getDevice(), 1000, 100, 3);
+
+    MaterialSystem materialSystem(ctx.getDevice());
+    for (const auto& pMaterial : materials) materialSystem.addMaterial(pMaterial);
+
+    // The first update is a full update and uploads all materials.
+    auto flags = materialSystem.update(false);
+    EXPECT(is_set(flags, Material::UpdateFlags::DataChanged));
+    std::vector<uint32_t> allIDs(materials.size());
+    std::iota(allIDs.begin(), allIDs.end(), 0u);
+    EXPECT(getUploadedMaterialIDs(materialSystem, materials) == allIDs);
+
+    // Nothing is uploaded without modifications.
+    clearMaterialData(materialSystem);
+    EXPECT(materialSystem.update(false) == Material::UpdateFlags::None);
+    EXPECT(getUploadedMaterialIDs(materialSystem, materials).empty());
+
+    // Only the modified materials are updated and uploaded.
+    clearMaterialData(materialSystem);
+    auto pMaterial = static_ref_cast<StandardMaterial>(materials[500]);
+    pMaterial->setRoughness(0.75f);
+    materials[20]->setDoubleSided(!materials[20]->isDoubleSided());
+    flags = materialSystem.update(false);
+    EXPECT(is_set(flags, Material::UpdateFlags::DataChanged));
+    EXPECT(getUploadedMaterialIDs(materialSystem, materials) == std::vector<uint32_t>({ 20, 500 }));
+    EXPECT(materialSystem.update(false) == Material::UpdateFlags::None);
+
+    // Modified materials close to each other are uploaded as one range, including the unmodified materials in between.
+    clearMaterialData(materialSystem);
+    for (uint32_t id : { 100, 110, 120 }) static_ref_cast<StandardMaterial>(materials[id])->setRoughness(0.5f);
+    materialSystem.update(false);
+    std::vector<uint32_t> rangeIDs(21);
+    std::iota(rangeIDs.begin(), rangeIDs.end(), 100u);
+    EXPECT(getUploadedMaterialIDs(materialSystem, materials) == rangeIDs);
+
+    // Materials removed as duplicates no longer record updates with the material system.
+    std::vector<MaterialID> idMap;
+    materialSystem.removeDuplicateMaterials(idMap);
+    materialSystem.update(false);
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        if (materialSystem.getMaterial(idMap[i]) != materials[i])
+        {
+            materials[i]->setDoubleSided(!materials[i]->isDoubleSided());
+            EXPECT(materialSystem.update(false) == Material::UpdateFlags::None);
+            break;
+        }
+    }
+}
+
+GPU_TEST(MaterialSystemUpdateBenchmark, TAGS("benchmark"))
+{
+    // Update of a few modified materials in a large material set, e.g. when optimizing material parameters.
+    const size_t kMaterialCount = 20000;
+    const size_t kModifiedCount = 16;
+    const uint32_t kFrameCount = 10;
+    auto materials = createMaterials(ctx.getDevice(), kMaterialCount, kMaterialCount, 4);
+
+    MaterialSystem materialSystem(ctx.getDevice());
+    for (const auto& pMaterial : materials) materialSystem.addMaterial(pMaterial);
+
+    CpuTimer timer;
+    timer.update();
+    materialSystem.update(false);
+    timer.update();
+    double fullTime = timer.delta();
+
+    std::mt19937 rng(5);
+    timer.update();
+    for (uint32_t frame = 0; frame < kFrameCount; frame++)
+    {
+        for (size_t i = 0; i < kModifiedCount; i++)
+            static_ref_cast<StandardMaterial>(materials[rng() % kMaterialCount])->setRoughness(float(frame) / kFrameCount);
+        EXPECT(is_set(materialSystem.update(false), Material::UpdateFlags::DataChanged));
+    }
+    timer.update();
+    double frameTime = timer.delta() / kFrameCount;
+
+    logInfo(
+        "MaterialSystemUpdateBenchmark: {} materials, full update {:.3f} ms, update of {} modified materials {:.3f} ms.",
+        kMaterialCount,
+        fullTime * 1000.0,
+        kModifiedCount,
+        frameTime * 1000.0
+    );
+}
+} // namespace Falcor
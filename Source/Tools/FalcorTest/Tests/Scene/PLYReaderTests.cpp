@@ -0,0 +1,316 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "PBRTImporter/PLYReader.h"
+#include "Core/Platform/OS.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+namespace
+{
+/// Corners of the unit square in the xy-plane, used as vertices of all test meshes.
+const float3 kPositions[4] = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {1.f, 1.f, 0.f}, {0.f, 1.f, 0.f}};
+
+/// A triangle and a quad, which is triangulated as a fan.
+const std::vector<std::vector<uint32_t>> kFaces = {{0, 1, 2}, {0, 1, 2, 3}};
+const std::vector<uint32_t> kTriangulatedIndices = {0, 1, 2, 0, 1, 2, 0, 2, 3};
+
+void writeFile(const std::filesystem::path& path, const std::string& data)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.data(), data.size());
+}
+
+void writeGzipFile(const std::filesystem::path& path, const std::string& data)
+{
+    gzFile file = gzopen(path.string().c_str(), "wb");
+    FALCOR_CHECK(file != nullptr, "Failed to open '{}'.", path);
+    gzwrite(file, data.data(), (unsigned)data.size());
+    gzclose(file);
+}
+
+template<typename T>
+void appendBinary(std::string& data, T value, bool bigEndian)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (bigEndian)
+        std::reverse(bytes, bytes + sizeof(T));
+    data.append(bytes, sizeof(T));
+}
+
+/// ASCII PLY file of the test mesh with per-vertex normals and texture coordinates and an unused element.
+std::string createAsciiPLY()
+{
+    std::string data =
+        "ply\n"
+        "format ascii 1.0\n"
+        "comment test mesh\n"
+        "element vertex 4\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property float nx\n"
+        "property float ny\n"
+        "property float nz\n"
+        "property float u\n"
+        "property float v\n"
+        "element face 2\n"
+        "property list uchar int vertex_indices\n"
+        "element material 1\n"
+        "property uchar id\n"
+        "end_header\n";
+    for (const auto& p : kPositions)
+        data += fmt::format("{} {} {} 0 0 1 {} {}\n", p.x, p.y, p.z, p.x, p.y);
+    for (const auto& face : kFaces)
+    {
+        data += std::to_string(face.size());
+        for (uint32_t index : face)
+            data += " " + std::to_string(index);
+        data += "\n";
+    }
+    data += "7\n";
+    return data;
+}
+
+/// Binary PLY file of the test mesh, with an unused vertex property and 16-bit indices.
+std::string createBinaryPLY(bool bigEndian)
+{
+    std::string data = fmt::format(
+        "ply\n"
+        "format {} 1.0\n"
+        "element vertex 4\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property uchar flags\n"
+        "property float nx\n"
+        "property float ny\n"
+        "property float nz\n"
+        "property double s\n"
+        "property double t\n"
+        "element face 2\n"
+        "property list uchar ushort vertex_indices\n"
+        "end_header\n",
+        bigEndian ? "binary_big_endian" : "binary_little_endian"
+    );
+    for (const auto& p : kPositions)
+    {
+        appendBinary(data, p.x, bigEndian);
+        appendBinary(data, p.y, bigEndian);
+        appendBinary(data, p.z, bigEndian);
+        appendBinary(data, uint8_t(0xff), bigEndian);
+        appendBinary(data, 0.f, bigEndian);
+        appendBinary(data, 0.f, bigEndian);
+        appendBinary(data, 1.f, bigEndian);
+        appendBinary(data, double(p.x), bigEndian);
+        appendBinary(data, double(p.y), bigEndian);
+    }
+    for (const auto& face : kFaces)
+    {
+        appendBinary(data, uint8_t(face.size()), bigEndian);
+        for (uint32_t index : face)
+            appendBinary(data, uint16_t(index), bigEndian);
+    }
+    return data;
+}
+
+/// Checks a mesh read from one of the files above. The v texture coordinate is flipped by the reader.
+void checkIndexedMesh(CPUUnitTestContext& ctx, const ref<TriangleMesh>& pMesh)
+{
+    ASSERT(pMesh != nullptr);
+    const auto& vertices = pMesh->getVertices();
+    ASSERT_EQ(vertices.size(), 4);
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT(math::all(vertices[i].position == kPositions[i])) << "vertex " << i;
+        EXPECT(math::all(vertices[i].normal == float3(0.f, 0.f, 1.f))) << "vertex " << i;
+        EXPECT(math::all(vertices[i].texCoord == float2(kPositions[i].x, 1.f - kPositions[i].y))) << "vertex " << i;
+    }
+    EXPECT(pMesh->getIndices() == kTriangulatedIndices);
+}
+} // namespace
+
+CPU_TEST(PLYReader_Ascii)
+{
+    const auto path = getRuntimeDirectory() / "test_ply_reader_ascii.ply";
+    writeFile(path, createAsciiPLY());
+    checkIndexedMesh(ctx, pbrt::readPLY(path));
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(PLYReader_Binary)
+{
+    const auto path = getRuntimeDirectory() / "test_ply_reader_binary.ply";
+    for (bool bigEndian : {false, true})
+    {
+        writeFile(path, createBinaryPLY(bigEndian));
+        checkIndexedMesh(ctx, pbrt::readPLY(path));
+    }
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(PLYReader_Gzip)
+{
+    const auto path = getRuntimeDirectory() / "test_ply_reader_gzip.ply.gz";
+    writeGzipFile(path, createAsciiPLY());
+    checkIndexedMesh(ctx, pbrt::readPLY(path));
+    writeGzipFile(path, createBinaryPLY(false));
+    checkIndexedMesh(ctx, pbrt::readPLY(path));
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(PLYReader_FaceVarying)
+{
+    const auto path = getRuntimeDirectory() / "test_ply_reader_face_varying.ply";
+
+    // Quad without normals and with face-varying texture coordinates. Vertices are duplicated per face corner
+    // and get faceted normals.
+    writeFile(
+        path,
+        "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 4\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "element face 1\n"
+        "property list uchar int vertex_indices\n"
+        "property list uchar float texcoord\n"
+        "end_header\n"
+        "0 0 0\n"
+        "1 0 0\n"
+        "1 1 0\n"
+        "0 1 0\n"
+        "4 0 1 2 3 8 0.5 0.5 0.75 0.5 0.75 0.75 0.5 0.75\n"
+    );
+
+    auto pMesh = pbrt::readPLY(path);
+    ASSERT(pMesh != nullptr);
+    const auto& vertices = pMesh->getVertices();
+    const std::vector<uint32_t> corners = {0, 1, 2, 0, 2, 3};
+    const float2 texCoords[4] = {{0.5f, 0.5f}, {0.75f, 0.5f}, {0.75f, 0.75f}, {0.5f, 0.75f}};
+    ASSERT_EQ(vertices.size(), corners.size());
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        EXPECT(math::all(vertices[i].position == kPositions[corners[i]])) << "corner " << i;
+        EXPECT(math::all(vertices[i].normal == float3(0.f, 0.f, 1.f))) << "corner " << i;
+        EXPECT(math::all(vertices[i].texCoord == float2(texCoords[corners[i]].x, 1.f - texCoords[corners[i]].y))) << "corner " << i;
+        EXPECT_EQ(pMesh->getIndices()[i], i);
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(PLYReader_Errors)
+{
+    const auto path = getRuntimeDirectory() / "test_ply_reader_errors.ply";
+
+    // Vertex index out of range.
+    std::string data = createAsciiPLY();
+    data.replace(data.find("4 0 1 2 3"), 9, "4 0 1 2 4");
+    writeFile(path, data);
+    EXPECT_THROW(pbrt::readPLY(path));
+
+    // Truncated binary data.
+    data = createBinaryPLY(false);
+    writeFile(path, data.substr(0, data.size() - 4));
+    EXPECT_THROW(pbrt::readPLY(path));
+
+    // Element count larger than the file.
+    data = createBinaryPLY(true);
+    data.replace(data.find("element vertex 4"), 16, "element vertex 400000000");
+    writeFile(path, data);
+    EXPECT_THROW(pbrt::readPLY(path));
+
+    // Not a PLY file.
+    writeFile(path, "solid cube\n");
+    EXPECT_THROW(pbrt::readPLY(path));
+
+    std::filesystem::remove(path);
+    EXPECT_THROW(pbrt::readPLY(path));
+}
+
+CPU_BENCHMARK(PLYReaderLoadBench)
+{
+    // Binary grid mesh with 1M vertices and 2M triangles, similar to the meshes in the pbrt-v4 scenes.
+    const uint32_t kSize = 1024;
+    const auto path = getRuntimeDirectory() / "test_ply_reader_bench.ply";
+
+    std::string data = fmt::format(
+        "ply\n"
+        "format binary_little_endian 1.0\n"
+        "element vertex {}\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property float nx\n"
+        "property float ny\n"
+        "property float nz\n"
+        "property float u\n"
+        "property float v\n"
+        "element face {}\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n",
+        kSize * kSize,
+        (kSize - 1) * (kSize - 1)
+    );
+    for (uint32_t y = 0; y < kSize; y++)
+    {
+        for (uint32_t x = 0; x < kSize; x++)
+        {
+            float u = x / float(kSize - 1), v = y / float(kSize - 1);
+            for (float value : {u, v, 0.f, 0.f, 0.f, 1.f, u, v})
+                appendBinary(data, value, false);
+        }
+    }
+    for (uint32_t y = 0; y + 1 < kSize; y++)
+    {
+        for (uint32_t x = 0; x + 1 < kSize; x++)
+        {
+            uint32_t i = y * kSize + x;
+            appendBinary(data, uint8_t(4), false);
+            for (uint32_t index : {i, i + 1, i + kSize + 1, i + kSize})
+                appendBinary(data, index, false);
+        }
+    }
+    writeFile(path, data);
+
+    ctx.setBytesPerIteration(data.size());
+    ctx.run([&]() { pbrt::readPLY(path); });
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,295 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/TransformHierarchy.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kInvalid = TransformHierarchy::kInvalidNode;
+
+float4x4 createRandomAffine(std::mt19937& rng)
+{
+    // Rotation, translation and a small non-uniform scale. Keeps the matrices well conditioned in deep hierarchies.
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    float4x4 R = math::matrixFromRotationXYZ(dist(rng), dist(rng), dist(rng));
+    float4x4 T = math::matrixFromTranslation(float3(dist(rng), dist(rng), dist(rng)));
+    float4x4 S = math::matrixFromScaling(float3(1.f) + 0.01f * float3(dist(rng), dist(rng), dist(rng)));
+    return mul(T, mul(R, S));
+}
+
+/// Random hierarchy where each node's parent is a random earlier node.
+std::vector<uint32_t> createRandomHierarchy(std::mt19937& rng, uint32_t nodeCount, uint32_t rootCount)
+{
+    std::vector<uint32_t> parents(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++)
+        parents[i] = i < rootCount ? kInvalid : rng() % i;
+    return parents;
+}
+
+/// Chains of nodes, each node is the child of the previous node in the chain.
+std::vector<uint32_t> createDeepHierarchy(uint32_t nodeCount, uint32_t chainCount)
+{
+    std::vector<uint32_t> parents(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++)
+        parents[i] = i < chainCount ? kInvalid : i - chainCount;
+    return parents;
+}
+
+/// Few roots with many children each, like instanced foliage.
+std::vector<uint32_t> createWideHierarchy(uint32_t nodeCount, uint32_t rootCount)
+{
+    std::vector<uint32_t> parents(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++)
+        parents[i] = i < rootCount ? kInvalid : i % rootCount;
+    return parents;
+}
+
+/// Serial reference implementation, matching the original scene graph traversal. Requires parents to precede their children.
+void updateReference(
+    const std::vector<uint32_t>& parents,
+    const std::vector<float4x4>& local,
+    std::vector<float4x4>& global,
+    std::vector<float4x4>& invTransposeGlobal,
+    std::vector<bool>& changed,
+    bool updateAll
+)
+{
+    for (size_t i = 0; i < parents.size(); i++)
+    {
+        if (parents[i] != kInvalid)
+            changed[i] = changed[i] || changed[parents[i]];
+        if (!changed[i] && !updateAll)
+            continue;
+        global[i] = parents[i] != kInvalid ? mul(global[parents[i]], local[i]) : local[i];
+        invTransposeGlobal[i] = transpose(inverse(global[i]));
+    }
+}
+
+float maxRelativeError(const std::vector<float4x4>& a, const std::vector<float4x4>& b)
+{
+    float maxError = 0.f;
+    for (size_t i = 0; i < a.size(); i++)
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                maxError = std::max(maxError, std::abs(a[i][r][c] - b[i][r][c]) / std::max(1.f, std::abs(a[i][r][c])));
+    return maxError;
+}
+
+struct HierarchyData
+{
+    std::vector<float4x4> local;
+    std::vector<float4x4> global;
+    std::vector<float4x4> invTransposeGlobal;
+
+    HierarchyData(std::mt19937& rng, size_t nodeCount) : global(nodeCount), invTransposeGlobal(nodeCount)
+    {
+        for (size_t i = 0; i < nodeCount; i++)
+            local.push_back(createRandomAffine(rng));
+    }
+
+    TransformHierarchy::Matrices getMatrices()
+    {
+        TransformHierarchy::Matrices matrices;
+        matrices.pLocal = local.data();
+        matrices.pGlobal = global.data();
+        matrices.pInvTransposeGlobal = invTransposeGlobal.data();
+        return matrices;
+    }
+};
+} // namespace
+
+CPU_TEST(TransformHierarchyLayout)
+{
+    // Children listed before their parents.
+    std::vector<uint32_t> parents = {kInvalid, 3, 3, 0, kInvalid, 2};
+    TransformHierarchy hierarchy(parents);
+    EXPECT_EQ(hierarchy.getNodeCount(), 6u);
+    EXPECT_EQ(hierarchy.getLevelCount(), 4u);
+
+    std::mt19937 rng(1);
+    HierarchyData data(rng, parents.size());
+    auto changed = hierarchy.createBitset();
+    hierarchy.update(data.getMatrices(), changed, true);
+
+    float4x4 m3 = mul(data.local[0], data.local[3]);
+    float4x4 m2 = mul(m3, data.local[2]);
+    EXPECT_LE(maxRelativeError({data.global[3], data.global[2], data.global[5]}, {m3, m2, mul(m2, data.local[5])}), 1e-5f);
+
+    // Only the changed subtree is flagged.
+    changed = hierarchy.createBitset();
+    TransformHierarchy::setBit(changed, 3);
+    hierarchy.update(data.getMatrices(), changed, false);
+    for (uint32_t i = 0; i < parents.size(); i++)
+        EXPECT_EQ(TransformHierarchy::testBit(changed, i), i == 1 || i == 2 || i == 3 || i == 5) << "node " << i;
+
+    // Cycles are rejected.
+    EXPECT_THROW(TransformHierarchy(std::vector<uint32_t>{1, 2, 0}));
+}
+
+CPU_TEST(TransformHierarchyUpdate)
+{
+    std::mt19937 rng(2);
+
+    for (uint32_t nodeCount : {100u, 50000u})
+    {
+        for (const auto& parents : {createRandomHierarchy(rng, nodeCount, 10), createWideHierarchy(nodeCount, 16), createDeepHierarchy(nodeCount, nodeCount / 50)})
+        {
+            HierarchyData data(rng, nodeCount);
+            // Include a few projective transforms to test the general path.
+            data.local[nodeCount / 2][3] = float4(0.1f, 0.f, 0.f, 1.f);
+
+            std::vector<float4x4> refGlobal(nodeCount), refInvTransposeGlobal(nodeCount);
+            std::vector<bool> refChanged(nodeCount, true);
+            updateReference(parents, data.local, refGlobal, refInvTransposeGlobal, refChanged, true);
+
+            TransformHierarchy hierarchy(parents);
+            auto changed = hierarchy.createBitset();
+            hierarchy.update(data.getMatrices(), changed, true);
+            EXPECT_LE(maxRelativeError(refGlobal, data.global), 1e-4f);
+            EXPECT_LE(maxRelativeError(refInvTransposeGlobal, data.invTransposeGlobal), 1e-3f);
+
+            // Change a few nodes and update incrementally.
+            changed = hierarchy.createBitset();
+            std::fill(refChanged.begin(), refChanged.end(), false);
+            for (uint32_t i = 0; i < 10; i++)
+            {
+                uint32_t node = rng() % nodeCount;
+                data.local[node] = createRandomAffine(rng);
+                TransformHierarchy::setBit(changed, node);
+                refChanged[node] = true;
+            }
+            updateReference(parents, data.local, refGlobal, refInvTransposeGlobal, refChanged, false);
+            hierarchy.update(data.getMatrices(), changed, false);
+            EXPECT_LE(maxRelativeError(refGlobal, data.global), 1e-4f);
+            EXPECT_LE(maxRelativeError(refInvTransposeGlobal, data.invTransposeGlobal), 1e-3f);
+
+            size_t mismatchCount = 0;
+            for (uint32_t i = 0; i < nodeCount; i++)
+                mismatchCount += TransformHierarchy::testBit(changed, i) != refChanged[i];
+            EXPECT_EQ(mismatchCount, 0u);
+        }
+    }
+}
+
+CPU_TEST(TransformHierarchyAnimation)
+{
+    // Several frames of incremental updates with animated nodes, compared to the serial traversal after every frame.
+    const uint32_t kNodeCount = 4000;
+    const uint32_t kFrameCount = 4;
+    std::mt19937 rng(3);
+
+    for (const auto& parents :
+         {createDeepHierarchy(kNodeCount, 40), createWideHierarchy(kNodeCount, 20), createRandomHierarchy(rng, kNodeCount, 20)})
+    {
+        HierarchyData data(rng, kNodeCount);
+        TransformHierarchy hierarchy(parents);
+        auto changed = hierarchy.createBitset();
+
+        std::vector<float4x4> refGlobal(kNodeCount), refInvTransposeGlobal(kNodeCount);
+        std::vector<bool> refChanged(kNodeCount);
+
+        // Animate 1% of the nodes each frame.
+        std::vector<uint32_t> animated;
+        for (uint32_t i = 0; i < kNodeCount / 100; i++)
+            animated.push_back(rng() % kNodeCount);
+
+        for (uint32_t frame = 0; frame < kFrameCount; frame++)
+        {
+            std::fill(refChanged.begin(), refChanged.end(), false);
+            std::fill(changed.begin(), changed.end(), 0);
+            for (uint32_t node : animated)
+            {
+                data.local[node] = createRandomAffine(rng);
+                refChanged[node] = true;
+                TransformHierarchy::setBit(changed, node);
+            }
+            updateReference(parents, data.local, refGlobal, refInvTransposeGlobal, refChanged, frame == 0);
+            hierarchy.update(data.getMatrices(), changed, frame == 0);
+
+            EXPECT_LE(maxRelativeError(refGlobal, data.global), 1e-4f) << "frame " << frame;
+            EXPECT_LE(maxRelativeError(refInvTransposeGlobal, data.invTransposeGlobal), 1e-3f) << "frame " << frame;
+        }
+    }
+}
+
+namespace
+{
+/// Benchmarks the per-frame update of a hierarchy with 1% of the nodes animated.
+void runUpdateBenchmark(CPUBenchmarkContext& ctx, std::mt19937& rng, const std::vector<uint32_t>& parents)
+{
+    const uint32_t nodeCount = (uint32_t)parents.size();
+    HierarchyData data(rng, nodeCount);
+    TransformHierarchy hierarchy(parents);
+    auto changed = hierarchy.createBitset();
+    hierarchy.update(data.getMatrices(), changed, true);
+
+    std::vector<uint32_t> animated;
+    for (uint32_t i = 0; i < nodeCount / 100; i++)
+        animated.push_back(rng() % nodeCount);
+
+    ctx.setItemsPerIteration(nodeCount);
+    ctx.setCounter("levels", hierarchy.getLevelCount());
+    ctx.run(
+        [&]()
+        {
+            std::fill(changed.begin(), changed.end(), 0);
+            for (uint32_t node : animated)
+                TransformHierarchy::setBit(changed, node);
+            hierarchy.update(data.getMatrices(), changed, false);
+        }
+    );
+}
+
+const uint32_t kBenchmarkNodeCount = 500000;
+} // namespace
+
+CPU_BENCHMARK(TransformHierarchyUpdateBench)
+{
+    // Large random hierarchy.
+    std::mt19937 rng(3);
+    runUpdateBenchmark(ctx, rng, createRandomHierarchy(rng, kBenchmarkNodeCount, 100));
+}
+
+CPU_BENCHMARK(TransformHierarchyUpdateDeepBench)
+{
+    // Deep chains with 5000 levels.
+    std::mt19937 rng(3);
+    runUpdateBenchmark(ctx, rng, createDeepHierarchy(kBenchmarkNodeCount, 100));
+}
+
+CPU_BENCHMARK(TransformHierarchyUpdateWideBench)
+{
+    // Wide, shallow hierarchy with two levels.
+    std::mt19937 rng(3);
+    runUpdateBenchmark(ctx, rng, createWideHierarchy(kBenchmarkNodeCount, 100));
+}
+} // namespace Falcor
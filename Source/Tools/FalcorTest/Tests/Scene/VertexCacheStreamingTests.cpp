@@ -0,0 +1,215 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/VertexCacheFile.h"
+#include "Scene/Animation/VertexCacheStreamer.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Math/Vector.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+/// Keyframe of a deforming grid of vertices. Smooth data like this compresses well.
+std::vector<float3> createKeyframe(uint32_t vertexCount, uint32_t keyframe)
+{
+    std::vector<float3> vertices(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+        vertices[i] = float3(float(i % 256), std::sin(0.1f * keyframe + 0.01f * i), float(i / 256));
+    return vertices;
+}
+
+std::vector<uint8_t> toBytes(const std::vector<float3>& data)
+{
+    std::vector<uint8_t> bytes(data.size() * sizeof(float3));
+    std::memcpy(bytes.data(), data.data(), bytes.size());
+    return bytes;
+}
+} // namespace
+
+CPU_TEST(VertexCacheFile)
+{
+    std::filesystem::path path = getTempFilePath();
+
+    // Write compressible and incompressible keyframes, and an empty one.
+    std::vector<std::vector<float3>> keyframes;
+    for (uint32_t i = 0; i < 4; i++)
+        keyframes.push_back(createKeyframe(1000 + i, i));
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist;
+    std::vector<float3> noise(5000);
+    for (auto& v : noise)
+        v = float3(dist(rng), dist(rng), dist(rng));
+    keyframes.push_back(noise);
+    keyframes.push_back({});
+
+    {
+        VertexCacheFile::Writer writer(path);
+        for (size_t i = 0; i < keyframes.size(); i++)
+            EXPECT_EQ(writer.addChunk(keyframes[i]), i);
+    }
+
+    {
+        auto pFile = VertexCacheFile::open(path, true);
+        ASSERT(pFile != nullptr);
+        ASSERT_EQ(pFile->getChunkCount(), keyframes.size());
+
+        // Read in reverse order to check random access.
+        for (size_t i = keyframes.size(); i-- > 0;)
+        {
+            EXPECT_EQ(pFile->getChunkSize((uint32_t)i), keyframes[i].size() * sizeof(float3));
+            auto data = pFile->readChunk<float3>((uint32_t)i);
+            ASSERT_EQ(data.size(), keyframes[i].size());
+            EXPECT(std::memcmp(data.data(), keyframes[i].data(), data.size() * sizeof(float3)) == 0);
+        }
+    }
+
+    // The file is deleted when the last reference is released.
+    EXPECT(!std::filesystem::exists(path));
+
+    // Invalid files are rejected.
+    EXPECT(VertexCacheFile::open(path) == nullptr);
+}
+
+CPU_TEST(VertexCacheStreamer)
+{
+    const uint32_t kKeyframeCount = 32;
+
+    VertexCacheStreamer::Options options;
+    options.residentKeyframeCount = 4;
+    options.prefetchFrameCount = 2;
+    options.threadCount = 2;
+    VertexCacheStreamer streamer(options);
+
+    std::set<uint32_t> resident;
+    uint32_t track = streamer.addTrack(
+        kKeyframeCount,
+        [](uint32_t keyframe) { return toBytes(createKeyframe(100, keyframe)); },
+        [&](uint32_t keyframe, const std::vector<uint8_t>& data)
+        {
+            EXPECT(data == toBytes(createKeyframe(100, keyframe)));
+            EXPECT(resident.insert(keyframe).second);
+        },
+        [&](uint32_t keyframe) { EXPECT_EQ(resident.erase(keyframe), 1u); }
+    );
+    ASSERT_EQ(track, 0u);
+
+    // Play back the keyframes twice, prefetching the next two keyframes.
+    for (uint32_t frame = 0; frame < 2 * kKeyframeCount; frame++)
+    {
+        uint32_t keyframe = frame % kKeyframeCount;
+        uint32_t next = (keyframe + 1) % kKeyframeCount;
+
+        streamer.beginFrame();
+        streamer.require(track, keyframe);
+        streamer.require(track, next);
+        EXPECT(resident.count(keyframe) == 1 && resident.count(next) == 1);
+        EXPECT(streamer.isResident(track, keyframe) && streamer.isResident(track, next));
+        for (uint32_t i = 2; i <= options.prefetchFrameCount + 1; i++)
+            streamer.prefetch(track, (keyframe + i) % kKeyframeCount);
+        streamer.endFrame();
+
+        EXPECT_LE(resident.size(), options.residentKeyframeCount);
+        EXPECT_EQ(streamer.getStats().residentCount, resident.size());
+    }
+
+    streamer.flush();
+    const auto& stats = streamer.getStats();
+    EXPECT_EQ(stats.requestCount, 4 * kKeyframeCount);
+    EXPECT_LE(stats.stallCount, stats.requestCount);
+    EXPECT_EQ(stats.loadCount - stats.evictCount, resident.size());
+    EXPECT_LE(stats.peakResidentBytes, (options.residentKeyframeCount + 1) * 100 * sizeof(float3));
+}
+
+CPU_TEST(VertexCacheStreamingPlayback)
+{
+    // Playback of several vertex caches streamed from disk, looping over the keyframes.
+    // Checks that the resident memory stays bounded compared to keeping all keyframes resident.
+    const uint32_t kTrackCount = 4;
+    const uint32_t kKeyframeCount = 48;
+    const uint32_t kVertexCount = 1 << 12;
+    const uint32_t kFrameCount = 300;
+    const double kFrameTime = 1.0 / 60.0;
+    const double kKeyframeTime = 1.0 / 24.0;
+
+    std::filesystem::path path = getTempFilePath();
+    uint64_t totalBytes = 0;
+    {
+        VertexCacheFile::Writer writer(path);
+        for (uint32_t i = 0; i < kTrackCount * kKeyframeCount; i++)
+        {
+            auto keyframe = createKeyframe(kVertexCount, i);
+            writer.addChunk(keyframe);
+            totalBytes += keyframe.size() * sizeof(float3);
+        }
+    }
+    auto pFile = VertexCacheFile::open(path, true);
+    ASSERT(pFile != nullptr);
+
+    VertexCacheStreamer::Options options;
+    VertexCacheStreamer streamer(options);
+    for (uint32_t t = 0; t < kTrackCount; t++)
+    {
+        auto load = [pFile, t](uint32_t keyframe)
+        {
+            uint32_t chunk = t * kKeyframeCount + keyframe;
+            std::vector<uint8_t> data(pFile->getChunkSize(chunk));
+            pFile->readChunk(chunk, data.data());
+            return data;
+        };
+        streamer.addTrack(kKeyframeCount, load, [](uint32_t, const std::vector<uint8_t>&) {}, [](uint32_t) {});
+    }
+
+    auto keyframeAt = [&](double time) { return std::min(uint32_t(std::fmod(time, kKeyframeCount * kKeyframeTime) / kKeyframeTime), kKeyframeCount - 1); };
+
+    for (uint32_t frame = 0; frame < kFrameCount; frame++)
+    {
+        double time = frame * kFrameTime;
+        streamer.beginFrame();
+        for (uint32_t t = 0; t < kTrackCount; t++)
+        {
+            uint32_t keyframe = keyframeAt(time);
+            streamer.require(t, keyframe);
+            streamer.require(t, (keyframe + 1) % kKeyframeCount);
+            for (uint32_t i = 1; i <= options.prefetchFrameCount; i++)
+                streamer.prefetch(t, (keyframeAt(time + i * kFrameTime) + 1) % kKeyframeCount);
+        }
+        streamer.endFrame();
+    }
+
+    const auto& stats = streamer.getStats();
+    EXPECT_EQ(stats.requestCount, 2 * kTrackCount * kFrameCount);
+    EXPECT_LE(stats.peakResidentBytes, kTrackCount * (options.residentKeyframeCount + 1) * kVertexCount * sizeof(float3));
+    EXPECT_LT(stats.peakResidentBytes, totalBytes);
+}
+} // namespace Falcor
@@ -59,4 +59,16 @@ CPU_TEST(SHA1)
         EXPECT(SHA1::compute(str.data(), str.size()) == md);
     }
 }
+
+CPU_BENCHMARK(SHA1Bench)
+{
+    const size_t kSize = 16 << 20;
+    std::mt19937 r;
+    std::vector<uint8_t> data(kSize);
+    for (uint8_t& byte : data)
+        byte = (uint8_t)r();
+
+    ctx.setBytesPerIteration(kSize);
+    ctx.run([&]() { ctx.doNotOptimize(SHA1::compute(data.data(), data.size())); });
+}
 } // namespace Falcor
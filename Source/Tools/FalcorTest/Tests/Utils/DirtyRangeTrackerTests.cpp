@@ -0,0 +1,130 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/DirtyRangeTracker.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using Range = DirtyRangeTracker::Range;
+}
+
+CPU_TEST(DirtyRangeTrackerCoalesce)
+{
+    DirtyRangeTracker tracker;
+    EXPECT(!tracker.isDirty());
+
+    // Adjacent and overlapping ranges are coalesced, also when marked out of order.
+    tracker.markDirty(10);
+    tracker.markDirty(11);
+    tracker.markDirty(20, 25);
+    tracker.markDirty(3, 5);
+    tracker.markDirty(22, 30);
+    tracker.markDirty(4, 10);
+    EXPECT(tracker.isDirty());
+    EXPECT(tracker.getRanges() == std::vector<Range>({{3, 12}, {20, 30}}));
+    EXPECT_EQ(tracker.getDirtyCount(), 19u);
+
+    // Ranges separated by at most the merge distance are merged.
+    tracker.setMergeDistance(8);
+    EXPECT(tracker.getRanges() == std::vector<Range>({{3, 30}}));
+
+    tracker.clear();
+    EXPECT(!tracker.isDirty());
+    EXPECT_EQ(tracker.getDirtyCount(), 0u);
+}
+
+CPU_TEST(DirtyRangeTrackerBitset)
+{
+    std::mt19937 rng(1);
+    const size_t count = 1000;
+
+    for (uint32_t density : {1u, 10u, 50u, 100u})
+    {
+        std::vector<uint64_t> bits((count + 63) / 64, 0);
+        std::vector<bool> expected(count, false);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (rng() % 100 < density)
+            {
+                bits[i / 64] |= uint64_t(1) << (i % 64);
+                expected[i] = true;
+            }
+        }
+
+        DirtyRangeTracker tracker;
+        tracker.markDirty(bits, count);
+
+        // Ranges must be sorted, disjoint, non-adjacent and cover exactly the set bits.
+        std::vector<bool> covered(count, false);
+        size_t prevEnd = 0;
+        bool first = true;
+        for (const auto& range : tracker.getRanges())
+        {
+            EXPECT_LT(range.begin, range.end);
+            EXPECT_LE(range.end, count);
+            if (!first)
+                EXPECT_GT(range.begin, prevEnd);
+            for (size_t i = range.begin; i < range.end; i++)
+                covered[i] = true;
+            prevEnd = range.end;
+            first = false;
+        }
+        EXPECT(covered == expected) << "density " << density;
+    }
+}
+
+GPU_TEST(DirtyRangeTrackerUpload)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+
+    const uint32_t count = 4096;
+    std::vector<uint32_t> data(count);
+    for (uint32_t i = 0; i < count; i++)
+        data[i] = i;
+
+    ref<Buffer> pBuffer = pDevice->createStructuredBuffer(sizeof(uint32_t), count, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, data.data(), false);
+
+    // Modify a few elements and upload them only.
+    DirtyRangeTracker tracker(2);
+    for (uint32_t i : {0u, 1u, 2u, 100u, 103u, 2000u, count - 1})
+    {
+        data[i] = 0xdeadbeef;
+        tracker.markDirty(i);
+    }
+    uint64_t uploadedBytes = tracker.upload(pRenderContext, pBuffer.get(), data.data(), sizeof(uint32_t));
+    EXPECT_EQ(uploadedBytes, (3 + 4 + 1 + 1) * sizeof(uint32_t));
+
+    std::vector<uint32_t> result = pRenderContext->readBuffer<uint32_t>(pBuffer.get());
+    EXPECT(result == data);
+}
+} // namespace Falcor
@@ -27,8 +27,10 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Math/ScalarMath.h"
+#include "Utils/Math/Float16.h"
 #include <fstd/bit.h> // TODO C++20: Replace with <bit>
 #include <random>
+#include <vector>
 
 namespace Falcor
 {
@@ -67,6 +69,41 @@ void testVector(CPUUnitTestContext& ctx)
     for (auto i = 0; i < N; i++)
         EXPECT_EQ((float)v[i], f[i]);
 }
+
+/// Returns float bit patterns covering rounding ties, denormals, overflow, infinities and NaNs, followed by random bit patterns.
+std::vector<float> getFloat32TestValues(size_t randomCount)
+{
+    std::vector<uint32_t> bits;
+
+    // All exponents with significands around the rounding points of the normalized and denormalized half ranges.
+    const uint32_t kSignificands[] = {
+        0x000000, 0x000001, 0x000fff, 0x001000, 0x001001, 0x001fff, 0x002000, 0x003000,
+        0x3ff000, 0x400000, 0x7fe000, 0x7ff000, 0x7fefff, 0x7fffff,
+    };
+    for (uint32_t sign = 0; sign < 2; sign++)
+        for (uint32_t exponent = 0; exponent < 256; exponent++)
+            for (uint32_t significand : kSignificands)
+                bits.push_back((sign << 31) | (exponent << 23) | significand);
+
+    // Denormalized halfs: the position of the rounding bit depends on the exponent.
+    for (int e = -10; e <= 0; e++)
+    {
+        uint32_t exponent = (uint32_t)(e + 127 - 15);
+        uint32_t tie = (1u << (13 - e)) & 0x7fffff;
+        for (uint32_t significand : {tie, tie - 1, tie + 1, tie | 0x400000})
+            for (uint32_t sign = 0; sign < 2; sign++)
+                bits.push_back((sign << 31) | (exponent << 23) | (significand & 0x7fffff));
+    }
+
+    std::mt19937 r;
+    for (size_t i = 0; i < randomCount; i++)
+        bits.push_back(r());
+
+    std::vector<float> values(bits.size());
+    for (size_t i = 0; i < bits.size(); i++)
+        values[i] = fstd::bit_cast<float>(bits[i]);
+    return values;
+}
 } // namespace
 
 CPU_TEST(Float16Vector)
@@ -162,4 +199,102 @@ CPU_TEST(Float16Scalar)
         EXPECT_EQ(fstd::bit_cast<uint16_t>(result), fstd::bit_cast<uint16_t>(expected));
     }
 }
+
+CPU_TEST(Float16BulkToFloat32)
+{
+    // Convert all bit patterns at different offsets to exercise unaligned access and tail handling.
+    std::vector<uint16_t> halfs(0x10000 + 16);
+    for (size_t i = 0; i < halfs.size(); i++)
+        halfs[i] = (uint16_t)i;
+
+    for (size_t offset = 0; offset < 8; offset++)
+    {
+        const size_t count = halfs.size() - offset - 3;
+        std::vector<float> result(count);
+        math::float16ToFloat32(fstd::span<const uint16_t>(halfs.data() + offset, count), result);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float expected = math::float16ToFloat32(halfs[offset + i]);
+            EXPECT_EQ(fstd::bit_cast<uint32_t>(result[i]), fstd::bit_cast<uint32_t>(expected)) << "half = " << halfs[offset + i];
+        }
+    }
+
+    // Empty and short arrays.
+    std::vector<float> empty;
+    math::float16ToFloat32(fstd::span<const uint16_t>(), empty);
+    for (size_t count = 1; count < 20; count++)
+    {
+        std::vector<float> result(count);
+        math::float16ToFloat32(fstd::span<const uint16_t>(halfs.data() + 0x7bf0, count), result);
+        for (size_t i = 0; i < count; i++)
+            EXPECT_EQ(fstd::bit_cast<uint32_t>(result[i]), fstd::bit_cast<uint32_t>(math::float16ToFloat32(halfs[0x7bf0 + i])));
+    }
+
+    // Mismatching sizes.
+    std::vector<float> tooSmall(4);
+    EXPECT_THROW(math::float16ToFloat32(fstd::span<const uint16_t>(halfs.data(), 5), tooSmall));
+}
+
+CPU_TEST(Float16BulkFromFloat32)
+{
+    const std::vector<float> values = getFloat32TestValues(1 << 20);
+
+    for (size_t offset = 0; offset < 8; offset++)
+    {
+        const size_t count = values.size() - offset - 5;
+        std::vector<uint16_t> result(count);
+        math::float32ToFloat16(fstd::span<const float>(values.data() + offset, count), result);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint16_t expected = math::float32ToFloat16(values[offset + i]);
+            EXPECT_EQ(result[i], expected) << "float bits = " << fstd::bit_cast<uint32_t>(values[offset + i]);
+        }
+    }
+
+    // Conversion through float16_t spans.
+    std::vector<float16_t> halfs(values.size());
+    math::float32ToFloat16(values, halfs);
+    std::vector<float> roundTrip(values.size());
+    math::float16ToFloat32(halfs, roundTrip);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        EXPECT_EQ(halfs[i].toBits(), math::float32ToFloat16(values[i]));
+        EXPECT_EQ(fstd::bit_cast<uint32_t>(roundTrip[i]), fstd::bit_cast<uint32_t>((float)halfs[i]));
+    }
+
+    // Mismatching sizes.
+    std::vector<uint16_t> tooSmall(4);
+    EXPECT_THROW(math::float32ToFloat16(fstd::span<const float>(values.data(), 5), tooSmall));
+}
+
+CPU_BENCHMARK(Float16BulkFromFloat32Bench)
+{
+    const size_t kCount = 1 << 20;
+    std::mt19937 r;
+    std::uniform_real_distribution<float> dist(-70000.f, 70000.f);
+    std::vector<float> values(kCount);
+    for (float& v : values)
+        v = dist(r);
+    std::vector<uint16_t> halfs(kCount);
+
+    ctx.setItemsPerIteration(kCount);
+    ctx.setBytesPerIteration(kCount * sizeof(float));
+    ctx.run([&]() { math::float32ToFloat16(values, halfs); });
+}
+
+CPU_BENCHMARK(Float16BulkToFloat32Bench)
+{
+    const size_t kCount = 1 << 20;
+    std::mt19937 r;
+    std::vector<uint16_t> halfs(kCount);
+    for (uint16_t& h : halfs)
+        h = (uint16_t)r();
+    std::vector<float> result(kCount);
+
+    ctx.setItemsPerIteration(kCount);
+    ctx.setBytesPerIteration(kCount * sizeof(uint16_t));
+    ctx.run([&]() { math::float16ToFloat32(halfs, result); });
+}
 } // namespace Falcor
@@ -0,0 +1,229 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ExrWriter.h"
+#include "Utils/Math/Float16.h"
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputPart.h>
+#include <ImfMultiPartInputFile.h>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 7;
+const uint32_t kHeight = 5;
+
+/// Values that are exactly representable in half precision.
+float getValue(uint32_t x, uint32_t y, uint32_t c)
+{
+    return (float)(x + y * kWidth) * 0.25f + (float)c * 100.f;
+}
+
+/// Creates RGBA float pixels with a padded row pitch.
+std::vector<float> createPixels(uint32_t rowPitchInFloats)
+{
+    std::vector<float> pixels(rowPitchInFloats * kHeight, -1.f);
+    for (uint32_t y = 0; y < kHeight; y++)
+        for (uint32_t x = 0; x < kWidth; x++)
+            for (uint32_t c = 0; c < 4; c++)
+                pixels[y * rowPitchInFloats + x * 4 + c] = getValue(x, y, c);
+    return pixels;
+}
+
+/// Reads a single channel of a part back from an EXR file as float.
+std::vector<float> readChannel(Imf::MultiPartInputFile& file, int partIndex, const std::string& name)
+{
+    std::vector<float> data(kWidth * kHeight, -1.f);
+    Imf::FrameBuffer frameBuffer;
+    frameBuffer.insert(name, Imf::Slice(Imf::FLOAT, reinterpret_cast<char*>(data.data()), sizeof(float), kWidth * sizeof(float)));
+    Imf::InputPart part(file, partIndex);
+    part.setFrameBuffer(frameBuffer);
+    part.readPixels(0, kHeight - 1);
+    return data;
+}
+
+/// Checks the type and pixel values of the channels of a layer in a part of an EXR file.
+void checkLayer(
+    CPUUnitTestContext& ctx,
+    Imf::MultiPartInputFile& file,
+    int partIndex,
+    const std::string& layerName,
+    const std::string& channelNames,
+    Imf::PixelType pixelType
+)
+{
+    const Imf::ChannelList& channels = file.header(partIndex).channels();
+    for (uint32_t c = 0; c < channelNames.size(); c++)
+    {
+        std::string name = layerName + "." + channelNames[c];
+        const Imf::Channel* pChannel = channels.findChannel(name);
+        ASSERT(pChannel != nullptr);
+        EXPECT(pChannel->type == pixelType);
+
+        auto data = readChannel(file, partIndex, name);
+        for (uint32_t y = 0; y < kHeight; y++)
+            for (uint32_t x = 0; x < kWidth; x++)
+                EXPECT_EQ(data[y * kWidth + x], getValue(x, y, c));
+    }
+}
+} // namespace
+
+CPU_TEST(ExrWriter_Float)
+{
+    const auto path = getRuntimeDirectory() / "test_exr_writer_float.exr";
+
+    // Write all channels as float from padded rows.
+    const uint32_t rowPitchInFloats = kWidth * 4 + 3;
+    auto pixels = createPixels(rowPitchInFloats);
+    auto layer = ExrWriter::createLayer("", kWidth, kHeight, ResourceFormat::RGBA32Float, pixels.data());
+    layer.rowPitch = rowPitchInFloats * sizeof(float);
+    EXPECT_EQ(layer.channels.size(), 4);
+
+    ExrWriter::Options options;
+    options.compression = ExrWriter::Compression::ZIP;
+    options.threadCount = 4;
+    ExrWriter::write(path, {layer}, options);
+
+    auto bmp = Bitmap::createFromFile(path, true);
+    ASSERT(bmp != nullptr);
+    EXPECT_EQ(bmp->getWidth(), kWidth);
+    EXPECT_EQ(bmp->getHeight(), kHeight);
+    ASSERT_EQ((uint32_t)bmp->getFormat(), (uint32_t)ResourceFormat::RGBA32Float);
+
+    const float* data = reinterpret_cast<const float*>(bmp->getData());
+    for (uint32_t y = 0; y < kHeight; y++)
+        for (uint32_t x = 0; x < kWidth; x++)
+            for (uint32_t c = 0; c < 4; c++)
+                EXPECT_EQ(data[(y * kWidth + x) * 4 + c], getValue(x, y, c));
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ExrWriter_Half)
+{
+    const auto path = getRuntimeDirectory() / "test_exr_writer_half.exr";
+
+    // Write the RGB channels as half with PIZ compression, the alpha channel is skipped.
+    auto pixels = createPixels(kWidth * 4);
+    auto layer = ExrWriter::createLayer(
+        "", kWidth, kHeight, ResourceFormat::RGBA32Float, pixels.data(), TextureChannelFlags::RGB, ExrWriter::PixelType::Half
+    );
+    EXPECT_EQ(layer.channels.size(), 3);
+
+    ExrWriter::Options options;
+    options.compression = ExrWriter::Compression::PIZ;
+    ExrWriter::write(path, {layer}, options);
+
+    // Half precision EXRs are loaded as RGBA16Float.
+    auto bmp = Bitmap::createFromFile(path, true);
+    ASSERT(bmp != nullptr);
+    ASSERT_EQ((uint32_t)bmp->getFormat(), (uint32_t)ResourceFormat::RGBA16Float);
+
+    const float16_t* data = reinterpret_cast<const float16_t*>(bmp->getData());
+    for (uint32_t y = 0; y < kHeight; y++)
+        for (uint32_t x = 0; x < kWidth; x++)
+            for (uint32_t c = 0; c < 3; c++)
+                EXPECT_EQ(float(data[(y * kWidth + x) * 4 + c]), getValue(x, y, c));
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ExrWriter_Layers)
+{
+    const auto path = getRuntimeDirectory() / "test_exr_writer_layers.exr";
+
+    auto pixels = createPixels(kWidth * 4);
+    auto posW = ExrWriter::createLayer("posW", kWidth, kHeight, ResourceFormat::RGBA32Float, pixels.data(), TextureChannelFlags::RGB);
+    auto color = ExrWriter::createLayer(
+        "color", kWidth, kHeight, ResourceFormat::RGBA32Float, pixels.data(), TextureChannelFlags::RGBA, ExrWriter::PixelType::Half
+    );
+
+    // Use lossless compression so that the pixel values can be compared exactly.
+    ExrWriter::Options options;
+    options.compression = ExrWriter::Compression::PIZ;
+
+    // Multi-part file with one named part per layer.
+    ExrWriter::write(path, {posW, color}, options);
+    {
+        Imf::MultiPartInputFile file(path.string().c_str());
+        ASSERT_EQ(file.parts(), 2);
+        ASSERT(file.header(0).hasName() && file.header(1).hasName());
+        EXPECT_EQ(file.header(0).name(), "posW");
+        EXPECT_EQ(file.header(1).name(), "color");
+        EXPECT(file.header(0).compression() == Imf::PIZ_COMPRESSION);
+
+        checkLayer(ctx, file, 0, "posW", "RGB", Imf::FLOAT);
+        checkLayer(ctx, file, 1, "color", "RGBA", Imf::HALF);
+        EXPECT(file.header(0).channels().findChannel("posW.A") == nullptr);
+        EXPECT(file.header(0).channels().findChannel("color.R") == nullptr);
+    }
+
+    // Single-part file with layered channel names.
+    options.multiPart = false;
+    ExrWriter::write(path, {posW, color}, options);
+    {
+        Imf::MultiPartInputFile file(path.string().c_str());
+        ASSERT_EQ(file.parts(), 1);
+        checkLayer(ctx, file, 0, "posW", "RGB", Imf::FLOAT);
+        checkLayer(ctx, file, 0, "color", "RGBA", Imf::HALF);
+        EXPECT(file.header(0).channels().findChannel("posW.A") == nullptr);
+    }
+
+    // Lossy compression is passed through to the file.
+    options.compression = ExrWriter::Compression::DWAA;
+    ExrWriter::write(path, {posW, color}, options);
+    {
+        Imf::MultiPartInputFile file(path.string().c_str());
+        ASSERT_EQ(file.parts(), 1);
+        EXPECT(file.header(0).compression() == Imf::DWAA_COMPRESSION);
+    }
+
+    // Invalid layers.
+    std::vector<ExrWriter::Layer> duplicateNames = {posW, posW};
+    EXPECT_THROW(ExrWriter::write(path, duplicateNames));
+
+    std::vector<ExrWriter::Layer> unnamed = {posW, color};
+    unnamed[0].name = "";
+    EXPECT_THROW(ExrWriter::write(path, unnamed));
+
+    std::vector<ExrWriter::Layer> mismatchingSize = {posW, color};
+    mismatchingSize[1].height = kHeight - 1;
+    EXPECT_THROW(ExrWriter::write(path, mismatchingSize, options));
+
+    std::vector<ExrWriter::Layer> invalidFormat = {posW};
+    invalidFormat[0].format = ResourceFormat::RGBA8Unorm;
+    EXPECT_THROW(ExrWriter::write(path, invalidFormat));
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -26,10 +26,31 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCache.h"
 #include "Utils/Image/TextureManager.h"
+#include <random>
 
 namespace Falcor
 {
+namespace
+{
+std::vector<uint8_t> createRandomPixels(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> pixels(width * height * 4);
+    for (auto& p : pixels)
+        p = (uint8_t)rng();
+    return pixels;
+}
+
+void writePng(const std::filesystem::path& path, uint32_t width, uint32_t height, std::vector<uint8_t>& pixels, Bitmap::ExportFlags flags)
+{
+    Bitmap::saveImage(
+        path, width, height, Bitmap::FileFormat::PngFile, flags | Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, pixels.data()
+    );
+}
+} // namespace
+
 GPU_TEST(TextureManager_LoadMips)
 {
     ref<Device> pDevice = ctx.getDevice();
@@ -51,4 +72,215 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_ContentDeduplication)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Write identical images under different names, the same pixels encoded differently, and a different image.
+    const uint32_t kSize = 16;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "TextureManager_ContentDeduplication";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    auto pixels = createRandomPixels(kSize, kSize, 1);
+    auto otherPixels = createRandomPixels(kSize, kSize, 2);
+    writePng(directory / "a.png", kSize, kSize, pixels, Bitmap::ExportFlags::None);
+    std::filesystem::copy_file(directory / "a.png", directory / "b.png");
+    writePng(directory / "c.png", kSize, kSize, pixels, Bitmap::ExportFlags::Uncompressed);
+    writePng(directory / "d.png", kSize, kSize, otherPixels, Bitmap::ExportFlags::None);
+    std::filesystem::copy_file(directory / "a.png", directory / "e.png");
+    std::filesystem::copy_file(directory / "a.png", directory / "f.png");
+
+    TextureManager textureManager(pDevice, 16);
+    textureManager.setContentDeduplication(true);
+    EXPECT(textureManager.isContentDeduplicationEnabled());
+
+    auto load = [&](const std::string& name)
+    { return textureManager.loadTexture(directory / name, true, false, ResourceBindFlags::ShaderResource, false); };
+
+    auto a = load("a.png");
+    auto b = load("b.png");
+    auto c = load("c.png");
+    auto d = load("d.png");
+    EXPECT(!(a == b) && !(a == c));
+    ASSERT(textureManager.getTexture(a) != nullptr);
+    EXPECT(textureManager.getTexture(b) == textureManager.getTexture(a));
+    EXPECT(textureManager.getTexture(c) == textureManager.getTexture(a));
+    EXPECT(textureManager.getTexture(d) != textureManager.getTexture(a));
+
+    // Different load options are not deduplicated.
+    auto aSrgb = textureManager.loadTexture(directory / "a.png", true, true, ResourceBindFlags::ShaderResource, false);
+    EXPECT(textureManager.getTexture(aSrgb) != textureManager.getTexture(a));
+
+    auto stats = textureManager.getStats();
+    EXPECT_EQ(stats.textureCount, 3);
+    EXPECT_EQ(stats.textureDeduplicatedCount, 2);
+    EXPECT_EQ(stats.textureDeduplicatedMemoryInBytes, 2 * textureManager.getTexture(a)->getTextureSizeInBytes());
+
+    // The shared texture stays managed until its last handle is removed.
+    auto pTexture = textureManager.getTexture(a);
+    textureManager.removeTexture(a);
+    EXPECT(textureManager.getTexture(b) == pTexture);
+    EXPECT(textureManager.addTexture(pTexture) == b || textureManager.addTexture(pTexture) == c);
+
+    // Deferred loading shares textures with identical files within the batch and with already loaded textures.
+    textureManager.beginDeferredLoading();
+    auto e = textureManager.loadTexture(directory / "e.png", true, false);
+    auto f = textureManager.loadTexture(directory / "f.png", true, false);
+    textureManager.endDeferredLoading();
+    EXPECT(textureManager.getTexture(e) == pTexture);
+    EXPECT(textureManager.getTexture(f) == pTexture);
+
+    std::filesystem::remove_all(directory);
+}
+
+GPU_TEST(TextureManager_TextureCache)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "TextureManager_TextureCache";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // Block compression requires dimensions that are a multiple of 4, other images are cached uncompressed.
+    auto pixels = createRandomPixels(16, 16, 1);
+    auto oddPixels = createRandomPixels(6, 6, 2);
+    writePng(directory / "a.png", 16, 16, pixels, Bitmap::ExportFlags::None);
+    writePng(directory / "b.png", 6, 6, oddPixels, Bitmap::ExportFlags::None);
+
+    auto prevDirectory = TextureCache::getDirectory();
+    TextureCache::setDirectory(directory / "cache");
+    TextureCache::resetStats();
+
+    auto load = [&](TextureManager& textureManager, const std::string& name, bool loadAsSrgb, ResourceBindFlags bindFlags)
+    {
+        auto handle = textureManager.loadTexture(directory / name, true, loadAsSrgb, bindFlags, false);
+        return textureManager.getTexture(handle);
+    };
+
+    {
+        // First load writes the cache entries and creates the textures from them.
+        TextureManager textureManager(pDevice, 16);
+        textureManager.setTextureCache(true);
+        EXPECT(textureManager.isTextureCacheEnabled());
+
+        auto pA = load(textureManager, "a.png", false, ResourceBindFlags::ShaderResource);
+        ASSERT(pA != nullptr);
+        EXPECT_EQ(pA->getFormat(), ResourceFormat::BC7Unorm);
+        EXPECT_EQ(pA->getWidth(), 16);
+        EXPECT_EQ(pA->getMipCount(), 5);
+        EXPECT(pA->getSourcePath() == directory / "a.png");
+
+        auto pB = load(textureManager, "b.png", false, ResourceBindFlags::ShaderResource);
+        ASSERT(pB != nullptr);
+        EXPECT(!isCompressedFormat(pB->getFormat()));
+        EXPECT_EQ(pB->getMipCount(), 3);
+
+        auto stats = TextureCache::getStats();
+        EXPECT_EQ(stats.writeCount, 2);
+        EXPECT_EQ(stats.missCount, 2);
+    }
+
+    {
+        // Second load reads the cache entries. The sRGB flag is applied when reading.
+        TextureManager textureManager(pDevice, 16);
+        textureManager.setTextureCache(true);
+        TextureCache::resetStats();
+
+        auto pA = load(textureManager, "a.png", true, ResourceBindFlags::ShaderResource);
+        ASSERT(pA != nullptr);
+        EXPECT_EQ(pA->getFormat(), ResourceFormat::BC7UnormSrgb);
+        EXPECT_EQ(pA->getMipCount(), 5);
+
+        auto stats = TextureCache::getStats();
+        EXPECT_EQ(stats.hitCount, 1);
+        EXPECT_EQ(stats.missCount, 0);
+        EXPECT_EQ(stats.writeCount, 0);
+
+        // Textures requesting unordered access are not cached.
+        auto pUav = load(textureManager, "a.png", false, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        ASSERT(pUav != nullptr);
+        EXPECT(!isCompressedFormat(pUav->getFormat()));
+        EXPECT_EQ(TextureCache::getStats().hitCount, 1);
+    }
+
+    TextureCache::setDirectory(prevDirectory);
+    TextureCache::resetStats();
+    std::filesystem::remove_all(directory);
+}
+
+GPU_TEST(TextureManager_TextureAnalysis)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "TextureManager_TextureAnalysis";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    std::vector<uint8_t> constantPixels(16 * 16 * 4);
+    for (size_t i = 0; i < constantPixels.size(); i++)
+        constantPixels[i] = (uint8_t)(64 * (i % 4) + 32);
+    auto pixels = createRandomPixels(16, 16, 1);
+    writePng(directory / "constant.png", 16, 16, constantPixels, Bitmap::ExportFlags::None);
+    writePng(directory / "random.png", 16, 16, pixels, Bitmap::ExportFlags::None);
+
+    auto prevDirectory = TextureCache::getDirectory();
+    TextureCache::setDirectory(directory / "cache");
+    TextureCache::resetStats();
+
+    auto load = [&](TextureManager& textureManager, const std::string& name)
+    {
+        auto handle = textureManager.loadTexture(directory / name, true, false, ResourceBindFlags::ShaderResource, false);
+        return textureManager.getTexture(handle);
+    };
+
+    auto verifyConstant = [&](const std::optional<TextureAnalyzer::Result>& analysis)
+    {
+        ASSERT(analysis.has_value());
+        EXPECT(analysis->isConstant(TextureChannelFlags::RGBA));
+        for (int c = 0; c < 4; c++)
+            EXPECT_EQ(analysis->value[c], (64 * c + 32) / 255.f) << "c = " << c;
+    };
+
+    // Textures are analyzed on the CPU while loading, with and without the texture cache.
+    for (bool useCache : {false, true})
+    {
+        TextureManager textureManager(pDevice, 16);
+        textureManager.setTextureCache(useCache);
+
+        auto pConstant = load(textureManager, "constant.png");
+        ASSERT(pConstant != nullptr);
+        verifyConstant(textureManager.getTextureAnalysis(pConstant.get()));
+
+        auto pRandom = load(textureManager, "random.png");
+        ASSERT(pRandom != nullptr);
+        auto analysis = textureManager.getTextureAnalysis(pRandom.get());
+        ASSERT(analysis.has_value());
+        EXPECT(!analysis->isConstant(TextureChannelFlags::RGB));
+    }
+
+    {
+        // Cached constant textures are created with a single texel without reading any image data.
+        TextureManager textureManager(pDevice, 16);
+        textureManager.setTextureCache(true);
+        TextureCache::resetStats();
+
+        auto pConstant = load(textureManager, "constant.png");
+        ASSERT(pConstant != nullptr);
+        EXPECT_EQ(pConstant->getWidth(), 1);
+        EXPECT_EQ(pConstant->getHeight(), 1);
+        EXPECT(pConstant->getSourcePath() == directory / "constant.png");
+        verifyConstant(textureManager.getTextureAnalysis(pConstant.get()));
+
+        auto stats = TextureCache::getStats();
+        EXPECT_EQ(stats.hitCount, 1);
+        EXPECT_EQ(stats.constantCount, 1);
+        EXPECT_EQ(stats.writeCount, 0);
+    }
+
+    TextureCache::setDirectory(prevDirectory);
+    TextureCache::resetStats();
+    std::filesystem::remove_all(directory);
+}
 } // namespace Falcor
@@ -856,4 +856,43 @@ CPU_TEST(Matrix_Json)
     );
 }
 
+
+CPU_BENCHMARK(Matrix_mulBench)
+{
+    const size_t kCount = 4096;
+    std::vector<float4x4> a(kCount), b(kCount), c(kCount);
+    for (size_t i = 0; i < kCount; i++)
+    {
+        a[i] = math::matrixFromRotationXYZ(0.1f * i, 0.2f * i, 0.3f * i);
+        b[i] = math::matrixFromTranslation(float3(float(i), 1.f, 2.f));
+    }
+
+    ctx.setItemsPerIteration(kCount);
+    ctx.run(
+        [&]()
+        {
+            for (size_t i = 0; i < kCount; i++)
+                c[i] = mul(a[i], b[i]);
+            ctx.doNotOptimize(c);
+        }
+    );
+}
+
+CPU_BENCHMARK(Matrix_inverseBench)
+{
+    const size_t kCount = 4096;
+    std::vector<float4x4> a(kCount), c(kCount);
+    for (size_t i = 0; i < kCount; i++)
+        a[i] = mul(math::matrixFromTranslation(float3(float(i), 1.f, 2.f)), math::matrixFromRotationXYZ(0.1f * i, 0.2f * i, 0.3f * i));
+
+    ctx.setItemsPerIteration(kCount);
+    ctx.run(
+        [&]()
+        {
+            for (size_t i = 0; i < kCount; i++)
+                c[i] = inverse(a[i]);
+            ctx.doNotOptimize(c);
+        }
+    );
+}
 } // namespace Falcor
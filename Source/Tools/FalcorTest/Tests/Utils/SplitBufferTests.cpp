@@ -652,4 +652,25 @@ GPU_TEST(SplitBuffer_StructuredBuffer_Many32B)
     }
 }
 
+
+CPU_BENCHMARK(SplitBuffer_InsertBench)
+{
+    // Inserting mesh-sized chunks on the CPU, as done by the scene builder for vertex and index data.
+    const uint32_t kChunkCount = 1024;
+    const uint32_t kChunkSize = 1024;
+    std::vector<S32B> chunk(kChunkSize);
+    for (uint32_t i = 0; i < kChunkSize; i++)
+        chunk[i] = S32B(float(i));
+
+    ctx.setItemsPerIteration(uint64_t(kChunkCount) * kChunkSize);
+    ctx.setBytesPerIteration(uint64_t(kChunkCount) * kChunkSize * sizeof(S32B));
+    ctx.run(
+        [&]()
+        {
+            SplitBuffer<S32B, false> buffer;
+            for (uint32_t i = 0; i < kChunkCount; i++)
+                ctx.doNotOptimize(buffer.insert(chunk.begin(), chunk.end()));
+        }
+    );
+}
 } // namespace Falcor
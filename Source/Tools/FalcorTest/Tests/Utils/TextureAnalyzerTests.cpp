@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Testing/UnitTest.h"
+#include "Utils/Image/Bitmap.h"
 #include "Utils/Image/TextureAnalyzer.h"
 
 namespace Falcor
@@ -118,6 +119,44 @@ const TextureAnalyzer::Result kExpectedResult[] = {
         float4(0.f, 0.f, 0.f, 1 / 256.f),
     },
 };
+
+std::filesystem::path getTestTexturePath(size_t i)
+{
+    return getRuntimeDirectory() / fmt::format("data/tests/texture{}.{}", i + 1, i < kNumPNGs ? "png" : "exr");
+}
+
+void verifyResults(UnitTestContext& ctx, const std::vector<TextureAnalyzer::Result>& result)
+{
+    for (size_t i = 0; i < kNumTests; i++)
+    {
+        EXPECT_EQ(result[i].mask, kExpectedResult[i].mask) << "i = " << i;
+
+        uint32_t rangeFlags = 0;
+        for (int c = 0; c < 4; c++)
+        {
+            bool isConstant = (kExpectedResult[i].mask & (1u << c)) == 0;
+            rangeFlags |= kExpectedResult[i].mask >> (4 + 4 * c);
+
+            EXPECT_EQ(result[i].isConstant(1u << c), isConstant) << " c = " << c;
+            EXPECT_EQ(result[i].minValue[c], kExpectedResult[i].minValue[c]) << "i = " << i << " c = " << c;
+            EXPECT_EQ(result[i].maxValue[c], kExpectedResult[i].maxValue[c]) << "i = " << i << " c = " << c;
+
+            if (isConstant)
+            {
+                EXPECT_EQ(result[i].value[c], kExpectedResult[i].value[c]) << "i = " << i << " c = " << c;
+            }
+        }
+
+        EXPECT_EQ(result[i].isPos(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isNeg(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isInf(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isNaN(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN) != 0)
+            << "i = " << i;
+    }
+}
 } // namespace
 
 GPU_TEST(TextureAnalyzer)
@@ -130,7 +169,7 @@ GPU_TEST(TextureAnalyzer)
     std::vector<ref<Texture>> textures(kNumTests);
     for (size_t i = 0; i < kNumTests; i++)
     {
-        std::filesystem::path path = getRuntimeDirectory() / fmt::format("data/tests/texture{}.{}", i + 1, i < kNumPNGs ? "png" : "exr");
+        std::filesystem::path path = getTestTexturePath(i);
         textures[i] = Texture::createFromFile(pDevice, path, false, false);
         if (!textures[i])
             FALCOR_THROW("Failed to load {}", path);
@@ -146,47 +185,56 @@ GPU_TEST(TextureAnalyzer)
         textureAnalyzer.analyze(ctx.getRenderContext(), textures[i], 0, 0, pResult, i * kResultSize);
     }
 
-    auto verify = [&ctx](ref<Buffer> pResult)
-    {
-        // Verify results.
-        std::vector<TextureAnalyzer::Result> result = pResult->getElements<TextureAnalyzer::Result>();
-        for (size_t i = 0; i < kNumTests; i++)
-        {
-            EXPECT_EQ(result[i].mask, kExpectedResult[i].mask) << "i = " << i;
+    verifyResults(ctx, pResult->getElements<TextureAnalyzer::Result>());
 
-            uint32_t rangeFlags = 0;
-            for (int c = 0; c < 4; c++)
-            {
-                bool isConstant = (kExpectedResult[i].mask & (1u << c)) == 0;
-                rangeFlags |= kExpectedResult[i].mask >> (4 + 4 * c);
+    // Test the array version of the interface.
+    ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0xbabababa));
+    textureAnalyzer.analyze(ctx.getRenderContext(), textures, pResult);
 
-                EXPECT_EQ(result[i].isConstant(1u << c), isConstant) << " c = " << c;
-                EXPECT_EQ(result[i].minValue[c], kExpectedResult[i].minValue[c]) << "i = " << i << " c = " << c;
-                EXPECT_EQ(result[i].maxValue[c], kExpectedResult[i].maxValue[c]) << "i = " << i << " c = " << c;
+    verifyResults(ctx, pResult->getElements<TextureAnalyzer::Result>());
+}
 
-                if (isConstant)
-                {
-                    EXPECT_EQ(result[i].value[c], kExpectedResult[i].value[c]) << "i = " << i << " c = " << c;
-                }
-            }
+CPU_TEST(TextureAnalyzer_CPU)
+{
+    // Analyze the decoded images on the CPU. The results match the GPU analysis of the textures.
+    std::vector<TextureAnalyzer::Result> results(kNumTests);
+    for (size_t i = 0; i < kNumTests; i++)
+    {
+        std::filesystem::path path = getTestTexturePath(i);
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true);
+        if (!pBitmap)
+            FALCOR_THROW("Failed to load {}", path);
+        auto result = TextureAnalyzer::analyze(*pBitmap);
+        ASSERT(result.has_value());
+        results[i] = *result;
+    }
 
-            EXPECT_EQ(result[i].isPos(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isNeg(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isInf(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isNaN(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN) != 0)
-                << "i = " << i;
-        }
-    };
+    verifyResults(ctx, results);
 
-    verify(pResult);
+    // Color channels of 8-bit textures are converted to linear when loaded as sRGB, alpha is unchanged.
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(getTestTexturePath(0), true);
+    auto srgbResult = TextureAnalyzer::analyze(*pBitmap, true);
+    ASSERT(srgbResult.has_value());
+    EXPECT_EQ(srgbResult->mask, kExpectedResult[0].mask);
+    EXPECT_LE(std::abs(srgbResult->value.r - 0.2158605f), 1e-6f);
+    EXPECT_EQ(srgbResult->value.g, 1.f);
+    EXPECT_EQ(srgbResult->value.a, 1.f);
 
-    // Test the array version of the interface.
-    ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0xbabababa));
-    textureAnalyzer.analyze(ctx.getRenderContext(), textures, pResult);
+    // Compressed formats are not supported.
+    std::vector<uint8_t> blocks(16);
+    EXPECT(!TextureAnalyzer::analyze(*Bitmap::create(4, 4, ResourceFormat::BC7Unorm, blocks.data())).has_value());
+}
+
+CPU_BENCHMARK(TextureAnalyzer_CPUBench)
+{
+    const uint32_t kSize = 2048;
+    std::vector<uint8_t> texels(size_t(kSize) * kSize * 4);
+    for (size_t i = 0; i < texels.size(); i++)
+        texels[i] = uint8_t(i * 2654435761u >> 24);
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::create(kSize, kSize, ResourceFormat::RGBA8Unorm, texels.data());
 
-    verify(pResult);
+    ctx.setItemsPerIteration(uint64_t(kSize) * kSize);
+    ctx.setBytesPerIteration(texels.size());
+    ctx.run([&]() { ctx.doNotOptimize(TextureAnalyzer::analyze(*pBitmap)); });
 }
 } // namespace Falcor
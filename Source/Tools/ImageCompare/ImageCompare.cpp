@@ -27,8 +27,11 @@
  **************************************************************************/
 #include <FreeImage.h>
 #include <args.hxx>
+#include <nlohmann/json.hpp>
 
 #include <iostream>
+#include <fstream>
+#include <iomanip>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,6 +39,12 @@
 #include <map>
 #include <functional>
 #include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <chrono>
+#include <random>
+#include <limits>
 
 #include <cmath>
 #include <cstring>
@@ -188,68 +197,326 @@ private:
     std::unique_ptr<float[]> mData;
 };
 
-struct MSE
+/// Number of pixels per work item of the metric kernels. The images are split into blocks of whole rows.
+static constexpr size_t kBlockPixelCount = 65536;
+
+/// Number of independent accumulators used for summing errors.
+static constexpr size_t kLaneCount = 8;
+
+/// Run func(index) for all indices in [0, count) in parallel.
+template<typename Func>
+void parallelFor(size_t count, const Func& func)
+{
+    std::vector<size_t> indices(count);
+    std::iota(indices.begin(), indices.end(), size_t(0));
+    std::for_each(std::execution::par, indices.begin(), indices.end(), func);
+}
+
+/**
+ * Sum an array of values.
+ * The values are summed in kLaneCount interleaved lanes which the compiler maps to SIMD registers.
+ * The order of summation only depends on the count, so results are deterministic.
+ */
+static double sumValues(const double* values, size_t count)
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    double lanes[kLaneCount] = {};
+    size_t i = 0;
+    for (; i + kLaneCount <= count; i += kLaneCount)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
+        for (size_t l = 0; l < kLaneCount; ++l)
+            lanes[l] += values[i + l];
     }
+    double sum = 0.0;
+    for (; i < count; ++i)
+        sum += values[i];
+    for (size_t l = 0; l < kLaneCount; ++l)
+        sum += lanes[l];
+    return sum;
+}
+
+/**
+ * Compute the mean of per-pixel errors.
+ * The image is split into blocks of rows which are processed in parallel. The block size only depends on the
+ * image width, so the result does not depend on the number of threads.
+ * @param[in] width Image width.
+ * @param[in] height Image height.
+ * @param[out] errorMap Optional per-pixel error map (width * height values).
+ * @param[in] kernel Callable kernel(firstRow, rowCount, errors) writing the errors of the given rows.
+ * @return The mean error.
+ */
+template<typename Kernel>
+double computeMeanError(uint32_t width, uint32_t height, float* errorMap, const Kernel& kernel)
+{
+    if (width == 0 || height == 0)
+        return 0.0;
+
+    const uint32_t blockRows = std::max<uint32_t>(1, uint32_t(kBlockPixelCount / width));
+    const size_t blockCount = (height + blockRows - 1) / blockRows;
+    std::vector<double> blockSums(blockCount);
+
+    parallelFor(
+        blockCount,
+        [&](size_t block)
+        {
+            const uint32_t firstRow = uint32_t(block * blockRows);
+            const uint32_t rowCount = std::min(blockRows, height - firstRow);
+            const size_t pixelCount = size_t(rowCount) * width;
+
+            std::vector<double> errors(pixelCount);
+            kernel(firstRow, rowCount, errors.data());
+
+            if (errorMap)
+            {
+                float* dst = errorMap + size_t(firstRow) * width;
+                for (size_t i = 0; i < pixelCount; ++i)
+                    dst[i] = float(errors[i]);
+            }
+            blockSums[block] = sumValues(errors.data(), pixelCount);
+        }
+    );
+
+    return sumValues(blockSums.data(), blockCount) / (double(width) * height);
+}
+
+struct MSE
+{
+    static constexpr double kScale = 1.0;
+    double operator()(float a, float b) const { return sqr(a - b); }
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
-    }
+    static constexpr double kScale = 1.0;
+    double operator()(float a, float b) const { return sqr(a - b) / (sqr(a) + 1e-3); }
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
-    }
+    static constexpr double kScale = 1.0;
+    double operator()(float a, float b) const { return std::fabs(sqr(a - b)); }
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 100.0;
+    double operator()(float a, float b) const { return std::fabs((a - b) / (a + 1e-3)); }
+};
+
+/**
+ * Compute per-pixel errors of a per-channel metric.
+ * The channel count is a compile-time constant so that the channel loop is unrolled and the pixel loop vectorized.
+ */
+template<typename Metric, uint32_t kChannelCount>
+void computePixelErrors(const float* a, const float* b, size_t pixelCount, double* errors)
+{
+    const Metric metric;
+    for (size_t i = 0; i < pixelCount; ++i)
     {
         double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
+        for (uint32_t c = 0; c < kChannelCount; ++c)
+            error += metric(a[i * 4 + c], b[i * 4 + c]);
+        errors[i] = Metric::kScale * error / kChannelCount;
     }
-};
+}
 
 template<typename Metric>
 double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
 {
-    Metric metric;
-    double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
+    const uint32_t width = imageA.getWidth();
+    return computeMeanError(
+        width,
+        imageA.getHeight(),
+        errorMap,
+        [&](uint32_t firstRow, uint32_t rowCount, double* errors)
+        {
+            const size_t offset = size_t(firstRow) * width * 4;
+            const size_t pixelCount = size_t(rowCount) * width;
+            if (alpha)
+                computePixelErrors<Metric, 4>(imageA.getData() + offset, imageB.getData() + offset, pixelCount, errors);
+            else
+                computePixelErrors<Metric, 3>(imageA.getData() + offset, imageB.getData() + offset, pixelCount, errors);
+        }
+    );
+}
+
+/// Peak signal-to-noise ratio in dB, assuming a peak value of 1. The error map contains the per-pixel squared error.
+static double comparePSNR(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+{
+    double mse = compare<MSE>(imageA, imageB, alpha, errorMap);
+    return 10.0 * std::log10(1.0 / mse);
+}
+
+/**
+ * Structural similarity index (Wang et al. 2004) using an 11x11 Gaussian window with sigma 1.5.
+ * SSIM is computed per channel assuming a dynamic range of 1 and averaged over the channels.
+ * The error map contains 1 - SSIM per pixel.
+ */
+static double compareSSIM(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+{
+    static constexpr int kRadius = 5;
+    static constexpr int kTapCount = 2 * kRadius + 1;
+    static constexpr float kSigma = 1.5f;
+    static constexpr float kC1 = 0.01f * 0.01f;
+    static constexpr float kC2 = 0.03f * 0.03f;
+    // Moments of the window: mean of a, mean of b, mean of a^2, mean of b^2, mean of a*b.
+    static constexpr size_t kMomentCount = 5;
+
+    float weights[kTapCount];
+    float weightSum = 0.f;
+    for (int i = 0; i < kTapCount; ++i)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
-        if (errorMap)
-            *errorMap++ = float(error);
-        sum += error;
-        a += 4;
-        b += 4;
+        weights[i] = std::exp(-sqr(float(i - kRadius)) / (2.f * sqr(kSigma)));
+        weightSum += weights[i];
     }
-    return sum / count;
+    for (float& weight : weights)
+        weight /= weightSum;
+
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+    const uint32_t channelCount = alpha ? 4 : 3;
+    const size_t rowSize = size_t(width) * 4;
+
+    double meanError = computeMeanError(
+        width,
+        height,
+        errorMap,
+        [&](uint32_t firstRow, uint32_t rowCount, double* errors)
+        {
+            // Filter the rows covered by the vertical window horizontally.
+            // The filter inputs (a, b, a^2, b^2, a*b) are written to rows padded with the clamped edge pixels,
+            // so that filtering is a branch free loop over contiguous values.
+            const uint32_t bandRows = rowCount + 2 * kRadius;
+            const size_t paddedRowSize = size_t(width + 2 * kRadius) * 4;
+            std::vector<float> band(bandRows * kMomentCount * rowSize);
+            std::vector<float> padded(kMomentCount * paddedRowSize);
+            for (uint32_t r = 0; r < bandRows; ++r)
+            {
+                const int y = clamp(int(firstRow + r) - kRadius, 0, int(height) - 1);
+                const float* a = imageA.getData() + y * rowSize;
+                const float* b = imageB.getData() + y * rowSize;
+                for (int x = 0; x < int(width) + 2 * kRadius; ++x)
+                {
+                    const size_t src = size_t(clamp(x - kRadius, 0, int(width) - 1)) * 4;
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        const size_t dst = x * 4 + c;
+                        const float va = a[src + c];
+                        const float vb = b[src + c];
+                        padded[dst] = va;
+                        padded[paddedRowSize + dst] = vb;
+                        padded[2 * paddedRowSize + dst] = va * va;
+                        padded[3 * paddedRowSize + dst] = vb * vb;
+                        padded[4 * paddedRowSize + dst] = va * vb;
+                    }
+                }
+
+                for (size_t m = 0; m < kMomentCount; ++m)
+                {
+                    const float* src = padded.data() + m * paddedRowSize;
+                    float* dst = band.data() + (r * kMomentCount + m) * rowSize;
+                    for (size_t i = 0; i < rowSize; ++i)
+                    {
+                        float sum = 0.f;
+                        for (int t = 0; t < kTapCount; ++t)
+                            sum += weights[t] * src[t * 4 + i];
+                        dst[i] = sum;
+                    }
+                }
+            }
+
+            // Filter vertically and evaluate SSIM.
+            std::vector<float> filtered(kMomentCount * rowSize);
+            for (uint32_t r = 0; r < rowCount; ++r)
+            {
+                const float* src = band.data() + r * kMomentCount * rowSize;
+                const size_t stride = kMomentCount * rowSize;
+                for (size_t i = 0; i < kMomentCount * rowSize; ++i)
+                {
+                    float sum = 0.f;
+                    for (int t = 0; t < kTapCount; ++t)
+                        sum += weights[t] * src[t * stride + i];
+                    filtered[i] = sum;
+                }
+
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    double ssim = 0.0;
+                    for (uint32_t c = 0; c < channelCount; ++c)
+                    {
+                        const size_t i = x * 4 + c;
+                        const float muA = filtered[i];
+                        const float muB = filtered[rowSize + i];
+                        const float varA = filtered[2 * rowSize + i] - muA * muA;
+                        const float varB = filtered[3 * rowSize + i] - muB * muB;
+                        const float covar = filtered[4 * rowSize + i] - muA * muB;
+                        ssim += ((2.f * muA * muB + kC1) * (2.f * covar + kC2)) / ((muA * muA + muB * muB + kC1) * (varA + varB + kC2));
+                    }
+                    errors[size_t(r) * width + x] = 1.0 - ssim / channelCount;
+                }
+            }
+        }
+    );
+
+    return 1.0 - meanError;
+}
+
+/// Cube root of a non-negative value. Unlike std::cbrt, this can be vectorized by the compiler.
+static float cbrtFast(float x)
+{
+    // Initial guess from the exponent bits, refined with Newton iterations to full float precision.
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(float));
+    bits = bits / 3 + 709921077;
+    float y;
+    std::memcpy(&y, &bits, sizeof(float));
+    for (int i = 0; i < 3; ++i)
+        y = (2.f * y + x / (y * y)) * (1.f / 3.f);
+    return y;
+}
+
+/// Convert linear sRGB to CIELAB (D65 white point).
+static void linearRGBToLab(const float* rgb, float& L, float& a, float& b)
+{
+    // Linear sRGB to CIE XYZ, normalized by the white point.
+    const float x = (0.4124564f * rgb[0] + 0.3575761f * rgb[1] + 0.1804375f * rgb[2]) / 0.95047f;
+    const float y = 0.2126729f * rgb[0] + 0.7151522f * rgb[1] + 0.0721750f * rgb[2];
+    const float z = (0.0193339f * rgb[0] + 0.1191920f * rgb[1] + 0.9503041f * rgb[2]) / 1.08883f;
+
+    auto f = [](float t) { return t > 0.008856f ? cbrtFast(t) : 7.787037f * t + 16.f / 116.f; };
+    const float fx = f(x);
+    const float fy = f(y);
+    const float fz = f(z);
+    L = 116.f * fy - 16.f;
+    a = 500.f * (fx - fy);
+    b = 200.f * (fy - fz);
+}
+
+/**
+ * Mean HyAB color difference (Abasi et al. 2020) in CIELAB, which is the color term of the FLIP metric.
+ * Images are assumed to contain linear sRGB values. The alpha channel is ignored.
+ */
+static double compareHyAB(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+{
+    const uint32_t width = imageA.getWidth();
+    return computeMeanError(
+        width,
+        imageA.getHeight(),
+        errorMap,
+        [&](uint32_t firstRow, uint32_t rowCount, double* errors)
+        {
+            const size_t offset = size_t(firstRow) * width * 4;
+            const float* a = imageA.getData() + offset;
+            const float* b = imageB.getData() + offset;
+            const size_t pixelCount = size_t(rowCount) * width;
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                float La, aa, ba, Lb, ab, bb;
+                linearRGBToLab(a + i * 4, La, aa, ba);
+                linearRGBToLab(b + i * 4, Lb, ab, bb);
+                errors[i] = std::fabs(La - Lb) + std::sqrt(sqr(aa - ab) + sqr(ba - bb));
+            }
+        }
+    );
 }
 
 struct ErrorMetric
@@ -257,6 +524,7 @@ struct ErrorMetric
     std::string name;
     std::string desc;
     std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    bool higherIsBetter = false; ///< If true, comparisons pass if the value is greater or equal to the threshold.
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
@@ -264,6 +532,9 @@ static const std::vector<ErrorMetric> errorMetrics = {
     {"rmse", "Relative Mean Squared Error", compare<RMSE>},
     {"mae", "Mean Absolute Error", compare<MAE>},
     {"mape", "Mean Absolute Percentage Error", compare<MAPE>},
+    {"psnr", "Peak Signal-to-Noise Ratio in dB, peak value 1 (higher is better)", comparePSNR, true},
+    {"ssim", "Structural Similarity Index (higher is better)", compareSSIM, true},
+    {"hyab", "Mean HyAB Color Difference in CIELAB (color term of FLIP)", compareHyAB},
 };
 
 static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
@@ -298,16 +569,36 @@ static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, c
     return image;
 }
 
-static bool compareImages(
-    const std::filesystem::path& pathA,
-    const std::filesystem::path& pathB,
-    ErrorMetric metric,
-    float threshold,
-    bool alpha,
-    const std::filesystem::path& heatMapPath
-)
+struct ImagePair
+{
+    std::string name; ///< Name used in reports.
+    std::filesystem::path pathA;
+    std::filesystem::path pathB;
+    std::filesystem::path heatMapPath; ///< Heat map output path or empty.
+};
+
+struct CompareResult
 {
-    auto loadImage = [](const std::filesystem::path& path)
+    double error = std::numeric_limits<double>::quiet_NaN();
+    bool success = false;
+    std::vector<std::string> messages; ///< Error messages.
+};
+
+static bool isWithinThreshold(const ErrorMetric& metric, double error, float threshold)
+{
+    // Treat nans and infs as errors, except for infinite values of metrics where higher is better (identical images).
+    if (std::isnan(error))
+        return false;
+    if (metric.higherIsBetter)
+        return error >= threshold;
+    return !std::isinf(error) && error <= threshold;
+}
+
+static CompareResult compareImages(const ImagePair& pair, const ErrorMetric& metric, float threshold, bool alpha)
+{
+    CompareResult result;
+
+    auto loadImage = [&result](const std::filesystem::path& path)
     {
         try
         {
@@ -315,12 +606,12 @@ static bool compareImages(
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.messages.push_back("Cannot load image from '" + path.string() + "' (Error: " + e.what() + ").");
             return std::shared_ptr<Image>{};
         }
     };
 
-    auto saveImage = [](const Image& image, const std::filesystem::path& path)
+    auto saveImage = [&result](const Image& image, const std::filesystem::path& path)
     {
         try
         {
@@ -328,46 +619,244 @@ static bool compareImages(
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot save image to '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.messages.push_back("Cannot save image to '" + path.string() + "' (Error: " + e.what() + ").");
         }
     };
 
     // Load images.
-    auto imageA = loadImage(pathA);
+    auto imageA = loadImage(pair.pathA);
     if (!imageA)
-        return false;
-    auto imageB = loadImage(pathB);
+        return result;
+    auto imageB = loadImage(pair.pathB);
     if (!imageB)
-        return false;
+        return result;
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.messages.push_back("Cannot compare images with different resolutions.");
+        return result;
     }
 
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap = pair.heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    result.error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
 
     // Generate heat map.
     if (errorMap)
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
-        saveImage(*heatMap, heatMapPath);
+        std::error_code ec;
+        if (pair.heatMapPath.has_parent_path())
+            std::filesystem::create_directories(pair.heatMapPath.parent_path(), ec);
+        saveImage(*heatMap, pair.heatMapPath);
     }
 
-    std::cout << error << std::endl;
+    result.success = isWithinThreshold(metric, result.error, threshold);
+    return result;
+}
 
-    // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
-        return false;
+static bool isImageFile(const std::filesystem::path& path)
+{
+    return FreeImage_GetFIFFromFilename(path.string().c_str()) != FIF_UNKNOWN;
+}
+
+/**
+ * Collect image pairs from two directories.
+ * Every image in dirA (including subdirectories) is paired with the image at the same relative path in dirB.
+ * If heatMapDir is not empty, heat maps are written to the same relative path in heatMapDir with an '.error.png' suffix.
+ */
+static std::vector<ImagePair> collectDirectoryPairs(
+    const std::filesystem::path& dirA,
+    const std::filesystem::path& dirB,
+    const std::filesystem::path& heatMapDir
+)
+{
+    if (!std::filesystem::is_directory(dirA))
+        throw std::runtime_error("'" + dirA.string() + "' is not a directory");
+    if (!std::filesystem::is_directory(dirB))
+        throw std::runtime_error("'" + dirB.string() + "' is not a directory");
+
+    std::vector<ImagePair> pairs;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dirA))
+    {
+        if (!entry.is_regular_file() || !isImageFile(entry.path()))
+            continue;
+        auto relativePath = std::filesystem::relative(entry.path(), dirA);
+        ImagePair pair{relativePath.generic_string(), entry.path(), dirB / relativePath};
+        if (!heatMapDir.empty())
+            pair.heatMapPath = heatMapDir / (relativePath.string() + ".error.png");
+        pairs.push_back(std::move(pair));
+    }
+
+    std::sort(pairs.begin(), pairs.end(), [](const ImagePair& lhs, const ImagePair& rhs) { return lhs.name < rhs.name; });
+    return pairs;
+}
+
+/**
+ * Read image pairs from a manifest file.
+ * Each line contains two image paths and an optional heat map path separated by tabs.
+ * Empty lines and lines starting with '#' are ignored. Relative paths are relative to the manifest directory.
+ */
+static std::vector<ImagePair> readManifestPairs(const std::filesystem::path& manifestPath)
+{
+    std::ifstream stream(manifestPath);
+    if (!stream)
+        throw std::runtime_error("Cannot open manifest '" + manifestPath.string() + "'");
+
+    const auto baseDir = manifestPath.parent_path();
+    std::vector<ImagePair> pairs;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(stream, line))
+    {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string> columns;
+        size_t start = 0;
+        while (true)
+        {
+            size_t end = line.find('\t', start);
+            columns.push_back(line.substr(start, end - start));
+            if (end == std::string::npos)
+                break;
+            start = end + 1;
+        }
+        if (columns.size() < 2 || columns.size() > 3)
+            throw std::runtime_error(
+                "Invalid manifest entry in '" + manifestPath.string() + "' line " + std::to_string(lineNumber) +
+                " (expected two or three tab separated paths)"
+            );
+
+        ImagePair pair{columns[1], baseDir / columns[0], baseDir / columns[1]};
+        if (columns.size() == 3)
+            pair.heatMapPath = baseDir / columns[2];
+        pairs.push_back(std::move(pair));
+    }
+
+    return pairs;
+}
+
+static void writeJsonReport(
+    const std::filesystem::path& path,
+    const ErrorMetric& metric,
+    float threshold,
+    const std::vector<ImagePair>& pairs,
+    const std::vector<CompareResult>& results
+)
+{
+    nlohmann::json report;
+    report["metric"] = metric.name;
+    report["threshold"] = threshold;
+    report["higher_is_better"] = metric.higherIsBetter;
+    size_t successCount = std::count_if(results.begin(), results.end(), [](const CompareResult& result) { return result.success; });
+    report["success_count"] = successCount;
+    report["failure_count"] = results.size() - successCount;
+
+    auto& entries = report["results"] = nlohmann::json::array();
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        const auto& result = results[i];
+        nlohmann::json entry;
+        entry["name"] = pairs[i].name;
+        entry["image1"] = pairs[i].pathA.string();
+        entry["image2"] = pairs[i].pathB.string();
+        // JSON has no representation of nans and infs, so they are written as null.
+        entry["error"] = std::isfinite(result.error) ? nlohmann::json(result.error) : nlohmann::json();
+        entry["success"] = result.success;
+        entry["messages"] = result.messages;
+        entries.push_back(std::move(entry));
+    }
+
+    std::ofstream stream(path);
+    if (!stream)
+        throw std::runtime_error("Cannot write report to '" + path.string() + "'");
+    stream << report.dump(4) << std::endl;
+}
+
+static void writeCsvReport(
+    const std::filesystem::path& path,
+    const std::vector<ImagePair>& pairs,
+    const std::vector<CompareResult>& results
+)
+{
+    auto quote = [](const std::string& str)
+    {
+        if (str.find_first_of(",\"\n") == std::string::npos)
+            return str;
+        std::string quoted = "\"";
+        for (char c : str)
+        {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    };
 
-    return error <= threshold;
+    std::ofstream stream(path);
+    if (!stream)
+        throw std::runtime_error("Cannot write report to '" + path.string() + "'");
+    stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+    stream << "name,image1,image2,error,success,message" << std::endl;
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        const auto& result = results[i];
+        std::string message;
+        for (const auto& m : result.messages)
+            message += (message.empty() ? "" : " ") + m;
+        stream << quote(pairs[i].name) << "," << quote(pairs[i].pathA.string()) << "," << quote(pairs[i].pathB.string()) << ","
+               << result.error << "," << (result.success ? "true" : "false") << "," << quote(message) << std::endl;
+    }
+}
+
+/// Measure the throughput of all error metrics on a pair of random images.
+static void runBenchmark(bool alpha)
+{
+    const uint32_t width = 1920;
+    const uint32_t height = 1080;
+    const size_t pixelCount = size_t(width) * height;
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    auto imageA = Image::create(width, height);
+    auto imageB = Image::create(width, height);
+    for (size_t i = 0; i < pixelCount * 4; ++i)
+    {
+        imageA->getData()[i] = dist(rng);
+        imageB->getData()[i] = imageA->getData()[i] + 0.1f * (dist(rng) - 0.5f);
+    }
+    auto errorMap = std::make_unique<float[]>(pixelCount);
+
+    std::cout << "Comparing " << width << "x" << height << " images" << (alpha ? " with alpha" : "") << ":" << std::endl;
+    for (const auto& metric : errorMetrics)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Run for at least one second after a warm-up run.
+        metric.compare(*imageA, *imageB, alpha, errorMap.get());
+        size_t iterations = 0;
+        auto start = Clock::now();
+        double seconds = 0.0;
+        while (seconds < 1.0)
+        {
+            metric.compare(*imageA, *imageB, alpha, errorMap.get());
+            ++iterations;
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        const double ms = 1000.0 * seconds / iterations;
+        const double mpixels = pixelCount * iterations / seconds * 1e-6;
+        std::cout << "  " << std::left << std::setw(6) << metric.name << std::right << std::fixed << std::setprecision(2) << std::setw(10)
+                  << ms << " ms " << std::setw(10) << mpixels << " MPixel/s" << std::defaultfloat << std::endl;
+    }
 }
 
 static void printMetrics(std::ostream& stream = std::cout)
@@ -388,9 +877,21 @@ int main(int argc, char** argv)
     args::ValueFlag<std::string> metricFlag(parser, "metric", "The error metric.", {'m'});
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
-    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::ValueFlag<std::string> heatMapFlag(
+        parser, "filename", "Generate error heat map. In directory mode, heat maps are written to this directory.", {'e'}
+    );
+    args::Flag directoryFlag(
+        parser, "", "Directory mode. Compare all images in directory image1 with the images at the same paths in directory image2.", {'d'}
+    );
+    args::ValueFlag<std::string> manifestFlag(
+        parser, "filename", "Compare the image pairs listed in a manifest file (tab separated image1, image2 and optional heat map path).",
+        {"manifest"}
+    );
+    args::ValueFlag<std::string> jsonFlag(parser, "filename", "Write results to a JSON file.", {"json"});
+    args::ValueFlag<std::string> csvFlag(parser, "filename", "Write results to a CSV file.", {"csv"});
+    args::Flag benchmarkFlag(parser, "", "Measure the throughput of the error metrics.", {"benchmark"});
+    args::Positional<std::string> image1(parser, "image1", "The first image.");
+    args::Positional<std::string> image2(parser, "image2", "The second image.");
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -426,6 +927,21 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    bool alpha = alphaFlag ? args::get(alphaFlag) : false;
+
+    if (benchmarkFlag)
+    {
+        runBenchmark(alpha);
+        return 0;
+    }
+
+    if (!manifestFlag && (!image1 || !image2))
+    {
+        std::cerr << "Two images are required." << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
     ErrorMetric metric = errorMetrics.front();
     if (metricFlag)
     {
@@ -441,13 +957,58 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
-    bool success = compareImages(
-        args::get(image1),
-        args::get(image2),
-        metric,
-        thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false,
-        heatMapFlag ? args::get(heatMapFlag) : ""
-    );
-    return success ? 0 : 1;
+    float threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    std::string heatMapPath = heatMapFlag ? args::get(heatMapFlag) : "";
+    bool batch = manifestFlag || directoryFlag;
+
+    try
+    {
+        // Collect image pairs.
+        std::vector<ImagePair> pairs;
+        if (manifestFlag)
+            pairs = readManifestPairs(args::get(manifestFlag));
+        else if (directoryFlag)
+            pairs = collectDirectoryPairs(args::get(image1), args::get(image2), heatMapPath);
+        else
+            pairs.push_back({args::get(image2), args::get(image1), args::get(image2), heatMapPath});
+
+        // Compare image pairs in parallel.
+        auto startTime = std::chrono::steady_clock::now();
+        std::vector<CompareResult> results(pairs.size());
+        parallelFor(pairs.size(), [&](size_t i) { results[i] = compareImages(pairs[i], metric, threshold, alpha); });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        // Print results.
+        size_t failureCount = 0;
+        for (size_t i = 0; i < pairs.size(); ++i)
+        {
+            const auto& result = results[i];
+            for (const auto& message : result.messages)
+                std::cerr << (batch ? pairs[i].name + ": " : "") << message << std::endl;
+            if (batch)
+                std::cout << result.error << "\t" << (result.success ? "PASSED" : "FAILED") << "\t" << pairs[i].name << std::endl;
+            else if (!std::isnan(result.error) || result.messages.empty())
+                std::cout << result.error << std::endl;
+            if (!result.success)
+                ++failureCount;
+        }
+        if (batch)
+        {
+            std::cout << "Compared " << pairs.size() << " image pairs in " << seconds << " s (" << pairs.size() / std::max(seconds, 1e-9)
+                      << " pairs/s), " << failureCount << " failed." << std::endl;
+        }
+
+        // Write reports.
+        if (jsonFlag)
+            writeJsonReport(args::get(jsonFlag), metric, threshold, pairs, results);
+        if (csvFlag)
+            writeCsvReport(args::get(csvFlag), pairs, results);
+
+        return failureCount == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "." << std::endl;
+        return 1;
+    }
 }
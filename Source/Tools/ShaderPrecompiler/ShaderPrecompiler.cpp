@@ -0,0 +1,193 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Falcor.h"
+#include "Core/Testbed.h"
+#include "Core/Plugin.h"
+#include "Core/Program/ProgramManager.h"
+#include "Utils/Scripting/Scripting.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <args.hxx>
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Falcor;
+
+FALCOR_EXPORT_D3D12_AGILITY_SDK
+
+/**
+ * Offline shader precompiler.
+ *
+ * Loads each combination of scene and render graph in a headless testbed and compiles the programs registered by
+ * the scene and render passes in parallel into the persistent program cache. A few frames are rendered afterwards,
+ * which compiles any programs that are only created or specialized while rendering and looks up the precompiled
+ * programs, so the reported cache hits show how much of the frame the cache covers.
+ * Later runs pointed at the same cache (see FALCOR_PROGRAM_CACHE_PATH) skip the Slang front-end for these programs.
+ */
+int runMain(int argc, char** argv)
+{
+    args::ArgumentParser parser("Falcor shader precompiler.");
+    parser.helpParams.programName = "ShaderPrecompiler";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlagList<std::string> sceneFlag(parser, "path", "Scene file to load (can be specified multiple times).", {'s', "scene"});
+    args::ValueFlagList<std::string> graphFlag(
+        parser, "path", "Render graph script to load (can be specified multiple times).", {'g', "graph"}
+    );
+    args::ValueFlag<std::string> cacheFlag(parser, "path", "Program cache directory.", {'c', "cache"}, args::Options::Required);
+    args::ValueFlag<std::string> deviceTypeFlag(parser, "d3d12|vulkan", "Graphics device type.", {'d', "device-type"});
+    args::ValueFlag<uint32_t> framesFlag(parser, "N", "Number of frames to render per configuration (default: 1).", {'f', "frames"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "N", "Number of compiler threads (default: hardware threads).", {'t', "threads"});
+
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    Testbed::Options options;
+    if (deviceTypeFlag)
+    {
+        if (args::get(deviceTypeFlag) == "d3d12")
+            options.deviceDesc.type = Device::Type::D3D12;
+        else if (args::get(deviceTypeFlag) == "vulkan")
+            options.deviceDesc.type = Device::Type::Vulkan;
+        else
+        {
+            std::cerr << "Invalid device type, use 'd3d12' or 'vulkan'" << std::endl;
+            return 1;
+        }
+    }
+
+    const uint32_t frameCount = framesFlag ? args::get(framesFlag) : 1;
+    const uint32_t threadCount = threadsFlag ? args::get(threadsFlag) : 0;
+
+    std::vector<std::filesystem::path> scenes;
+    for (const auto& scene : args::get(sceneFlag))
+        scenes.push_back(scene);
+    // Render graphs without a scene use a different set of programs, so always precompile those too.
+    if (scenes.empty())
+        scenes.push_back({});
+
+    Scripting::start();
+    PluginManager::instance().loadAllPlugins();
+
+    size_t failedCount = 0;
+    {
+        ref<Testbed> pTestbed = Testbed::create(options);
+        ProgramManager* pProgramManager = pTestbed->getDevice()->getProgramManager();
+        // The command line takes precedence over the FALCOR_PROGRAM_CACHE_PATH environment variable.
+        pProgramManager->setProgramCachePath(args::get(cacheFlag));
+
+        CpuTimer timer;
+        timer.update();
+
+        for (const auto& scene : scenes)
+        {
+            if (!scene.empty())
+            {
+                logInfo("Loading scene '{}'.", scene);
+                pTestbed->loadScene(scene);
+            }
+
+            for (const auto& graph : args::get(graphFlag))
+            {
+                logInfo("Loading render graph '{}'.", graph);
+                pTestbed->setRenderGraph(pTestbed->loadRenderGraph(graph));
+                failedCount += pProgramManager->precompileRegisteredPrograms(threadCount);
+                for (uint32_t i = 0; i < frameCount; ++i)
+                    pTestbed->frame();
+            }
+
+            // Compile scene programs even if no render graph was given.
+            if (args::get(graphFlag).empty())
+            {
+                failedCount += pProgramManager->precompileRegisteredPrograms(threadCount);
+                for (uint32_t i = 0; i < frameCount; ++i)
+                    pTestbed->frame();
+            }
+        }
+
+        timer.update();
+
+        auto compilationStats = pProgramManager->getCompilationStats();
+        auto cacheStats = pProgramManager->getProgramCacheStats();
+        fmt::print(
+            "Compiled {} program versions and {} program kernels in {:.2f} s.\n",
+            compilationStats.programVersionCount,
+            compilationStats.programKernelsCount,
+            timer.delta()
+        );
+        fmt::print(
+            "Program cache '{}': {} hits, {} misses, {} writes.\n",
+            pProgramManager->getProgramCachePath(),
+            cacheStats.hitCount,
+            cacheStats.missCount,
+            cacheStats.writeCount
+        );
+        if (failedCount > 0)
+            fmt::print("{} program versions failed to compile.\n", failedCount);
+
+        pTestbed.reset();
+    }
+
+    PluginManager::instance().releaseAllPlugins();
+    Scripting::shutdown();
+
+    return failedCount > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    return catchAndReportAllExceptions([&]() { return runMain(argc, argv); });
+}
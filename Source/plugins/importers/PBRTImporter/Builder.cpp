@@ -126,6 +126,53 @@ void BasicScene::addInstances(std::vector<InstanceSceneEntity>& instances)
     std::move(instances.begin(), instances.end(), std::back_inserter(mInstances));
 }
 
+void BasicScene::mergeImported(BasicScene& imported, std::optional<uint32_t> inheritedMaterialIndex)
+{
+    const uint32_t firstImportedMaterial = inheritedMaterialIndex ? 1 : 0;
+    const uint32_t materialOffset = (uint32_t)mMaterials.size() - firstImportedMaterial;
+    const int areaLightOffset = (int)mAreaLights.size();
+
+    auto remapShape = [&](ShapeSceneEntity& shape)
+    {
+        if (uint32_t* pIndex = std::get_if<uint32_t>(&shape.materialRef))
+            *pIndex = *pIndex < firstImportedMaterial ? *inheritedMaterialIndex : *pIndex + materialOffset;
+        if (shape.lightIndex >= 0)
+            shape.lightIndex += areaLightOffset;
+    };
+
+    for (uint32_t i = firstImportedMaterial; i < imported.mMaterials.size(); ++i)
+    {
+        auto& material = imported.mMaterials[i];
+        material.name = fmt::format("Unnamed{}", mMaterials.size());
+        mMaterials.push_back(std::move(material));
+    }
+
+    for (auto& [name, material] : imported.mNamedMaterials)
+        mNamedMaterials.emplace(name, std::move(material));
+    for (auto& [name, texture] : imported.mFloatTextures)
+        mFloatTextures.emplace(name, std::move(texture));
+    for (auto& [name, texture] : imported.mSpectrumTextures)
+        mSpectrumTextures.emplace(name, std::move(texture));
+
+    std::move(imported.mMedia.begin(), imported.mMedia.end(), std::back_inserter(mMedia));
+    std::move(imported.mLights.begin(), imported.mLights.end(), std::back_inserter(mLights));
+    std::move(imported.mAreaLights.begin(), imported.mAreaLights.end(), std::back_inserter(mAreaLights));
+
+    for (auto& shape : imported.mShapes)
+    {
+        remapShape(shape);
+        mShapes.push_back(std::move(shape));
+    }
+
+    for (auto& [name, instanceDefinition] : imported.mInstanceDefinitions)
+    {
+        for (auto& shape : instanceDefinition.shapes)
+            remapShape(shape);
+        mInstanceDefinitions.emplace(name, std::move(instanceDefinition));
+    }
+    std::move(imported.mInstances.begin(), imported.mInstances.end(), std::back_inserter(mInstances));
+}
+
 const MaterialSceneEntity& BasicScene::getMaterial(const MaterialRef& materialRef) const
 {
     if (const uint32_t* pIndex = std::get_if<uint32_t>(&materialRef))
@@ -214,6 +261,23 @@ std::string BasicScene::toString() const
 
 BasicSceneBuilder::BasicSceneBuilder(BasicScene& scene) : mScene(scene) {}
 
+BasicSceneBuilder::BasicSceneBuilder(const BasicSceneBuilder& parent, FileLoc loc)
+    : mpImportScene(std::make_unique<BasicScene>(parent.mScene.getSearchPath()))
+    , mScene(*mpImportScene)
+    , mCurrentBlock(parent.mCurrentBlock)
+    , mGraphicsState(parent.mGraphicsState)
+    , mNamedCoordinateSystems(parent.mNamedCoordinateSystems)
+{
+    // Unnamed materials are referenced by index. The material active at the Import directive lives in the
+    // parent's scene, so reserve local index 0 for it and remap when merging.
+    if (const uint32_t* pIndex = std::get_if<uint32_t>(&mGraphicsState.currentMaterial))
+    {
+        mInheritedMaterialIndex = *pIndex;
+        mGraphicsState.currentMaterial = mScene.addMaterial(MaterialSceneEntity("Inherited", "", {}, loc));
+        mUnamedMaterialIndex = 1;
+    }
+}
+
 void BasicSceneBuilder::onReverseOrientation(FileLoc loc)
 {
     VERIFY_WORLD("ReverseOrientation");
@@ -462,6 +526,42 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+std::unique_ptr<ParserTarget> BasicSceneBuilder::onImportBegin(FileLoc loc)
+{
+    VERIFY_WORLD("Import");
+
+    if (mpActiveInstanceDefinition)
+    {
+        throwError(loc, "Import can't be called inside instance definition.");
+    }
+
+    return std::unique_ptr<ParserTarget>(new BasicSceneBuilder(*this, loc));
+}
+
+void BasicSceneBuilder::onImportEnd(ParserTarget& importTarget, FileLoc loc)
+{
+    auto& imported = static_cast<BasicSceneBuilder&>(importTarget);
+    FALCOR_ASSERT(imported.mpImportScene);
+
+    // Names defined in imported files are only checked against this builder when merging.
+    auto mergeNames = [&](std::set<std::string>& names, const std::set<std::string>& importedNames, const std::string_view type)
+    {
+        for (const auto& name : importedNames)
+        {
+            if (!names.insert(name).second)
+                throwError(loc, "Redefining {} '{}' in imported file.", type, name);
+        }
+    };
+    mergeNames(mNamedMaterialNames, imported.mNamedMaterialNames, "named material");
+    mergeNames(mMediumNames, imported.mMediumNames, "named medium");
+    mergeNames(mFloatTextureNames, imported.mFloatTextureNames, "float texture");
+    mergeNames(mSpectrumTextureNames, imported.mSpectrumTextureNames, "spectrum texture");
+    mergeNames(mInstanceNames, imported.mInstanceNames, "object instance");
+
+    mScene.mergeImported(*imported.mpImportScene, imported.mInheritedMaterialIndex);
+    mUnamedMaterialIndex = (uint32_t)mScene.getMaterials().size();
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
@@ -39,6 +39,8 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <variant>
@@ -252,6 +254,16 @@ public:
     void addInstanceDefinition(InstanceDefinitionSceneEntity instanceDefinition);
     void addInstances(std::vector<InstanceSceneEntity>& instances);
 
+    /**
+     * Merge the entities of a scene built from an imported file into this scene.
+     * Unnamed material and area light indices of the imported shapes are remapped to this scene.
+     * @param imported Scene built from the imported file. Its entities are moved.
+     * @param inheritedMaterialIndex If set, material index 0 of the imported scene is a placeholder for this material index.
+     */
+    void mergeImported(BasicScene& imported, std::optional<uint32_t> inheritedMaterialIndex);
+
+    const std::filesystem::path& getSearchPath() const { return mSearchPath; }
+
     const CameraSceneEntity& getCamera() const { return mCamera; }
 
     const std::map<std::string, MaterialSceneEntity>& getNamedMaterials() const { return mNamedMaterials; }
@@ -384,10 +396,18 @@ public:
     void onObjectBegin(const std::string& name, FileLoc loc) override;
     void onObjectEnd(FileLoc loc) override;
     void onObjectInstance(const std::string& name, FileLoc loc) override;
+    std::unique_ptr<ParserTarget> onImportBegin(FileLoc loc) override;
+    void onImportEnd(ParserTarget& importTarget, FileLoc loc) override;
 
     void onEndOfFiles() override;
 
 private:
+    /**
+     * Create a builder for an imported file.
+     * The builder writes to its own scene and starts with a copy of the parent's graphics state.
+     */
+    BasicSceneBuilder(const BasicSceneBuilder& parent, FileLoc loc);
+
     float4x4 getTransform() const { return mGraphicsState.ctm[0]; }
 
     static constexpr int kStartTransformBits = 1 << 0;
@@ -426,7 +446,9 @@ private:
         Float transformStartTime = 0, transformEndTime = 1;
     };
 
+    std::unique_ptr<BasicScene> mpImportScene; ///< Scene owned by builders for imported files.
     BasicScene& mScene;
+    std::optional<uint32_t> mInheritedMaterialIndex; ///< Parent's material index that local material index 0 stands for.
 
     enum class BlockState
     {
@@ -33,129 +33,34 @@
 
 #include "LoopSubdivide.h"
 #include "Core/Error.h"
+#include "Utils/NumericRange.h"
 
 #include <algorithm>
-#include <map>
-#include <memory>
-#include <memory_resource>
-#include <set>
+#include <atomic>
+#include <execution>
+#include <limits>
+#include <numeric>
 
 #include <cmath>
 
 namespace Falcor::pbrt
 {
 
-struct SDFace;
-struct SDVertex;
-
-#define NEXT(i) (((i) + 1) % 3)
-#define PREV(i) (((i) + 2) % 3)
-
-struct SDVertex
+namespace
 {
-    SDVertex(const float3& p = float3(0.f)) : p(p) {}
+constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
 
-    int valence();
-    void oneRing(float3* p);
-
-    float3 p;
-    SDFace* startFace = nullptr;
-    SDVertex* child = nullptr;
-    bool regular = false;
-    bool boundary = false;
-};
+/// Number of vertices processed per task in parallel loops.
+constexpr uint32_t kVertexBlockSize = 1024;
 
-struct SDFace
+inline uint32_t next(uint32_t i)
 {
-    SDFace()
-    {
-        for (uint32_t i = 0; i < 3; ++i)
-        {
-            v[i] = nullptr;
-            f[i] = nullptr;
-        }
-        for (uint32_t i = 0; i < 4; ++i)
-        {
-            children[i] = nullptr;
-        }
-    }
-
-    uint32_t vnum(SDVertex* vert) const
-    {
-        for (int i = 0; i < 3; ++i)
-        {
-            if (v[i] == vert)
-                return i;
-        }
-        FALCOR_THROW("Basic logic error in SDFace::vnum().");
-    }
-
-    SDFace* nextFace(SDVertex* vert) const { return f[vnum(vert)]; }
-    SDFace* prevFace(SDVertex* vert) const { return f[PREV(vnum(vert))]; }
-    SDVertex* nextVert(SDVertex* vert) const { return v[NEXT(vnum(vert))]; }
-    SDVertex* prevVert(SDVertex* vert) const { return v[PREV(vnum(vert))]; }
-    SDVertex* otherVert(SDVertex* v0, SDVertex* v1)
-    {
-        for (uint32_t i = 0; i < 3; ++i)
-        {
-            if (v[i] != v0 && v[i] != v1)
-                return v[i];
-        }
-        FALCOR_THROW("Basic logic error in SDFace::otherVert()");
-    }
-
-    SDVertex* v[3];
-    SDFace* f[3];
-    SDFace* children[4];
-};
-
-struct SDEdge
-{
-    SDEdge(SDVertex* v0 = nullptr, SDVertex* v1 = nullptr)
-    {
-        v[0] = std::min(v0, v1);
-        v[1] = std::max(v0, v1);
-        f[0] = f[1] = nullptr;
-        f0edgeNum = -1;
-    }
-
-    bool operator<(const SDEdge& e2) const
-    {
-        if (v[0] == e2.v[0])
-            return v[1] < e2.v[1];
-        return v[0] < e2.v[0];
-    }
-
-    SDVertex* v[2];
-    SDFace* f[2];
-    int f0edgeNum;
-};
-
-static float3 weightOneRing(SDVertex* vert, float beta);
-static float3 weightBoundary(SDVertex* vert, float beta);
+    return (i + 1) % 3;
+}
 
-inline int SDVertex::valence()
+inline uint32_t prev(uint32_t i)
 {
-    SDFace* f = startFace;
-    if (!boundary)
-    {
-        // Compute valence of interior vertex.
-        int nf = 1;
-        while ((f = f->nextFace(this)) != startFace)
-            ++nf;
-        return nf;
-    }
-    else
-    {
-        // Compute valence of boundary vertex
-        int nf = 1;
-        while ((f = f->nextFace(this)) != nullptr)
-            ++nf;
-        f = startFace;
-        while ((f = f->prevFace(this)) != nullptr)
-            ++nf;
-        return nf + 1;
-    }
+    return (i + 2) % 3;
 }
 
 inline float beta(uint32_t valence)
@@ -171,372 +76,589 @@ inline float loopGamma(uint32_t valence)
     return 1.f / (valence + 3.f / (8.f * beta(valence)));
 }
 
-LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
+/**
+ * Subdivision mesh stored in flat arrays.
+ * Face f has vertices faceVertices[3 * f + j] and neighbors faceNeighbors[3 * f + j],
+ * where neighbor j is the face across the edge from vertex j to vertex next(j).
+ * Half-edge h refers to edge h % 3 of face h / 3.
+ */
+struct SubdivisionMesh
 {
-    std::vector<SDVertex*> vertices;
-    std::vector<SDFace*> faces;
+    enum VertexFlags : uint8_t
+    {
+        kRegular = 1,
+        kBoundary = 2,
+    };
+
+    std::vector<float3> positions;
+    std::vector<uint32_t> startFaces; ///< Per vertex, a face adjacent to the vertex.
+    std::vector<uint8_t> vertexFlags; ///< Per vertex, combination of VertexFlags.
+    std::vector<uint32_t> faceVertices;
+    std::vector<uint32_t> faceNeighbors;
+
+    uint32_t getVertexCount() const { return (uint32_t)positions.size(); }
+    uint32_t getFaceCount() const { return (uint32_t)(faceVertices.size() / 3); }
+
+    bool isBoundary(uint32_t vertex) const { return (vertexFlags[vertex] & kBoundary) != 0; }
+    bool isRegular(uint32_t vertex) const { return (vertexFlags[vertex] & kRegular) != 0; }
+
+    uint32_t vnum(uint32_t face, uint32_t vertex) const
+    {
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            if (faceVertices[3 * face + i] == vertex)
+                return i;
+        }
+        FALCOR_THROW("Basic logic error in SubdivisionMesh::vnum().");
+    }
 
-    // Allocate vertices and faces.
-    std::unique_ptr<SDVertex[]> vertexBuffer = std::make_unique<SDVertex[]>(positions.size());
-    for (size_t i = 0; i < positions.size(); ++i)
+    uint32_t nextFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[3 * face + vnum(face, vertex)]; }
+    uint32_t prevFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[3 * face + prev(vnum(face, vertex))]; }
+    uint32_t nextVert(uint32_t face, uint32_t vertex) const { return faceVertices[3 * face + next(vnum(face, vertex))]; }
+    uint32_t prevVert(uint32_t face, uint32_t vertex) const { return faceVertices[3 * face + prev(vnum(face, vertex))]; }
+
+    uint32_t otherVert(uint32_t face, uint32_t v0, uint32_t v1) const
     {
-        vertexBuffer[i] = SDVertex(positions[i]);
-        vertices.push_back(&vertexBuffer[i]);
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            uint32_t v = faceVertices[3 * face + i];
+            if (v != v0 && v != v1)
+                return v;
+        }
+        FALCOR_THROW("Basic logic error in SubdivisionMesh::otherVert()");
     }
-    size_t faceCount = indices.size() / 3;
-    std::unique_ptr<SDFace[]> fs = std::make_unique<SDFace[]>(faceCount);
-    for (size_t i = 0; i < faceCount; ++i)
+
+    /**
+     * Count a step of a walk around a vertex.
+     * Walks on non-manifold meshes can end up in cycles not containing the start face.
+     */
+    void countStep(uint32_t& steps) const
     {
-        faces.push_back(&fs[i]);
+        if (++steps > getFaceCount())
+            FALCOR_THROW("Loop subdivision failed. The mesh is not manifold.");
     }
 
-    // Set face to vertex pointers.
+    /**
+     * Get the one-ring of a vertex.
+     * The number of one-ring vertices equals the valence of the vertex.
+     * @param[in] vertex Vertex index.
+     * @param[out] ring One-ring vertex positions.
+     */
+    void oneRing(uint32_t vertex, std::vector<float3>& ring) const
     {
-        const uint32_t* vp = indices.data();
-        for (size_t i = 0; i < faceCount; ++i, vp += 3)
+        ring.clear();
+        uint32_t face = startFaces[vertex];
+        uint32_t steps = 0;
+        if (!isBoundary(vertex))
         {
-            SDFace* f = faces[i];
-            for (uint32_t j = 0; j < 3; ++j)
+            // Get one-ring vertices for interior vertex.
+            do
             {
-                SDVertex* v = vertices[vp[j]];
-                f->v[j] = v;
-                v->startFace = f;
+                countStep(steps);
+                ring.push_back(positions[nextVert(face, vertex)]);
+                face = nextFace(face, vertex);
+            } while (face != startFaces[vertex]);
+        }
+        else
+        {
+            // Get one-ring vertices for boundary vertex.
+            uint32_t f2;
+            while ((f2 = nextFace(face, vertex)) != kInvalidIndex)
+            {
+                countStep(steps);
+                face = f2;
             }
+            ring.push_back(positions[nextVert(face, vertex)]);
+            do
+            {
+                countStep(steps);
+                ring.push_back(positions[prevVert(face, vertex)]);
+                face = prevFace(face, vertex);
+            } while (face != kInvalidIndex);
         }
     }
 
-    // Set neighbor pointers in faces.
-    std::set<SDEdge> edges;
-    for (size_t i = 0; i < faceCount; ++i)
+    uint32_t valence(uint32_t vertex) const
     {
-        SDFace* f = faces[i];
-        for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
+        uint32_t face = startFaces[vertex];
+        uint32_t steps = 0;
+        if (!isBoundary(vertex))
         {
-            // Update neighbor pointer for edgeNum.
-            int v0 = edgeNum, v1 = NEXT(edgeNum);
-            SDEdge e(f->v[v0], f->v[v1]);
-            if (edges.find(e) == edges.end())
+            // Compute valence of interior vertex.
+            uint32_t nf = 1;
+            while ((face = nextFace(face, vertex)) != startFaces[vertex])
             {
-                // Handle new edge.
-                e.f[0] = f;
-                e.f0edgeNum = edgeNum;
-                edges.insert(e);
+                countStep(steps);
+                ++nf;
             }
-            else
+            return nf;
+        }
+        else
+        {
+            // Compute valence of boundary vertex.
+            uint32_t nf = 1;
+            while ((face = nextFace(face, vertex)) != kInvalidIndex)
             {
-                // Handle previously seen edge.
-                e = *edges.find(e);
-                e.f[0]->f[e.f0edgeNum] = f;
-                f->f[edgeNum] = e.f[0];
-                edges.erase(e);
+                countStep(steps);
+                ++nf;
             }
+            face = startFaces[vertex];
+            while ((face = prevFace(face, vertex)) != kInvalidIndex)
+            {
+                countStep(steps);
+                ++nf;
+            }
+            return nf + 1;
         }
     }
 
-    // Finish vertex initialization.
-    for (size_t i = 0; i < positions.size(); ++i)
+    float3 weightOneRing(uint32_t vertex, float beta, const std::vector<float3>& ring) const
     {
-        SDVertex* v = vertices[i];
-        SDFace* f = v->startFace;
-        do
+        uint32_t valence = (uint32_t)ring.size();
+        float3 p = (1 - valence * beta) * positions[vertex];
+        for (uint32_t i = 0; i < valence; ++i)
         {
-            f = f->nextFace(v);
-        } while ((f != nullptr) && f != v->startFace);
-        v->boundary = (f == nullptr);
-        if (!v->boundary && v->valence() == 6)
-            v->regular = true;
-        else if (v->boundary && v->valence() == 4)
-            v->regular = true;
-        else
-            v->regular = false;
+            p += beta * ring[i];
+        }
+        return p;
     }
 
-    // Refine LoopSubdiv into triangles.
-    std::vector<SDFace*> f = faces;
-    std::vector<SDVertex*> v = vertices;
-
-    std::pmr::monotonic_buffer_resource buffer;
-    std::pmr::polymorphic_allocator<SDVertex> vertexAllocator(&buffer);
-    std::pmr::polymorphic_allocator<SDFace> faceAllocator(&buffer);
-
-    for (size_t i = 0; i < levels; ++i)
+    float3 weightBoundary(uint32_t vertex, float beta, const std::vector<float3>& ring) const
     {
-        // Update f and v for next level of subdivision.
-        std::vector<SDFace*> newFaces;
-        std::vector<SDVertex*> newVertices;
+        uint32_t valence = (uint32_t)ring.size();
+        float3 p = (1 - 2 * beta) * positions[vertex];
+        p += beta * ring[0];
+        p += beta * ring[valence - 1];
+        return p;
+    }
+};
 
-        // Allocate next level of children in mesh tree.
-        for (SDVertex* vertex : v)
-        {
-            vertex->child = vertexAllocator.allocate(1);
-            vertex->child->regular = vertex->regular;
-            vertex->child->boundary = vertex->boundary;
-            newVertices.push_back(vertex->child);
-        }
-        for (SDFace* face : f)
+/**
+ * Run a function on blocks of vertices in parallel.
+ * Each block gets its own one-ring scratch buffer.
+ */
+template<typename Func>
+void forEachVertexBlock(uint32_t vertexCount, Func func)
+{
+    uint32_t blockCount = (vertexCount + kVertexBlockSize - 1) / kVertexBlockSize;
+    auto range = NumericRange<uint32_t>(0, blockCount);
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](uint32_t block)
         {
-            for (uint32_t k = 0; k < 4; ++k)
-            {
-                face->children[k] = faceAllocator.allocate(1);
-                newFaces.push_back(face->children[k]);
-            }
+            std::vector<float3> ring;
+            ring.reserve(16);
+            uint32_t end = std::min(vertexCount, (block + 1) * kVertexBlockSize);
+            for (uint32_t vertex = block * kVertexBlockSize; vertex < end; ++vertex)
+                func(vertex, ring);
         }
+    );
+}
+
+/// Get the vertex indices of a half-edge, ordered by index.
+std::pair<uint32_t, uint32_t> getEdgeVertices(const SubdivisionMesh& mesh, uint32_t h)
+{
+    uint32_t v0 = mesh.faceVertices[h];
+    uint32_t v1 = mesh.faceVertices[h - h % 3 + next(h % 3)];
+    return std::make_pair(std::min(v0, v1), std::max(v0, v1));
+}
 
-        // Update vertex positions and create new edge vertices.
+/**
+ * Group the half-edges of a mesh by their (unordered) vertex pair.
+ * Half-edges are bucketed by their smaller vertex index and sorted by the other vertex index and
+ * then by half-edge index. This makes the result independent of the order in which the buckets are filled.
+ */
+struct EdgeGroups
+{
+    std::vector<uint32_t> offsets;   ///< Per vertex, offset of its bucket in halfEdges (vertex count + 1 entries).
+    std::vector<uint32_t> halfEdges; ///< Half-edges grouped by vertex pair.
 
-        // Update vertex positions for even vertices.
-        for (SDVertex* vertex : v)
+    EdgeGroups(const SubdivisionMesh& mesh)
+    {
+        const uint32_t vertexCount = mesh.getVertexCount();
+        const uint32_t halfEdgeCount = (uint32_t)mesh.faceVertices.size();
+
+        std::vector<std::atomic<uint32_t>> counts(vertexCount + 1);
+        auto halfEdgeRange = NumericRange<uint32_t>(0, halfEdgeCount);
+        std::for_each(
+            std::execution::par,
+            halfEdgeRange.begin(),
+            halfEdgeRange.end(),
+            [&](uint32_t h) { counts[getEdgeVertices(mesh, h).first + 1].fetch_add(1, std::memory_order_relaxed); }
+        );
+
+        offsets.resize(vertexCount + 1);
+        offsets[0] = 0;
+        for (uint32_t v = 0; v < vertexCount; ++v)
         {
-            if (!vertex->boundary)
-            {
-                // Apply one-ring rule for even vertex.
-                if (vertex->regular)
-                    vertex->child->p = weightOneRing(vertex, 1.f / 16.f);
-                else
-                    vertex->child->p = weightOneRing(vertex, beta(vertex->valence()));
-            }
-            else
-            {
-                // Apply boundary rule for even vertex.
-                vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
-            }
+            offsets[v + 1] = offsets[v] + counts[v + 1].load(std::memory_order_relaxed);
+            counts[v + 1].store(offsets[v], std::memory_order_relaxed);
         }
 
-        // Compute new odd edge vertices.
-        std::map<SDEdge, SDVertex*> edgeVerts;
-        for (SDFace* face : f)
-        {
-            for (uint32_t k = 0; k < 3; ++k)
+        halfEdges.resize(halfEdgeCount);
+        std::for_each(
+            std::execution::par,
+            halfEdgeRange.begin(),
+            halfEdgeRange.end(),
+            [&](uint32_t h) { halfEdges[counts[getEdgeVertices(mesh, h).first + 1].fetch_add(1, std::memory_order_relaxed)] = h; }
+        );
+
+        auto vertexRange = NumericRange<uint32_t>(0, vertexCount);
+        std::for_each(
+            std::execution::par,
+            vertexRange.begin(),
+            vertexRange.end(),
+            [&](uint32_t v)
             {
-                // Compute odd vertex on kth edge.
-                SDEdge edge(face->v[k], face->v[NEXT(k)]);
-                SDVertex* vert = edgeVerts[edge];
-                if (vert == nullptr)
-                {
-                    // Create and initialize new odd vertex
-                    vert = vertexAllocator.allocate(1);
-                    newVertices.push_back(vert);
-                    vert->regular = true;
-                    vert->boundary = (face->f[k] == nullptr);
-                    vert->startFace = face->children[3];
-
-                    // Apply edge rules to compute new vertex position
-                    if (vert->boundary)
+                std::sort(
+                    halfEdges.begin() + offsets[v],
+                    halfEdges.begin() + offsets[v + 1],
+                    [&](uint32_t a, uint32_t b)
                     {
-                        vert->p = 0.5f * edge.v[0]->p;
-                        vert->p += 0.5f * edge.v[1]->p;
+                        uint32_t va = getEdgeVertices(mesh, a).second;
+                        uint32_t vb = getEdgeVertices(mesh, b).second;
+                        return va != vb ? va < vb : a < b;
                     }
-                    else
-                    {
-                        vert->p = 3.f / 8.f * edge.v[0]->p;
-                        vert->p += 3.f / 8.f * edge.v[1]->p;
-                        vert->p += 1.f / 8.f * face->otherVert(edge.v[0], edge.v[1])->p;
-                        vert->p += 1.f / 8.f * face->f[k]->otherVert(edge.v[0], edge.v[1])->p;
-                    }
-                    edgeVerts[edge] = vert;
-                }
+                );
             }
-        }
+        );
+    }
 
-        // Update new mesh topology.
+    /**
+     * Call a function for each group of half-edges sharing the same vertex pair.
+     * Groups are visited in parallel, half-edges within a group are ordered by index.
+     * The function is called with (const uint32_t* begin, const uint32_t* end).
+     */
+    template<typename Func>
+    void forEachGroup(const SubdivisionMesh& mesh, Func func) const
+    {
+        auto range = NumericRange<uint32_t>(0, (uint32_t)offsets.size() - 1);
+        std::for_each(
+            std::execution::par,
+            range.begin(),
+            range.end(),
+            [&](uint32_t v)
+            {
+                const uint32_t* begin = halfEdges.data() + offsets[v];
+                const uint32_t* end = halfEdges.data() + offsets[v + 1];
+                while (begin != end)
+                {
+                    const uint32_t other = getEdgeVertices(mesh, *begin).second;
+                    const uint32_t* groupEnd = begin + 1;
+                    while (groupEnd != end && getEdgeVertices(mesh, *groupEnd).second == other)
+                        ++groupEnd;
+                    func(begin, groupEnd);
+                    begin = groupEnd;
+                }
+            }
+        );
+    }
+};
 
-        // Update even vertex face pointers.
-        for (SDVertex* vertex : v)
-        {
-            int vertNum = vertex->startFace->vnum(vertex);
-            vertex->child->startFace = vertex->startFace->children[vertNum];
-        }
+SubdivisionMesh createMesh(fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
+{
+    SubdivisionMesh mesh;
+    const uint32_t vertexCount = (uint32_t)positions.size();
+    const uint32_t faceCount = (uint32_t)(indices.size() / 3);
+
+    mesh.positions.assign(positions.begin(), positions.end());
+    mesh.faceVertices.assign(indices.begin(), indices.begin() + 3 * faceCount);
+    mesh.faceNeighbors.assign(3 * faceCount, kInvalidIndex);
+    mesh.vertexFlags.resize(vertexCount);
+
+    // Set vertex to face indices. The last face referencing a vertex is used.
+    mesh.startFaces.assign(vertexCount, kInvalidIndex);
+    for (uint32_t i = 0; i < 3 * faceCount; ++i)
+    {
+        if (mesh.faceVertices[i] >= vertexCount)
+            FALCOR_THROW("Vertex index {} is out of bounds.", mesh.faceVertices[i]);
+        mesh.startFaces[mesh.faceVertices[i]] = i / 3;
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        if (mesh.startFaces[v] == kInvalidIndex)
+            FALCOR_THROW("Vertex {} is not referenced by any face.", v);
+    }
 
-        // Update face neighbor pointers.
-        for (SDFace* face : f)
+    // Set neighbor indices in faces.
+    // Half-edges sharing a vertex pair are paired up in order, a half-edge without a pair is on the boundary.
+    EdgeGroups edgeGroups(mesh);
+    edgeGroups.forEachGroup(
+        mesh,
+        [&](const uint32_t* begin, const uint32_t* end)
         {
-            for (uint32_t j = 0; j < 3; ++j)
+            for (; end - begin >= 2; begin += 2)
             {
-                // Update children f pointers for siblings.
-                face->children[3]->f[j] = face->children[NEXT(j)];
-                face->children[j]->f[NEXT(j)] = face->children[3];
-
-                // Update children f pointers for neighbor children.
-                SDFace* f2 = face->f[j];
-                face->children[j]->f[j] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                f2 = face->f[PREV(j)];
-                face->children[j]->f[PREV(j)] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
+                mesh.faceNeighbors[begin[0]] = begin[1] / 3;
+                mesh.faceNeighbors[begin[1]] = begin[0] / 3;
             }
         }
+    );
 
-        // Update face vertex pointers.
-        for (SDFace* face : f)
+    // Finish vertex initialization.
+    auto vertexRange = NumericRange<uint32_t>(0, vertexCount);
+    std::for_each(
+        std::execution::par,
+        vertexRange.begin(),
+        vertexRange.end(),
+        [&](uint32_t v)
         {
-            for (uint32_t j = 0; j < 3; ++j)
+            uint32_t face = mesh.startFaces[v];
+            uint32_t steps = 0;
+            do
             {
-                // Update child vertex pointer to new even vertex
-                face->children[j]->v[j] = face->v[j]->child;
-
-                // Update child vertex pointer to new odd vertex
-                SDVertex* vert = edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
-                face->children[j]->v[NEXT(j)] = vert;
-                face->children[NEXT(j)]->v[j] = vert;
-                face->children[3]->v[j] = vert;
-            }
+                mesh.countStep(steps);
+                face = mesh.nextFace(face, v);
+            } while (face != kInvalidIndex && face != mesh.startFaces[v]);
+            bool boundary = face == kInvalidIndex;
+            mesh.vertexFlags[v] = boundary ? SubdivisionMesh::kBoundary : 0;
+            uint32_t valence = mesh.valence(v);
+            if ((!boundary && valence == 6) || (boundary && valence == 4))
+                mesh.vertexFlags[v] |= SubdivisionMesh::kRegular;
         }
+    );
 
-        // Prepare for next level of subdivision
-        f = newFaces;
-        v = newVertices;
-    }
+    return mesh;
+}
 
-    // Push vertices to limit surface.
-    std::vector<float3> pLimit(v.size());
-    for (size_t i = 0; i < v.size(); ++i)
-    {
-        if (v[i]->boundary)
-            pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
-        else
-            pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
-    }
-    for (size_t i = 0; i < v.size(); ++i)
-    {
-        v[i]->p = pLimit[i];
-    }
+/**
+ * Apply one level of loop subdivision.
+ * Vertices and faces are numbered the same way as the pbrt implementation: Vertex v keeps its index,
+ * new edge vertices follow in order of the first half-edge referencing them, and face f is replaced
+ * by the four child faces 4 * f + k.
+ */
+SubdivisionMesh subdivide(const SubdivisionMesh& mesh)
+{
+    const uint32_t vertexCount = mesh.getVertexCount();
+    const uint32_t faceCount = mesh.getFaceCount();
+    const uint32_t halfEdgeCount = 3 * faceCount;
 
-    // Compute vertex tangents on limit surface.
-    std::vector<float3> Ns;
-    Ns.reserve(v.size());
-    std::vector<float3> pRing(16, float3());
-    for (SDVertex* vertex : v)
+    // Assign new edge vertices to the first half-edge of each edge.
+    std::vector<uint32_t> firstHalfEdges(halfEdgeCount);
     {
-        float3 S(0.f);
-        float3 T(0.f);
-        uint32_t valence = vertex->valence();
-        if (valence > pRing.size())
-            pRing.resize(valence);
-        vertex->oneRing(&pRing[0]);
-        if (!vertex->boundary)
-        {
-            // Compute tangents of interior face
-            for (uint32_t j = 0; j < valence; ++j)
+        EdgeGroups edgeGroups(mesh);
+        edgeGroups.forEachGroup(
+            mesh,
+            [&](const uint32_t* begin, const uint32_t* end)
             {
-                S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-                T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                for (const uint32_t* h = begin; h != end; ++h)
+                    firstHalfEdges[*h] = *begin;
             }
-        }
-        else
+        );
+    }
+
+    // Number the new edge vertices in half-edge order.
+    std::vector<uint32_t> edgeVertices(halfEdgeCount);
+    auto halfEdgeRange = NumericRange<uint32_t>(0, halfEdgeCount);
+    {
+        std::vector<uint32_t> isFirst(halfEdgeCount);
+        std::transform(
+            std::execution::par,
+            halfEdgeRange.begin(),
+            halfEdgeRange.end(),
+            isFirst.begin(),
+            [&](uint32_t h) { return firstHalfEdges[h] == h ? 1u : 0u; }
+        );
+        std::exclusive_scan(std::execution::par, isFirst.begin(), isFirst.end(), edgeVertices.begin(), vertexCount);
+    }
+    const uint32_t newVertexCount = halfEdgeCount > 0 ? edgeVertices.back() + (firstHalfEdges.back() == halfEdgeCount - 1) : vertexCount;
+
+    SubdivisionMesh newMesh;
+    newMesh.positions.resize(newVertexCount);
+    newMesh.startFaces.resize(newVertexCount);
+    newMesh.vertexFlags.resize(newVertexCount);
+    newMesh.faceVertices.resize(4 * 3 * faceCount);
+    newMesh.faceNeighbors.resize(4 * 3 * faceCount);
+
+    // Update vertex positions for even vertices.
+    forEachVertexBlock(
+        vertexCount,
+        [&](uint32_t v, std::vector<float3>& ring)
         {
-            // Compute tangents of boundary face
-            S = pRing[valence - 1] - pRing[0];
-            if (valence == 2)
+            mesh.oneRing(v, ring);
+            if (!mesh.isBoundary(v))
             {
-                T = float3(pRing[0] + pRing[1] - 2.f * vertex->p);
+                // Apply one-ring rule for even vertex.
+                if (mesh.isRegular(v))
+                    newMesh.positions[v] = mesh.weightOneRing(v, 1.f / 16.f, ring);
+                else
+                    newMesh.positions[v] = mesh.weightOneRing(v, beta((uint32_t)ring.size()), ring);
             }
-            else if (valence == 3)
+            else
             {
-                T = pRing[1] - vertex->p;
+                // Apply boundary rule for even vertex.
+                newMesh.positions[v] = mesh.weightBoundary(v, 1.f / 8.f, ring);
             }
-            else if (valence == 4) // regular
+            newMesh.vertexFlags[v] = mesh.vertexFlags[v];
+            uint32_t startFace = mesh.startFaces[v];
+            newMesh.startFaces[v] = 4 * startFace + mesh.vnum(startFace, v);
+        }
+    );
+
+    // Compute new odd edge vertices.
+    std::for_each(
+        std::execution::par,
+        halfEdgeRange.begin(),
+        halfEdgeRange.end(),
+        [&](uint32_t h)
+        {
+            if (firstHalfEdges[h] != h)
+                return;
+
+            uint32_t face = h / 3;
+            uint32_t v0 = mesh.faceVertices[h];
+            uint32_t v1 = mesh.faceVertices[3 * face + next(h % 3)];
+            uint32_t neighbor = mesh.faceNeighbors[h];
+            uint32_t vert = edgeVertices[h];
+            bool boundary = neighbor == kInvalidIndex;
+
+            newMesh.vertexFlags[vert] = SubdivisionMesh::kRegular | (boundary ? SubdivisionMesh::kBoundary : 0);
+            newMesh.startFaces[vert] = 4 * face + 3;
+
+            // Apply edge rules to compute new vertex position.
+            float3 p;
+            if (boundary)
             {
-                T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex->p);
+                p = 0.5f * mesh.positions[v0];
+                p += 0.5f * mesh.positions[v1];
             }
             else
             {
-                float theta = float(M_PI) / float(valence - 1);
-                T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
-                for (uint32_t k = 1; k < valence - 1; ++k)
-                {
-                    float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
-                    T += float3(wt * pRing[k]);
-                }
-                T = -T;
+                p = 3.f / 8.f * mesh.positions[v0];
+                p += 3.f / 8.f * mesh.positions[v1];
+                p += 1.f / 8.f * mesh.positions[mesh.otherVert(face, v0, v1)];
+                p += 1.f / 8.f * mesh.positions[mesh.otherVert(neighbor, v0, v1)];
             }
+            newMesh.positions[vert] = p;
         }
-        Ns.push_back(cross(S, T));
-    }
-
-    // Create triangle mesh from subdivision mesh
-    {
-        size_t ntris = f.size();
-        std::vector<uint32_t> verts(3 * ntris);
-        uint32_t* vp = verts.data();
-        uint32_t totVerts = (uint32_t)v.size();
-        std::map<SDVertex*, uint32_t> usedVerts;
-        for (uint32_t i = 0; i < totVerts; ++i)
-        {
-            usedVerts[v[i]] = i;
-        }
-        for (size_t i = 0; i < ntris; ++i)
+    );
+
+    // Update new mesh topology.
+    auto faceRange = NumericRange<uint32_t>(0, faceCount);
+    std::for_each(
+        std::execution::par,
+        faceRange.begin(),
+        faceRange.end(),
+        [&](uint32_t face)
         {
+            const uint32_t children[4] = {4 * face, 4 * face + 1, 4 * face + 2, 4 * face + 3};
+
+            for (uint32_t j = 0; j < 3; ++j)
+            {
+                // Update children face indices for siblings.
+                newMesh.faceNeighbors[3 * children[3] + j] = children[next(j)];
+                newMesh.faceNeighbors[3 * children[j] + next(j)] = children[3];
+
+                // Update children face indices for neighbor children.
+                uint32_t vertex = mesh.faceVertices[3 * face + j];
+                uint32_t f2 = mesh.faceNeighbors[3 * face + j];
+                newMesh.faceNeighbors[3 * children[j] + j] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, vertex) : kInvalidIndex;
+                f2 = mesh.faceNeighbors[3 * face + prev(j)];
+                newMesh.faceNeighbors[3 * children[j] + prev(j)] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, vertex) : kInvalidIndex;
+            }
+
             for (uint32_t j = 0; j < 3; ++j)
             {
-                *vp = usedVerts[f[i]->v[j]];
-                ++vp;
+                // Update child vertex index to new even vertex.
+                newMesh.faceVertices[3 * children[j] + j] = mesh.faceVertices[3 * face + j];
+
+                // Update child vertex index to new odd vertex.
+                uint32_t vert = edgeVertices[firstHalfEdges[3 * face + j]];
+                newMesh.faceVertices[3 * children[j] + next(j)] = vert;
+                newMesh.faceVertices[3 * children[next(j)] + j] = vert;
+                newMesh.faceVertices[3 * children[3] + j] = vert;
             }
         }
+    );
 
-        LoopSubdivideResult result;
-        result.positions = std::move(pLimit);
-        result.normals = std::move(Ns);
-        result.indices = std::move(verts);
-        return result;
-    }
+    return newMesh;
 }
+} // namespace
 
-static float3 weightOneRing(SDVertex* vert, float beta)
+LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
 {
-    // Put vert one-ring in pRing.
-    uint32_t valence = vert->valence();
-    FALCOR_ASSERT(valence < 16);
-    float3 pRing[16];
-
-    vert->oneRing(pRing);
-    float3 p = (1 - valence * beta) * vert->p;
-    for (uint32_t i = 0; i < valence; ++i)
-    {
-        p += beta * pRing[i];
-    }
-    return p;
-}
+    SubdivisionMesh mesh = createMesh(positions, indices);
 
-void SDVertex::oneRing(float3* p_)
-{
-    if (!boundary)
-    {
-        // Get one-ring vertices for interior vertex.
-        SDFace* face = startFace;
-        do
-        {
-            *p_++ = face->nextVert(this)->p;
-            face = face->nextFace(this);
-        } while (face != startFace);
-    }
-    else
-    {
-        // Get one-ring vertices for boundary vertex.
-        SDFace* face = startFace;
-        SDFace* f2;
-        while ((f2 = face->nextFace(this)) != nullptr)
+    // Refine subdivision mesh into triangles.
+    for (uint32_t i = 0; i < levels; ++i)
+        mesh = subdivide(mesh);
+
+    const uint32_t vertexCount = mesh.getVertexCount();
+    LoopSubdivideResult result;
+    result.positions.resize(vertexCount);
+    result.normals.resize(vertexCount);
+
+    // Push vertices to limit surface.
+    forEachVertexBlock(
+        vertexCount,
+        [&](uint32_t v, std::vector<float3>& ring)
         {
-            face = f2;
+            mesh.oneRing(v, ring);
+            if (mesh.isBoundary(v))
+                result.positions[v] = mesh.weightBoundary(v, 1.f / 5.f, ring);
+            else
+                result.positions[v] = mesh.weightOneRing(v, loopGamma((uint32_t)ring.size()), ring);
         }
-        *p_++ = face->nextVert(this)->p;
-        do
+    );
+    mesh.positions = std::move(result.positions);
+
+    // Compute vertex tangents on limit surface.
+    forEachVertexBlock(
+        vertexCount,
+        [&](uint32_t v, std::vector<float3>& pRing)
         {
-            *p_++ = face->prevVert(this)->p;
-            face = face->prevFace(this);
-        } while (face != nullptr);
-    }
-}
+            const float3& p = mesh.positions[v];
+            float3 S(0.f);
+            float3 T(0.f);
+            mesh.oneRing(v, pRing);
+            uint32_t valence = (uint32_t)pRing.size();
+            if (!mesh.isBoundary(v))
+            {
+                // Compute tangents of interior face.
+                for (uint32_t j = 0; j < valence; ++j)
+                {
+                    S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                    T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                }
+            }
+            else
+            {
+                // Compute tangents of boundary face.
+                S = pRing[valence - 1] - pRing[0];
+                if (valence == 2)
+                {
+                    T = float3(pRing[0] + pRing[1] - 2.f * p);
+                }
+                else if (valence == 3)
+                {
+                    T = pRing[1] - p;
+                }
+                else if (valence == 4) // regular
+                {
+                    T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * p);
+                }
+                else
+                {
+                    float theta = float(M_PI) / float(valence - 1);
+                    T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
+                    for (uint32_t k = 1; k < valence - 1; ++k)
+                    {
+                        float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
+                        T += float3(wt * pRing[k]);
+                    }
+                    T = -T;
+                }
+            }
+            result.normals[v] = cross(S, T);
+        }
+    );
 
-static float3 weightBoundary(SDVertex* vert, float beta)
-{
-    // Put vert one-ring in pRing.
-    uint32_t valence = vert->valence();
-    FALCOR_ASSERT(valence < 16);
-    float3 pRing[16];
-
-    vert->oneRing(pRing);
-    float3 p = (1 - 2 * beta) * vert->p;
-    p += beta * pRing[0];
-    p += beta * pRing[valence - 1];
-    return p;
+    // Create triangle mesh from subdivision mesh.
+    result.positions = std::move(mesh.positions);
+    result.indices = std::move(mesh.faceVertices);
+    return result;
 }
 
 } // namespace Falcor::pbrt
@@ -63,12 +63,16 @@
 #include "Builder.h"
 #include "Helpers.h"
 #include "LoopSubdivide.h"
+#include "PLYReader.h"
 #include "EnvMapConverter.h"
 #include "Core/Error.h"
 #include "Core/API/Device.h"
 #include "Utils/Settings/Settings.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Image/Bitmap.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/FNVHash.h"
 #include "Scene/Importer.h"
@@ -86,6 +90,10 @@
 
 #include <pybind11/pybind11.h>
 
+#include <algorithm>
+#include <exception>
+#include <execution>
+#include <future>
 #include <unordered_map>
 
 namespace Falcor
@@ -124,18 +132,47 @@ struct Camera
  */
 struct Light
 {
+    /**
+     * Env map that is still being loaded from an equal-area octahedral image.
+     * The image is decoded on a worker thread. Creating the texture and the conversion to an env map
+     * are deferred to the end of the scene build and run on the import thread.
+     */
+    struct PendingEnvMap
+    {
+        std::filesystem::path path;
+        std::future<Bitmap::UniqueConstPtr> octBitmap; ///< Decoded image, not valid for DDS files which are loaded directly.
+        float scale = 1.f;
+        float3 rotation;
+    };
+
     Falcor::ref<Falcor::Light> pLight;
     Falcor::ref<Falcor::EnvMap> pEnvMap;
+    std::optional<PendingEnvMap> pendingEnvMap;
+
+    bool hasEnvMap() const { return pEnvMap || pendingEnvMap; }
+};
+
+/**
+ * Describes an image texture.
+ * Image textures are not loaded when the texture is created. Instead, the texture is requested through the
+ * scene builder when it is assigned to a material, so that loading happens asynchronously and identical
+ * files are only loaded once.
+ */
+struct ImageTexture
+{
+    std::filesystem::path path;
+    bool generateMips = false;
+    bool sRGB = false;
 };
 
 /**
  * Represents a float texture.
- * These can be unassigned (std::monostate), a constant float or a texture.
+ * These can be unassigned (std::monostate), a constant float or an image texture.
  * Note: pbrt-v4 supports many additional texture types that we currently don't support and represent here.
  */
 struct FloatTexture
 {
-    std::variant<std::monostate, float, Falcor::ref<Texture>> texture;
+    std::variant<std::monostate, float, ImageTexture> texture;
     float4x4 transform = float4x4::identity();
 
     bool isConstant() const { return std::holds_alternative<float>(texture); }
@@ -148,13 +185,13 @@ struct FloatTexture
 
 /**
  * Represents a spectrum texture.
- * These can be unassigned (std::monostate), a constant spectrum or a texture.
+ * These can be unassigned (std::monostate), a constant spectrum or an image texture.
  * Note: pbrt-v4 supports many additional texture types that we currently don't support and represent here.
  */
 struct SpectrumTexture
 {
     SpectrumType spectrumType = SpectrumType::Albedo;
-    std::variant<std::monostate, Spectrum, Falcor::ref<Texture>> texture;
+    std::variant<std::monostate, Spectrum, ImageTexture> texture;
     float4x4 transform = float4x4::identity();
 
     bool isConstant() const { return std::holds_alternative<Spectrum>(texture); }
@@ -176,6 +213,7 @@ struct Shape
     Falcor::ref<Falcor::TriangleMesh> pTriangleMesh;
     float4x4 transform = float4x4::identity();
     Falcor::ref<Falcor::Material> pMaterial;
+    bool isSkipped = false; ///< True if the shape is invalid and ignored.
 };
 
 /**
@@ -230,6 +268,8 @@ struct BuilderContext
 
     bool usePBRTMaterials = false;
 
+    double textureLoadTime = 0.0; ///< Time spent loading textures on the import thread in seconds.
+
     Falcor::ref<Falcor::Material> getMaterial(const MaterialRef& materialRef)
     {
         Falcor::ref<Falcor::Material> pMaterial;
@@ -361,15 +401,37 @@ SpectrumTexture getSpectrumTexture(
     return spectrumTexture;
 }
 
+void loadMaterialTexture(
+    BuilderContext& ctx,
+    const Falcor::ref<Material>& pMaterial,
+    Material::TextureSlot slot,
+    const std::filesystem::path& path,
+    bool generateMips,
+    bool sRGB
+)
+{
+    // Material textures are currently loaded synchronously by the texture manager, see TextureManager.cpp.
+    CpuTimer timer;
+    timer.update();
+    ctx.builder.loadMaterialTexture(pMaterial, slot, path, generateMips, sRGB);
+    timer.update();
+    ctx.textureLoadTime += timer.delta();
+}
+
+void loadMaterialTexture(BuilderContext& ctx, const Falcor::ref<Material>& pMaterial, Material::TextureSlot slot, const ImageTexture& texture)
+{
+    loadMaterialTexture(ctx, pMaterial, slot, texture.path, texture.generateMips, texture.sRGB);
+}
+
 void assignSpectrumTexture(
     const SpectrumTexture& spectrumTexture,
     std::function<void(float3)> constantSetter,
-    std::function<void(Falcor::ref<Texture>)> textureSetter
+    std::function<void(const ImageTexture&)> textureSetter
 )
 {
     if (const auto* pSpectrum = std::get_if<Spectrum>(&spectrumTexture.texture))
         constantSetter(spectrumToRGB(*pSpectrum, spectrumTexture.spectrumType));
-    else if (const auto* pTexture = std::get_if<Falcor::ref<Texture>>(&spectrumTexture.texture))
+    else if (const auto* pTexture = std::get_if<ImageTexture>(&spectrumTexture.texture))
         textureSetter(*pTexture);
 }
 
@@ -723,22 +785,22 @@ Light createLight(BuilderContext& ctx, const LightSceneEntity& entity)
         else if (!filename.empty())
         {
             auto path = ctx.resolver(filename);
-            auto pOctTexture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, false, false);
             // TODO: Use equal-area octahedral parametrization when env map supports it.
             logWarning(
                 entity.loc,
                 "Environment map is converted from equal-area octahedral to lat-long parametrization. Exact results cannot be expected."
             );
-            EnvMapConverter envMapConverter(ctx.builder.getDevice());
-            auto pLatLongTexture = envMapConverter.convertEqualAreaOctToLatLong(ctx.builder.getDevice()->getRenderContext(), pOctTexture);
-            auto pEnvMap = Falcor::EnvMap::create(ctx.builder.getDevice(), pLatLongTexture);
-            pEnvMap->setIntensity(scale);
 
-            float3 rotation;
-            math::extractEulerAngleXYZ(entity.transform, rotation.x, rotation.y, rotation.z);
-            pEnvMap->setRotation(math::degrees(rotation));
+            // Start decoding the image now. The texture is created and converted in finalizeEnvMap() once the shapes are built.
+            // Only the decoding runs on a worker thread, as GPU work can't be submitted in parallel to the scene build.
+            Light::PendingEnvMap pendingEnvMap;
+            pendingEnvMap.path = path;
+            if (!hasExtension(path, "dds"))
+                pendingEnvMap.octBitmap = std::async(std::launch::async, [path]() { return Bitmap::createFromFile(path, true); });
+            pendingEnvMap.scale = scale;
+            math::extractEulerAngleXYZ(entity.transform, pendingEnvMap.rotation.x, pendingEnvMap.rotation.y, pendingEnvMap.rotation.z);
 
-            light.pEnvMap = pEnvMap;
+            light.pendingEnvMap = std::move(pendingEnvMap);
         }
     }
     else
@@ -749,6 +811,41 @@ Light createLight(BuilderContext& ctx, const LightSceneEntity& entity)
     return light;
 }
 
+Falcor::ref<Falcor::EnvMap> finalizeEnvMap(BuilderContext& ctx, Light::PendingEnvMap& pendingEnvMap)
+{
+    CpuTimer timer;
+    timer.update();
+
+    Falcor::ref<Texture> pOctTexture;
+    if (pendingEnvMap.octBitmap.valid())
+    {
+        auto pBitmap = pendingEnvMap.octBitmap.get();
+        if (pBitmap)
+        {
+            pOctTexture = Texture::createFromBitmap(ctx.builder.getDevice(), *pBitmap, false, false);
+            pOctTexture->setSourcePath(pendingEnvMap.path);
+        }
+    }
+    else
+    {
+        pOctTexture = Texture::createFromFile(ctx.builder.getDevice(), pendingEnvMap.path, false, false);
+    }
+
+    timer.update();
+    ctx.textureLoadTime += timer.delta();
+
+    if (!pOctTexture)
+        return nullptr;
+
+    EnvMapConverter envMapConverter(ctx.builder.getDevice());
+    auto pLatLongTexture = envMapConverter.convertEqualAreaOctToLatLong(ctx.builder.getDevice()->getRenderContext(), pOctTexture);
+    auto pEnvMap = Falcor::EnvMap::create(ctx.builder.getDevice(), pLatLongTexture);
+    pEnvMap->setIntensity(pendingEnvMap.scale);
+    pEnvMap->setRotation(math::degrees(pendingEnvMap.rotation));
+
+    return pEnvMap;
+}
+
 FloatTexture createFloatTexture(BuilderContext& ctx, const TextureSceneEntity& entity)
 {
     auto warnUnsupported = [&]() { warnUnsupportedType(entity.loc, "Float texture", entity.name); };
@@ -821,7 +918,7 @@ FloatTexture createFloatTexture(BuilderContext& ctx, const TextureSceneEntity& e
         }
         bool sRGB = encoding == "sRGB";
 
-        floatTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
+        floatTexture.texture = ImageTexture{path, generateMips, sRGB};
     }
     else if (type == "checkerboard")
     {
@@ -938,7 +1035,7 @@ SpectrumTexture createSpectrumTexture(BuilderContext& ctx, const TextureSceneEnt
         }
         bool sRGB = encoding == "sRGB";
 
-        spectrumTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
+        spectrumTexture.texture = ImageTexture{path, generateMips, sRGB};
     }
     else if (type == "checkerboard")
     {
@@ -1004,7 +1101,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 reflectance,
                 [&](float3 rgb) { pPBRTMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setBaseColorTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pPBRTMaterial, Material::TextureSlot::BaseColor, texture); }
             );
             pPBRTMaterial->setDoubleSided(true);
             pMaterial = pPBRTMaterial;
@@ -1017,7 +1114,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 reflectance,
                 [&](float3 rgb) { pStandardMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setBaseColorTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pStandardMaterial, Material::TextureSlot::BaseColor, texture); }
             );
             pStandardMaterial->setDoubleSided(true);
             pMaterial = pStandardMaterial;
@@ -1043,7 +1140,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 reflectance,
                 [&](float3 rgb) { pPBRTMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setBaseColorTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pPBRTMaterial, Material::TextureSlot::BaseColor, texture); }
             );
             pPBRTMaterial->setDoubleSided(true);
             pMaterial = pPBRTMaterial;
@@ -1058,7 +1155,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 reflectance,
                 [&](float3 rgb) { pStandardMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setBaseColorTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pStandardMaterial, Material::TextureSlot::BaseColor, texture); }
             );
             pStandardMaterial->setDoubleSided(true);
             pMaterial = pStandardMaterial;
@@ -1215,12 +1312,12 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 reflectance,
                 [&](float3 rgb) { pPBRTMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setBaseColorTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pPBRTMaterial, Material::TextureSlot::BaseColor, texture); }
             );
             assignSpectrumTexture(
                 transmittance,
                 [&](float3 rgb) { pPBRTMaterial->setTransmissionColor(rgb); },
-                [&](Falcor::ref<Texture> pTexture) { pPBRTMaterial->setTransmissionTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pPBRTMaterial, Material::TextureSlot::Transmission, texture); }
             );
             pMaterial = pPBRTMaterial;
         }
@@ -1233,12 +1330,12 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 reflectance,
                 [&](float3 rgb) { pStandardMaterial->setBaseColor(float4(rgb, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setBaseColorTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pStandardMaterial, Material::TextureSlot::BaseColor, texture); }
             );
             assignSpectrumTexture(
                 transmittance,
                 [&](float3 rgb) { pStandardMaterial->setTransmissionColor(rgb); },
-                [&](Falcor::ref<Texture> pTexture) { pStandardMaterial->setTransmissionTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pStandardMaterial, Material::TextureSlot::Transmission, texture); }
             );
             pStandardMaterial->setDoubleSided(true);
             pMaterial = pStandardMaterial;
@@ -1283,7 +1380,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 *sigma_a,
                 [&](float3 constant) { pHairMaterial->setBaseColor(float4(HairMaterial::colorFromSigmaA(constant, beta_n), 1.f)); },
-                [&](Falcor::ref<Texture> pTexture)
+                [&](const ImageTexture& texture)
                 { logWarning(entity.loc, "Non-constant 'sigma_a' is currently not supported. Using default color instead."); }
             );
         }
@@ -1297,7 +1394,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
             assignSpectrumTexture(
                 *reflectance,
                 [&](float3 constant) { pHairMaterial->setBaseColor(float4(constant, 1.f)); },
-                [&](Falcor::ref<Texture> pTexture) { pHairMaterial->setBaseColorTexture(pTexture); }
+                [&](const ImageTexture& texture) { loadMaterialTexture(ctx, pHairMaterial, Material::TextureSlot::BaseColor, texture); }
             );
         }
         else if (eumelanin || pheomelanin)
@@ -1344,8 +1441,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
         auto normalmap = params.getString("normalmap", "");
         if (!normalmap.empty())
         {
-            auto pNormalMap = Texture::createFromFile(ctx.builder.getDevice(), ctx.resolver(normalmap), true, false);
-            pMaterial->setTexture(Material::TextureSlot::Normal, pNormalMap);
+            loadMaterialTexture(ctx, pMaterial, Material::TextureSlot::Normal, ctx.resolver(normalmap), true, false);
         }
     }
 
@@ -1415,7 +1511,12 @@ void createAreaLight(BuilderContext& ctx, const SceneEntity& entity, const Falco
     }
 }
 
-Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
+/**
+ * Create the geometry of a shape.
+ * This only reads the shape entity and is safe to call for different entities in parallel.
+ * Materials, area lights and curves are handled in finalizeShape().
+ */
+Shape createShapeGeometry(BuilderContext& ctx, const ShapeSceneEntity& entity)
 {
     auto warnUnsupported = [&]() { warnUnsupportedType(entity.loc, "Shape", entity.name); };
 
@@ -1466,52 +1567,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
     }
     else if (type == "curve")
     {
-        // Parameters:
-        // Float width, Float width0, Float width1, Int degree, String basis,
-        // Point3[] P, String type, Normal3[] N, Int splitdepth
-        warnUnsupportedParameters(params, {"degree", "N"});
-
-        auto splitdepth = params.getInt("splitdepth", 1);
-
-        auto width = params.getFloat("width", 1.f);
-        auto width0 = params.getFloat("width0", width);
-        auto width1 = params.getFloat("width1", width);
-
-        auto basis = params.getString("basis", "bezier");
-        if (basis != "bspline")
-            logWarning(entity.loc, "Basis '{}' is not supported. Using 'bspline' basis instead.", basis);
-
-        auto curveType = params.getString("type", "flat");
-        if (curveType != "cylinder")
-            logWarning(entity.loc, "Curve type '{}' is not supported. Using 'cylinder' type instead.", curveType);
-
-        auto P = params.getPoint3Array("P");
-
-        // Create or get existing curve aggregate.
-        auto pMaterial = ctx.getMaterial(entity.materialRef);
-        CurveAggregate::Key key{entity.transform, pMaterial.get()};
-        auto it = ctx.curveAggregates.find(key);
-        if (it == ctx.curveAggregates.end())
-        {
-            it = ctx.curveAggregates.emplace(key, CurveAggregate{}).first;
-            it->second.transform = entity.transform;
-            it->second.pMaterial = pMaterial;
-            it->second.splitDepth = splitdepth;
-        }
-        CurveAggregate& aggregate = it->second;
-
-        // Append curve to aggregate.
-        size_t pointCount = P.size();
-        size_t offset = aggregate.points.size();
-        aggregate.strands.push_back(pointCount);
-        aggregate.points.resize(aggregate.points.size() + pointCount);
-        aggregate.widths.resize(aggregate.widths.size() + pointCount);
-        for (size_t i = 0; i < pointCount; ++i)
-        {
-            float t = float(i) / pointCount;
-            aggregate.points[offset + i] = P[i];
-            aggregate.widths[offset + i] = math::lerp(width0, width1, t);
-        }
+        // Curves are aggregated in finalizeShape().
     }
     else if (type == "trianglemesh")
     {
@@ -1533,7 +1589,8 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
             else
             {
                 logWarning(entity.loc, "Vertex indices 'indices' missing. Skipping.");
-                return {};
+                shape.isSkipped = true;
+                return shape;
             }
         }
         if (indices.size() % 3 != 0)
@@ -1547,7 +1604,8 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         if (P.empty())
         {
             logWarning(entity.loc, "Vertex positions 'positions' missing. Skipping.");
-            return {};
+            shape.isSkipped = true;
+            return shape;
         }
         if (!uv.empty() && uv.size() != P.size())
         {
@@ -1564,7 +1622,8 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
             if (i < 0 || i >= P.size())
             {
                 logWarning(entity.loc, "Vertex index {} is out of bounds. Skipping.", i);
-                return {};
+                shape.isSkipped = true;
+                return shape;
             }
         }
 
@@ -1593,9 +1652,15 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         auto filename = params.getString("filename", "");
         auto path = ctx.resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
-        if (shape.pTriangleMesh)
+        try
+        {
+            shape.pTriangleMesh = readPLY(path);
             shape.pTriangleMesh->setName(filename);
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning(entity.loc, "{}", e.what());
+        }
         shape.transform = entity.transform;
     }
     else if (type == "loopsubdiv")
@@ -1639,6 +1704,73 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
     if (entity.reverseOrientation && shape.pTriangleMesh)
         shape.pTriangleMesh->setFrontFaceCW(!shape.pTriangleMesh->getFrontFaceCW());
 
+    return shape;
+}
+
+/**
+ * Add a curve shape to the curve aggregates.
+ */
+void addCurve(BuilderContext& ctx, const ShapeSceneEntity& entity)
+{
+    const auto& params = entity.params;
+
+    // Parameters:
+    // Float width, Float width0, Float width1, Int degree, String basis,
+    // Point3[] P, String type, Normal3[] N, Int splitdepth
+    warnUnsupportedParameters(params, {"degree", "N"});
+
+    auto splitdepth = params.getInt("splitdepth", 1);
+
+    auto width = params.getFloat("width", 1.f);
+    auto width0 = params.getFloat("width0", width);
+    auto width1 = params.getFloat("width1", width);
+
+    auto basis = params.getString("basis", "bezier");
+    if (basis != "bspline")
+        logWarning(entity.loc, "Basis '{}' is not supported. Using 'bspline' basis instead.", basis);
+
+    auto curveType = params.getString("type", "flat");
+    if (curveType != "cylinder")
+        logWarning(entity.loc, "Curve type '{}' is not supported. Using 'cylinder' type instead.", curveType);
+
+    auto P = params.getPoint3Array("P");
+
+    // Create or get existing curve aggregate.
+    auto pMaterial = ctx.getMaterial(entity.materialRef);
+    CurveAggregate::Key key{entity.transform, pMaterial.get()};
+    auto it = ctx.curveAggregates.find(key);
+    if (it == ctx.curveAggregates.end())
+    {
+        it = ctx.curveAggregates.emplace(key, CurveAggregate{}).first;
+        it->second.transform = entity.transform;
+        it->second.pMaterial = pMaterial;
+        it->second.splitDepth = splitdepth;
+    }
+    CurveAggregate& aggregate = it->second;
+
+    // Append curve to aggregate.
+    size_t pointCount = P.size();
+    size_t offset = aggregate.points.size();
+    aggregate.strands.push_back(pointCount);
+    aggregate.points.resize(aggregate.points.size() + pointCount);
+    aggregate.widths.resize(aggregate.widths.size() + pointCount);
+    for (size_t i = 0; i < pointCount; ++i)
+    {
+        float t = float(i) / pointCount;
+        aggregate.points[offset + i] = P[i];
+        aggregate.widths[offset + i] = math::lerp(width0, width1, t);
+    }
+}
+
+/**
+ * Finalize a shape created by createShapeGeometry().
+ * This assigns the material, creates area lights and aggregates curves. It must be called in shape order.
+ */
+void finalizeShape(BuilderContext& ctx, const ShapeSceneEntity& entity, Shape& shape)
+{
+    if (entity.name == "curve")
+        addCurve(ctx, entity);
+
     // Get the material.
     shape.pMaterial = ctx.getMaterial(entity.materialRef);
 
@@ -1663,8 +1795,59 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         const SceneEntity& areaLightEntity = ctx.scene.getAreaLight(entity.lightIndex);
         createAreaLight(ctx, areaLightEntity, shape.pMaterial);
     }
+}
 
-    return shape;
+/**
+ * Create shapes from a list of shape entities.
+ * The shape geometry is created in parallel in batches, the shapes are then finalized and passed to the callback
+ * in the original order. Invalid shapes are skipped.
+ */
+template<typename Callback>
+void createShapes(BuilderContext& ctx, const std::vector<ShapeSceneEntity>& entities, Callback callback)
+{
+    // Limit the number of meshes held in memory at once.
+    const size_t kBatchSize = 1024;
+
+    std::vector<Shape> shapes;
+    std::vector<std::exception_ptr> exceptions;
+
+    for (size_t batchStart = 0; batchStart < entities.size(); batchStart += kBatchSize)
+    {
+        const size_t batchSize = std::min(kBatchSize, entities.size() - batchStart);
+        shapes.assign(batchSize, Shape{});
+        exceptions.assign(batchSize, nullptr);
+
+        auto range = NumericRange<size_t>(0, batchSize);
+        std::for_each(
+            std::execution::par,
+            range.begin(),
+            range.end(),
+            [&](size_t i)
+            {
+                try
+                {
+                    shapes[i] = createShapeGeometry(ctx, entities[batchStart + i]);
+                }
+                catch (...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+            }
+        );
+
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            if (exceptions[i])
+                std::rethrow_exception(exceptions[i]);
+            if (shapes[i].isSkipped)
+                continue;
+
+            const auto& entity = entities[batchStart + i];
+            finalizeShape(ctx, entity, shapes[i]);
+            callback(entity, shapes[i]);
+            shapes[i] = {};
+        }
+    }
 }
 
 /**
@@ -1758,35 +1941,38 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
 {
     InstanceDefinition instanceDefinition;
 
-    for (const auto& shapeEntity : entity.shapes)
-    {
-        // Process shapes and create meshes.
-        auto shape = createShape(ctx, shapeEntity);
-        if (shape.pTriangleMesh)
-        {
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            instanceDefinition.meshes.emplace_back(meshID, shape.transform);
-        }
-
-        // Create curves from curve aggregates assembled during the processing step above.
-        for (const auto& [_, curveAggregate] : ctx.curveAggregates)
+    // Process shapes and create meshes.
+    createShapes(
+        ctx,
+        entity.shapes,
+        [&](const ShapeSceneEntity& shapeEntity, const Shape& shape)
         {
-            auto meshOrCurveID = createCurveGeometry(ctx, curveAggregate);
-            if (auto meshID = std::get_if<Falcor::MeshID>(&meshOrCurveID))
+            if (shape.pTriangleMesh)
             {
-                instanceDefinition.meshes.emplace_back(*meshID, curveAggregate.transform);
+                auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
+                instanceDefinition.meshes.emplace_back(meshID, shape.transform);
             }
-            else if (auto curveID = std::get_if<Falcor::CurveID>(&meshOrCurveID))
-            {
-                instanceDefinition.curves.emplace_back(*curveID, curveAggregate.transform);
-            }
-            else
+
+            // Create curves from curve aggregates assembled during the processing step above.
+            for (const auto& [_, curveAggregate] : ctx.curveAggregates)
             {
-                FALCOR_UNREACHABLE();
+                auto meshOrCurveID = createCurveGeometry(ctx, curveAggregate);
+                if (auto meshID = std::get_if<Falcor::MeshID>(&meshOrCurveID))
+                {
+                    instanceDefinition.meshes.emplace_back(*meshID, curveAggregate.transform);
+                }
+                else if (auto curveID = std::get_if<Falcor::CurveID>(&meshOrCurveID))
+                {
+                    instanceDefinition.curves.emplace_back(*curveID, curveAggregate.transform);
+                }
+                else
+                {
+                    FALCOR_UNREACHABLE();
+                }
             }
+            ctx.curveAggregates.clear();
         }
-        ctx.curveAggregates.clear();
-    }
+    );
 
     return instanceDefinition;
 }
@@ -1822,6 +2008,9 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Create lights.
+    // Env maps loaded from files are finalized after all shapes are built, so that decoding overlaps with shape processing.
+    bool hasEnvMap = ctx.builder.getEnvMap() != nullptr;
+    std::optional<Light::PendingEnvMap> pendingEnvMap;
     for (const auto& entity : ctx.scene.getLights())
     {
         auto light = createLight(ctx, entity);
@@ -1829,11 +2018,15 @@ void buildScene(BuilderContext& ctx)
         {
             ctx.builder.addLight(light.pLight);
         }
-        if (light.pEnvMap)
+        if (light.hasEnvMap())
         {
-            if (ctx.builder.getEnvMap() == nullptr)
+            if (!hasEnvMap)
             {
-                ctx.builder.setEnvMap(light.pEnvMap);
+                hasEnvMap = true;
+                if (light.pEnvMap)
+                    ctx.builder.setEnvMap(light.pEnvMap);
+                else
+                    pendingEnvMap = std::move(light.pendingEnvMap);
             }
             else
             {
@@ -1843,16 +2036,19 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Process shapes and create meshes.
-    for (const auto& entity : ctx.scene.getShapes())
-    {
-        auto shape = createShape(ctx, entity);
-        if (shape.pTriangleMesh)
+    createShapes(
+        ctx,
+        ctx.scene.getShapes(),
+        [&ctx](const ShapeSceneEntity& entity, const Shape& shape)
         {
-            auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            ctx.builder.addMeshInstance(nodeID, meshID);
+            if (shape.pTriangleMesh)
+            {
+                auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
+                auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
+                ctx.builder.addMeshInstance(nodeID, meshID);
+            }
         }
-    }
+    );
 
     // Create curves from curve aggregates assembled during the processing step above.
     for (const auto& [_, curveAggregate] : ctx.curveAggregates)
@@ -1902,6 +2098,13 @@ void buildScene(BuilderContext& ctx)
             ctx.builder.addMeshInstance(nodeID, meshID);
         }
     }
+
+    // Finalize env map.
+    if (pendingEnvMap)
+    {
+        if (auto pEnvMap = finalizeEnvMap(ctx, *pendingEnvMap))
+            ctx.builder.setEnvMap(pEnvMap);
+    }
 }
 
 } // namespace pbrt
@@ -1933,6 +2136,9 @@ void PBRTImporter::importScene(
         pbrt::buildScene(ctx);
         timeReport.measure("Building pbrt scene");
         timeReport.printToLog();
+
+        // Textures are loaded while building the scene, report the share of the build spent on them.
+        logInfo("Loading pbrt textures took {:.2f} s of the scene build.", ctx.textureLoadTime);
     }
     catch (const RuntimeError& e)
     {
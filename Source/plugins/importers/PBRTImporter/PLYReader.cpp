@@ -0,0 +1,691 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PLYReader.h"
+#include "Helpers.h"
+#include "Core/Error.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+
+#include <fast_float/fast_float.h>
+
+#include <charconv>
+#include <cstring>
+#include <initializer_list>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor::pbrt
+{
+
+namespace
+{
+
+enum class Format
+{
+    Ascii,
+    BinaryLittleEndian,
+    BinaryBigEndian,
+};
+
+enum class Type
+{
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64,
+};
+
+std::optional<Type> parseType(std::string_view name)
+{
+    if (name == "char" || name == "int8")
+        return Type::Int8;
+    if (name == "uchar" || name == "uint8")
+        return Type::UInt8;
+    if (name == "short" || name == "int16")
+        return Type::Int16;
+    if (name == "ushort" || name == "uint16")
+        return Type::UInt16;
+    if (name == "int" || name == "int32")
+        return Type::Int32;
+    if (name == "uint" || name == "uint32")
+        return Type::UInt32;
+    if (name == "float" || name == "float32")
+        return Type::Float32;
+    if (name == "double" || name == "float64")
+        return Type::Float64;
+    return {};
+}
+
+size_t getTypeSize(Type type)
+{
+    switch (type)
+    {
+    case Type::Int8:
+    case Type::UInt8:
+        return 1;
+    case Type::Int16:
+    case Type::UInt16:
+        return 2;
+    case Type::Int32:
+    case Type::UInt32:
+    case Type::Float32:
+        return 4;
+    case Type::Float64:
+        return 8;
+    }
+    FALCOR_UNREACHABLE();
+}
+
+bool isFloatType(Type type)
+{
+    return type == Type::Float32 || type == Type::Float64;
+}
+
+struct Property
+{
+    std::string name;
+    Type type = Type::Float32;
+    bool isList = false;
+    Type countType = Type::UInt8;
+};
+
+struct Element
+{
+    std::string name;
+    size_t count = 0;
+    std::vector<Property> properties;
+
+    /// Returns the index of the first property matching one of the names, or -1 if none is found.
+    int findProperty(std::initializer_list<std::string_view> names) const
+    {
+        for (auto name : names)
+        {
+            for (size_t i = 0; i < properties.size(); ++i)
+            {
+                if (properties[i].name == name)
+                    return (int)i;
+            }
+        }
+        return -1;
+    }
+};
+
+struct Header
+{
+    Format format = Format::Ascii;
+    std::vector<Element> elements;
+    size_t dataOffset = 0;
+};
+
+std::string_view nextLine(const char*& pos, const char* end)
+{
+    const char* begin = pos;
+    while (pos < end && *pos != '\n')
+        ++pos;
+    std::string_view line(begin, pos - begin);
+    if (pos < end)
+        ++pos;
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    return line;
+}
+
+std::vector<std::string_view> splitWords(std::string_view line)
+{
+    std::vector<std::string_view> words;
+    size_t pos = 0;
+    while (pos < line.size())
+    {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t'))
+            ++pos;
+        size_t begin = pos;
+        while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t')
+            ++pos;
+        if (pos > begin)
+            words.push_back(line.substr(begin, pos - begin));
+    }
+    return words;
+}
+
+Header parseHeader(const char* data, size_t size)
+{
+    const char* pos = data;
+    const char* end = data + size;
+
+    if (nextLine(pos, end) != "ply")
+        throwError("Missing 'ply' magic.");
+
+    Header header;
+    bool hasFormat = false;
+
+    while (true)
+    {
+        if (pos == end)
+            throwError("Missing 'end_header'.");
+
+        auto line = nextLine(pos, end);
+        auto words = splitWords(line);
+        if (words.empty())
+            continue;
+
+        if (words[0] == "end_header")
+        {
+            break;
+        }
+        else if (words[0] == "comment" || words[0] == "obj_info")
+        {
+            continue;
+        }
+        else if (words[0] == "format" && words.size() == 3)
+        {
+            if (words[1] == "ascii")
+                header.format = Format::Ascii;
+            else if (words[1] == "binary_little_endian")
+                header.format = Format::BinaryLittleEndian;
+            else if (words[1] == "binary_big_endian")
+                header.format = Format::BinaryBigEndian;
+            else
+                throwError("Unknown format '{}'.", words[1]);
+            hasFormat = true;
+        }
+        else if (words[0] == "element" && words.size() == 3)
+        {
+            Element element;
+            element.name = std::string(words[1]);
+            auto result = std::from_chars(words[2].data(), words[2].data() + words[2].size(), element.count);
+            if (result.ec != std::errc() || result.ptr != words[2].data() + words[2].size())
+                throwError("Invalid element count '{}'.", words[2]);
+            header.elements.push_back(std::move(element));
+        }
+        else if (words[0] == "property" && (words.size() == 3 || (words.size() == 5 && words[1] == "list")))
+        {
+            if (header.elements.empty())
+                throwError("Property '{}' declared before any element.", line);
+
+            Property property;
+            std::optional<Type> type;
+            if (words.size() == 5)
+            {
+                auto countType = parseType(words[2]);
+                if (!countType || isFloatType(*countType))
+                    throwError("Invalid list count type in '{}'.", line);
+                property.isList = true;
+                property.countType = *countType;
+                type = parseType(words[3]);
+            }
+            else
+            {
+                type = parseType(words[1]);
+            }
+            if (!type)
+                throwError("Unknown property type in '{}'.", line);
+            property.type = *type;
+            property.name = std::string(words.back());
+            header.elements.back().properties.push_back(std::move(property));
+        }
+        else
+        {
+            throwError("Unexpected header line '{}'.", line);
+        }
+    }
+
+    if (!hasFormat)
+        throwError("Missing 'format'.");
+
+    header.dataOffset = pos - data;
+    return header;
+}
+
+/**
+ * Reads values from binary PLY data.
+ * Values are converted from the file's byte order while loading. The byte reversal is written in plain C++ so
+ * that the compiler emits the native byte swap instructions.
+ */
+class BinarySource
+{
+public:
+    BinarySource(const char* pos, const char* end, bool swapBytes) : mPos(pos), mEnd(end), mSwapBytes(swapBytes) {}
+
+    template<typename T>
+    T read(Type type)
+    {
+        switch (type)
+        {
+        case Type::Int8:
+            return (T)load<int8_t>();
+        case Type::UInt8:
+            return (T)load<uint8_t>();
+        case Type::Int16:
+            return (T)load<int16_t>();
+        case Type::UInt16:
+            return (T)load<uint16_t>();
+        case Type::Int32:
+            return (T)load<int32_t>();
+        case Type::UInt32:
+            return (T)load<uint32_t>();
+        case Type::Float32:
+            return (T)load<float>();
+        case Type::Float64:
+            return (T)load<double>();
+        }
+        FALCOR_UNREACHABLE();
+    }
+
+    void skip(Type type, size_t count = 1)
+    {
+        size_t size = getTypeSize(type) * count;
+        if (size_t(mEnd - mPos) < size)
+            throwError("Unexpected end of file.");
+        mPos += size;
+    }
+
+    /// Returns the smallest number of bytes a value of the given type occupies in the file.
+    size_t getMinValueSize(Type type) const { return getTypeSize(type); }
+
+    size_t getRemaining() const { return mEnd - mPos; }
+
+private:
+    template<typename U>
+    U load()
+    {
+        if (size_t(mEnd - mPos) < sizeof(U))
+            throwError("Unexpected end of file.");
+        char bytes[sizeof(U)];
+        if (mSwapBytes)
+        {
+            for (size_t i = 0; i < sizeof(U); ++i)
+                bytes[i] = mPos[sizeof(U) - 1 - i];
+        }
+        else
+        {
+            std::memcpy(bytes, mPos, sizeof(U));
+        }
+        mPos += sizeof(U);
+        U value;
+        std::memcpy(&value, bytes, sizeof(U));
+        return value;
+    }
+
+    const char* mPos;
+    const char* mEnd;
+    bool mSwapBytes;
+};
+
+/**
+ * Reads values from ASCII PLY data.
+ * Values are whitespace separated, line breaks between elements are not significant.
+ */
+class AsciiSource
+{
+public:
+    AsciiSource(const char* pos, const char* end) : mPos(pos), mEnd(end) {}
+
+    template<typename T>
+    T read(Type type)
+    {
+        std::string_view token = nextToken();
+        const char* begin = token.data();
+        const char* end = token.data() + token.size();
+        if (isFloatType(type))
+        {
+            double value;
+            auto result = fast_float::from_chars(begin, end, value);
+            if (result.ptr != end)
+                throwError("'{}': Expected a number.", token);
+            return (T)value;
+        }
+        else
+        {
+            int64_t value;
+            auto result = std::from_chars(begin, end, value);
+            if (result.ptr != end)
+                throwError("'{}': Expected an integer.", token);
+            return (T)value;
+        }
+    }
+
+    void skip(Type type, size_t count = 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            nextToken();
+    }
+
+    /// Returns the smallest number of bytes a value of the given type occupies in the file (a single digit).
+    size_t getMinValueSize(Type) const { return 1; }
+
+    size_t getRemaining() const { return mEnd - mPos; }
+
+private:
+    std::string_view nextToken()
+    {
+        while (mPos < mEnd && (*mPos == ' ' || *mPos == '\t' || *mPos == '\n' || *mPos == '\r'))
+            ++mPos;
+        const char* begin = mPos;
+        while (mPos < mEnd && *mPos != ' ' && *mPos != '\t' && *mPos != '\n' && *mPos != '\r')
+            ++mPos;
+        if (mPos == begin)
+            throwError("Unexpected end of file.");
+        return std::string_view(begin, mPos - begin);
+    }
+
+    const char* mPos;
+    const char* mEnd;
+};
+
+template<typename Source>
+uint32_t readListCount(Source& source, const Property& property)
+{
+    int64_t count = source.template read<int64_t>(property.countType);
+    if (count < 0)
+        throwError("Negative list size in property '{}'.", property.name);
+    return (uint32_t)count;
+}
+
+/// Throws if the remaining data is too small to hold all entries of the element, before any memory is allocated for them.
+template<typename Source>
+void checkElementCount(const Source& source, const Element& element)
+{
+    size_t stride = 0;
+    for (const auto& property : element.properties)
+        stride += source.getMinValueSize(property.isList ? property.countType : property.type);
+    if (stride > 0 && element.count > source.getRemaining() / stride)
+        throwError("Element '{}' has {} entries, but only {} bytes of data remain.", element.name, element.count, source.getRemaining());
+}
+
+template<typename Source>
+void skipElement(Source& source, const Element& element)
+{
+    for (size_t i = 0; i < element.count; ++i)
+    {
+        for (const auto& property : element.properties)
+        {
+            if (property.isList)
+                source.skip(property.type, readListCount(source, property));
+            else
+                source.skip(property.type);
+        }
+    }
+}
+
+template<typename Source>
+void readVertices(Source& source, const Element& element, TriangleMesh::VertexList& vertices, bool& hasNormals, bool& hasTexCoords)
+{
+    // Attribute slots: position (0-2), normal (3-5), texture coordinate (6-7).
+    const int attributeProperties[8] = {
+        element.findProperty({"x"}),
+        element.findProperty({"y"}),
+        element.findProperty({"z"}),
+        element.findProperty({"nx"}),
+        element.findProperty({"ny"}),
+        element.findProperty({"nz"}),
+        element.findProperty({"u", "s", "texture_u", "texture_s"}),
+        element.findProperty({"v", "t", "texture_v", "texture_t"}),
+    };
+
+    std::vector<int> propertySlots(element.properties.size(), -1);
+    for (int slot = 0; slot < 8; ++slot)
+    {
+        int index = attributeProperties[slot];
+        if (index < 0)
+            continue;
+        if (element.properties[index].isList)
+            throwError("Vertex property '{}' must not be a list.", element.properties[index].name);
+        propertySlots[index] = slot;
+    }
+
+    if (attributeProperties[0] < 0 || attributeProperties[1] < 0 || attributeProperties[2] < 0)
+        throwError("Missing vertex positions.");
+    hasNormals = attributeProperties[3] >= 0 && attributeProperties[4] >= 0 && attributeProperties[5] >= 0;
+    hasTexCoords = attributeProperties[6] >= 0 && attributeProperties[7] >= 0;
+
+    checkElementCount(source, element);
+    vertices.resize(element.count);
+    for (auto& vertex : vertices)
+    {
+        float values[8] = {};
+        for (size_t i = 0; i < element.properties.size(); ++i)
+        {
+            const auto& property = element.properties[i];
+            if (propertySlots[i] >= 0)
+                values[propertySlots[i]] = source.template read<float>(property.type);
+            else if (property.isList)
+                source.skip(property.type, readListCount(source, property));
+            else
+                source.skip(property.type);
+        }
+
+        vertex.position = float3(values[0], values[1], values[2]);
+        vertex.normal = hasNormals ? float3(values[3], values[4], values[5]) : float3(0.f);
+        vertex.texCoord = hasTexCoords ? float2(values[6], 1.f - values[7]) : float2(0.f);
+    }
+}
+
+template<typename Source>
+void readFaces(Source& source, const Element& element, TriangleMesh::IndexList& indices, std::vector<float2>& cornerTexCoords)
+{
+    const int indicesProperty = element.findProperty({"vertex_indices", "vertex_index"});
+    const int texCoordProperty = element.findProperty({"texcoord"});
+
+    if (indicesProperty < 0 || !element.properties[indicesProperty].isList)
+        throwError("Missing face property 'vertex_indices'.");
+    if (texCoordProperty >= 0 && !element.properties[texCoordProperty].isList)
+        throwError("Face property 'texcoord' must be a list.");
+
+    checkElementCount(source, element);
+    indices.reserve(indices.size() + element.count * 3);
+    if (texCoordProperty >= 0)
+        cornerTexCoords.reserve(cornerTexCoords.size() + element.count * 3);
+
+    std::vector<uint32_t> polygon;
+    std::vector<float2> polygonTexCoords;
+
+    for (size_t face = 0; face < element.count; ++face)
+    {
+        polygon.clear();
+        polygonTexCoords.clear();
+
+        for (int i = 0; i < (int)element.properties.size(); ++i)
+        {
+            const auto& property = element.properties[i];
+            if (!property.isList)
+            {
+                source.skip(property.type);
+                continue;
+            }
+
+            uint32_t count = readListCount(source, property);
+            if (i == indicesProperty)
+            {
+                for (uint32_t j = 0; j < count; ++j)
+                {
+                    int64_t index = source.template read<int64_t>(property.type);
+                    if (index < 0)
+                        throwError("Negative vertex index in face {}.", face);
+                    polygon.push_back((uint32_t)index);
+                }
+            }
+            else if (i == texCoordProperty)
+            {
+                for (uint32_t j = 0; j + 1 < count; j += 2)
+                {
+                    float u = source.template read<float>(property.type);
+                    float v = source.template read<float>(property.type);
+                    polygonTexCoords.push_back(float2(u, 1.f - v));
+                }
+                if (count % 2 != 0)
+                    source.skip(property.type);
+            }
+            else
+            {
+                source.skip(property.type, count);
+            }
+        }
+
+        // Skip degenerate faces.
+        if (polygon.size() < 3)
+            continue;
+
+        if (texCoordProperty >= 0 && polygonTexCoords.size() != polygon.size())
+            throwError("Face {} has {} vertices but {} texture coordinates.", face, polygon.size(), polygonTexCoords.size());
+
+        // Triangulate quads and larger polygons as fans.
+        for (size_t j = 1; j + 1 < polygon.size(); ++j)
+        {
+            indices.push_back(polygon[0]);
+            indices.push_back(polygon[j]);
+            indices.push_back(polygon[j + 1]);
+            if (texCoordProperty >= 0)
+            {
+                cornerTexCoords.push_back(polygonTexCoords[0]);
+                cornerTexCoords.push_back(polygonTexCoords[j]);
+                cornerTexCoords.push_back(polygonTexCoords[j + 1]);
+            }
+        }
+    }
+}
+
+template<typename Source>
+ref<TriangleMesh> readMesh(Source& source, const Header& header)
+{
+    TriangleMesh::VertexList vertices;
+    TriangleMesh::IndexList indices;
+    std::vector<float2> cornerTexCoords;
+    bool hasVertices = false;
+    bool hasNormals = false;
+    bool hasTexCoords = false;
+
+    for (const auto& element : header.elements)
+    {
+        if (element.name == "vertex" && !hasVertices)
+        {
+            readVertices(source, element, vertices, hasNormals, hasTexCoords);
+            hasVertices = true;
+        }
+        else if (element.name == "face")
+        {
+            readFaces(source, element, indices, cornerTexCoords);
+        }
+        else
+        {
+            skipElement(source, element);
+        }
+    }
+
+    if (!hasVertices)
+        throwError("Missing 'vertex' element.");
+
+    for (uint32_t index : indices)
+    {
+        if (index >= vertices.size())
+            throwError("Vertex index {} out of range (vertex count is {}).", index, vertices.size());
+    }
+
+    // Face-varying texture coordinates and faceted normals need separate vertices for each face corner.
+    if (!cornerTexCoords.empty() || !hasNormals)
+    {
+        TriangleMesh::VertexList corners(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                corners[i + j] = vertices[indices[i + j]];
+                if (!cornerTexCoords.empty())
+                    corners[i + j].texCoord = cornerTexCoords[i + j];
+            }
+
+            if (!hasNormals)
+            {
+                float3 normal = cross(corners[i + 1].position - corners[i].position, corners[i + 2].position - corners[i].position);
+                float len = length(normal);
+                normal = len > 0.f ? normal / len : float3(0.f);
+                for (size_t j = 0; j < 3; ++j)
+                    corners[i + j].normal = normal;
+            }
+        }
+        vertices = std::move(corners);
+        std::iota(indices.begin(), indices.end(), 0u);
+    }
+
+    return TriangleMesh::create(std::move(vertices), std::move(indices));
+}
+
+} // namespace
+
+ref<TriangleMesh> readPLY(const std::filesystem::path& path)
+{
+    std::string decompressed;
+    MemoryMappedFile file;
+    const char* data = nullptr;
+    size_t size = 0;
+
+    if (hasExtension(path, "gz"))
+    {
+        decompressed = decompressFile(path);
+        data = decompressed.data();
+        size = decompressed.size();
+    }
+    else
+    {
+        if (!file.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan))
+            throwError("Failed to open PLY file '{}'.", path);
+        data = static_cast<const char*>(file.getData());
+        size = file.getMappedSize();
+    }
+
+    try
+    {
+        Header header = parseHeader(data, size);
+        const char* begin = data + header.dataOffset;
+        const char* end = data + size;
+
+        if (header.format == Format::Ascii)
+        {
+            AsciiSource source(begin, end);
+            return readMesh(source, header);
+        }
+        else
+        {
+            // All supported platforms are little endian.
+            BinarySource source(begin, end, header.format == Format::BinaryBigEndian);
+            return readMesh(source, header);
+        }
+    }
+    catch (const RuntimeError& e)
+    {
+        throwError("Failed to read PLY file '{}': {}", path, e.what());
+    }
+}
+
+} // namespace Falcor::pbrt
@@ -0,0 +1,57 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Object.h"
+#include "Scene/TriangleMesh.h"
+#include <filesystem>
+
+namespace Falcor::pbrt
+{
+
+/**
+ * Read a triangle mesh from a PLY file.
+ *
+ * Supports ASCII and binary (little and big endian) PLY files, optionally gzip compressed.
+ * Uncompressed files are memory mapped and decoded directly into the mesh vertex and index lists.
+ *
+ * Vertices are read from the "vertex" element with properties x/y/z, nx/ny/nz and u/v (or s/t, texture_u/texture_v,
+ * texture_s/texture_t). Faces are read from the "vertex_indices" list of the "face" element. Quads and other convex
+ * polygons are triangulated as fans. Face-varying texture coordinates given by a "texcoord" list of the "face" element
+ * are supported, in which case vertices are duplicated per face corner.
+ *
+ * To match the mesh import through Assimp, the v texture coordinate is flipped and faceted normals are generated
+ * if the file has no normals.
+ *
+ * Throws a RuntimeError if the file cannot be read or is malformed.
+ *
+ * @param[in] path File path.
+ * @return The triangle mesh.
+ */
+ref<TriangleMesh> readPLY(const std::filesystem::path& path);
+
+} // namespace Falcor::pbrt
@@ -39,7 +39,11 @@
 
 #include <fast_float/fast_float.h>
 
+#include <algorithm>
 #include <atomic>
+#include <exception>
+#include <execution>
+#include <mutex>
 #include <utility>
 #include <charconv>
 
@@ -86,17 +90,61 @@ static char decodeEscaped(int ch, const FileLoc& loc)
     return 0;
 }
 
+namespace
+{
+enum CharClass : uint8_t
+{
+    kWhitespace = 1, ///< ' ', '\n', '\t' or '\r'.
+    kDelimiter = 2,  ///< Whitespace, '"', '[' or ']', terminating a regular token.
+    kLineEnd = 4,    ///< '\n' or '\r', terminating a comment.
+    kArrayValue = 8, ///< Characters allowed in numeric and Boolean array values.
+};
+
+struct CharClassTable
+{
+    uint8_t classes[256] = {};
+
+    constexpr CharClassTable()
+    {
+        for (char c : {' ', '\n', '\t', '\r'})
+            classes[(uint8_t)c] |= kWhitespace | kDelimiter;
+        for (char c : {'"', '[', ']'})
+            classes[(uint8_t)c] |= kDelimiter;
+        for (char c : {'\n', '\r'})
+            classes[(uint8_t)c] |= kLineEnd;
+        for (char c = '0'; c <= '9'; ++c)
+            classes[(uint8_t)c] |= kArrayValue;
+        for (char c : {'+', '-', '.', 'e', 'E', 't', 'r', 'u', 'f', 'a', 'l', 's'})
+            classes[(uint8_t)c] |= kArrayValue;
+    }
+
+    bool is(char c, CharClass charClass) const { return (classes[(uint8_t)c] & charClass) != 0; }
+};
+
+// Tokens and whitespace runs in pbrt files are only a few characters long,
+// so a table lookup per character is cheaper than wider vectorized scans.
+constexpr CharClassTable kCharClasses;
+} // namespace
+
 std::unique_ptr<Tokenizer> Tokenizer::createFromFile(const std::filesystem::path& path)
 {
     if (hasExtension(path, "gz"))
     {
-        std::string str = decompressFile(path);
-        return std::make_unique<Tokenizer>(std::move(str), path);
+        auto pReader = std::make_unique<CompressedFileReader>(path);
+        if (!pReader->isOpen())
+            throwError("Failed to open file '{}'.", path);
+        return std::make_unique<Tokenizer>(std::move(pReader), path);
     }
     else
     {
-        std::string str = readFile(path);
-        return std::make_unique<Tokenizer>(std::move(str), path);
+        auto pFile = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!pFile->isOpen())
+        {
+            // Memory mapping fails for empty files.
+            std::string str = readFile(path);
+            return std::make_unique<Tokenizer>(std::move(str), path);
+        }
+        return std::make_unique<Tokenizer>(std::move(pFile), path);
     }
 }
 
@@ -107,13 +155,36 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
 
 Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path) : mPath(path), mContents(std::move(str))
 {
-    auto pFilename = std::make_unique<std::string>(path.string());
+    init(mContents.data(), mContents.size());
+}
+
+Tokenizer::Tokenizer(std::unique_ptr<MemoryMappedFile> pFile, const std::filesystem::path& path) : mPath(path), mpFile(std::move(pFile))
+{
+    init(static_cast<const char*>(mpFile->getData()), mpFile->getMappedSize());
+}
+
+Tokenizer::Tokenizer(std::unique_ptr<CompressedFileReader> pReader, const std::filesystem::path& path)
+    : mPath(path), mpReader(std::move(pReader))
+{
+    refill();
+    init(mPos, mEnd - mPos);
+}
+
+void Tokenizer::init(const char* data, size_t size)
+{
+    auto pFilename = std::make_unique<std::string>(mPath.string());
     mLoc = FileLoc(*pFilename);
-    getFilenames().push_back(std::move(pFilename));
+    {
+        // Imported files are tokenized on multiple threads.
+        static std::mutex filenamesMutex;
+        std::lock_guard<std::mutex> lock(filenamesMutex);
+        getFilenames().push_back(std::move(pFilename));
+    }
 
-    mPos = mContents.data();
-    mEnd = mPos + mContents.size();
-    if (isUTF16(mContents.data(), mContents.size()))
+    mPos = data;
+    mEnd = data + size;
+    mTokenStart = mPos;
+    if (isUTF16(data, size))
         throwError("File is encoded with UTF-16, which is not currently supported.");
 }
 
@@ -124,102 +195,147 @@ bool Tokenizer::isUTF16(const void* ptr, size_t len) const
     return (len >= 2 && ((c[0] == 0xfe && c[1] == 0xff) || (c[0] == 0xff && c[1] == 0xfe)));
 }
 
+bool Tokenizer::refill()
+{
+    if (!mpReader || mpReader->isEOF())
+        return false;
+
+    // Decompress into the other chunk. Tokens returned from the current chunk stay valid until the next refill.
+    size_t carry = mEnd - mTokenStart;
+    auto& chunk = mChunks[mChunkIndex ^= 1];
+    chunk.resize(std::max(kChunkSize, 2 * carry));
+    std::copy(mTokenStart, mEnd, chunk.data());
+    size_t size = mpReader->read(chunk.data() + carry, chunk.size() - carry);
+
+    mTokenStart = chunk.data();
+    mPos = mTokenStart + carry;
+    mEnd = mPos + size;
+    return size > 0;
+}
+
 std::optional<Token> Tokenizer::next()
 {
+    // Skip whitespace.
     while (true)
     {
-        const char* tokenStart = mPos;
-        FileLoc startLoc = mLoc;
-
-        int ch = getChar();
-        if (ch == EOF)
-        {
-            return {};
-        }
-        else if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r')
+        while (mPos < mEnd && kCharClasses.is(*mPos, kWhitespace))
         {
-            // Skip.
+            if (*mPos++ == '\n')
+            {
+                ++mLoc.line;
+                mLoc.column = 0;
+            }
+            else
+            {
+                ++mLoc.column;
+            }
         }
-        else if (ch == '"')
+        mTokenStart = mPos;
+        if (mPos < mEnd || !refill())
+            break;
+    }
+
+    FileLoc startLoc = mLoc;
+
+    int ch = getChar();
+    if (ch == EOF)
+    {
+        return {};
+    }
+    else if (ch == '"')
+    {
+        // Scan to closing quote.
+        bool haveEscaped = false;
+        while ((ch = getChar()) != '"')
         {
-            // Scan to closing quote.
-            bool haveEscaped = false;
-            while ((ch = getChar()) != '"')
+            if (ch == EOF)
             {
-                if (ch == EOF)
-                {
-                    throwError(startLoc, "Premature EOF.");
-                }
-                else if (ch == '\n')
-                {
-                    throwError(startLoc, "Unterminated string.");
-                }
-                else if (ch == '\\')
-                {
-                    haveEscaped = true;
-                    // Grab the next character.
-                    if ((ch = getChar()) == EOF)
-                    {
-                        throwError(startLoc, "Premature EOF.");
-                    }
-                }
+                throwError(startLoc, "Premature EOF.");
             }
-
-            if (!haveEscaped)
+            else if (ch == '\n')
             {
-                return Token({tokenStart, size_t(mPos - tokenStart)}, startLoc);
+                throwError(startLoc, "Unterminated string.");
             }
-            else
+            else if (ch == '\\')
             {
-                mEscaped.clear();
-                for (const char* p = tokenStart; p < mPos; ++p)
+                haveEscaped = true;
+                // Grab the next character.
+                if ((ch = getChar()) == EOF)
                 {
-                    if (*p != '\\')
-                    {
-                        mEscaped.push_back(*p);
-                    }
-                    else
-                    {
-                        ++p;
-                        FALCOR_ASSERT(p < mPos);
-                        mEscaped.push_back(decodeEscaped(*p, startLoc));
-                    }
+                    throwError(startLoc, "Premature EOF.");
                 }
-                return Token({mEscaped.data(), mEscaped.size()}, startLoc);
             }
         }
-        else if (ch == '[' || ch == ']')
+
+        if (!haveEscaped)
         {
-            return Token({tokenStart, size_t(1)}, startLoc);
+            return Token({mTokenStart, size_t(mPos - mTokenStart)}, startLoc);
         }
-        else if (ch == '#')
+        else
         {
-            // Comment: scan to EOL (or EOF).
-            while ((ch = getChar()) != EOF)
+            mEscaped.clear();
+            for (const char* p = mTokenStart; p < mPos; ++p)
             {
-                if (ch == '\n' || ch == '\r')
+                if (*p != '\\')
                 {
-                    ungetChar();
-                    break;
+                    mEscaped.push_back(*p);
+                }
+                else
+                {
+                    ++p;
+                    FALCOR_ASSERT(p < mPos);
+                    mEscaped.push_back(decodeEscaped(*p, startLoc));
                 }
             }
+            return Token({mEscaped.data(), mEscaped.size()}, startLoc);
+        }
+    }
+    else if (ch == '[' || ch == ']')
+    {
+        return Token({mTokenStart, size_t(1)}, startLoc);
+    }
+    else
+    {
+        // Comment: scan to EOL (or EOF).
+        // Regular statement or numeric token: scan until we hit a space, opening quote, or bracket.
+        CharClass terminator = ch == '#' ? kLineEnd : kDelimiter;
+        while (true)
+        {
+            const char* p = mPos;
+            while (p < mEnd && !kCharClasses.is(*p, terminator))
+                ++p;
+            mLoc.column += uint32_t(p - mPos);
+            mPos = p;
+            if (mPos < mEnd || !refill())
+                break;
+        }
+        return Token({mTokenStart, size_t(mPos - mTokenStart)}, startLoc);
+    }
+}
 
-            return Token({tokenStart, size_t(mPos - tokenStart)}, startLoc);
+size_t Tokenizer::countArrayValues() const
+{
+    size_t count = 0;
+    bool inValue = false;
+    for (const char* p = mPos; p < mEnd; ++p)
+    {
+        if (kCharClasses.is(*p, kWhitespace))
+        {
+            inValue = false;
+        }
+        else if (kCharClasses.is(*p, kArrayValue))
+        {
+            count += inValue ? 0 : 1;
+            inValue = true;
         }
         else
         {
-            // Regular statement or numeric token. Scan until we hit a space, opening quote, or bracket.
-            while ((ch = getChar()) != EOF)
-            {
-                if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == '"' || ch == '[' || ch == ']')
-                {
-                    ungetChar();
-                    break;
-                }
-            }
-            return Token({tokenStart, size_t(mPos - tokenStart)}, startLoc);
+            // Stop at the closing bracket, give up on strings, comments or malformed values.
+            return *p == ']' ? count : 0;
         }
     }
+    // Reached the end of the current chunk.
+    return count;
 }
 
 static int32_t parseInt(const Token& t)
@@ -279,8 +395,8 @@ static std::string_view dequoteString(const Token& t)
 constexpr uint32_t TokenOptional = 0;
 constexpr uint32_t TokenRequired = 1;
 
-template<typename Next, typename Unget>
-static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
+template<typename Next, typename Unget, typename CountArrayValues>
+static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken, CountArrayValues countArrayValues)
 {
     ParsedParameterVector parameterVector;
 
@@ -342,6 +458,9 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
         if (param.type == "integer")
             valType = Int;
 
+        // Number of values in the array, used to pre-size the value arrays.
+        size_t arraySize = 0;
+
         auto addVal = [&](const Token& t)
         {
             if (isQuotedString(t.token))
@@ -380,6 +499,8 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
                     break;
                 }
 
+                if (param.bools.empty())
+                    param.bools.reserve(arraySize);
                 param.addBool(true);
             }
             else if (t.token[0] == 'f' && t.token == "false")
@@ -399,6 +520,8 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
                     break;
                 }
 
+                if (param.bools.empty())
+                    param.bools.reserve(arraySize);
                 param.addBool(false);
             }
             else
@@ -419,9 +542,17 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
                 }
 
                 if (valType == Int)
+                {
+                    if (param.ints.empty())
+                        param.ints.reserve(arraySize);
                     param.addInt(parseInt(t));
+                }
                 else
+                {
+                    if (param.floats.empty())
+                        param.floats.reserve(arraySize);
                     param.addFloat(parseFloat(t));
+                }
             }
         };
 
@@ -429,6 +560,7 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
 
         if (val.token == "[")
         {
+            arraySize = countArrayValues();
             while (true)
             {
                 val = *nextToken(TokenRequired);
@@ -442,23 +574,30 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
             addVal(val);
         }
 
-        parameterVector.push_back(param);
+        parameterVector.push_back(std::move(param));
     }
 
     return parameterVector;
 }
 
-void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
+void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, const std::filesystem::path& searchPath)
 {
     static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
 
     logInfo("PBRTImporter: Started parsing '{}'.", tokenizer->getPath().string());
 
-    auto searchPath = tokenizer->getPath().parent_path();
-
     std::vector<std::unique_ptr<Tokenizer>> fileStack;
     fileStack.push_back(std::move(tokenizer));
 
+    struct Import
+    {
+        std::filesystem::path path;
+        FileLoc loc;
+        std::unique_ptr<ParserTarget> pTarget;
+        std::exception_ptr pException;
+    };
+    std::vector<Import> imports;
+
     std::optional<Token> ungetToken;
 
     /**
@@ -505,6 +644,13 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         ungetToken = t;
     };
 
+    auto countArrayValues = [&]() -> size_t
+    {
+        if (ungetToken.has_value() || fileStack.empty())
+            return 0;
+        return fileStack.back()->countArrayValues();
+    };
+
     /**
      * Helper function for pbrt API entrypoints that take a single string
      * parameter and a ParameterVector (e.g. onShape()).
@@ -514,7 +660,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         Token t = *nextToken(TokenRequired);
         std::string_view dequoted = dequoteString(t);
         std::string n = toString(dequoted);
-        ParsedParameterVector parameterVector = parseParameters(nextToken, unget);
+        ParsedParameterVector parameterVector = parseParameters(nextToken, unget, countArrayValues);
         (target.*apiFunc)(n, std::move(parameterVector), loc);
     };
 
@@ -639,7 +785,10 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             }
             else if (tok->token == "Import")
             {
-                throwError(tok->loc, "'Import' directive not supported yet.");
+                Token filenameToken = *nextToken(TokenRequired);
+                std::string filename = toString(dequoteString(filenameToken));
+                // Imported files are parsed once this file is done, see below.
+                imports.push_back({searchPath / filename, tok->loc, target.onImportBegin(tok->loc)});
             }
             else if (tok->token == "Identity")
             {
@@ -850,7 +999,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 Token t = *nextToken(TokenRequired);
                 std::string_view dequoted = dequoteString(t);
                 std::string texName = toString(dequoted);
-                ParsedParameterVector params = parseParameters(nextToken, unget);
+                ParsedParameterVector params = parseParameters(nextToken, unget, countArrayValues);
                 target.onTexture(name, type, texName, std::move(params), tok->loc);
             }
             else
@@ -874,19 +1023,49 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             syntaxError(*tok);
         }
     }
+
+    // Parse imported files in parallel, each into its own target.
+    // Exceptions are captured and rethrown in order of the Import directives.
+    std::for_each(
+        std::execution::par,
+        imports.begin(),
+        imports.end(),
+        [&](Import& import)
+        {
+            try
+            {
+                parse(*import.pTarget, Tokenizer::createFromFile(import.path), searchPath);
+                import.pTarget->onEndOfFiles();
+            }
+            catch (...)
+            {
+                import.pException = std::current_exception();
+            }
+        }
+    );
+
+    // Merge imported targets in order, so the resulting scene does not depend on thread scheduling.
+    for (auto& import : imports)
+    {
+        if (import.pException)
+            std::rethrow_exception(import.pException);
+        target.onImportEnd(*import.pTarget, import.loc);
+    }
 }
 
 void parseFile(ParserTarget& target, const std::filesystem::path& path)
 {
     auto tokenizer = Tokenizer::createFromFile(path);
-    parse(target, std::move(tokenizer));
+    auto searchPath = tokenizer->getPath().parent_path();
+    parse(target, std::move(tokenizer), searchPath);
     target.onEndOfFiles();
 }
 
 void parseString(ParserTarget& target, std::string str)
 {
     auto tokenizer = Tokenizer::createFromString(std::move(str));
-    parse(target, std::move(tokenizer));
+    auto searchPath = tokenizer->getPath().parent_path();
+    parse(target, std::move(tokenizer), searchPath);
     target.onEndOfFiles();
 }
 
@@ -35,11 +35,14 @@
 
 #include "Types.h"
 #include "Parameters.h"
+#include "Core/Platform/CompressedFileReader.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include <functional>
 #include <filesystem>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace Falcor::pbrt
 {
@@ -98,6 +101,19 @@ public:
     virtual void onObjectEnd(FileLoc loc) = 0;
     virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
 
+    /**
+     * Create a separate target for parsing an imported file.
+     * Imported files are parsed in parallel after the importing file. The returned target starts from the
+     * current graphics state, changes to the graphics state inside the imported file are not propagated back.
+     */
+    virtual std::unique_ptr<ParserTarget> onImportBegin(FileLoc loc) = 0;
+
+    /**
+     * Merge a target created by onImportBegin() after the imported file has been parsed.
+     * Imported targets are merged in the order of the Import directives.
+     */
+    virtual void onImportEnd(ParserTarget& importTarget, FileLoc loc) = 0;
+
     virtual void onEndOfFiles() = 0;
 };
 
@@ -118,18 +134,41 @@ class Tokenizer
 public:
     Tokenizer(std::string str, const std::filesystem::path& path);
 
+    /**
+     * Create a tokenizer reading from a memory-mapped file.
+     * Tokens are referencing the mapped memory directly.
+     */
+    Tokenizer(std::unique_ptr<MemoryMappedFile> pFile, const std::filesystem::path& path);
+
+    /**
+     * Create a tokenizer reading from a compressed file.
+     * The file is decompressed in chunks while tokenizing, only two chunks are kept in memory.
+     */
+    Tokenizer(std::unique_ptr<CompressedFileReader> pReader, const std::filesystem::path& path);
+
     static std::unique_ptr<Tokenizer> createFromFile(const std::filesystem::path& path);
     static std::unique_ptr<Tokenizer> createFromString(std::string str);
 
     /**
      * Get the next token.
      * Note: The Token::token field is only valid until the next call to next().
+     * When reading from a compressed file, tokens are kept valid until the next chunk is decompressed.
      */
     std::optional<Token> next();
 
+    /**
+     * Count the number of values in the array following the current position.
+     * This is used to pre-size parameter arrays. Only numeric and Boolean arrays are counted.
+     * @return Number of values before the closing bracket. Returns 0 if unknown.
+     */
+    size_t countArrayValues() const;
+
     const std::filesystem::path& getPath() const { return mPath; }
 
 private:
+    /// Size of the decompressed chunks when reading from a compressed file.
+    static constexpr size_t kChunkSize = 4 * 1024 * 1024;
+
     /**
      * Static list of filenames to allow file locations (FileLoc::filename) to be valid
      * even after the tokenizer is destroyed.
@@ -140,11 +179,20 @@ private:
         return filenames;
     }
 
+    void init(const char* data, size_t size);
+
     bool isUTF16(const void* ptr, size_t len) const;
 
+    /**
+     * Decompress the next chunk from the compressed file.
+     * The current token (starting at mTokenStart) is copied to the start of the new chunk.
+     * @return False if there is no more data.
+     */
+    bool refill();
+
     int getChar()
     {
-        if (mPos == mEnd)
+        if (mPos == mEnd && !refill())
             return EOF;
         int ch = *mPos++;
         if (ch == '\n')
@@ -159,23 +207,18 @@ private:
         return ch;
     }
 
-    void ungetChar()
-    {
-        --mPos;
-        if (*mPos == '\n')
-        {
-            // Don't worry about the column; we'll be going to the start of
-            // the next line again shortly...
-            --mLoc.line;
-        }
-    }
-
     std::filesystem::path mPath; ///< File path we're reading from.
     FileLoc mLoc;                ///< File location.
-    std::string mContents;       ///< File contents we're parsing.
+    std::string mContents;       ///< File contents we're parsing (if parsing from a string).
+
+    std::unique_ptr<MemoryMappedFile> mpFile;          ///< Memory-mapped file (if parsing from a file).
+    std::unique_ptr<CompressedFileReader> mpReader;    ///< Compressed file (if parsing from a compressed file).
+    std::vector<char> mChunks[2];                      ///< Decompressed chunks (if parsing from a compressed file).
+    uint32_t mChunkIndex = 0;                          ///< Index of the current chunk.
 
-    const char* mPos; ///< Current position in the file.
-    const char* mEnd; ///< End of the file (one past).
+    const char* mPos = nullptr;        ///< Current position in the file.
+    const char* mEnd = nullptr;        ///< End of the file or current chunk (one past).
+    const char* mTokenStart = nullptr; ///< Start of the current token.
 
     std::string mEscaped; ///< Temporary storage for escaped tokens.
 };
@@ -238,10 +238,11 @@ class Test:
 
         return Test.Result.PASSED, [], rerun_env
 
-    def compare_images(self, ref_dir: Path, result_dir: Path, image_compare_exe: Path):
+    def compare_images(self, ref_dir: Path, result_dir: Path, image_compare_exe: Path, temp_dir: Path):
         '''
         Run ImageCompare on a set of images in ref_dir and result_dir.
         Checks if error between reference and result image is within a given tolerance.
+        All images are compared by a single ImageCompare process in batch mode.
         Returns a tuple containing the result code, a list of messages and a list of image reports.
         '''
         # Bail out if test is skipped.
@@ -270,8 +271,9 @@ class Test:
         messages = []
         image_reports = []
 
-        # Compare every result image with the corresponding reference image and report missing references.
-        processes = {}
+        # Collect image pairs and report missing references.
+        images = []
+        manifest = []
         for image in result_images:
             if not image in ref_images:
                 result = Test.Result.FAILED
@@ -281,30 +283,44 @@ class Test:
             ref_file = ref_dir / image
             result_file = result_dir / image
             error_file = result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)
+            images.append(image)
+            manifest.append(f'{ref_file}\t{result_file}\t{error_file}')
+
+        # Compare every result image with the corresponding reference image.
+        if len(images) > 0:
+            temp_dir.mkdir(parents=True, exist_ok=True)
+            file_prefix = f'{self.name.split("/")[-1]}_{hashlib.sha1(str(result_dir).encode()).hexdigest()[:8]}'
+            manifest_file = temp_dir / f'{file_prefix}_compare.txt'
+            compare_report_file = temp_dir / f'{file_prefix}_compare.json'
+            manifest_file.write_text('\n'.join(manifest) + '\n')
+            compare_report_file.unlink(missing_ok=True)
+
+            args = [str(image_compare_exe), '-m', 'mse', '-t', str(self.tolerance), '--manifest', str(manifest_file), '--json', str(compare_report_file)]
+            process = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+            if not self.process_controller.add_process(self.name + ":image_compare", process):
+                return Test.Result.FAILED, ['Process killed due to global exit'], []
+            output = process.communicate()[0]
 
-            args = [str(image_compare_exe), '-m', 'mse', '-t', str(self.tolerance), str(ref_file), str(result_file)]
-            if error_file:
-                args += ['-e', str(error_file)]
-            processes[image] = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
-            if not self.process_controller.add_process(self.name + ":image:" + str(image), processes[image]):
-                return Test.Result.FAILED, ['Process killed due to global exit']
-
-        for image, process in processes.items():
+            if not compare_report_file.exists():
+                errors = list(map(lambda l: l.rstrip(), output.decode('utf-8').splitlines()))
+                return Test.Result.FAILED, errors + [f'{image_compare_exe} exited with return code {process.returncode}'], []
+            compare_report = json.loads(compare_report_file.read_text())
 
-            output = process.communicate()[0]
-            compare_success =  process.returncode == 0
-            compare_error = float(output.strip())
+            for image, entry in zip(images, compare_report['results']):
+                compare_success = entry['success']
+                compare_error = entry['error'] if entry['error'] is not None else float('nan')
 
-            if not compare_success:
-                result = Test.Result.FAILED
-                messages.append(f'Test image "{image}" failed with error {compare_error}.')
+                if not compare_success:
+                    result = Test.Result.FAILED
+                    messages.append(f'Test image "{image}" failed with error {compare_error}.')
+                    messages += entry['messages']
 
-            image_reports.append({
-                'name': str(image),
-                'success': compare_success,
-                'error': compare_error,
-                'tolerance': self.tolerance
-            })
+                image_reports.append({
+                    'name': str(image),
+                    'success': compare_success,
+                    'error': compare_error,
+                    'tolerance': self.tolerance
+                })
 
         # Report missing result images for existing reference images.
         for image in ref_images:
@@ -340,7 +356,7 @@ class Test:
 
         # Compare to references.
         if not run_only and result == Test.Result.PASSED:
-            result, messages, report['images'] = self.compare_images(ref_dir, result_dir, image_compare_exe)
+            result, messages, report['images'] = self.compare_images(ref_dir, result_dir, image_compare_exe, temp_dir)
 
         # Finish report.
         report['result'] = Test.RESULT_STRING[result]